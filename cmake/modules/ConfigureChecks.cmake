@@ -6,9 +6,12 @@ include(CheckCXXSourceCompiles)
 include(TestBigEndian)
 
 check_function_exists(stat64 HAVE_STAT64)
+check_function_exists(posix_fadvise HAVE_POSIX_FADVISE)
+check_function_exists(mincore HAVE_MINCORE)
 
 check_include_files(sys/vfs.h HAVE_SYS_VFS_H)
 check_include_files(sys/statvfs.h HAVE_SYS_STATVFS_H)
 check_include_files(byteswap.h HAVE_BYTESWAP_H)
+check_include_files(sys/inotify.h HAVE_SYS_INOTIFY_H)
 
 test_big_endian(WORDS_BIGENDIAN)
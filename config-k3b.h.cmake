@@ -12,8 +12,14 @@
 
 #cmakedefine HAVE_SYS_STATVFS_H
 
+#cmakedefine HAVE_SYS_INOTIFY_H
+
 #cmakedefine HAVE_STAT64
 
+#cmakedefine HAVE_POSIX_FADVISE
+
+#cmakedefine HAVE_MINCORE
+
 #define K3B_VERSION_STRING "${K3B_VERSION_STRING}"
 
 #cmakedefine ENABLE_HAL_SUPPORT
@@ -25,13 +25,190 @@
 #include <QDateTime>
 #include <QDebug>
 #include <QBitArray>
+#include <QHash>
 #include <QLoggingCategory>
+#include <QMutex>
+#include <QQueue>
+#include <QThread>
+#include <QWaitCondition>
 
 #include <stdlib.h>
 
 namespace
 {
     const int CMD_MIMETYPE = 70; // Should be declared in KIOCore/KIO/Global, but it's missing. Why?
+
+    // files are streamed in blocks of this size...
+    const int s_streamBlockSize = 128*2048;
+
+    // ...with this many blocks read in advance
+    const int s_readAheadBlocks = 4;
+
+    /**
+     * Opened Video DVDs are kept between requests since file managers
+     * issue lots of stat() and listDir() calls for a single folder view.
+     * The primary volume descriptor identifies the medium.
+     *
+     * Only the parsed file system is kept, the device itself is closed
+     * after each request. Encrypted media are read through libdvdcss which
+     * keeps its own handle, so these are dropped after each request.
+     */
+    struct CachedIso
+    {
+        K3b::Iso9660* iso;
+        QByteArray mediaId;
+        bool encrypted;
+    };
+
+    QHash<K3b::Device::Device*, CachedIso> s_isoCache;
+
+    KIO::UDSEntry createVideoDVDEntry( const K3b::Iso9660SimplePrimaryDescriptor& desc )
+    {
+        KIO::UDSEntry uds;
+        uds.insert( KIO::UDSEntry::UDS_NAME, desc.volumeId );
+        uds.insert( KIO::UDSEntry::UDS_FILE_TYPE, S_IFDIR );
+        uds.insert( KIO::UDSEntry::UDS_MIME_TYPE, "inode/directory" );
+        uds.insert( KIO::UDSEntry::UDS_ICON_NAME, "media-optical-video" );
+        uds.insert( KIO::UDSEntry::UDS_SIZE, desc.volumeSetSize );
+        return uds;
+    }
+
+    QByteArray readMediaId( K3b::Device::Device* dev )
+    {
+        QByteArray pvd( 2048, '\0' );
+        if( dev->read10( reinterpret_cast<unsigned char*>( pvd.data() ), pvd.size(), 16, 1 ) )
+            return pvd;
+        else
+            return QByteArray();
+    }
+
+    /**
+     * \return The opened Iso9660 for the medium in \p dev if it has been
+     * opened before and the medium did not change in the meantime.
+     */
+    K3b::Iso9660* cachedIso( K3b::Device::Device* dev )
+    {
+        QHash<K3b::Device::Device*, CachedIso>::iterator it = s_isoCache.find( dev );
+        if( it == s_isoCache.end() )
+            return 0;
+
+        const QByteArray mediaId = readMediaId( dev );
+        if( !mediaId.isEmpty() && mediaId == it->mediaId )
+            return it->iso;
+
+        qDebug() << "(kio_videodvdProtocol) medium changed in" << dev->blockDeviceName();
+        delete it->iso;
+        s_isoCache.erase( it );
+        return 0;
+    }
+
+    /**
+     * Closes the devices of all cached media. Called at the end of each
+     * request so no device is kept open while the slave is idle.
+     */
+    void releaseDevices()
+    {
+        QHash<K3b::Device::Device*, CachedIso>::iterator it = s_isoCache.begin();
+        while( it != s_isoCache.end() ) {
+            if( it->encrypted ) {
+                delete it->iso;
+                it = s_isoCache.erase( it );
+            }
+            else {
+                it.key()->close();
+                ++it;
+            }
+        }
+    }
+
+    void clearIsoCache()
+    {
+        for( QHash<K3b::Device::Device*, CachedIso>::const_iterator it = s_isoCache.constBegin();
+             it != s_isoCache.constEnd(); ++it )
+            delete it->iso;
+        s_isoCache.clear();
+    }
+
+    /**
+     * Reads a file ahead of the consumer in large blocks so the drive
+     * keeps streaming while the data is sent to the application.
+     */
+    class ReadAheadThread : public QThread
+    {
+    public:
+        explicit ReadAheadThread( const K3b::Iso9660File* file )
+            : m_file( file ),
+              m_finished( false ),
+              m_error( false ),
+              m_canceled( false ) {
+        }
+
+        /**
+         * \return The next block of data or an empty array once the whole
+         *         file has been read or an error occurred.
+         */
+        QByteArray takeBlock() {
+            QMutexLocker locker( &m_mutex );
+            while( m_blocks.isEmpty() && !m_finished )
+                m_cond.wait( &m_mutex );
+            if( m_blocks.isEmpty() )
+                return QByteArray();
+            QByteArray block = m_blocks.dequeue();
+            m_cond.wakeAll();
+            return block;
+        }
+
+        bool hasError() const {
+            QMutexLocker locker( &m_mutex );
+            return m_error;
+        }
+
+        void cancel() {
+            QMutexLocker locker( &m_mutex );
+            m_canceled = true;
+            m_cond.wakeAll();
+        }
+
+    protected:
+        void run() {
+            unsigned int pos = 0;
+            forever {
+                {
+                    QMutexLocker locker( &m_mutex );
+                    while( m_blocks.count() >= s_readAheadBlocks && !m_canceled )
+                        m_cond.wait( &m_mutex );
+                    if( m_canceled )
+                        break;
+                }
+
+                QByteArray block( s_streamBlockSize, Qt::Uninitialized );
+                const int read = m_file->read( pos, block.data(), block.size() );
+
+                QMutexLocker locker( &m_mutex );
+                if( read <= 0 ) {
+                    m_error = ( read < 0 );
+                    break;
+                }
+                block.resize( read );
+                m_blocks.enqueue( block );
+                pos += read;
+                m_cond.wakeAll();
+            }
+
+            QMutexLocker locker( &m_mutex );
+            m_finished = true;
+            m_cond.wakeAll();
+        }
+
+    private:
+        const K3b::Iso9660File* m_file;
+        QQueue<QByteArray> m_blocks;
+        mutable QMutex m_mutex;
+        QWaitCondition m_cond;
+        bool m_finished;
+        bool m_error;
+        bool m_canceled;
+    };
 } // namespace
 
 using namespace KIO;
@@ -94,6 +271,7 @@ kio_videodvdProtocol::~kio_videodvdProtocol()
     s_instanceCnt--;
     if( s_instanceCnt == 0 )
     {
+        clearIsoCache();
         delete s_deviceManager;
         s_deviceManager = 0;
     }
@@ -130,8 +308,6 @@ KIO::UDSEntry kio_videodvdProtocol::createUDSEntry( const K3b::Iso9660Entry* e )
 }
 
 
-// FIXME: remember the iso instance for quicker something and search for the videodvd
-//        in the available devices.
 K3b::Iso9660* kio_videodvdProtocol::openIso( const QUrl& url, QString& plainIsoPath )
 {
     // get the volume id from the url
@@ -139,24 +315,42 @@ K3b::Iso9660* kio_videodvdProtocol::openIso( const QUrl& url, QString& plainIsoP
 
     qDebug() << "(kio_videodvdProtocol) searching for Video dvd: " << volumeId;
 
+    plainIsoPath = url.path().section( '/', 2, -1 ) + '/';
 
     // now search the devices for this volume id
     // FIXME: use the cache created in listVideoDVDs
     QList<K3b::Device::Device *> items(s_deviceManager->dvdReader());
+    for( QList<K3b::Device::Device *>::const_iterator it = items.constBegin();
+         it != items.constEnd(); ++it ) {
+        K3b::Iso9660* iso = cachedIso( *it );
+        if( iso && iso->primaryDescriptor().volumeId == volumeId ) {
+            qDebug() << "(kio_videodvdProtocol) using cached iso with path: " << plainIsoPath;
+            // keep the device open for the rest of the request
+            (*it)->open();
+            return iso;
+        }
+    }
+
     for( QList<K3b::Device::Device *>::const_iterator it = items.constBegin();
          it != items.constEnd(); ++it ) {
         K3b::Device::Device* dev = *it;
+        if( s_isoCache.contains( dev ) )
+            continue;
+
         K3b::Device::DiskInfo di = dev->diskInfo();
 
         // we search for a DVD with a single track.
         // this time let K3b::Iso9660 decide if we need dvdcss or not
         // FIXME: check for encryption and libdvdcss and report an error
         if( K3b::Device::isDvdMedia( di.mediaType() ) && di.numTracks() == 1 ) {
+            const bool encrypted = ( dev->copyrightProtectionSystemType() == K3b::Device::COPYRIGHT_PROTECTION_CSS );
             K3b::Iso9660* iso = new K3b::Iso9660( dev );
             iso->setPlainIso9660( true );
             if( iso->open() /*&& iso->primaryDescriptor().volumeId == volumeId*/ ) {
-                plainIsoPath = url.path().section( '/', 2, -1 ) + '/';
                 qDebug() << "(kio_videodvdProtocol) using iso path: " << plainIsoPath;
+                // without a media id the iso is replaced on the next request
+                CachedIso cached = { iso, readMediaId( dev ), encrypted };
+                s_isoCache.insert( dev, cached );
                 return iso;
             }
             delete iso;
@@ -180,28 +374,28 @@ void kio_videodvdProtocol::get(const QUrl& url )
         {
             const K3b::Iso9660File* file = static_cast<const K3b::Iso9660File*>( e );
             totalSize( file->size() );
-            QByteArray buffer( 10*2048, '\n' );
-            int read = 0;
-            int cnt = 0;
+
+            ReadAheadThread reader( file );
+            reader.start();
+
+            QByteArray block;
             KIO::filesize_t totalRead = 0;
-            while( (read = file->read( totalRead, buffer.data(), buffer.size() )) > 0 )
+            while( !( block = reader.takeBlock() ).isEmpty() )
             {
-                buffer.resize( read );
-                data(buffer);
-                ++cnt;
-                totalRead += read;
-                if( cnt == 10 )
+                data( block );
+                totalRead += block.size();
+                processedSize( totalRead );
+                if( wasKilled() )
                 {
-                    cnt = 0;
-                    processedSize( totalRead );
+                    reader.cancel();
+                    break;
                 }
             }
-
-            delete iso;
+            reader.wait();
 
             data(QByteArray()); // empty array means we're done sending the data
 
-            if( read == 0 )
+            if( !reader.hasError() )
                 finished();
             else
                 error( ERR_SLAVE_DEFINED, i18n("Read error.") );
@@ -209,6 +403,8 @@ void kio_videodvdProtocol::get(const QUrl& url )
         else
             error( ERR_DOES_NOT_EXIST, url.path() );
     }
+
+    releaseDevices();
 }
 
 
@@ -245,11 +441,10 @@ void kio_videodvdProtocol::listDir( const QUrl& url )
             else {
                 error( ERR_CANNOT_ENTER_DIRECTORY, url.path() );
             }
-
-            // for testing we always do the whole thing
-            delete iso;
         }
     }
+
+    releaseDevices();
 }
 
 
@@ -261,6 +456,15 @@ void kio_videodvdProtocol::listVideoDVDs()
     for( QList<K3b::Device::Device *>::const_iterator it = items.constBegin();
          it != items.constEnd(); ++it ) {
         K3b::Device::Device* dev = *it;
+
+        if( const K3b::Iso9660* iso = cachedIso( dev ) ) {
+            if( iso->firstIsoDirEntry()->entry( "VIDEO_TS" ) != 0 ) {
+                udsl.append( createVideoDVDEntry( iso->primaryDescriptor() ) );
+                listEntries( udsl );
+            }
+            continue;
+        }
+
         K3b::Device::DiskInfo di = dev->diskInfo();
 
         // we search for a DVD with a single track.
@@ -273,16 +477,7 @@ void kio_videodvdProtocol::listVideoDVDs()
             K3b::Iso9660 iso( new K3b::Iso9660DeviceBackend(dev) );
             iso.setPlainIso9660( true );
             if( iso.open() && iso.firstIsoDirEntry()->entry( "VIDEO_TS" ) != 0 ) {
-                // FIXME: cache the entry for speedup
-
-                UDSEntry uds;
-                uds.insert( KIO::UDSEntry::UDS_NAME,iso.primaryDescriptor().volumeId );
-                uds.insert( KIO::UDSEntry::UDS_FILE_TYPE, S_IFDIR );
-                uds.insert( KIO::UDSEntry::UDS_MIME_TYPE, "inode/directory" );
-                uds.insert( KIO::UDSEntry::UDS_ICON_NAME, "media-optical-video" );
-                uds.insert( KIO::UDSEntry::UDS_SIZE, iso.primaryDescriptor().volumeSetSize );
-
-                udsl.append( uds );
+                udsl.append( createVideoDVDEntry( iso.primaryDescriptor() ) );
                 listEntries( udsl );
             }
         }
@@ -325,10 +520,10 @@ void kio_videodvdProtocol::stat( const QUrl& url )
             }
             else
                 error( ERR_DOES_NOT_EXIST, url.path() );
-
-            delete iso;
         }
     }
+
+    releaseDevices();
 }
 
 
@@ -372,6 +567,7 @@ void kio_videodvdProtocol::mimetype( const QUrl& url )
                     error( ERR_SLAVE_DEFINED, i18n("Read error.") );
             }
         }
-        delete iso;
     }
+
+    releaseDevices();
 }
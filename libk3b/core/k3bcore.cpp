@@ -18,6 +18,7 @@
 #include "k3bjob.h"
 #include "k3bmediacache.h"
 
+#include "k3bdevice.h"
 #include "k3bdevicemanager.h"
 #include "k3bexternalbinmanager.h"
 #include "k3bdefaultexternalprograms.h"
@@ -227,6 +228,9 @@ void K3b::Core::readSettings( KSharedConfig::Ptr c )
     globalSettings()->readSettings( c->group( "General Options" ) );
     deviceManager()->readConfig( c->group( "Devices" ) );
     externalBinManager()->readConfig( c->group( "External Programs" ) );
+
+    Q_FOREACH( Device::Device* dev, deviceManager()->allDevices() )
+        dev->setCommandTracingEnabled( globalSettings()->traceDeviceCommands() );
 }
 
 
@@ -317,6 +321,8 @@ bool K3b::Core::internalBlockDevice( K3b::Device::Device* dev )
 {
     if( !d->blockedDevices.contains( dev ) ) {
         d->blockedDevices.append( dev );
+        // keep the device open while the job sends its commands
+        dev->holdHandle();
         return true;
     }
     else
@@ -326,7 +332,11 @@ bool K3b::Core::internalBlockDevice( K3b::Device::Device* dev )
 
 void K3b::Core::internalUnblockDevice( K3b::Device::Device* dev )
 {
-    d->blockedDevices.removeAll( dev );
+    if( d->blockedDevices.removeAll( dev ) > 0 )
+        dev->releaseHandle();
+
+    // the medium may have been written by an external application
+    dev->invalidateCachedResponses();
 }
 
 
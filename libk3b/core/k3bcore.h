@@ -116,6 +116,10 @@ namespace K3b {
          * When using this method in a job be aware that reimplementations might
          * open dialogs and resulting in a blocking call.
          *
+         * While blocked the device handle is held open (see Device::Device::holdHandle())
+         * instead of opening and closing the device for each command. Jobs which hand
+         * the device to an external program have to release the handle first.
+         *
          * This method calls internalBlockDevice() to do the actual work.
          */
         bool blockDevice( Device::Device* );
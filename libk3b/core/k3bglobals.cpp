@@ -340,6 +340,8 @@ K3b::WritingApp K3b::writingAppFromString( const QString& s )
         return K3b::WritingAppDvdRwFormat;
     else if (s.toLower() == "cdrskin")
         return K3b::WritingAppCdrskin;
+    else if( s.toLower() == "native" )
+        return K3b::WritingAppNative;
     else
         return K3b::WritingAppAuto;
 }
@@ -356,6 +358,8 @@ QString K3b::writingAppToString( K3b::WritingApp app )
         return "growisofs";
     case WritingAppDvdRwFormat:
         return "dvd+rw-format";
+    case WritingAppNative:
+        return "native";
     default:
         return "auto";
     }
@@ -33,10 +33,12 @@
 #define k3b_struct_stat struct stat64
 #define k3b_stat        ::stat64
 #define k3b_lstat       ::lstat64
+#define k3b_fstatat     ::fstatat64
 #else
 #define k3b_struct_stat struct stat
 #define k3b_stat        ::stat
 #define k3b_lstat       ::lstat
+#define k3b_fstatat     ::fstatat
 #endif
 
 
@@ -66,7 +68,8 @@ namespace K3b {
         WritingAppCdrdao = 2,
         WritingAppGrowisofs = 4,
         WritingAppDvdRwFormat = 8,
-        WritingAppCdrskin = 9
+        WritingAppCdrskin = 9,
+        WritingAppNative = 16 /**< Write DVD and Blu-ray media directly via MMC commands */
     };
     Q_DECLARE_FLAGS( WritingApps, WritingApp )
 
@@ -25,7 +25,8 @@ K3b::GlobalSettings::GlobalSettings()
       m_overburn(false),
       m_useManualBufferSize(false),
       m_bufferSize(4),
-      m_force(false)
+      m_force(false),
+      m_traceDeviceCommands(false)
 {
 }
 
@@ -43,6 +44,7 @@ void K3b::GlobalSettings::readSettings( const KConfigGroup& c )
     m_useManualBufferSize = c.readEntry( "Manual buffer size", false );
     m_bufferSize = c.readEntry( "Fifo buffer", 4 );
     m_force = c.readEntry( "Force unsafe operations", false );
+    m_traceDeviceCommands = c.readEntry( "Trace device commands", false );
 	m_defaultTempPath = c.readPathEntry("Temp Dir",
             QStandardPaths::writableLocation(QStandardPaths::MoviesLocation));
     QFileInfo checkPath(m_defaultTempPath);
@@ -61,5 +63,6 @@ void K3b::GlobalSettings::saveSettings( KConfigGroup c )
     c.writeEntry( "Manual buffer size", m_useManualBufferSize );
     c.writeEntry( "Fifo buffer", m_bufferSize );
     c.writeEntry( "Force unsafe operations", m_force );
+    c.writeEntry( "Trace device commands", m_traceDeviceCommands );
     c.writeEntry( "Temp Dir", m_defaultTempPath );
 }
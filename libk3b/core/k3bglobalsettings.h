@@ -60,6 +60,13 @@ namespace K3b {
          */
         QString defaultTempPath() const { return m_defaultTempPath; }
 
+        /**
+         * If true the commands sent to the devices are traced for
+         * the debugging output.
+         * \sa K3b::Device::Device::setCommandTracingEnabled
+         */
+        bool traceDeviceCommands() const { return m_traceDeviceCommands; }
+
         void setEjectMedia( bool b ) { m_eject = b; }
         void setBurnfree( bool b ) { m_burnfree = b; }
         void setOverburn( bool b ) { m_overburn = b; }
@@ -67,6 +74,7 @@ namespace K3b {
         void setBufferSize( int size ) { m_bufferSize = size; }
         void setForce( bool b ) { m_force = b; }
         void setDefaultTempPath( const QString& s ) { m_defaultTempPath = s; }
+        void setTraceDeviceCommands( bool b ) { m_traceDeviceCommands = b; }
 
     private:
         // FIXME: d-pointer
@@ -77,6 +85,7 @@ namespace K3b {
         int m_bufferSize;
         bool m_force;
         QString m_defaultTempPath;
+        bool m_traceDeviceCommands;
     };
 }
 
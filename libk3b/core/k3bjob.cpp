@@ -20,6 +20,7 @@
 
 #include <QDebug>
 #include <QEventLoop>
+#include <QSharedPointer>
 #include <QStringList>
 
 
@@ -34,9 +35,37 @@ public:
     bool active;
 
     QList<QEventLoop*> waitLoops;
+
+    QSharedPointer<K3b::JobTelemetry> telemetry;
+    int telemetryStage;
+
+    void startTelemetry( K3b::Job* job, K3b::Job* parentJob );
 };
 
 
+void K3b::Job::Private::startTelemetry( K3b::Job* job, K3b::Job* parentJob )
+{
+    //
+    // Subjobs record into the telemetry of the top-level job. A new one is
+    // created for every run of a top-level job so old subjobs do not mix in.
+    //
+    int parentStage = -1;
+    if( parentJob && parentJob->d->telemetry ) {
+        telemetry = parentJob->d->telemetry;
+        parentStage = parentJob->d->telemetryStage;
+    }
+    else {
+        telemetry.reset( new K3b::JobTelemetry() );
+        telemetry->start( job->jobDescription() );
+    }
+
+    QString name = QString::fromLatin1( job->metaObject()->className() );
+    if( name.startsWith( QLatin1String( "K3b::" ) ) )
+        name = name.mid( 5 );
+    telemetryStage = telemetry->addStage( name, parentStage );
+}
+
+
 const char K3b::Job::DEFAULT_SIGNAL_CONNECTION[] = "K3b::JobDefault";
 
 
@@ -47,6 +76,7 @@ K3b::Job::Job( K3b::JobHandler* handler, QObject* parent )
     d->jobHandler = handler;
     d->canceled = false;
     d->active = false;
+    d->telemetryStage = -1;
 
     connect( this, SIGNAL(canceled()),
              this, SLOT(slotCanceled()) );
@@ -102,10 +132,15 @@ void K3b::Job::jobStarted()
     d->canceled = false;
     d->active = true;
 
-    if( jobHandler() && jobHandler()->isJob() )
-        static_cast<K3b::Job*>(jobHandler())->registerSubJob( this );
-    else
+    if( jobHandler() && jobHandler()->isJob() ) {
+        K3b::Job* parentJob = static_cast<K3b::Job*>(jobHandler());
+        d->startTelemetry( this, parentJob );
+        parentJob->registerSubJob( this );
+    }
+    else {
+        d->startTelemetry( this, 0 );
         k3bcore->registerJob( this );
+    }
 
     emit started();
 }
@@ -115,6 +150,9 @@ void K3b::Job::jobFinished( bool success )
 {
     d->active = false;
 
+    if( d->telemetry )
+        d->telemetry->flush( d->telemetryStage );
+
     if( jobHandler() && jobHandler()->isJob() )
         static_cast<K3b::Job*>(jobHandler())->unregisterSubJob( this );
     else
@@ -128,6 +166,25 @@ void K3b::Job::jobFinished( bool success )
 }
 
 
+K3b::JobTelemetry* K3b::Job::telemetry() const
+{
+    return d->telemetry.data();
+}
+
+
+int K3b::Job::telemetryStage() const
+{
+    return d->telemetryStage;
+}
+
+
+void K3b::Job::recordTelemetry( K3b::JobTelemetry::Kind kind, qint64 value )
+{
+    if( d->telemetry )
+        d->telemetry->record( d->telemetryStage, kind, value );
+}
+
+
 void K3b::Job::slotCanceled()
 {
     d->canceled = true;
@@ -316,6 +373,23 @@ K3b::BurnJob::BurnJob( K3b::JobHandler* handler, QObject* parent )
       d( new Private() )
 {
     d->writeMethod = K3b::WritingAppAuto;
+
+    //
+    // Most burn jobs only forward the signals of their writer which records
+    // the samples itself.
+    //
+    connect( this, &K3b::BurnJob::bufferStatus, this, [this]( int fill ) {
+        if( numRunningSubJobs() == 0 )
+            recordTelemetry( K3b::JobTelemetry::FifoFill, fill );
+    } );
+    connect( this, &K3b::BurnJob::deviceBuffer, this, [this]( int fill ) {
+        if( numRunningSubJobs() == 0 )
+            recordTelemetry( K3b::JobTelemetry::DeviceBuffer, fill );
+    } );
+    connect( this, &K3b::BurnJob::writeSpeed, this, [this]( int speed, K3b::Device::SpeedMultiplicator ) {
+        if( numRunningSubJobs() == 0 )
+            recordTelemetry( K3b::JobTelemetry::WriteSpeed, speed );
+    } );
 }
 
 
@@ -21,6 +21,7 @@
 #include "k3bdevicetypes.h"
 #include "k3bglobals.h"
 #include "k3bjobhandler.h"
+#include "k3bjobtelemetry.h"
 
 #include <QObject>
 #include <QString>
@@ -178,6 +179,19 @@ namespace K3b {
          */
         void wait();
 
+        /**
+         * The telemetry of the job tree this job belongs to. It is created
+         * when the top-level job is started and shared by all its subjobs.
+         *
+         * \return 0 if the job has never been started.
+         */
+        JobTelemetry* telemetry() const;
+
+        /**
+         * The telemetry stage of this job, -1 if the job has never been started.
+         */
+        int telemetryStage() const;
+
     public Q_SLOTS:
         /**
          * This is the slot that starts the job. The first call should always
@@ -253,6 +267,15 @@ namespace K3b {
          */
         virtual void jobFinished( bool success );
 
+        /**
+         * Records a telemetry sample for this job. Thread-safe and cheap
+         * enough to be called for every block of data.
+         *
+         * Buffer levels and the writing speed of writers and burn jobs are
+         * recorded automatically.
+         */
+        void recordTelemetry( JobTelemetry::Kind kind, qint64 value );
+
     private Q_SLOTS:
         void slotCanceled();
         void slotNewSubTask( const QString& str );
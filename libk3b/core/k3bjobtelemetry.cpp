@@ -0,0 +1,277 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bjobtelemetry.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+
+#include <atomic>
+
+
+K3b::JobTelemetry::JobTelemetry()
+    : m_slots( new Slot[RingSize] ),
+      m_head( 0 ),
+      m_stages( new StageState[MaxStages] ),
+      m_numStages( 0 ),
+      m_sampleInterval( 100*1000 ),
+      m_stallThreshold( 2*1000*1000 )
+{
+    start();
+}
+
+
+K3b::JobTelemetry::~JobTelemetry()
+{
+    delete [] m_slots;
+    delete [] m_stages;
+}
+
+
+void K3b::JobTelemetry::start( const QString& description )
+{
+    QMutexLocker locker( &m_stageMutex );
+
+    m_head.storeRelease( 0 );
+    for( int i = 0; i < RingSize; ++i )
+        m_slots[i].sequence.storeRelease( 0 );
+
+    m_numStages.storeRelease( 0 );
+    m_stageNames.clear();
+    m_parents.clear();
+
+    m_description = description;
+    m_startTime = QDateTime::currentDateTimeUtc();
+    m_clock.start();
+}
+
+
+int K3b::JobTelemetry::addStage( const QString& name, int parent )
+{
+    QMutexLocker locker( &m_stageMutex );
+
+    const int stage = m_stageNames.count();
+    if( stage >= MaxStages ) {
+        qDebug() << "(K3b::JobTelemetry) too many stages, ignoring" << name;
+        return -1;
+    }
+
+    QString uniqueName = name;
+    for( int i = 2; m_stageNames.contains( uniqueName ); ++i )
+        uniqueName = QString::fromLatin1( "%1#%2" ).arg( name ).arg( i );
+
+    // the bytes start out as recorded so flush() does not record stages without data
+    StageState& s = m_stages[stage];
+    s.bytes.store( 0 );
+    s.recordedBytes.store( 0 );
+    s.lastSample.store( -1 );
+    s.lastProgress.store( -1 );
+
+    m_stageNames.append( uniqueName );
+    m_parents.append( parent >= 0 && parent < stage ? parent : -1 );
+    m_numStages.storeRelease( stage + 1 );
+
+    return stage;
+}
+
+
+QString K3b::JobTelemetry::stageName( int stage ) const
+{
+    QMutexLocker locker( &m_stageMutex );
+    return m_stageNames.value( stage );
+}
+
+
+int K3b::JobTelemetry::parentStage( int stage ) const
+{
+    QMutexLocker locker( &m_stageMutex );
+    return m_parents.value( stage, -1 );
+}
+
+
+int K3b::JobTelemetry::numStages() const
+{
+    return m_numStages.loadAcquire();
+}
+
+
+void K3b::JobTelemetry::setSampleInterval( int msecs )
+{
+    m_sampleInterval = qint64( msecs )*1000;
+}
+
+
+void K3b::JobTelemetry::setStallThreshold( int msecs )
+{
+    m_stallThreshold = qint64( msecs )*1000;
+}
+
+
+void K3b::JobTelemetry::store( int stage, Kind kind, qint64 value, qint64 timestamp )
+{
+    //
+    // Same scheme as in Device::CommandTrace: the sequence number of a slot is 0
+    // while it is being written and the position plus one once it is complete.
+    //
+    const quint64 pos = m_head.fetchAndAddRelaxed( 1 );
+    Slot& slot = m_slots[pos % RingSize];
+    slot.sequence.storeRelease( 0 );
+    std::atomic_thread_fence( std::memory_order_release );
+    slot.sample.timestamp = timestamp;
+    slot.sample.stage = stage;
+    slot.sample.kind = kind;
+    slot.sample.value = value;
+    slot.sequence.storeRelease( pos + 1 );
+}
+
+
+void K3b::JobTelemetry::record( int stage, Kind kind, qint64 value )
+{
+    if( stage < 0 || stage >= m_numStages.loadAcquire() )
+        return;
+
+    const qint64 now = m_clock.nsecsElapsed()/1000;
+
+    if( kind != Bytes ) {
+        store( stage, kind, value, now );
+        return;
+    }
+
+    StageState& s = m_stages[stage];
+    const qint64 previous = s.bytes.fetchAndStoreRelaxed( value );
+    if( value > previous ) {
+        const qint64 lastProgress = s.lastProgress.fetchAndStoreRelaxed( now );
+        if( lastProgress >= 0 && now - lastProgress > m_stallThreshold )
+            store( stage, Stall, ( now - lastProgress )/1000, now );
+    }
+
+    const qint64 lastSample = s.lastSample.loadAcquire();
+    if( lastSample >= 0 && now - lastSample < m_sampleInterval )
+        return;
+
+    // only one of several threads updating the same stage records the sample
+    if( s.lastSample.testAndSetOrdered( lastSample, now ) ) {
+        s.recordedBytes.store( value );
+        store( stage, Bytes, value, now );
+    }
+}
+
+
+void K3b::JobTelemetry::flush( int stage )
+{
+    if( stage < 0 || stage >= m_numStages.loadAcquire() )
+        return;
+
+    StageState& s = m_stages[stage];
+    const qint64 bytes = s.bytes.load();
+    if( s.recordedBytes.fetchAndStoreOrdered( bytes ) != bytes ) {
+        const qint64 now = m_clock.nsecsElapsed()/1000;
+        s.lastSample.storeRelease( now );
+        store( stage, Bytes, bytes, now );
+    }
+}
+
+
+QList<K3b::JobTelemetry::Sample> K3b::JobTelemetry::samples( qint64 since ) const
+{
+    QList<Sample> list;
+
+    const quint64 head = m_head.loadAcquire();
+    const quint64 start = ( head > quint64( RingSize ) ? head - RingSize : 0 );
+    for( quint64 pos = start; pos < head; ++pos ) {
+        const Slot& slot = m_slots[pos % RingSize];
+        if( slot.sequence.loadAcquire() != pos + 1 )
+            continue;
+        const Sample sample = slot.sample;
+        std::atomic_thread_fence( std::memory_order_acquire );
+        if( slot.sequence.load() == pos + 1 && sample.timestamp > since )
+            list.append( sample );
+    }
+
+    return list;
+}
+
+
+quint64 K3b::JobTelemetry::droppedSamples() const
+{
+    const quint64 head = m_head.loadAcquire();
+    return ( head > quint64( RingSize ) ? head - RingSize : 0 );
+}
+
+
+QString K3b::JobTelemetry::kindString( Kind kind )
+{
+    switch( kind ) {
+    case Bytes:
+        return QLatin1String( "bytes" );
+    case FifoFill:
+        return QLatin1String( "fifo" );
+    case DeviceBuffer:
+        return QLatin1String( "devicebuffer" );
+    case WriteSpeed:
+        return QLatin1String( "writespeed" );
+    case Retry:
+        return QLatin1String( "retry" );
+    case Stall:
+        return QLatin1String( "stall" );
+    }
+    return QString();
+}
+
+
+QByteArray K3b::JobTelemetry::toJsonLine( const Sample& sample ) const
+{
+    QJsonObject o;
+    o.insert( QLatin1String( "t" ), double( sample.timestamp ) );
+    o.insert( QLatin1String( "stage" ), stageName( sample.stage ) );
+    const int parent = parentStage( sample.stage );
+    if( parent >= 0 )
+        o.insert( QLatin1String( "parent" ), stageName( parent ) );
+    o.insert( QLatin1String( "kind" ), kindString( sample.kind ) );
+    o.insert( QLatin1String( "value" ), double( sample.value ) );
+    return QJsonDocument( o ).toJson( QJsonDocument::Compact );
+}
+
+
+QByteArray K3b::JobTelemetry::toJsonLines( qint64 since ) const
+{
+    QJsonObject header;
+    header.insert( QLatin1String( "kind" ), QLatin1String( "start" ) );
+    header.insert( QLatin1String( "time" ), m_startTime.toString( Qt::ISODate ) );
+    header.insert( QLatin1String( "job" ), m_description );
+    header.insert( QLatin1String( "dropped" ), double( droppedSamples() ) );
+
+    QByteArray lines = QJsonDocument( header ).toJson( QJsonDocument::Compact );
+    lines += '\n';
+    Q_FOREACH( const Sample& sample, samples( since ) ) {
+        lines += toJsonLine( sample );
+        lines += '\n';
+    }
+    return lines;
+}
+
+
+bool K3b::JobTelemetry::writeJsonLines( const QString& filename ) const
+{
+    QFile f( filename );
+    if( !f.open( QIODevice::WriteOnly|QIODevice::Truncate ) ) {
+        qDebug() << "(K3b::JobTelemetry) could not open" << filename;
+        return false;
+    }
+
+    const QByteArray lines = toJsonLines();
+    return( f.write( lines ) == lines.size() );
+}
@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef _K3B_JOB_TELEMETRY_H_
+#define _K3B_JOB_TELEMETRY_H_
+
+#include "k3b_export.h"
+
+#include <QAtomicInteger>
+#include <QByteArray>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+
+namespace K3b {
+    /**
+     * Timestamped samples describing the data flow through a job and its
+     * subjobs.
+     *
+     * Every job of a job tree records into the telemetry of the top-level
+     * job under its own stage. Samples are kept in a fixed size ring buffer.
+     * Recording is lock-free and can be done from any thread. Byte counters are
+     * cheap enough to be updated for every block: they are only turned into
+     * samples once per sample interval and when the stage is flushed.
+     *
+     * A stage which does not make progress for longer than the stall threshold
+     * records a Stall sample with the length of the pause once it continues.
+     *
+     * The samples can be exported as JSON lines, one object per sample:
+     * \code
+     * {"kind":"fifo","parent":"CdCopyJob","stage":"CdrecordWriter","t":1520345,"value":97}
+     * \endcode
+     * "t" is the time in usecs since the telemetry has been started.
+     *
+     * \sa Job::telemetry()
+     */
+    class LIBK3B_EXPORT JobTelemetry
+    {
+    public:
+        enum Kind {
+            Bytes,         /**< bytes processed by the stage so far */
+            FifoFill,      /**< fill level of the software FIFO in percent */
+            DeviceBuffer,  /**< fill level of the drive buffer in percent */
+            WriteSpeed,    /**< in KB/s */
+            Retry,         /**< the number of retries of a single operation */
+            Stall          /**< the number of msecs the stage did not make progress */
+        };
+
+        enum {
+            RingSize = 8192,
+            MaxStages = 64
+        };
+
+        struct Sample {
+            qint64 timestamp;   /**< usecs since start() */
+            int stage;
+            Kind kind;
+            qint64 value;
+        };
+
+        JobTelemetry();
+        ~JobTelemetry();
+
+        /**
+         * Forgets all samples and stages and restarts the clock.
+         * Must not be called while stages are recording.
+         */
+        void start( const QString& description = QString() );
+
+        /**
+         * Registers a stage. Names are made unique by appending a number.
+         *
+         * \param parent The stage of the parent job or -1.
+         * \return The id of the stage or -1 if there are too many stages.
+         */
+        int addStage( const QString& name, int parent = -1 );
+
+        QString stageName( int stage ) const;
+        int parentStage( int stage ) const;
+        int numStages() const;
+
+        /**
+         * Records a sample. Thread-safe and lock-free.
+         *
+         * Bytes samples are throttled to the sample interval per stage, use
+         * flush() to record the last value.
+         */
+        void record( int stage, Kind kind, qint64 value );
+
+        /**
+         * Records the last Bytes value of \p stage if it has not been
+         * recorded yet.
+         */
+        void flush( int stage );
+
+        /**
+         * The minimum time between two Bytes samples of a stage. Defaults to
+         * 100 msecs.
+         */
+        void setSampleInterval( int msecs );
+
+        /**
+         * Pauses longer than this are recorded as Stall samples. Defaults to
+         * 2 seconds.
+         */
+        void setStallThreshold( int msecs );
+
+        /**
+         * \return The recorded samples, oldest first.
+         *
+         * \param since Only return samples with a timestamp greater than this.
+         */
+        QList<Sample> samples( qint64 since = -1 ) const;
+
+        /**
+         * \return The number of samples which have been dropped because the
+         * ring buffer was full.
+         */
+        quint64 droppedSamples() const;
+
+        /**
+         * \return One JSON object per sample.
+         */
+        QByteArray toJsonLine( const Sample& sample ) const;
+
+        /**
+         * \return A header line describing the job followed by one line per
+         * sample.
+         */
+        QByteArray toJsonLines( qint64 since = -1 ) const;
+
+        /**
+         * Writes toJsonLines() to \p filename.
+         */
+        bool writeJsonLines( const QString& filename ) const;
+
+        static QString kindString( Kind kind );
+
+    private:
+        void store( int stage, Kind kind, qint64 value, qint64 timestamp );
+
+        struct Slot {
+            QAtomicInteger<quint64> sequence;
+            Sample sample;
+        };
+
+        struct StageState {
+            QAtomicInteger<qint64> bytes;
+            QAtomicInteger<qint64> recordedBytes;
+            QAtomicInteger<qint64> lastSample;
+            QAtomicInteger<qint64> lastProgress;
+        };
+
+        Slot* m_slots;
+        QAtomicInteger<quint64> m_head;
+        StageState* m_stages;
+        QAtomicInt m_numStages;
+        QStringList m_stageNames;
+        QList<int> m_parents;
+        mutable QMutex m_stageMutex;
+
+        qint64 m_sampleInterval;
+        qint64 m_stallThreshold;
+
+        QElapsedTimer m_clock;
+        QDateTime m_startTime;
+        QString m_description;
+
+        Q_DISABLE_COPY( JobTelemetry )
+    };
+}
+
+#endif
@@ -24,13 +24,34 @@
 
 #include <QDebug>
 #include <QFile>
+#include <QList>
+#include <QPair>
+#include <QStringList>
 
 #include <unistd.h>
 
 
+namespace {
+#ifdef Q_OS_NETBSD
+    const int s_defaultBufferSizeSectors = 31;
+    const int s_maxBufferSizeSectors = 31;
+#else
+    const int s_defaultBufferSizeSectors = 128;
+    const int s_maxBufferSizeSectors = 256;
+#endif
 
-// FIXME: determine max DMA buffer size
-static int s_bufferSizeSectors = 10;
+    // number of sectors read without errors before the speed is raised again
+    const int s_speedRampSectors = 16*1024;
+
+    int numSpeedReductions( const QList<QPair<unsigned long, int> >& profile )
+    {
+        int n = 0;
+        for( int i = 1; i < profile.count(); ++i )
+            if( profile[i].second < profile[i-1].second )
+                ++n;
+        return n;
+    }
+}
 
 
 class K3b::DataTrackReader::Private
@@ -57,6 +78,18 @@ public:
     int errorSectorCount;
 
     ReadSectorSize usedSectorSize;
+
+    // determined for each run, readers on different devices do not share anything
+    int bufferSizeSectors;
+
+    // Read speeds in KB/s. maxReadSpeed is 0 if the speed is not controlled.
+    int maxReadSpeed;
+    int minReadSpeed;
+    int readSpeed;
+    int cleanSectors;
+
+    // the sectors at which the read speed changed together with the new speed
+    QList<QPair<unsigned long, int> > speedProfile;
 };
 
 
@@ -66,7 +99,12 @@ K3b::DataTrackReader::Private::Private()
       retries(10),
       device(0),
       ioDevice(0),
-      libcss(0)
+      libcss(0),
+      bufferSizeSectors(0),
+      maxReadSpeed(0),
+      minReadSpeed(0),
+      readSpeed(0),
+      cleanSectors(0)
 {
 }
 
@@ -251,34 +289,31 @@ bool K3b::DataTrackReader::run()
     setErrorRecovery( d->device, d->noCorrection ? 0x21 : 0x20 );
 
     //
-    // Let the drive determine the optimal reading speed
+    // Start at the maximal reading speed. It is lowered around unreadable areas.
     //
-    d->device->setSpeed( 0xffff, 0xffff );
+    initReadSpeed();
 
-#ifdef Q_OS_NETBSD
-    s_bufferSizeSectors = 31;
-#else
-    s_bufferSizeSectors = 128;
-#endif
-    unsigned char* buffer = new unsigned char[d->usedSectorSize*s_bufferSizeSectors];
-    while( s_bufferSizeSectors > 0 && read( buffer, d->firstSector.lba(), s_bufferSizeSectors ) < 0 ) {
+    d->bufferSizeSectors = determineBufferSize();
+    unsigned char* buffer = new unsigned char[d->usedSectorSize*d->bufferSizeSectors];
+    while( d->bufferSizeSectors > 0 && read( buffer, d->firstSector.lba(), d->bufferSizeSectors ) < 0 ) {
         qDebug() << "(K3b::DataTrackReader) determine max read sectors: "
-                 << s_bufferSizeSectors << " too high." << endl;
-        s_bufferSizeSectors /= 2;
+                 << d->bufferSizeSectors << " too high." << endl;
+        d->bufferSizeSectors /= 2;
     }
     qDebug() << "(K3b::DataTrackReader) determine max read sectors: "
-             << s_bufferSizeSectors << " is max." << endl;
+             << d->bufferSizeSectors << " is max." << endl;
 
-    //    s_bufferSizeSectors = K3b::Device::determineMaxReadingBufferSize( d->device, d->firstSector );
-    if( s_bufferSizeSectors <= 0 ) {
+    if( d->bufferSizeSectors <= 0 ) {
         emit infoMessage( i18n("Error while reading sector %1.",d->firstSector.lba()), K3b::Job::MessageError );
+        setErrorRecovery( d->device, d->oldErrorRecoveryMode );
         d->device->block( false );
         k3bcore->unblockDevice( d->device );
+        delete [] buffer;
         return false;
     }
 
-    qDebug() << "(K3b::DataTrackReader) using buffer size of " << s_bufferSizeSectors << " blocks.";
-    emit debuggingOutput( "K3b::DataTrackReader", QString("using buffer size of %1 blocks.").arg( s_bufferSizeSectors ) );
+    qDebug() << "(K3b::DataTrackReader) using buffer size of " << d->bufferSizeSectors << " blocks.";
+    emit debuggingOutput( "K3b::DataTrackReader", QString("using buffer size of %1 blocks.").arg( d->bufferSizeSectors ) );
 
     // 2. get it on
     K3b::Msf currentSector = d->firstSector;
@@ -289,7 +324,7 @@ bool K3b::DataTrackReader::run()
     bool readError = false;
     int lastPercent = 0;
     unsigned long lastReadMb = 0;
-    int bufferLen = s_bufferSizeSectors*d->usedSectorSize;
+    int bufferLen = d->bufferSizeSectors*d->usedSectorSize;
     while( !canceled() && currentSector <= d->lastSector ) {
 
         int maxReadSectors = qMin( bufferLen/d->usedSectorSize, d->lastSector.lba()-currentSector.lba()+1 );
@@ -298,6 +333,7 @@ bool K3b::DataTrackReader::run()
                                 currentSector.lba(),
                                 maxReadSectors );
         if( readSectors < 0 ) {
+            updateReadSpeed( currentSector.lba(), 0, true );
             if( !retryRead( buffer,
                             currentSector.lba(),
                             maxReadSectors ) ) {
@@ -307,6 +343,9 @@ bool K3b::DataTrackReader::run()
             else
                 readSectors = maxReadSectors;
         }
+        else {
+            updateReadSpeed( currentSector.lba(), readSectors, false );
+        }
 
         totalReadSectors += readSectors;
 
@@ -336,6 +375,7 @@ bool K3b::DataTrackReader::run()
         }
 
         currentSector += readSectors;
+        recordTelemetry( K3b::JobTelemetry::Bytes, qint64( totalReadSectors.lba() ) * d->usedSectorSize );
 
         int currentPercent = 100 * (currentSector.lba() - d->firstSector.lba() + 1 ) /
                              (d->lastSector.lba() - d->firstSector.lba() + 1 );
@@ -356,6 +396,17 @@ bool K3b::DataTrackReader::run()
         emit infoMessage( i18np("Ignored %1 erroneous sector.", "Ignored a total of %1 erroneous sectors.", d->errorSectorCount ),
                           K3b::Job::MessageError );
 
+    if( d->speedProfile.count() > 1 ) {
+        QStringList profile;
+        for( int i = 0; i < d->speedProfile.count(); ++i )
+            profile << QString("%1: %2 KB/s").arg( d->speedProfile[i].first ).arg( d->speedProfile[i].second );
+        emit debuggingOutput( "K3b::DataTrackReader", QString("Read speed profile (sector: speed): %1").arg( profile.join( ", " ) ) );
+        emit infoMessage( i18np("Reading speed was reduced %1 time due to read errors.",
+                                "Reading speed was reduced %1 times due to read errors.",
+                                numSpeedReductions( d->speedProfile ) ),
+                          K3b::Job::MessageInfo );
+    }
+
     // reset the error recovery mode
     setErrorRecovery( d->device, d->oldErrorRecoveryMode );
 
@@ -431,6 +482,9 @@ bool K3b::DataTrackReader::retryRead( unsigned char* buffer, unsigned long start
         while( !canceled() && retry && (sectorsRead = read( &buffer[( sector - startSector ) * d->usedSectorSize], sector, 1 )) < 0 )
             --retry;
 
+        if( retry < d->retries )
+            recordTelemetry( K3b::JobTelemetry::Retry, d->retries - retry );
+
         success = ( sectorsRead > 0 );
 
         if( canceled() )
@@ -457,6 +511,92 @@ bool K3b::DataTrackReader::retryRead( unsigned char* buffer, unsigned long start
 }
 
 
+int K3b::DataTrackReader::determineBufferSize()
+{
+    //
+    // Use the transfer length the kernel allows for the device. Without it
+    // we fall back to the default which is reduced in run() if the drive
+    // refuses it.
+    //
+    int sectors = s_defaultBufferSizeSectors;
+    const int maxTransferLength = d->device->maxTransferLength();
+    if( maxTransferLength > 0 )
+        sectors = qBound( 1, maxTransferLength / d->usedSectorSize, s_maxBufferSizeSectors );
+
+    emit debuggingOutput( "K3b::DataTrackReader",
+                          QString("max transfer length of %1: %2 bytes.")
+                          .arg( d->device->blockDeviceName() )
+                          .arg( maxTransferLength ) );
+
+    return sectors;
+}
+
+
+void K3b::DataTrackReader::initReadSpeed()
+{
+    d->speedProfile.clear();
+    d->cleanSectors = 0;
+
+    d->maxReadSpeed = d->device->determineMaximalReadSpeed();
+
+    int factor = K3b::Device::SPEED_FACTOR_CD;
+    if( K3b::Device::isDvdMedia( d->device->mediaType() ) )
+        factor = K3b::Device::SPEED_FACTOR_DVD;
+    else if( K3b::Device::isBdMedia( d->device->mediaType() ) )
+        factor = K3b::Device::SPEED_FACTOR_BD;
+    d->minReadSpeed = 2*factor;
+
+    // without a known maximum we cannot ramp up again and leave the speed to the drive
+    if( d->maxReadSpeed <= d->minReadSpeed )
+        d->maxReadSpeed = 0;
+
+    emit debuggingOutput( "K3b::DataTrackReader",
+                          QString("read speed range: %1 - %2 KB/s.")
+                          .arg( d->minReadSpeed )
+                          .arg( d->maxReadSpeed ) );
+
+    //
+    // Let the drive determine the optimal reading speed
+    //
+    d->device->setSpeed( 0xffff, 0xffff );
+    d->readSpeed = d->maxReadSpeed;
+    d->speedProfile.append( qMakePair( (unsigned long)d->firstSector.lba(), d->readSpeed ) );
+}
+
+
+void K3b::DataTrackReader::updateReadSpeed( unsigned long sector, int sectors, bool error )
+{
+    if( d->maxReadSpeed == 0 )
+        return;
+
+    int speed = d->readSpeed;
+    if( error ) {
+        // slow down quickly when hitting an error-dense area...
+        d->cleanSectors = 0;
+        speed = qMax( d->minReadSpeed, d->readSpeed/2 );
+    }
+    else {
+        // ...and speed up slowly once we are through
+        d->cleanSectors += sectors;
+        if( d->cleanSectors >= s_speedRampSectors && d->readSpeed < d->maxReadSpeed ) {
+            d->cleanSectors = 0;
+            speed = qMin( d->maxReadSpeed, d->readSpeed*3/2 );
+        }
+    }
+
+    if( speed != d->readSpeed ) {
+        emit debuggingOutput( "K3b::DataTrackReader",
+                              QString("Changing read speed from %1 to %2 KB/s at sector %3.")
+                              .arg( d->readSpeed ).arg( speed ).arg( sector ) );
+
+        // at the maximum we let the drive decide again
+        d->device->setSpeed( speed == d->maxReadSpeed ? 0xffff : speed, 0xffff );
+        d->readSpeed = speed;
+        d->speedProfile.append( qMakePair( sector, speed ) );
+    }
+}
+
+
 bool K3b::DataTrackReader::setErrorRecovery( K3b::Device::Device* dev, int code )
 {
     Device::UByteArray data;
@@ -82,6 +82,9 @@ namespace K3b {
 
         int read( unsigned char* buffer, unsigned long sector, unsigned int len );
         bool retryRead( unsigned char* buffer, unsigned long startSector, unsigned int len );
+        int determineBufferSize();
+        void initReadSpeed();
+        void updateReadSpeed( unsigned long sector, int sectors, bool error );
         bool setErrorRecovery( Device::Device* dev, int code );
 
         class Private;
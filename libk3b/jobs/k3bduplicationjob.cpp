@@ -0,0 +1,645 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bduplicationjob.h"
+#include "k3bmetawriter.h"
+#include "k3bdatatrackreader.h"
+#include "k3bfanoutbuffer.h"
+#include "k3bactivepipe.h"
+#include "k3bfilesplitter.h"
+#include "k3biso9660.h"
+
+#include "k3bdevice.h"
+#include "k3bdeviceglobals.h"
+#include "k3bdiskinfo.h"
+#include "k3btoc.h"
+#include "k3bmedium.h"
+#include "k3bmediacache.h"
+#include "k3bglobals.h"
+#include "k3bglobalsettings.h"
+#include "k3bcore.h"
+#include "k3b_i18n.h"
+
+#include <KIOCore/KIO/Global>
+
+#include <QDebug>
+#include <QFile>
+#include <QStringList>
+#include <QTimer>
+#include <QUrl>
+
+
+class K3b::DuplicationJob::Private
+{
+public:
+    Private()
+        : readerDevice( 0 ),
+          speed( 0 ),
+          writingMode( K3b::WritingModeAuto ),
+          simulate( false ),
+          bufferSize( 64 ),
+          fanOut( 0 ),
+          dataTrackReader( 0 ),
+          running( false ),
+          canceled( false ),
+          readerRunning( false ),
+          startingWriters( false ) {
+    }
+
+    struct Writer {
+        Writer()
+            : device( 0 ),
+              job( 0 ),
+              sink( -1 ),
+              percent( 0 ),
+              running( false ),
+              success( false ) {
+        }
+
+        Device::Device* device;
+        MetaWriter* job;
+        int sink;
+        int percent;
+        bool running;
+        bool success;
+    };
+
+    int writerIndex( QObject* job ) const {
+        for( int i = 0; i < writers.count(); ++i )
+            if( writers[i].job == job )
+                return i;
+        return -1;
+    }
+
+    int writerIndexForSink( int sink ) const {
+        for( int i = 0; i < writers.count(); ++i )
+            if( writers[i].sink == sink )
+                return i;
+        return -1;
+    }
+
+    int runningWriters() const {
+        int cnt = 0;
+        for( int i = 0; i < writers.count(); ++i )
+            if( writers[i].running )
+                ++cnt;
+        return cnt;
+    }
+
+    QString imagePath;
+    Device::Device* readerDevice;
+    QList<Device::Device*> writerDevices;
+    int speed;
+    WritingMode writingMode;
+    bool simulate;
+    int bufferSize;
+
+    Msf trackSize;
+
+    QList<Writer> writers;
+
+    FanOutBuffer* fanOut;
+    FileSplitter imageFile;
+    ActivePipe imagePipe;
+    DataTrackReader* dataTrackReader;
+    QTimer bufferStatusTimer;
+
+    bool running;
+    bool canceled;
+    bool readerRunning;
+
+    // writers failing in their start() must not finish the job, startWriters() does
+    bool startingWriters;
+};
+
+
+K3b::DuplicationJob::DuplicationJob( K3b::JobHandler* hdl, QObject* parent )
+    : K3b::BurnJob( hdl, parent ),
+      d( new Private() )
+{
+    connect( &d->bufferStatusTimer, SIGNAL(timeout()), this, SLOT(slotUpdateBufferStatus()) );
+}
+
+
+K3b::DuplicationJob::~DuplicationJob()
+{
+    delete d->fanOut;
+    delete d;
+}
+
+
+K3b::Device::Device* K3b::DuplicationJob::writer() const
+{
+    return d->writerDevices.isEmpty() ? 0 : d->writerDevices.first();
+}
+
+
+QList<K3b::Device::Device*> K3b::DuplicationJob::writers() const
+{
+    return d->writerDevices;
+}
+
+
+int K3b::DuplicationJob::successfulCopies() const
+{
+    int cnt = 0;
+    for( int i = 0; i < d->writers.count(); ++i )
+        if( d->writers[i].success )
+            ++cnt;
+    return cnt;
+}
+
+
+void K3b::DuplicationJob::setImagePath( const QString& path )
+{
+    d->imagePath = path;
+}
+
+
+void K3b::DuplicationJob::setReaderDevice( K3b::Device::Device* dev )
+{
+    d->readerDevice = dev;
+}
+
+
+void K3b::DuplicationJob::setWriterDevices( const QList<K3b::Device::Device*>& devs )
+{
+    d->writerDevices = devs;
+}
+
+
+void K3b::DuplicationJob::setWriteSpeed( int s )
+{
+    d->speed = s;
+}
+
+
+void K3b::DuplicationJob::setWritingMode( K3b::WritingMode mode )
+{
+    d->writingMode = mode;
+}
+
+
+void K3b::DuplicationJob::setSimulate( bool b )
+{
+    d->simulate = b;
+}
+
+
+void K3b::DuplicationJob::setBufferSize( int mb )
+{
+    d->bufferSize = mb;
+}
+
+
+void K3b::DuplicationJob::start()
+{
+    jobStarted();
+
+    d->running = true;
+    d->canceled = false;
+    d->readerRunning = false;
+
+    emit newTask( i18n("Preparing duplication") );
+
+    if( d->writerDevices.isEmpty() ) {
+        emit infoMessage( i18n("No writers selected."), MessageError );
+        d->running = false;
+        jobFinished( false );
+        return;
+    }
+
+    if( d->imagePath.isEmpty() && d->writerDevices.contains( d->readerDevice ) ) {
+        emit infoMessage( i18n("The source device cannot be used as a writer at the same time."), MessageError );
+        d->running = false;
+        jobFinished( false );
+        return;
+    }
+
+    if( !determineSourceSize() ) {
+        d->running = false;
+        jobFinished( false );
+        return;
+    }
+
+    //
+    // All writers need a medium before we can start since all of them are fed from
+    // one stream.
+    //
+    Q_FOREACH( Device::Device* dev, d->writerDevices ) {
+        emit newSubTask( i18n("Waiting for medium in %1 %2", dev->vendor(), dev->description()) );
+        if( waitForMedium( dev, Device::STATE_EMPTY, Device::MEDIA_WRITABLE, d->trackSize ) == Device::MEDIA_UNKNOWN ||
+            d->canceled ) {
+            d->running = false;
+            emit canceled();
+            jobFinished( false );
+            return;
+        }
+    }
+
+    if( !startWriters() ) {
+        d->running = false;
+        jobFinished( false );
+        return;
+    }
+
+    startReading();
+}
+
+
+void K3b::DuplicationJob::cancel()
+{
+    if( !d->running )
+        return;
+
+    d->canceled = true;
+
+    //
+    // The writers go first. A sink thread of the fan out buffer may be blocked in
+    // a write to a writer which only returns once the writer is gone. The buffer
+    // is stopped before the reader since the reader may wait for room in it.
+    //
+    for( int i = 0; i < d->writers.count(); ++i )
+        if( d->writers[i].running )
+            d->writers[i].job->cancel();
+
+    stopReading();
+
+    checkFinished();
+}
+
+
+bool K3b::DuplicationJob::determineSourceSize()
+{
+    if( !d->imagePath.isEmpty() ) {
+        if( !QFile::exists( d->imagePath ) ) {
+            emit infoMessage( i18n("Could not find image %1", d->imagePath), MessageError );
+            return false;
+        }
+        d->trackSize = K3b::imageFilesize( QUrl::fromLocalFile( d->imagePath ) )/2048;
+        return true;
+    }
+
+    if( !d->readerDevice ) {
+        emit infoMessage( i18n("No source selected."), MessageError );
+        return false;
+    }
+
+    emit newSubTask( i18n("Waiting for source medium") );
+    if( waitForMedium( d->readerDevice,
+                       Device::STATE_COMPLETE|Device::STATE_INCOMPLETE,
+                       Device::MEDIA_ALL ) == Device::MEDIA_UNKNOWN ) {
+        return false;
+    }
+
+    const Medium medium = k3bcore->mediaCache()->medium( d->readerDevice );
+    const Device::Toc toc = medium.toc();
+
+    if( medium.diskInfo().numSessions() > 1 ||
+        toc.count() != 1 ||
+        toc.first().type() != Device::Track::TYPE_DATA ) {
+        emit infoMessage( i18n("Only single session data media can be duplicated."), MessageError );
+        return false;
+    }
+
+    //
+    // The TOC of overwritable media covers the whole formatted area. Like DvdCopyJob
+    // we rely on the ISO 9660 header in that case.
+    //
+    if( medium.diskInfo().mediaType() & ( Device::MEDIA_DVD_PLUS_RW|Device::MEDIA_DVD_RW_OVWR|Device::MEDIA_BD_RE ) ) {
+        K3b::Iso9660 isoF( d->readerDevice, 0 );
+        if( !isoF.open() ) {
+            emit infoMessage( i18n("Unable to determine the ISO 9660 filesystem size."), MessageError );
+            return false;
+        }
+        d->trackSize = ((long long)isoF.primaryDescriptor().logicalBlockSize*isoF.primaryDescriptor().volumeSpaceSize)/2048LL;
+    }
+    else {
+        d->trackSize = toc.first().length();
+    }
+
+    if( K3b::isMounted( d->readerDevice ) ) {
+        emit infoMessage( i18n("Unmounting source medium"), MessageInfo );
+        K3b::unmount( d->readerDevice );
+    }
+
+    return true;
+}
+
+
+bool K3b::DuplicationJob::startWriters()
+{
+    // the sink threads of the last run write to the old writers
+    delete d->fanOut;
+    d->fanOut = 0;
+
+    for( int i = 0; i < d->writers.count(); ++i )
+        delete d->writers[i].job;
+    d->writers.clear();
+
+    d->fanOut = new FanOutBuffer( d->bufferSize*1024*1024 );
+    connect( d->fanOut, SIGNAL(sinkFailed(int)), this, SLOT(slotSinkFailed(int)) );
+
+    Device::Toc toc;
+    toc << Device::Track( 0, d->trackSize - 1, Device::Track::TYPE_DATA, Device::Track::MODE1 );
+
+    Q_FOREACH( Device::Device* dev, d->writerDevices ) {
+        Private::Writer w;
+        w.device = dev;
+        w.job = new MetaWriter( dev, this );
+        w.job->setWritingApp( writingApp() );
+        w.job->setWritingMode( d->writingMode );
+        w.job->setSimulate( d->simulate );
+        w.job->setBurnSpeed( d->speed );
+        w.job->setSessionToWrite( toc );
+
+        connect( w.job, SIGNAL(infoMessage(QString,int)), this, SIGNAL(infoMessage(QString,int)) );
+        connect( w.job, SIGNAL(percent(int)), this, SLOT(slotWriterPercent(int)) );
+        connect( w.job, SIGNAL(processedSize(int,int)), this, SLOT(slotWriterProcessedSize(int,int)) );
+        connect( w.job, SIGNAL(deviceBuffer(int)), this, SLOT(slotWriterDeviceBuffer(int)) );
+        connect( w.job, SIGNAL(finished(bool)), this, SLOT(slotWriterFinished(bool)) );
+        connect( w.job, SIGNAL(debuggingOutput(QString,QString)),
+                 this, SIGNAL(debuggingOutput(QString,QString)) );
+
+        d->writers.append( w );
+    }
+
+    if( d->simulate )
+        emit newTask( i18np("Simulating %1 copy", "Simulating %1 copies", d->writers.count()) );
+    else
+        emit newTask( i18np("Writing %1 copy", "Writing %1 copies", d->writers.count()) );
+
+    emit burning( true );
+
+    d->startingWriters = true;
+    for( int i = 0; i < d->writers.count(); ++i ) {
+        Private::Writer& w = d->writers[i];
+        w.running = true;
+        w.job->start();
+
+        // the writer may already have failed in start()
+        if( w.running && w.job->ioDevice() ) {
+#ifdef __GNUC__
+#warning Growisofs needs stdin to be closed in order to exit gracefully. Cdrecord does not. However,  if closed with cdrecord we loose parts of stderr. Why?
+#endif
+            w.sink = d->fanOut->addSink( w.job->ioDevice(), w.job->usedWritingApp() == K3b::WritingAppGrowisofs );
+        }
+        else if( w.running ) {
+            w.job->cancel();
+        }
+    }
+
+    if( d->fanOut->numSinks() == 0 || !d->fanOut->open( QIODevice::WriteOnly ) ) {
+        emit infoMessage( i18n("Unable to start any of the writers."), MessageError );
+        for( int i = 0; i < d->writers.count(); ++i )
+            if( d->writers[i].running )
+                d->writers[i].job->cancel();
+        d->startingWriters = false;
+        emit burning( false );
+        return false;
+    }
+    d->startingWriters = false;
+
+    d->bufferStatusTimer.start( 500 );
+    return true;
+}
+
+
+void K3b::DuplicationJob::startReading()
+{
+    if( !d->imagePath.isEmpty() ) {
+        // the pipe closes the fan out buffer once the whole image has been read
+        d->imageFile.close();
+        d->imageFile.setName( d->imagePath );
+        d->imagePipe.close();
+        d->imagePipe.readFrom( &d->imageFile, true );
+        d->imagePipe.writeTo( d->fanOut, true );
+        if( !d->imagePipe.open( true ) ) {
+            emit infoMessage( i18n("Unable to open '%1' for reading.", d->imagePath), MessageError );
+            cancel();
+        }
+    }
+    else {
+        d->readerRunning = true;
+
+        if( !d->dataTrackReader ) {
+            d->dataTrackReader = new DataTrackReader( this );
+            connect( d->dataTrackReader, SIGNAL(finished(bool)), this, SLOT(slotReaderFinished(bool)) );
+            connect( d->dataTrackReader, SIGNAL(infoMessage(QString,int)), this, SIGNAL(infoMessage(QString,int)) );
+            connect( d->dataTrackReader, SIGNAL(debuggingOutput(QString,QString)),
+                     this, SIGNAL(debuggingOutput(QString,QString)) );
+        }
+        d->dataTrackReader->setDevice( d->readerDevice );
+        d->dataTrackReader->setSectorRange( 0, d->trackSize - 1 );
+        d->dataTrackReader->writeTo( d->fanOut );
+        d->dataTrackReader->start();
+    }
+}
+
+
+void K3b::DuplicationJob::stopReading()
+{
+    // does not wait for the sink threads which might still be busy with a writer
+    if( d->fanOut )
+        d->fanOut->stop();
+    if( d->readerRunning && d->dataTrackReader )
+        d->dataTrackReader->cancel();
+    d->imagePipe.close();
+}
+
+
+void K3b::DuplicationJob::slotReaderFinished( bool success )
+{
+    d->readerRunning = false;
+
+    if( d->canceled )
+        return;
+
+    if( success ) {
+        // signal the end of the stream to all writers
+        d->fanOut->close();
+    }
+    else {
+        emit infoMessage( i18n("Error while reading the source."), MessageError );
+        cancel();
+    }
+}
+
+
+void K3b::DuplicationJob::slotSinkFailed( int sink )
+{
+    const int i = d->writerIndexForSink( sink );
+    if( i >= 0 && d->writers[i].running && !d->canceled ) {
+        emit infoMessage( i18n("Writer %1 %2 stopped accepting data.",
+                               d->writers[i].device->vendor(), d->writers[i].device->description()),
+                          MessageWarning );
+    }
+}
+
+
+void K3b::DuplicationJob::slotWriterPercent( int p )
+{
+    const int i = d->writerIndex( sender() );
+    if( i < 0 )
+        return;
+
+    d->writers[i].percent = p;
+    emit writerPercent( d->writers[i].device, p );
+
+    // the overall progress is determined by the slowest writer still running
+    int slowest = 100;
+    for( int j = 0; j < d->writers.count(); ++j )
+        if( d->writers[j].running )
+            slowest = qMin( slowest, d->writers[j].percent );
+    emit percent( slowest );
+    emit subPercent( slowest );
+}
+
+
+void K3b::DuplicationJob::slotWriterProcessedSize( int p, int size )
+{
+    const int i = d->writerIndex( sender() );
+    if( i < 0 )
+        return;
+
+    emit writerProcessedSize( d->writers[i].device, p, size );
+    if( i == 0 )
+        emit processedSize( p, size );
+}
+
+
+void K3b::DuplicationJob::slotWriterDeviceBuffer( int fill )
+{
+    const int i = d->writerIndex( sender() );
+    if( i < 0 )
+        return;
+
+    emit writerDeviceBuffer( d->writers[i].device, fill );
+    if( i == 0 )
+        emit deviceBuffer( fill );
+}
+
+
+void K3b::DuplicationJob::slotUpdateBufferStatus()
+{
+    if( !d->fanOut )
+        return;
+
+    int lowest = 100;
+    for( int i = 0; i < d->writers.count(); ++i ) {
+        if( d->writers[i].running && d->writers[i].sink >= 0 ) {
+            const int fill = d->fanOut->fillLevel( d->writers[i].sink );
+            emit writerBufferStatus( d->writers[i].device, fill );
+            lowest = qMin( lowest, fill );
+        }
+    }
+    emit bufferStatus( lowest );
+
+    // the writers are running, so the signal is not recorded by BurnJob
+    recordTelemetry( K3b::JobTelemetry::FifoFill, lowest );
+}
+
+
+void K3b::DuplicationJob::slotWriterFinished( bool success )
+{
+    const int i = d->writerIndex( sender() );
+    if( i < 0 )
+        return;
+
+    Private::Writer& w = d->writers[i];
+    w.running = false;
+    w.success = success && !d->canceled;
+
+    if( !d->canceled ) {
+        if( success )
+            emit infoMessage( i18n("Successfully written copy on %1 %2.", w.device->vendor(), w.device->description()),
+                              MessageSuccess );
+        else
+            emit infoMessage( i18n("Writing copy on %1 %2 failed.", w.device->vendor(), w.device->description()),
+                              MessageError );
+    }
+
+    emit writerFinished( w.device, w.success );
+
+    if( k3bcore->globalSettings()->ejectMedia() && !d->simulate )
+        Device::eject( w.device );
+
+    checkFinished();
+}
+
+
+void K3b::DuplicationJob::checkFinished()
+{
+    if( !d->running || d->startingWriters || d->runningWriters() > 0 )
+        return;
+
+    // no writer left to feed
+    stopReading();
+
+    d->bufferStatusTimer.stop();
+    d->running = false;
+    emit burning( false );
+
+    if( d->canceled ) {
+        emit canceled();
+        jobFinished( false );
+        return;
+    }
+
+    const int copies = successfulCopies();
+    if( copies < d->writers.count() ) {
+        emit infoMessage( i18n("%1 of %2 copies written successfully.", copies, d->writers.count()),
+                          copies > 0 ? MessageWarning : MessageError );
+    }
+
+    jobFinished( copies == d->writers.count() );
+}
+
+
+QString K3b::DuplicationJob::jobDescription() const
+{
+    if( d->simulate )
+        return i18n("Simulating Duplication");
+    else
+        return i18np("Duplicating to %1 Writer", "Duplicating to %1 Writers", d->writerDevices.count());
+}
+
+
+QString K3b::DuplicationJob::jobDetails() const
+{
+    if( !d->imagePath.isEmpty() )
+        return d->imagePath.section('/', -1) + QString( " (%1)" ).arg(KIO::convertSize(K3b::filesize(QUrl::fromLocalFile(d->imagePath))));
+    else
+        return QString();
+}
+
+
+QString K3b::DuplicationJob::jobSource() const
+{
+    if( !d->imagePath.isEmpty() )
+        return d->imagePath;
+    else if( d->readerDevice )
+        return d->readerDevice->vendor() + ' ' + d->readerDevice->description();
+    else
+        return QString();
+}
+
+
+QString K3b::DuplicationJob::jobTarget() const
+{
+    QStringList targets;
+    Q_FOREACH( Device::Device* dev, d->writerDevices )
+        targets << dev->vendor() + ' ' + dev->description();
+    return targets.join( QLatin1String( ", " ) );
+}
@@ -0,0 +1,124 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef _K3B_DUPLICATION_JOB_H_
+#define _K3B_DUPLICATION_JOB_H_
+
+#include "k3bjob.h"
+#include "k3b_export.h"
+
+#include <QList>
+#include <QString>
+
+
+namespace K3b {
+    namespace Device {
+        class Device;
+    }
+
+    /**
+     * Writes one data track to several writers at the same time.
+     *
+     * The source, either an image file or a single session data medium,
+     * is read only once. The data is distributed to all writers through
+     * a FanOutBuffer, thus the slowest writer determines the overall speed.
+     * A failing writer does not affect the others.
+     *
+     * Progress of the individual writers is reported through the writer*
+     * signals. The general percent() signal reports the progress of the
+     * slowest writer still running.
+     */
+    class LIBK3B_EXPORT DuplicationJob : public BurnJob
+    {
+        Q_OBJECT
+
+    public:
+        explicit DuplicationJob( JobHandler* hdl, QObject* parent = 0 );
+        ~DuplicationJob();
+
+        /**
+         * \return The first writer.
+         */
+        virtual Device::Device* writer() const;
+        QList<Device::Device*> writers() const;
+
+        virtual QString jobDescription() const;
+        virtual QString jobDetails() const;
+        virtual QString jobSource() const;
+        virtual QString jobTarget() const;
+
+        /**
+         * \return The number of writers which finished successfully.
+         */
+        int successfulCopies() const;
+
+    public Q_SLOTS:
+        void start();
+        void cancel();
+
+        /**
+         * Use an image file as source. Overrides setReaderDevice().
+         */
+        void setImagePath( const QString& path );
+
+        /**
+         * Read the source from a medium. Only single session data
+         * media are supported.
+         */
+        void setReaderDevice( K3b::Device::Device* dev );
+
+        void setWriterDevices( const QList<K3b::Device::Device*>& devs );
+        void setWriteSpeed( int s );
+        void setWritingMode( K3b::WritingMode mode );
+        void setSimulate( bool b );
+
+        /**
+         * Size of the buffer shared by all writers in MB. Defaults to 64 MB.
+         */
+        void setBufferSize( int mb );
+
+    Q_SIGNALS:
+        void writerPercent( K3b::Device::Device* dev, int percent );
+        void writerProcessedSize( K3b::Device::Device* dev, int processed, int size );
+
+        /**
+         * The fill level of the shared buffer as seen by this writer, ie. the
+         * amount of data read from the source but not yet consumed by the writer.
+         */
+        void writerBufferStatus( K3b::Device::Device* dev, int fill );
+        void writerDeviceBuffer( K3b::Device::Device* dev, int fill );
+        void writerFinished( K3b::Device::Device* dev, bool success );
+
+    private Q_SLOTS:
+        void slotWriterPercent( int p );
+        void slotWriterProcessedSize( int p, int size );
+        void slotWriterDeviceBuffer( int fill );
+        void slotWriterFinished( bool success );
+        void slotSinkFailed( int sink );
+        void slotReaderFinished( bool success );
+        void slotUpdateBufferStatus();
+
+    private:
+        bool determineSourceSize();
+        bool startWriters();
+        void startReading();
+        void stopReading();
+        void checkFinished();
+
+        class Private;
+        Private* const d;
+    };
+}
+
+#endif
@@ -0,0 +1,990 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bjobqueue.h"
+#include "k3bjob.h"
+#include "k3bjobhandler.h"
+#include "k3bcore.h"
+#include "k3bglobals.h"
+#include "k3bmediacache.h"
+#include "k3bmedium.h"
+#include "k3bdevice.h"
+#include "k3bdevicemanager.h"
+#include "k3bdiskinfo.h"
+#include "k3biso9660imagewritingjob.h"
+#include "k3bcdcopyjob.h"
+#include "k3bdvdcopyjob.h"
+#include "k3bduplicationjob.h"
+#include "k3b_i18n.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QTemporaryDir>
+#include <QTimer>
+
+
+namespace {
+    K3b::Device::MediaTypes requestedMedia( const QVariantMap& description )
+    {
+        const QString media = description.value( QLatin1String( "media" ) ).toString().toLower();
+        if( media == QLatin1String( "cd" ) )
+            return K3b::Device::MEDIA_CD_ALL;
+        else if( media == QLatin1String( "dvd" ) )
+            return K3b::Device::MEDIA_DVD_ALL;
+        else if( media == QLatin1String( "bd" ) )
+            return K3b::Device::MEDIA_BD_ALL;
+        else
+            return K3b::Device::MEDIA_ALL;
+    }
+
+
+    bool isDvd( const QVariantMap& description, K3b::Device::Device* reader )
+    {
+        const QString media = description.value( QLatin1String( "media" ) ).toString().toLower();
+        if( !media.isEmpty() )
+            return media == QLatin1String( "dvd" );
+        else if( reader && k3bcore && k3bcore->mediaCache() )
+            return K3b::Device::isDvdMedia( k3bcore->mediaCache()->medium( reader ).diskInfo().mediaType() );
+        else
+            return false;
+    }
+
+
+    /**
+     * The queue writes each copy in a job of its own, see JobQueue::Private::jobFinished().
+     */
+    QVariantMap singleCopy( const QVariantMap& description )
+    {
+        QVariantMap single( description );
+        if( single.contains( QLatin1String( "copies" ) ) )
+            single.insert( QLatin1String( "copies" ), 1 );
+        return single;
+    }
+
+
+    K3b::JobQueue::JobType imageWritingJobType()
+    {
+        K3b::JobQueue::JobType type;
+        type.roles = K3b::JobQueue::Writer;
+        type.create = []( const QVariantMap& description, K3b::Device::Device*, K3b::Device::Device* writer,
+                          K3b::JobHandler* handler, QObject* parent ) -> K3b::Job* {
+            const QString image = description.value( QLatin1String( "image" ) ).toString();
+            if( image.isEmpty() )
+                return 0;
+
+            K3b::Iso9660ImageWritingJob* job = new K3b::Iso9660ImageWritingJob( handler );
+            job->setParent( parent );
+            job->setImagePath( image );
+            job->setBurnDevice( writer );
+            job->setSpeed( description.value( QLatin1String( "speed" ), 0 ).toInt() );
+            job->setCopies( qMax( 1, description.value( QLatin1String( "copies" ), 1 ).toInt() ) );
+            job->setSimulate( description.value( QLatin1String( "simulate" ), false ).toBool() );
+            job->setVerifyData( description.value( QLatin1String( "verify" ), false ).toBool() );
+            return job;
+        };
+        return type;
+    }
+
+
+    K3b::JobQueue::JobType copyJobType()
+    {
+        K3b::JobQueue::JobType type;
+        type.roles = K3b::JobQueue::Reader|K3b::JobQueue::Writer;
+        type.create = []( const QVariantMap& description, K3b::Device::Device* reader, K3b::Device::Device* writer,
+                          K3b::JobHandler* handler, QObject* parent ) -> K3b::Job* {
+            const bool onTheFly = description.value( QLatin1String( "onTheFly" ), false ).toBool();
+            const bool simulate = description.value( QLatin1String( "simulate" ), false ).toBool();
+            const int speed = description.value( QLatin1String( "speed" ), 0 ).toInt();
+            const int copies = qMax( 1, description.value( QLatin1String( "copies" ), 1 ).toInt() );
+
+            if( isDvd( description, reader ) ) {
+                K3b::DvdCopyJob* job = new K3b::DvdCopyJob( handler, parent );
+                const QString tempDir = K3b::JobQueue::privateTempDir( job );
+                if( tempDir.isEmpty() ) {
+                    delete job;
+                    return 0;
+                }
+                job->setReaderDevice( reader );
+                job->setWriterDevice( writer );
+                job->setOnTheFly( onTheFly );
+                job->setImagePath( tempDir + QLatin1String( "image.iso" ) );
+                job->setRemoveImageFiles( true );
+                job->setSimulate( simulate );
+                job->setWriteSpeed( speed );
+                job->setCopies( copies );
+                return job;
+            }
+            else {
+                K3b::CdCopyJob* job = new K3b::CdCopyJob( handler, parent );
+                const QString tempDir = K3b::JobQueue::privateTempDir( job );
+                if( tempDir.isEmpty() ) {
+                    delete job;
+                    return 0;
+                }
+                job->setReaderDevice( reader );
+                job->setWriterDevice( writer );
+                job->setOnTheFly( onTheFly );
+                job->setTempPath( tempDir );
+                job->setKeepImage( false );
+                job->setSimulate( simulate );
+                job->setSpeed( speed );
+                job->setCopies( copies );
+                return job;
+            }
+        };
+        type.tempSpace = []( const QVariantMap& description, K3b::Device::Device* reader ) -> KIO::filesize_t {
+            if( description.value( QLatin1String( "onTheFly" ), false ).toBool() )
+                return 0;
+            // audio sectors are the biggest ones
+            return k3bcore->mediaCache()->medium( reader ).diskInfo().size().audioBytes();
+        };
+        return type;
+    }
+
+
+    /**
+     * The queue assigns all "writers" to the job, the first one is passed to create().
+     */
+    K3b::DuplicationJob* createDuplicationJob( const QVariantMap& description, K3b::Device::Device* writer,
+                                               K3b::JobHandler* handler, QObject* parent )
+    {
+        QList<K3b::Device::Device*> writers;
+        Q_FOREACH( const QString& name, description.value( QLatin1String( "writers" ) ).toStringList() )
+            writers << k3bcore->deviceManager()->findDevice( name );
+        if( writers.isEmpty() )
+            writers << writer;
+
+        K3b::DuplicationJob* job = new K3b::DuplicationJob( handler, parent );
+        job->setWriterDevices( writers );
+        job->setWriteSpeed( description.value( QLatin1String( "speed" ), 0 ).toInt() );
+        job->setSimulate( description.value( QLatin1String( "simulate" ), false ).toBool() );
+        if( description.contains( QLatin1String( "bufferSize" ) ) )
+            job->setBufferSize( description.value( QLatin1String( "bufferSize" ) ).toInt() );
+        return job;
+    }
+
+
+    K3b::JobQueue::JobType duplicationJobType()
+    {
+        K3b::JobQueue::JobType type;
+        type.roles = K3b::JobQueue::Reader|K3b::JobQueue::Writer;
+        type.create = []( const QVariantMap& description, K3b::Device::Device* reader, K3b::Device::Device* writer,
+                          K3b::JobHandler* handler, QObject* parent ) -> K3b::Job* {
+            K3b::DuplicationJob* job = createDuplicationJob( description, writer, handler, parent );
+            job->setReaderDevice( reader );
+            return job;
+        };
+        return type;
+    }
+
+
+    K3b::JobQueue::JobType imageDuplicationJobType()
+    {
+        K3b::JobQueue::JobType type;
+        type.roles = K3b::JobQueue::Writer;
+        type.create = []( const QVariantMap& description, K3b::Device::Device*, K3b::Device::Device* writer,
+                          K3b::JobHandler* handler, QObject* parent ) -> K3b::Job* {
+            const QString image = description.value( QLatin1String( "image" ) ).toString();
+            if( image.isEmpty() )
+                return 0;
+
+            K3b::DuplicationJob* job = createDuplicationJob( description, writer, handler, parent );
+            job->setImagePath( image );
+            return job;
+        };
+        return type;
+    }
+
+
+    K3b::JobQueue::JobType ripJobType()
+    {
+        K3b::JobQueue::JobType type;
+        type.roles = K3b::JobQueue::Reader;
+        type.create = []( const QVariantMap& description, K3b::Device::Device* reader, K3b::Device::Device*,
+                          K3b::JobHandler* handler, QObject* parent ) -> K3b::Job* {
+            const QString image = description.value( QLatin1String( "image" ) ).toString();
+            if( image.isEmpty() )
+                return 0;
+
+            if( isDvd( description, reader ) ) {
+                K3b::DvdCopyJob* job = new K3b::DvdCopyJob( handler, parent );
+                job->setReaderDevice( reader );
+                job->setImagePath( image );
+                job->setOnlyCreateImage( true );
+                return job;
+            }
+            else {
+                K3b::CdCopyJob* job = new K3b::CdCopyJob( handler, parent );
+                job->setReaderDevice( reader );
+                job->setTempPath( image );
+                job->setOnlyCreateImage( true );
+                job->setKeepImage( true );
+                return job;
+            }
+        };
+        return type;
+    }
+}
+
+
+K3b::JobQueue::JobType::JobType()
+    : roles( 0 )
+{
+}
+
+
+class K3b::JobQueue::Private
+{
+public:
+    /**
+     * The medium a job asked for in vain. The job is restarted once it is there.
+     */
+    struct MediumRequest {
+        MediumRequest()
+            : pending( false ),
+              role( 0 ),
+              device( 0 ),
+              mediaState( Device::STATE_EMPTY ),
+              mediaType( Device::MEDIA_WRITABLE ),
+              since( -1 ) {
+        }
+
+        bool pending;
+        int role;                 // the role of the drive, 0 if it is none of the job's drives
+        Device::Device* device;   // only used if role is 0
+        Device::MediaStates mediaState;
+        Device::MediaTypes mediaType;
+        K3b::Msf minMediaSize;
+        qint64 since;             // -1 if the job does not wait
+    };
+
+    /**
+     * Each entry is the job handler of its jobs so we know which job asks.
+     */
+    struct Entry : public JobHandler {
+        explicit Entry( Private* d_ )
+            : d( d_ ) {
+        }
+
+        Device::MediaType waitForMedium( Device::Device* dev,
+                                         Device::MediaStates mediaState,
+                                         Device::MediaTypes mediaType,
+                                         const K3b::Msf& minMediaSize,
+                                         const QString& message ) {
+            return d->waitForMedium( this, dev, mediaState, mediaType, minMediaSize, message );
+        }
+        bool questionYesNo( const QString& text,
+                            const QString&,
+                            const KGuiItem&,
+                            const KGuiItem& ) {
+            // there is nobody to ask, take the safe way
+            qDebug() << "(K3b::JobQueue) answering no to:" << text;
+            return false;
+        }
+        void blockingInformation( const QString& text,
+                                  const QString& ) {
+            qDebug() << "(K3b::JobQueue) ignoring blocking information:" << text;
+        }
+
+        Private* d;
+        JobInfo info;
+        Job* job;
+        Device::Device* reader;
+        Device::Device* writer;
+        QList<Device::Device*> writers;     // all writers, the first one is writer
+        KIO::filesize_t tempSpace;
+        int copiesLeft;     // copies to write after the current one
+        bool canceled;
+        MediumRequest mediumRequest;
+    };
+
+    struct DriveStats {
+        DriveStats()
+            : busyMSecs( 0 ),
+              busySince( -1 ),
+              jobs( 0 ),
+              failedJobs( 0 ) {
+        }
+
+        qint64 busyMSecs;
+        qint64 busySince;   // -1 while idle
+        int jobs;
+        int failedJobs;
+    };
+
+    Private( JobQueue* q_ )
+        : q( q_ ),
+          nextId( 1 ),
+          tempBudget( 0 ),
+          reservedTemp( 0 ),
+          tempJobs( 0 ),
+          maxTempJobs( 2 ),
+          mediumTimeout( 10*60 ),
+          scheduled( false ) {
+        clock.start();
+    }
+
+    ~Private() {
+        qDeleteAll( entries );
+    }
+
+    Device::MediaType waitForMedium( Entry* e,
+                                     Device::Device* dev,
+                                     Device::MediaStates mediaState,
+                                     Device::MediaTypes mediaType,
+                                     const K3b::Msf& minMediaSize,
+                                     const QString& message );
+
+    Entry* entry( int id ) const;
+    Entry* runningEntry( Device::Device* dev ) const;
+
+    static Device::MediaType suitableMedium( const Medium& medium,
+                                             Device::MediaStates mediaState,
+                                             Device::MediaTypes mediaType,
+                                             const K3b::Msf& minMediaSize );
+    bool mediumArrived( const Entry* e, Device::Device* dev ) const;
+
+    bool idle( Device::Device* dev ) const;
+    bool suitable( Device::Device* dev, int role, Device::MediaTypes media ) const;
+    Device::Device* findDevice( const Entry* e, int role, const QList<Device::Device*>& exclude ) const;
+    QList<Device::Device*> findWriters( const Entry* e ) const;
+    bool tempSpaceAvailable( KIO::filesize_t bytes ) const;
+
+    void scheduleLater();
+    void schedule();
+    void startJob( Entry* e, const JobType& type );
+    void jobFinished( int id, bool success );
+
+    void setBusy( Device::Device* dev );
+    void setIdle( Device::Device* dev, bool success );
+
+    JobQueue* q;
+
+    QHash<QString, JobType> types;
+    QList<Entry*> entries;
+    int nextId;
+
+    QHash<Device::Device*, DriveStats> driveStats;
+    QElapsedTimer clock;
+
+    KIO::filesize_t tempBudget;
+    KIO::filesize_t reservedTemp;
+    int tempJobs;
+    int maxTempJobs;
+
+    int mediumTimeout;
+
+    bool scheduled;
+};
+
+
+K3b::JobQueue::Private::Entry* K3b::JobQueue::Private::entry( int id ) const
+{
+    Q_FOREACH( Entry* e, entries ) {
+        if( e->info.id == id )
+            return e;
+    }
+    return 0;
+}
+
+
+K3b::JobQueue::Private::Entry* K3b::JobQueue::Private::runningEntry( Device::Device* dev ) const
+{
+    Q_FOREACH( Entry* e, entries ) {
+        if( e->job && ( e->reader == dev || e->writers.contains( dev ) ) )
+            return e;
+    }
+    return 0;
+}
+
+
+K3b::Device::MediaType K3b::JobQueue::Private::suitableMedium( const Medium& medium,
+                                                              Device::MediaStates mediaState,
+                                                              Device::MediaTypes mediaType,
+                                                              const K3b::Msf& minMediaSize )
+{
+    const Device::DiskInfo info = medium.diskInfo();
+    if( ( info.diskState() & mediaState ) && ( info.mediaType() & mediaType ) ) {
+        if( info.diskState() == Device::STATE_EMPTY
+            ? minMediaSize <= info.capacity()
+            : minMediaSize <= medium.actuallyRemainingSize() )
+            return info.mediaType();
+    }
+    return Device::MEDIA_UNKNOWN;
+}
+
+
+bool K3b::JobQueue::Private::mediumArrived( const Entry* e, Device::Device* dev ) const
+{
+    const MediumRequest& r = e->mediumRequest;
+    return( !r.pending ||
+            suitableMedium( k3bcore->mediaCache()->medium( dev ), r.mediaState, r.mediaType, r.minMediaSize ) != Device::MEDIA_UNKNOWN );
+}
+
+
+K3b::Device::MediaType K3b::JobQueue::Private::waitForMedium( Entry* e,
+                                                             Device::Device* dev,
+                                                             Device::MediaStates mediaState,
+                                                             Device::MediaTypes mediaType,
+                                                             const K3b::Msf& minMediaSize,
+                                                             const QString& message )
+{
+    //
+    // The queue only assigns drives which contain a suitable medium and writes each
+    // copy in a job of its own so in most cases we are done at once.
+    //
+    Device::MediaType type = suitableMedium( k3bcore->mediaCache()->medium( dev ), mediaState, mediaType, minMediaSize );
+    if( type != Device::MEDIA_UNKNOWN )
+        return type;
+
+    //
+    // The media cache forgets the medium of a drive a job has just been writing to
+    // and needs a moment to have a look at it again. Jobs which verify the written
+    // data ask for it right away.
+    //
+    if( dev ) {
+        Medium medium( dev );
+        medium.update();
+        type = suitableMedium( medium, mediaState, mediaType, minMediaSize );
+        if( type != Device::MEDIA_UNKNOWN )
+            return type;
+    }
+
+    //
+    // Waiting here would need a nested event loop. Those can only be left in reverse
+    // order which would keep jobs waiting for the ones which started waiting later.
+    // Instead the job is stopped and the scheduler restarts it once the medium is there,
+    // see jobFinished().
+    //
+    MediumRequest& r = e->mediumRequest;
+    r.pending = true;
+    r.role = ( dev && dev == e->writer ? Writer : dev && dev == e->reader ? Reader : 0 );
+    r.device = dev;
+    r.mediaState = mediaState;
+    r.mediaType = mediaType;
+    r.minMediaSize = minMediaSize;
+    r.since = clock.elapsed();
+
+    emit q->infoMessage( e->info.id, message.isEmpty()
+                         ? Medium::mediaRequestString( mediaType, mediaState, minMediaSize, dev )
+                         : message,
+                         Job::MessageInfo );
+
+    return Device::MEDIA_UNKNOWN;
+}
+
+
+bool K3b::JobQueue::Private::idle( Device::Device* dev ) const
+{
+    return( !runningEntry( dev ) && !k3bcore->deviceBlocked( dev ) );
+}
+
+
+bool K3b::JobQueue::Private::suitable( Device::Device* dev, int role, Device::MediaTypes media ) const
+{
+    const Device::DiskInfo info = k3bcore->mediaCache()->medium( dev ).diskInfo();
+    if( role == Writer ) {
+        return( ( dev->writeCapabilities() & media ) &&
+                ( info.mediaType() & media & Device::MEDIA_WRITABLE ) &&
+                ( info.empty() || info.appendable() || info.rewritable() ) );
+    }
+    else {
+        return( ( dev->readCapabilities() & media ) &&
+                ( info.mediaType() & media ) &&
+                ( info.diskState() & ( Device::STATE_COMPLETE|Device::STATE_INCOMPLETE ) ) );
+    }
+}
+
+
+K3b::Device::Device* K3b::JobQueue::Private::findDevice( const Entry* e, int role, const QList<Device::Device*>& exclude ) const
+{
+    const QVariantMap& description = e->info.description;
+    const QString key = QLatin1String( role == Writer ? "writer" : "reader" );
+    const Device::MediaTypes media = requestedMedia( description );
+
+    // a job which asked for a medium before only gets a drive which contains it
+    const bool requested = ( e->mediumRequest.pending && e->mediumRequest.role == role );
+
+    if( description.contains( key ) ) {
+        // an explicitly requested drive may be used for reading and writing
+        Device::Device* dev = k3bcore->deviceManager()->findDevice( description.value( key ).toString() );
+        if( dev && idle( dev ) && suitable( dev, role, media ) && ( !requested || mediumArrived( e, dev ) ) )
+            return dev;
+        else
+            return 0;
+    }
+
+    // keep the burners free for writing if possible
+    Device::Device* burner = 0;
+    Q_FOREACH( Device::Device* dev, k3bcore->deviceManager()->allDevices() ) {
+        if( exclude.contains( dev ) || !idle( dev ) || !suitable( dev, role, media ) )
+            continue;
+        if( requested && !mediumArrived( e, dev ) )
+            continue;
+        if( role == Writer || !dev->burner() )
+            return dev;
+        else if( !burner )
+            burner = dev;
+    }
+    return burner;
+}
+
+
+QList<K3b::Device::Device*> K3b::JobQueue::Private::findWriters( const Entry* e ) const
+{
+    QList<Device::Device*> writers;
+
+    const QStringList names = e->info.description.value( QLatin1String( "writers" ) ).toStringList();
+    if( names.isEmpty() ) {
+        if( Device::Device* dev = findDevice( e, Writer, QList<Device::Device*>() ) )
+            writers << dev;
+        return writers;
+    }
+
+    // a job writing to several drives at once needs all of them
+    const Device::MediaTypes media = requestedMedia( e->info.description );
+    const MediumRequest& r = e->mediumRequest;
+    Q_FOREACH( const QString& name, names ) {
+        Device::Device* dev = k3bcore->deviceManager()->findDevice( name );
+        if( !dev || writers.contains( dev ) || !idle( dev ) || !suitable( dev, Writer, media ) )
+            return QList<Device::Device*>();
+        if( r.pending && r.device == dev && !mediumArrived( e, dev ) )
+            return QList<Device::Device*>();
+        writers << dev;
+    }
+    return writers;
+}
+
+
+bool K3b::JobQueue::Private::tempSpaceAvailable( KIO::filesize_t bytes ) const
+{
+    if( tempJobs >= maxTempJobs )
+        return false;
+
+    KIO::filesize_t budget = tempBudget;
+    if( budget == 0 ) {
+        unsigned long size, avail;
+        if( !K3b::kbFreeOnFs( K3b::defaultTempPath(), size, avail ) )
+            return true;   // let the job find out
+        // the running jobs might not have written everything yet
+        budget = KIO::filesize_t( avail )*1024 + reservedTemp;
+    }
+
+    return reservedTemp + bytes <= budget;
+}
+
+
+void K3b::JobQueue::Private::scheduleLater()
+{
+    if( !scheduled ) {
+        scheduled = true;
+        QTimer::singleShot( 0, q, [this]() { schedule(); } );
+    }
+}
+
+
+void K3b::JobQueue::Private::schedule()
+{
+    scheduled = false;
+
+    Q_FOREACH( Entry* e, entries ) {
+        if( e->info.state != Queued )
+            continue;
+
+        if( e->mediumRequest.pending &&
+            clock.elapsed() - e->mediumRequest.since > qint64( mediumTimeout )*1000 ) {
+            e->info.state = Failed;
+            e->info.error = i18n("No suitable medium found.");
+            emit q->jobFinished( e->info.id, false );
+            continue;
+        }
+
+        const JobType type = types.value( e->info.description.value( QLatin1String( "type" ) ).toString() );
+
+        QList<Device::Device*> writers;
+        Device::Device* reader = 0;
+        if( type.roles & Writer ) {
+            writers = findWriters( e );
+            if( writers.isEmpty() )
+                continue;
+        }
+        if( type.roles & Reader ) {
+            reader = findDevice( e, Reader, writers );
+            if( !reader )
+                continue;
+        }
+        if( e->mediumRequest.pending && e->mediumRequest.role == 0 && !mediumArrived( e, e->mediumRequest.device ) )
+            continue;
+        e->reader = reader;
+        e->writers = writers;
+        e->writer = ( writers.isEmpty() ? 0 : writers.first() );
+
+        e->tempSpace = ( type.tempSpace ? type.tempSpace( singleCopy( e->info.description ), reader ) : 0 );
+        if( e->tempSpace > 0 && !tempSpaceAvailable( e->tempSpace ) ) {
+            if( tempJobs == 0 ) {
+                // it will never fit
+                e->info.state = Failed;
+                e->info.error = i18n("Not enough space left in temporary folder.");
+                emit q->jobFinished( e->info.id, false );
+            }
+            continue;
+        }
+
+        startJob( e, type );
+    }
+}
+
+
+void K3b::JobQueue::Private::startJob( Entry* e, const JobType& type )
+{
+    const int id = e->info.id;
+
+    e->job = type.create( singleCopy( e->info.description ), e->reader, e->writer, e, q );
+    if( !e->job ) {
+        e->info.state = Failed;
+        e->info.error = i18n("Invalid job description.");
+        emit q->jobFinished( id, false );
+        return;
+    }
+
+    if( e->reader ) {
+        e->info.reader = e->reader->blockDeviceName();
+        setBusy( e->reader );
+    }
+    QStringList writerNames;
+    Q_FOREACH( Device::Device* dev, e->writers ) {
+        if( dev != e->reader ) {
+            writerNames << dev->blockDeviceName();
+            setBusy( dev );
+        }
+    }
+    e->info.writer = writerNames.join( QLatin1String( ", " ) );
+    if( e->tempSpace > 0 ) {
+        reservedTemp += e->tempSpace;
+        ++tempJobs;
+    }
+
+    connect( e->job, &Job::finished, q, [this,id]( bool success ) { jobFinished( id, success ); } );
+    connect( e->job, &Job::infoMessage, q, [this,id]( const QString& msg, int type ) {
+        emit q->infoMessage( id, msg, type );
+    } );
+    connect( e->job, &Job::percent, q, [this,id]( int p ) { emit q->percent( id, p ); } );
+
+    e->info.jobDescription = e->job->jobDescription();
+    e->info.state = Running;
+    e->mediumRequest = MediumRequest();
+
+    qDebug() << "(K3b::JobQueue) starting job" << id << e->info.jobDescription
+             << "reader:" << e->info.reader << "writer:" << e->info.writer;
+
+    emit q->jobStarted( id );
+
+    // start the job from the event loop since it might wait for a medium
+    QTimer::singleShot( 0, e->job, SLOT(start()) );
+}
+
+
+void K3b::JobQueue::Private::jobFinished( int id, bool success )
+{
+    Entry* e = entry( id );
+    if( !e || !e->job )
+        return;
+
+    // a job which waits for a medium did not fail (yet)
+    const bool waiting = ( !success && e->mediumRequest.pending && !e->canceled );
+
+    if( e->reader )
+        setIdle( e->reader, success || waiting );
+    Q_FOREACH( Device::Device* dev, e->writers ) {
+        if( dev != e->reader )
+            setIdle( dev, success || waiting );
+    }
+    if( e->tempSpace > 0 ) {
+        reservedTemp -= e->tempSpace;
+        --tempJobs;
+    }
+
+    e->job->deleteLater();
+    e->job = 0;
+
+    if( waiting ) {
+        // restart the job once the medium is there, see schedule()
+        e->info.state = Queued;
+        e->info.reader.clear();
+        e->info.writer.clear();
+        e->reader = e->writer = 0;
+        e->writers.clear();
+        e->tempSpace = 0;
+        QTimer::singleShot( mediumTimeout*1000 + 1000, q, [this]() { scheduleLater(); } );
+        scheduleLater();
+        return;
+    }
+
+    if( success && !e->canceled && e->copiesLeft > 0 ) {
+        // the next copy is written on whichever drive gets a suitable medium first
+        --e->copiesLeft;
+        e->info.state = Queued;
+        e->info.reader.clear();
+        e->info.writer.clear();
+        e->reader = e->writer = 0;
+        e->writers.clear();
+        e->tempSpace = 0;
+        emit q->infoMessage( id, i18n("Waiting for a drive to write the next copy."), Job::MessageInfo );
+        scheduleLater();
+        return;
+    }
+
+    if( e->canceled )
+        e->info.state = Canceled;
+    else
+        e->info.state = ( success ? Succeeded : Failed );
+
+    emit q->jobFinished( id, success );
+
+    scheduleLater();
+}
+
+
+void K3b::JobQueue::Private::setBusy( Device::Device* dev )
+{
+    DriveStats& s = driveStats[dev];
+    s.busySince = clock.elapsed();
+    ++s.jobs;
+}
+
+
+void K3b::JobQueue::Private::setIdle( Device::Device* dev, bool success )
+{
+    DriveStats& s = driveStats[dev];
+    if( s.busySince >= 0 )
+        s.busyMSecs += clock.elapsed() - s.busySince;
+    s.busySince = -1;
+    if( !success )
+        ++s.failedJobs;
+}
+
+
+K3b::JobQueue::JobQueue( QObject* parent )
+    : QObject( parent ),
+      d( new Private( this ) )
+{
+    registerJobType( QLatin1String( "image" ), imageWritingJobType() );
+    registerJobType( QLatin1String( "copy" ), copyJobType() );
+    registerJobType( QLatin1String( "rip" ), ripJobType() );
+    registerJobType( QLatin1String( "duplicate" ), duplicationJobType() );
+    registerJobType( QLatin1String( "duplicateimage" ), imageDuplicationJobType() );
+
+    // drives become available when media are changed or other jobs finish
+    connect( k3bcore->mediaCache(), &MediaCache::mediumChanged, this, [this]() { d->scheduleLater(); } );
+    connect( k3bcore, &Core::jobFinished, this, [this]() { d->scheduleLater(); } );
+}
+
+
+K3b::JobQueue::~JobQueue()
+{
+    Q_FOREACH( Private::Entry* e, d->entries ) {
+        if( e->job ) {
+            e->canceled = true;
+            e->job->cancel();
+        }
+    }
+    delete d;
+}
+
+
+void K3b::JobQueue::registerJobType( const QString& name, const JobType& type )
+{
+    d->types.insert( name, type );
+}
+
+
+QStringList K3b::JobQueue::jobTypes() const
+{
+    return d->types.keys();
+}
+
+
+int K3b::JobQueue::enqueue( const QVariantMap& description, QString* error )
+{
+    const QString type = description.value( QLatin1String( "type" ) ).toString();
+    if( !d->types.contains( type ) ) {
+        if( error )
+            *error = i18n("Unknown job type '%1'.", type);
+        return -1;
+    }
+
+    QStringList devices = description.value( QLatin1String( "writers" ) ).toStringList();
+    Q_FOREACH( const QString& key, QStringList() << QLatin1String( "reader" ) << QLatin1String( "writer" ) ) {
+        if( description.contains( key ) )
+            devices << description.value( key ).toString();
+    }
+    Q_FOREACH( const QString& name, devices ) {
+        if( !k3bcore->deviceManager()->findDevice( name ) ) {
+            if( error )
+                *error = i18n("Unknown device '%1'.", name);
+            return -1;
+        }
+    }
+
+    Private::Entry* e = new Private::Entry( d );
+    e->info.id = d->nextId++;
+    e->info.description = description;
+    e->info.state = Queued;
+    e->job = 0;
+    e->reader = e->writer = 0;
+    e->tempSpace = 0;
+    e->copiesLeft = qMax( 1, description.value( QLatin1String( "copies" ), 1 ).toInt() ) - 1;
+    e->canceled = false;
+    d->entries.append( e );
+
+    emit jobQueued( e->info.id );
+
+    d->scheduleLater();
+
+    return e->info.id;
+}
+
+
+bool K3b::JobQueue::cancel( int id )
+{
+    Private::Entry* e = d->entry( id );
+    if( !e )
+        return false;
+
+    if( e->info.state == Queued ) {
+        e->info.state = Canceled;
+        emit jobFinished( id, false );
+        return true;
+    }
+    else if( e->job ) {
+        e->canceled = true;
+        e->job->cancel();
+        return true;
+    }
+    else {
+        return false;
+    }
+}
+
+
+QList<K3b::JobQueue::JobInfo> K3b::JobQueue::jobs() const
+{
+    QList<JobInfo> list;
+    Q_FOREACH( Private::Entry* e, d->entries )
+        list.append( e->info );
+    return list;
+}
+
+
+K3b::JobQueue::JobInfo K3b::JobQueue::job( int id ) const
+{
+    if( Private::Entry* e = d->entry( id ) )
+        return e->info;
+
+    JobInfo info;
+    info.id = -1;
+    info.state = Failed;
+    return info;
+}
+
+
+void K3b::JobQueue::clearFinished()
+{
+    QList<Private::Entry*>::iterator it = d->entries.begin();
+    while( it != d->entries.end() ) {
+        if( (*it)->info.state != Queued && (*it)->info.state != Running ) {
+            delete *it;
+            it = d->entries.erase( it );
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+
+void K3b::JobQueue::setTempBudget( KIO::filesize_t bytes )
+{
+    d->tempBudget = bytes;
+    d->scheduleLater();
+}
+
+
+KIO::filesize_t K3b::JobQueue::tempBudget() const
+{
+    return d->tempBudget;
+}
+
+
+void K3b::JobQueue::setMaxTempJobs( int jobs )
+{
+    d->maxTempJobs = qMax( 1, jobs );
+    d->scheduleLater();
+}
+
+
+void K3b::JobQueue::setMediumTimeout( int secs )
+{
+    d->mediumTimeout = secs;
+}
+
+
+QList<K3b::JobQueue::DriveUtilisation> K3b::JobQueue::utilisation() const
+{
+    QList<DriveUtilisation> list;
+
+    const qint64 now = d->clock.elapsed();
+    Q_FOREACH( Device::Device* dev, k3bcore->deviceManager()->allDevices() ) {
+        const Private::DriveStats s = d->driveStats.value( dev );
+        DriveUtilisation u;
+        u.device = dev;
+        u.busyMSecs = s.busyMSecs + ( s.busySince >= 0 ? now - s.busySince : 0 );
+        u.jobs = s.jobs;
+        u.failedJobs = s.failedJobs;
+        u.utilisation = ( now > 0 ? double( u.busyMSecs ) / double( now ) : 0.0 );
+        list.append( u );
+    }
+
+    return list;
+}
+
+
+QString K3b::JobQueue::privateTempDir( QObject* job )
+{
+    QTemporaryDir* dir = new QTemporaryDir( K3b::defaultTempPath() + QLatin1String( "k3bQueueXXXXXX" ) );
+    if( !dir->isValid() ) {
+        qDebug() << "(K3b::JobQueue) unable to create a temp folder in" << K3b::defaultTempPath();
+        delete dir;
+        return QString();
+    }
+
+    QObject::connect( job, &QObject::destroyed, [dir]() { delete dir; } );
+    return K3b::prepareDir( dir->path() );
+}
+
+
+QString K3b::JobQueue::utilisationReport() const
+{
+    QStringList lines;
+    Q_FOREACH( const DriveUtilisation& u, utilisation() ) {
+        lines << QString::fromLatin1( "%1 (%2 %3): %4% busy, %5 jobs, %6 failed" )
+            .arg( u.device->blockDeviceName() )
+            .arg( u.device->vendor() )
+            .arg( u.device->description() )
+            .arg( 100.0*u.utilisation, 0, 'f', 1 )
+            .arg( u.jobs )
+            .arg( u.failedJobs );
+    }
+    return lines.join( QLatin1String( "\n" ) );
+}
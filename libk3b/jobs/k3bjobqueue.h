@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef _K3B_JOB_QUEUE_H_
+#define _K3B_JOB_QUEUE_H_
+
+#include "k3b_export.h"
+
+#include <KIOCore/KIO/Global>
+
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+
+#include <functional>
+
+
+namespace K3b {
+    class Job;
+    class JobHandler;
+
+    namespace Device {
+        class Device;
+    }
+
+    /**
+     * The job queue runs disc jobs on all available drives at once.
+     *
+     * Jobs are described by a map of simple values which makes it easy to
+     * create them from scripts. The "type" entry selects one of the registered
+     * job types, all other entries are interpreted by the job type. The following
+     * entries are understood by the queue itself:
+     *
+     * \li "writer", "reader": The block device name of the drive to use. If not
+     *     set the queue picks an idle drive which supports the "media".
+     * \li "writers": A list of block device names. The job writes to all of them
+     *     at once and only starts once all of them are idle. Overrides "writer".
+     * \li "media": "cd", "dvd", or "bd". The kind of media the job works with.
+     *
+     * Once a job type's drives are idle and the temp folder has room for its
+     * images the job is created and started. Questions asked by the jobs are
+     * answered with no.
+     *
+     * Each of the "copies" is written by a job of its own on the next drive
+     * with a suitable medium. Be aware that this means that every copy reads
+     * its source again: a "copy" job reads the source medium once per copy and
+     * a project job creates its image once per copy.
+     *
+     * A job which asks for a medium that is not there is stopped and queued
+     * again. It is restarted once a suitable medium has been inserted or fails
+     * when the medium timeout expires. Any number of jobs may wait that way.
+     *
+     * The built-in job types are "image" (write an ISO9660 image), "copy"
+     * (copy a CD or DVD), "rip" (read a CD or DVD into an image), and
+     * "duplicate" and "duplicateimage" which read a single session data medium
+     * or an "image" once and write it to all "writers" at the same time.
+     */
+    class LIBK3B_EXPORT JobQueue : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        enum DeviceRole {
+            Reader = 0x1,
+            Writer = 0x2
+        };
+
+        struct JobType {
+            JobType();
+
+            /**
+             * The drives a job of this type needs, a combination of DeviceRole.
+             */
+            int roles;
+
+            /**
+             * Creates the job. \p reader and \p writer are only set if the roles
+             * contain them. Returns 0 if the description is invalid.
+             */
+            std::function<Job*( const QVariantMap& description,
+                                Device::Device* reader,
+                                Device::Device* writer,
+                                JobHandler* handler,
+                                QObject* parent )> create;
+
+            /**
+             * Optional. The number of bytes the job will store in the temp folder.
+             */
+            std::function<KIO::filesize_t( const QVariantMap& description,
+                                           Device::Device* reader )> tempSpace;
+        };
+
+        enum State {
+            Queued,
+            Running,
+            Succeeded,
+            Failed,
+            Canceled
+        };
+
+        struct JobInfo {
+            int id;
+            QVariantMap description;
+            State state;
+            QString reader;     /**< block device name, empty if not assigned */
+            QString writer;     /**< comma separated if the job uses several writers */
+            QString jobDescription;
+            QString error;
+        };
+
+        struct DriveUtilisation {
+            Device::Device* device;
+            qint64 busyMSecs;
+            int jobs;
+            int failedJobs;
+            double utilisation;  /**< busy time relative to the lifetime of the queue */
+        };
+
+        explicit JobQueue( QObject* parent = 0 );
+        ~JobQueue();
+
+        /**
+         * Registers a job type. An existing type with the same name is replaced.
+         */
+        void registerJobType( const QString& name, const JobType& type );
+        QStringList jobTypes() const;
+
+        /**
+         * Queues a job and starts it as soon as possible.
+         *
+         * \return The id of the job or -1 if the description is invalid. In that case
+         * \p error is set to a description of the problem.
+         */
+        int enqueue( const QVariantMap& description, QString* error = 0 );
+
+        /**
+         * Removes a queued job or cancels a running one.
+         */
+        bool cancel( int id );
+
+        /**
+         * \return All jobs in the order they have been queued, including
+         * the ones which are already done.
+         */
+        QList<JobInfo> jobs() const;
+        JobInfo job( int id ) const;
+
+        /**
+         * Removes the information about finished jobs.
+         */
+        void clearFinished();
+
+        /**
+         * The maximum number of bytes the jobs running at the same time may store in
+         * the temp folder. 0, the default, means the free space in the temp folder.
+         */
+        void setTempBudget( KIO::filesize_t bytes );
+        KIO::filesize_t tempBudget() const;
+
+        /**
+         * The maximum number of jobs which use the temp folder at the same time.
+         * Defaults to 2 to not have the jobs fight over the disk.
+         */
+        void setMaxTempJobs( int jobs );
+
+        /**
+         * The time in seconds a job waits for a suitable medium before it is
+         * canceled. Defaults to 10 minutes.
+         */
+        void setMediumTimeout( int secs );
+
+        QList<DriveUtilisation> utilisation() const;
+
+        /**
+         * Creates a folder in the temp folder which is only used by \p job and
+         * removed together with it. This way jobs running at the same time
+         * cannot pick the same image file names.
+         *
+         * \return The path of the folder or an empty string on error.
+         */
+        static QString privateTempDir( QObject* job );
+
+        /**
+         * A human readable summary of the drive utilisation.
+         */
+        QString utilisationReport() const;
+
+    Q_SIGNALS:
+        void jobQueued( int id );
+        void jobStarted( int id );
+        void jobFinished( int id, bool success );
+        void infoMessage( int id, const QString& message, int type );
+        void percent( int id, int p );
+
+    private:
+        class Private;
+        Private* const d;
+    };
+}
+
+#endif
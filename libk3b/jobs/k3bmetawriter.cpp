@@ -16,6 +16,7 @@
 #include "k3bcdrskinwriter.h"
 #include "k3bcdrdaowriter.h"
 #include "k3bgrowisofswriter.h"
+#include "k3bnativewriter.h"
 #include "k3btocfilewriter.h"
 #include "k3binffilewriter.h"
 
@@ -172,6 +173,9 @@ void K3b::MetaWriter::start()
     case K3b::WritingAppCdrskin:
         success = setupCdrskinJob();
         break;
+    case K3b::WritingAppNative:
+        success = setupNativeJob();
+        break;
     default:
         Q_ASSERT(false);
         break;
@@ -461,6 +465,25 @@ bool K3b::MetaWriter::determineUsedAppAndMode()
     // Some final checks and safety nets
     // =============================================
 
+    if( d->usedWritingApp == K3b::WritingAppNative ) {
+        if( mediaType & Device::MEDIA_CD_ALL ) {
+            emit infoMessage( i18n( "%1 media cannot be written with the native writer.",
+                                    K3b::Device::mediaTypeString( mediaType, true ) ), MessageError );
+            return false;
+        }
+        if( !d->cueFile.isEmpty() ||
+            d->toc.count() != 1 ||
+            d->toc.first().type() != Device::Track::TYPE_DATA ) {
+            emit infoMessage( i18n("The native writer can only write a single data track."), MessageError );
+            return false;
+        }
+        if( !medium.diskInfo().empty() &&
+            !( mediaType & (Device::MEDIA_DVD_PLUS_RW|Device::MEDIA_DVD_RW_OVWR|Device::MEDIA_BD_RE) ) ) {
+            emit infoMessage( i18n("The native writer cannot append to a non-empty medium."), MessageError );
+            return false;
+        }
+    }
+
     // on-the-fly writing with cdrecord >= 2.01a13
     if( d->usedWritingApp == K3b::WritingAppCdrecord &&
         onTheFly &&
@@ -728,6 +751,26 @@ bool K3b::MetaWriter::setupGrowisofsob()
 }
 
 
+bool K3b::MetaWriter::setupNativeJob()
+{
+    K3b::NativeWriter* job = new K3b::NativeWriter( burnDevice(), this, this );
+
+    job->setSimulate( simulate() );
+    job->setBurnSpeed( burnSpeed() );
+    job->setMultiSession( d->multiSession );
+    job->setTrackSize( d->toc.first().length().lba() );
+
+    if( d->images.isEmpty() )
+        job->setImageToWrite( QString() ); // read from ioDevice()
+    else
+        job->setImageToWrite( d->images.first() );
+
+    d->writingJob = job;
+
+    return true;
+}
+
+
 bool K3b::MetaWriter::setupCdrskinJob()
 {
     K3b::CdrskinWriter* writer = new K3b::CdrskinWriter( burnDevice(), this, this );
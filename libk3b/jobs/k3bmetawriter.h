@@ -82,6 +82,7 @@ namespace K3b {
         bool setupCdrskinJob();
         bool setupCdrdaoJob();
         bool setupGrowisofsob();
+        bool setupNativeJob();
         bool startTrackWriting();
 
         void informUser();
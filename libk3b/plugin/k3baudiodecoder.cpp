@@ -30,6 +30,7 @@
 #include <QMimeType>
 
 #include <math.h>
+#include <string.h>
 
 #include <samplerate.h>
 
@@ -471,6 +472,67 @@ void K3b::AudioDecoder::from8BitTo16BitBeSigned( char* src, char* dest, int samp
 }
 
 
+//
+// The conversions below are written without branches in the inner loops
+// so the compiler is able to vectorize them.
+//
+void K3b::AudioDecoder::fromNative16BitTo16BitBeSigned( const qint16* src, char* dest, int samples )
+{
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+    if( reinterpret_cast<const char*>( src ) != dest )
+        ::memmove( dest, src, samples*2 );
+#else
+    uchar* out = reinterpret_cast<uchar*>( dest );
+    for( int i = 0; i < samples; ++i ) {
+        const quint16 s = quint16( src[i] );
+        out[2*i]   = s >> 8;
+        out[2*i+1] = s;
+    }
+#endif
+}
+
+
+void K3b::AudioDecoder::fromNative32BitTo16BitBeSigned( const qint32* src, char* dest, int samples, int bitsPerSample )
+{
+    // writing sample i never touches the source of the samples after it
+    uchar* out = reinterpret_cast<uchar*>( dest );
+    if( bitsPerSample >= 16 ) {
+        const int shift = bitsPerSample - 16;
+        for( int i = 0; i < samples; ++i ) {
+            const quint16 s = quint16( src[i] >> shift );
+            out[2*i]   = s >> 8;
+            out[2*i+1] = s;
+        }
+    }
+    else {
+        const int shift = 16 - bitsPerSample;
+        for( int i = 0; i < samples; ++i ) {
+            const quint16 s = quint16( quint32( src[i] ) << shift );
+            out[2*i]   = s >> 8;
+            out[2*i+1] = s;
+        }
+    }
+}
+
+
+void K3b::AudioDecoder::fromPlanar32BitTo16BitBeSigned( const qint32* const* src, int channels, int frames,
+                                                        int bitsPerSample, char* dest )
+{
+    const int stride = 2*channels;
+    const int rshift = qMax( 0, bitsPerSample - 16 );
+    const int lshift = qMax( 0, 16 - bitsPerSample );
+    for( int c = 0; c < channels; ++c ) {
+        const qint32* in = src[c];
+        uchar* out = reinterpret_cast<uchar*>( dest ) + 2*c;
+        for( int i = 0; i < frames; ++i ) {
+            const quint16 s = quint16( quint32( in[i] >> rshift ) << lshift );
+            out[stride*i]   = s >> 8;
+            out[stride*i+1] = s;
+        }
+    }
+}
+
+
 bool K3b::AudioDecoder::seek( const K3b::Msf& pos )
 {
     qDebug() << "(K3b::AudioDecoder) seek from " << d->currentPos.toString() << " (+" << d->currentPosOffset
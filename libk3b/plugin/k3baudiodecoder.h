@@ -150,6 +150,26 @@ namespace K3b {
         static void from16bitBeSignedToFloat( char* src, float* dest, int samples );
         static void from8BitTo16BitBeSigned( char* src, char* dest, int samples );
 
+        /**
+         * Converts native 16 bit samples to big endian.
+         * \p src and \p dest may point to the same buffer.
+         */
+        static void fromNative16BitTo16BitBeSigned( const qint16* src, char* dest, int samples );
+
+        /**
+         * Converts interleaved native samples with \p bitsPerSample significant
+         * bits to 16 bit big endian. Larger samples are truncated.
+         * \p src and \p dest may point to the same buffer.
+         */
+        static void fromNative32BitTo16BitBeSigned( const qint32* src, char* dest, int samples, int bitsPerSample );
+
+        /**
+         * Like fromNative32BitTo16BitBeSigned() but interleaves the samples of
+         * \p channels separate channel buffers as used by lossless codecs.
+         */
+        static void fromPlanar32BitTo16BitBeSigned( const qint32* const* src, int channels, int frames,
+                                                    int bitsPerSample, char* dest );
+
     protected:
         /**
          * Use this method if using the default implementation of @p metaInfo
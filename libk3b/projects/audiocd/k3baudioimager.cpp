@@ -34,10 +34,13 @@ class K3b::AudioImager::Private
 {
 public:
     Private()
-        : ioDev(0) {
+        : ioDev(0),
+          analyzeLevels(false) {
     }
 
     QIODevice* ioDev;
+    bool analyzeLevels;
+    QList<AudioLevels> trackLevels;
     AudioImager::ErrorType lastError;
     AudioDoc* doc;
     AudioJobTempData* tempData;
@@ -66,6 +69,18 @@ void K3b::AudioImager::writeTo( QIODevice* dev )
 }
 
 
+void K3b::AudioImager::setAnalyzeLevels( bool b )
+{
+    d->analyzeLevels = b;
+}
+
+
+QList<K3b::AudioLevels> K3b::AudioImager::trackLevels() const
+{
+    return d->trackLevels;
+}
+
+
 K3b::AudioImager::ErrorType K3b::AudioImager::lastErrorType() const
 {
     return d->lastError;
@@ -77,6 +92,8 @@ bool K3b::AudioImager::run()
     d->lastError = K3b::AudioImager::ERROR_UNKNOWN;
 
     K3b::WaveFileWriter waveFileWriter;
+    K3b::AudioLevelAnalyzer levelAnalyzer;
+    d->trackLevels.clear();
 
     qint64 totalSize = d->doc->length().audioBytes();
     qint64 totalRead = 0;
@@ -100,6 +117,7 @@ bool K3b::AudioImager::run()
         //
         qint64 read = 0;
         qint64 trackRead = 0;
+        levelAnalyzer.reset();
 
         //
         // Create the image file
@@ -116,6 +134,10 @@ bool K3b::AudioImager::run()
         // Read data from the track
         //
         while( !trackReader.atEnd() && (read = trackReader.read( buffer, sizeof(buffer) )) > 0 ) {
+            if( d->analyzeLevels ) {
+                levelAnalyzer.process( buffer, read, K3b::AudioLevelAnalyzer::BigEndian );
+            }
+
             if( !d->ioDev ) {
                 waveFileWriter.write( buffer, read, K3b::WaveFileWriter::BigEndian );
             }
@@ -137,6 +159,7 @@ bool K3b::AudioImager::run()
             //
             totalRead += read;
             trackRead += read;
+            recordTelemetry( K3b::JobTelemetry::Bytes, totalRead );
 
             emit subPercent( 100LL*trackRead/trackReader.size() );
             emit percent( 100LL*totalRead/totalSize );
@@ -151,6 +174,10 @@ bool K3b::AudioImager::run()
             d->lastError = K3b::AudioImager::ERROR_DECODING_TRACK;
             return false;
         }
+
+        if( d->analyzeLevels ) {
+            d->trackLevels.append( levelAnalyzer.levels() );
+        }
     }
 
     return true;
@@ -16,6 +16,9 @@
 #define _K3B_AUDIO_IMAGER_H_
 
 #include "k3bthreadjob.h"
+#include "k3baudiolevelanalyzer.h"
+
+#include <QList>
 
 class QIODevice;
 
@@ -38,6 +41,19 @@ namespace K3b {
          */
         void writeTo( QIODevice* dev );
 
+        /**
+         * Compute the volume levels of all tracks while decoding them.
+         * The result is available through trackLevels() once the job
+         * has finished.
+         */
+        void setAnalyzeLevels( bool b );
+
+        /**
+         * \return The levels of all tracks as computed during the last run
+         *         or an empty list if level analysis was disabled.
+         */
+        QList<AudioLevels> trackLevels() const;
+
         enum ErrorType {
             ERROR_FD_WRITE,
             ERROR_DECODING_TRACK,
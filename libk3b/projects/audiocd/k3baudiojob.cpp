@@ -152,6 +152,9 @@ void K3b::AudioJob::start()
     if( m_doc->dummy() )
         d->copies = 1;
 
+    // the levels are computed while decoding and handed to the normalize job
+    m_audioImager->setAnalyzeLevels( m_doc->normalize() && !m_doc->onTheFly() );
+
     emit newTask( i18n("Preparing data") );
 
     //
@@ -726,6 +729,7 @@ void K3b::AudioJob::normalizeFiles()
     }
 
     m_normalizeJob->setFilesToNormalize( files );
+    m_normalizeJob->setTrackLevels( m_audioImager->trackLevels() );
 
     emit newTask( i18n("Normalizing volume levels") );
     m_normalizeJob->start();
@@ -0,0 +1,262 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3baudiolevelanalyzer.h"
+
+#include <math.h>
+#include <string.h>
+
+
+namespace {
+    //
+    // The ReplayGain equal loudness filter for 44.1 kHz as published with the
+    // reference implementation (gain_analysis.c). A 10th order Yule-Walker
+    // filter followed by a 2nd order Butterworth high pass.
+    //
+    const double s_yuleB[11] = {
+        0.05418656406430, -0.02911007808948, -0.00848709379851, -0.00851165645469,
+        -0.00834990904936, 0.02245293253339, -0.02596338512915, 0.01624864962975,
+        -0.00240879051584, 0.00674613682247, -0.00187763777362
+    };
+    const double s_yuleA[11] = {
+        1.0, -3.47845948550071, 6.36317777566148, -8.54751527471874,
+        9.47693607801280, -8.81498681370155, 6.85401540936998, -4.39470996079559,
+        2.19611684890774, -0.75104302451432, 0.13149317958808
+    };
+    const double s_butterB[3] = { 0.98500175787242, -1.97000351574484, 0.98500175787242 };
+    const double s_butterA[3] = { 1.0, -1.96977855582618, 0.97022847566350 };
+
+    // 50 ms RMS windows
+    const int s_windowSize = 44100 / 20;
+
+    // resolution of the loudness histogram
+    const int s_stepsPerDb = 100;
+    const int s_maxDb = 120;
+
+    // loudness of the pink noise reference signal in dB
+    const double s_pinkReference = 64.82;
+
+    // the loudness of a track is the 95th percentile of its windows
+    const double s_rmsPercentile = 0.95;
+
+    // decode in blocks of one second
+    const int s_blockSamples = 44100;
+
+    inline qint16 fromBigEndian( const char* p )
+    {
+        return qint16( ( ( p[0] << 8 ) & 0xff00 ) | ( p[1] & 0x00ff ) );
+    }
+
+    inline qint16 fromLittleEndian( const char* p )
+    {
+        return qint16( ( ( p[1] << 8 ) & 0xff00 ) | ( p[0] & 0x00ff ) );
+    }
+}
+
+
+double K3b::AudioLevels::normalizationGain() const
+{
+    if( !isValid() )
+        return 0.0;
+
+    double gain = replayGain;
+    if( peak > 0.0 ) {
+        // never amplify beyond full scale
+        gain = qMin( gain, -20.0 * log10( peak ) );
+    }
+    return gain;
+}
+
+
+K3b::AudioLevelAnalyzer::AudioLevelAnalyzer()
+{
+    m_left.resize( s_blockSamples );
+    m_right.resize( s_blockSamples );
+    m_filteredLeft.resize( s_blockSamples );
+    m_filteredRight.resize( s_blockSamples );
+    reset();
+}
+
+
+K3b::AudioLevelAnalyzer::~AudioLevelAnalyzer()
+{
+}
+
+
+void K3b::AudioLevelAnalyzer::reset()
+{
+    ::memset( m_leftInHistory, 0, sizeof(m_leftInHistory) );
+    ::memset( m_rightInHistory, 0, sizeof(m_rightInHistory) );
+    ::memset( m_leftYuleHistory, 0, sizeof(m_leftYuleHistory) );
+    ::memset( m_rightYuleHistory, 0, sizeof(m_rightYuleHistory) );
+    ::memset( m_leftButterHistory, 0, sizeof(m_leftButterHistory) );
+    ::memset( m_rightButterHistory, 0, sizeof(m_rightButterHistory) );
+
+    m_windowSum = 0.0;
+    m_windowSamples = 0;
+    m_histogram.fill( 0, s_maxDb * s_stepsPerDb );
+
+    m_peak = 0.0;
+    m_squareSum = 0.0;
+    m_samples = 0;
+    m_numPendingBytes = 0;
+}
+
+
+void K3b::AudioLevelAnalyzer::process( const char* data, qint64 len, ByteOrder byteOrder )
+{
+    // complete a sample split over two calls
+    while( m_numPendingBytes > 0 && len > 0 ) {
+        m_pendingBytes[m_numPendingBytes++] = *data++;
+        --len;
+        if( m_numPendingBytes == 4 ) {
+            m_numPendingBytes = 0;
+            process( m_pendingBytes, 4, byteOrder );
+        }
+    }
+
+    while( len >= 4 ) {
+        const int samples = qMin<qint64>( len / 4, s_blockSamples );
+        float* left = m_left.data();
+        float* right = m_right.data();
+
+        //
+        // Convert to float. The loops are kept free of branches so the compiler
+        // can vectorize them.
+        //
+        if( byteOrder == BigEndian ) {
+            for( int i = 0; i < samples; ++i ) {
+                left[i] = fromBigEndian( data + 4*i );
+                right[i] = fromBigEndian( data + 4*i + 2 );
+            }
+        }
+        else {
+            for( int i = 0; i < samples; ++i ) {
+                left[i] = fromLittleEndian( data + 4*i );
+                right[i] = fromLittleEndian( data + 4*i + 2 );
+            }
+        }
+
+        float peak = m_peak * 32768.0f;
+        float squareSum = 0.0f;
+        for( int i = 0; i < samples; ++i ) {
+            peak = qMax( peak, qMax( qAbs( left[i] ), qAbs( right[i] ) ) );
+            squareSum += left[i]*left[i] + right[i]*right[i];
+        }
+        m_peak = peak / 32768.0f;
+        m_squareSum += squareSum;
+        m_samples += samples;
+
+        //
+        // Equal loudness filtering and windowed RMS for ReplayGain
+        //
+        filterChannel( left, samples, m_leftInHistory, m_leftYuleHistory, m_leftButterHistory, m_filteredLeft.data() );
+        filterChannel( right, samples, m_rightInHistory, m_rightYuleHistory, m_rightButterHistory, m_filteredRight.data() );
+
+        const float* fl = m_filteredLeft.constData();
+        const float* fr = m_filteredRight.constData();
+        for( int i = 0; i < samples; ++i ) {
+            m_windowSum += double( fl[i] )*fl[i] + double( fr[i] )*fr[i];
+            if( ++m_windowSamples == s_windowSize ) {
+                const double db = 10.0 * log10( m_windowSum / double( s_windowSize ) * 0.5 + 1.0e-37 );
+                const int index = qBound( 0, int( db * double( s_stepsPerDb ) ), m_histogram.count() - 1 );
+                ++m_histogram[index];
+                m_windowSum = 0.0;
+                m_windowSamples = 0;
+            }
+        }
+
+        data += 4*samples;
+        len -= 4*samples;
+    }
+
+    // keep the remaining bytes of an incomplete sample for the next call
+    while( len > 0 ) {
+        m_pendingBytes[m_numPendingBytes++] = *data++;
+        --len;
+    }
+}
+
+
+void K3b::AudioLevelAnalyzer::filterChannel( const float* in, int samples,
+                                             double* inHistory, double* yuleHistory, double* butterHistory,
+                                             float* out )
+{
+    //
+    // The histories of the last ten input and Yule output values are placed in
+    // front of the block so the filters can be run without special-casing the
+    // block start. The histories are stored oldest first.
+    //
+    m_filterIn.resize( samples + 10 );
+    m_filterYule.resize( samples + 10 );
+    m_filterButter.resize( samples + 2 );
+    double* x = m_filterIn.data() + 10;
+    double* y = m_filterYule.data() + 10;
+    double* z = m_filterButter.data() + 2;
+
+    ::memcpy( x - 10, inHistory, 10 * sizeof(double) );
+    ::memcpy( y - 10, yuleHistory, 10 * sizeof(double) );
+    ::memcpy( z - 2, butterHistory, 2 * sizeof(double) );
+
+    for( int i = 0; i < samples; ++i )
+        x[i] = in[i];
+
+    for( int i = 0; i < samples; ++i ) {
+        // the tiny offset keeps the filter out of denormal territory on digital silence
+        double v = 1.0e-10 + s_yuleB[0] * x[i];
+        for( int k = 1; k <= 10; ++k )
+            v += s_yuleB[k] * x[i-k] - s_yuleA[k] * y[i-k];
+        y[i] = v;
+    }
+
+    for( int i = 0; i < samples; ++i ) {
+        z[i] = s_butterB[0] * y[i] + s_butterB[1] * y[i-1] + s_butterB[2] * y[i-2]
+               - s_butterA[1] * z[i-1] - s_butterA[2] * z[i-2];
+        out[i] = z[i];
+    }
+
+    ::memcpy( inHistory, x + samples - 10, 10 * sizeof(double) );
+    ::memcpy( yuleHistory, y + samples - 10, 10 * sizeof(double) );
+    ::memcpy( butterHistory, z + samples - 2, 2 * sizeof(double) );
+}
+
+
+K3b::AudioLevels K3b::AudioLevelAnalyzer::levels() const
+{
+    AudioLevels l;
+    if( m_samples == 0 )
+        return l;
+
+    l.samples = m_samples;
+    l.peak = m_peak;
+    l.rms = sqrt( m_squareSum / double( 2*m_samples ) ) / 32768.0;
+
+    quint64 windows = 0;
+    for( int i = 0; i < m_histogram.count(); ++i )
+        windows += m_histogram[i];
+
+    if( windows > 0 ) {
+        const quint64 upper = quint64( ceil( double( windows ) * ( 1.0 - s_rmsPercentile ) ) );
+        quint64 sum = 0;
+        int i = m_histogram.count();
+        while( i-- > 0 ) {
+            sum += m_histogram[i];
+            if( sum >= upper )
+                break;
+        }
+        l.replayGain = s_pinkReference - double( qMax( i, 0 ) ) / double( s_stepsPerDb );
+    }
+
+    return l;
+}
@@ -0,0 +1,127 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef _K3B_AUDIO_LEVEL_ANALYZER_H_
+#define _K3B_AUDIO_LEVEL_ANALYZER_H_
+
+#include <QtGlobal>
+#include <QVector>
+
+
+namespace K3b {
+    /**
+     * The volume levels of one audio track.
+     */
+    class AudioLevels
+    {
+    public:
+        AudioLevels()
+            : peak( 0.0 ),
+              rms( 0.0 ),
+              replayGain( 0.0 ),
+              samples( 0 ) {
+        }
+
+        bool isValid() const { return samples > 0; }
+
+        /**
+         * The gain in dB which brings the track to the ReplayGain reference
+         * level without clipping.
+         */
+        double normalizationGain() const;
+
+        /**
+         * Peak amplitude in the range [0,1]
+         */
+        double peak;
+
+        /**
+         * RMS amplitude in the range [0,1]
+         */
+        double rms;
+
+        /**
+         * The ReplayGain track gain in dB relative to the 89 dB reference level.
+         */
+        double replayGain;
+
+        /**
+         * Number of stereo samples analyzed.
+         */
+        qint64 samples;
+    };
+
+
+    /**
+     * Computes peak, RMS and ReplayGain of 16bit stereo 44.1 kHz audio data.
+     *
+     * Data is fed in blocks of arbitrary size through process(). The analyzer
+     * keeps all filter state between calls so it can be fed directly from a
+     * decoding loop.
+     */
+    class AudioLevelAnalyzer
+    {
+    public:
+        enum ByteOrder {
+            BigEndian,
+            LittleEndian
+        };
+
+        AudioLevelAnalyzer();
+        ~AudioLevelAnalyzer();
+
+        void reset();
+
+        /**
+         * Analyze \p len bytes of 16bit stereo samples.
+         */
+        void process( const char* data, qint64 len, ByteOrder byteOrder = BigEndian );
+
+        AudioLevels levels() const;
+
+    private:
+        void filterChannel( const float* in, int samples, double* inHistory, double* yuleHistory, double* butterHistory, float* out );
+
+        QVector<float> m_left;
+        QVector<float> m_right;
+        QVector<float> m_filteredLeft;
+        QVector<float> m_filteredRight;
+
+        // scratch buffers for filterChannel()
+        QVector<double> m_filterIn;
+        QVector<double> m_filterYule;
+        QVector<double> m_filterButter;
+
+        double m_leftInHistory[10];
+        double m_rightInHistory[10];
+        double m_leftYuleHistory[10];
+        double m_rightYuleHistory[10];
+        double m_leftButterHistory[2];
+        double m_rightButterHistory[2];
+
+        double m_windowSum;
+        int m_windowSamples;
+        QVector<quint32> m_histogram;
+
+        float m_peak;
+        double m_squareSum;
+        qint64 m_samples;
+
+        // an incomplete sample from the previous call to process()
+        char m_pendingBytes[4];
+        int m_numPendingBytes;
+    };
+}
+
+#endif
@@ -12,192 +12,216 @@
  * See the file "COPYING" for the exact licensing terms.
  */
 
+#include <config-libk3b.h>
 
 #include "k3baudionormalizejob.h"
-#include "k3bexternalbinmanager.h"
-#include "k3bprocess.h"
-#include "k3bcore.h"
 #include "k3b_i18n.h"
 
+#include <QAtomicInt>
 #include <QDebug>
+#include <QFile>
+#include <QRunnable>
+#include <QThreadPool>
+
+#include <math.h>
+
+#if !(HAVE_LRINT && HAVE_LRINTF)
+#define lrintf(flt)             ((int) (flt+0.5))
+#endif
+
+
+namespace {
+    // the wave files are created by WaveFileWriter which always writes a 44 byte header
+    const int s_waveHeaderSize = 44;
+
+    const int s_bufferSize = 2352 * 75;
+
+    // adjustments smaller than this are not worth rewriting the file
+    const double s_adjustmentThreshold = 0.125;
+
+    enum Action {
+        COMPUTING_LEVELS,
+        ADJUSTING_LEVELS
+    };
+
+    /**
+     * Analyzes or adjusts one file. Progress and errors are reported through
+     * shared state since the runnables are executed on a thread pool.
+     */
+    class TrackWorker : public QRunnable
+    {
+    public:
+        TrackWorker( Action action,
+                     const QString& filename,
+                     K3b::AudioLevels* levels,
+                     const QAtomicInt& canceled,
+                     QAtomicInt& processedBlocks,
+                     QAtomicInt& failed )
+            : m_action( action ),
+              m_filename( filename ),
+              m_levels( levels ),
+              m_canceled( canceled ),
+              m_processedBlocks( processedBlocks ),
+              m_failed( failed ) {
+            setAutoDelete( true );
+        }
 
+        void run() {
+            bool success = ( m_action == COMPUTING_LEVELS ? analyze() : adjust() );
+            if( !success )
+                m_failed.ref();
+        }
 
-K3b::AudioNormalizeJob::AudioNormalizeJob( K3b::JobHandler* hdl, QObject* parent )
-    : K3b::Job( hdl, parent ),
-      m_process(0)
-{
-}
-
-
-K3b::AudioNormalizeJob::~AudioNormalizeJob()
-{
-    delete m_process;
-}
-
-
-void K3b::AudioNormalizeJob::start()
-{
-    m_canceled = false;
-    m_currentAction = COMPUTING_LEVELS;
-    m_currentTrack = 1;
-
-    jobStarted();
-
-    if( m_process )
-        delete m_process;
-
-    m_process = new K3b::Process();
-    connect( m_process, SIGNAL(stderrLine(QString)), this, SLOT(slotStdLine(QString)) );
-    connect( m_process, SIGNAL(finished(int,QProcess::ExitStatus)), this, SLOT(slotProcessExited(int,QProcess::ExitStatus)) );
-
-    const K3b::ExternalBin* bin = k3bcore->externalBinManager()->binObject( "normalize" );
+    private:
+        bool analyze() {
+            QFile f( m_filename );
+            if( !f.open( QIODevice::ReadOnly ) || !f.seek( s_waveHeaderSize ) ) {
+                qDebug() << "(K3b::AudioNormalizeJob) unable to open" << m_filename;
+                return false;
+            }
 
-    if( !bin ) {
-        emit infoMessage( i18n("Could not find normalize executable."), MessageError );
-        jobFinished(false);
-        return;
-    }
+            K3b::AudioLevelAnalyzer analyzer;
+            QByteArray buffer( s_bufferSize, Qt::Uninitialized );
+            qint64 read = 0;
+            while( ( read = f.read( buffer.data(), buffer.size() ) ) > 0 ) {
+                if( m_canceled.load() )
+                    return false;
+                analyzer.process( buffer.constData(), read, K3b::AudioLevelAnalyzer::LittleEndian );
+                m_processedBlocks.ref();
+            }
 
-    if( !bin->copyright().isEmpty() )
-        emit infoMessage( i18n("Using %1 %2 – Copyright © %3",bin->name(),bin->version(),bin->copyright()), MessageInfo );
+            *m_levels = analyzer.levels();
+            return read == 0;
+        }
 
-    // create the commandline
-    *m_process << bin;
+        bool adjust() {
+            const float factor = pow( 10.0, m_levels->normalizationGain() / 20.0 );
 
-    // additional user parameters from config
-    const QStringList& params = bin->userParameters();
-    for( QStringList::const_iterator it = params.begin(); it != params.end(); ++it )
-        *m_process << *it;
+            QFile f( m_filename );
+            if( !f.open( QIODevice::ReadWrite ) ) {
+                qDebug() << "(K3b::AudioNormalizeJob) unable to open" << m_filename;
+                return false;
+            }
 
-    // end the options
-    *m_process << "--";
+            QByteArray buffer( s_bufferSize, Qt::Uninitialized );
+            qint64 pos = s_waveHeaderSize;
+            qint64 read = 0;
+            while( f.seek( pos ) && ( read = f.read( buffer.data(), buffer.size() ) ) > 0 ) {
+                if( m_canceled.load() )
+                    return false;
+
+                char* data = buffer.data();
+                const int samples = read / 2;
+                for( int i = 0; i < samples; ++i ) {
+                    const float v = float( qint16( ( ( data[2*i+1] << 8 ) & 0xff00 ) | ( data[2*i] & 0x00ff ) ) ) * factor;
+                    const qint16 s = qint16( lrintf( qBound( -32768.0f, v, 32767.0f ) ) );
+                    data[2*i] = s;
+                    data[2*i+1] = s >> 8;
+                }
+
+                if( !f.seek( pos ) || f.write( data, read ) != read ) {
+                    qDebug() << "(K3b::AudioNormalizeJob) writing to" << m_filename << "failed";
+                    return false;
+                }
+                pos += read;
+                m_processedBlocks.ref();
+            }
 
-    // add the files
-    for( int i = 0; i < m_files.count(); ++i )
-        *m_process << m_files[i];
+            return read == 0;
+        }
 
-    // now start the process
-    if( !m_process->start( KProcess::OnlyStderrChannel ) ) {
-        // something went wrong when starting the program
-        // it "should" be the executable
-        qDebug() << "(K3b::AudioNormalizeJob) could not start normalize";
-        emit infoMessage( i18n("Could not start normalize."), K3b::Job::MessageError );
-        jobFinished(false);
-    }
+        Action m_action;
+        QString m_filename;
+        K3b::AudioLevels* m_levels;
+        const QAtomicInt& m_canceled;
+        QAtomicInt& m_processedBlocks;
+        QAtomicInt& m_failed;
+    };
 }
 
 
-void K3b::AudioNormalizeJob::cancel()
+K3b::AudioNormalizeJob::AudioNormalizeJob( K3b::JobHandler* hdl, QObject* parent )
+    : K3b::ThreadJob( hdl, parent )
 {
-    m_canceled = true;
-
-    if( m_process )
-        if( m_process->isRunning() ) {
-            m_process->kill();
-        }
 }
 
 
-void K3b::AudioNormalizeJob::slotStdLine( const QString& line )
+K3b::AudioNormalizeJob::~AudioNormalizeJob()
 {
-    // percent, subPercent, newTask (compute level and adjust)
-
-    //  emit newSubTask( i18n("Normalizing track %1 of %2 (%3)",t,tt,m_files.at(t-1)) );
-
-    emit debuggingOutput( "normalize", line );
+}
 
-    // wenn "% done" drin:
-    //    wenn ein --% drin ist, so beginnt ein neuer track
-    //    sonst prozent parsen "batch xxx" ist der fortschritt der action
-    //                         also ev. den batch fortschritt * 1/2
 
-    if( line.startsWith( "Applying adjustment" ) ) {
-        if( m_currentAction == COMPUTING_LEVELS ) {
-            // starting the adjustment with track 1
-            m_currentTrack = 1;
-            m_currentAction = ADJUSTING_LEVELS;
-        }
+bool K3b::AudioNormalizeJob::run()
+{
+    QList<AudioLevels> levels = m_levels;
+    if( levels.count() != m_files.count() ) {
+        levels.clear();
+        for( int i = 0; i < m_files.count(); ++i )
+            levels.append( AudioLevels() );
     }
 
-    else if( line.contains( "already normalized" ) ) {
-        // no normalization necessary for the current track
-        emit infoMessage( i18n("Track %1 is already normalized.",m_currentTrack), MessageInfo );
-        m_currentTrack++;
+    //
+    // Progress is counted in blocks over both actions
+    //
+    qint64 totalBlocks = 0;
+    for( int i = 0; i < m_files.count(); ++i ) {
+        const qint64 blocks = ( QFile( m_files[i] ).size() - s_waveHeaderSize + s_bufferSize - 1 ) / s_bufferSize;
+        if( !levels[i].isValid() )
+            totalBlocks += blocks;
+        totalBlocks += blocks;
     }
+    totalBlocks = qMax( totalBlocks, qint64( 1 ) );
+
+    QAtomicInt cancelFlag( 0 );
+    QAtomicInt processedBlocks( 0 );
+    QAtomicInt failed( 0 );
+
+    QThreadPool pool;
+
+    for( int action = COMPUTING_LEVELS; action <= ADJUSTING_LEVELS; ++action ) {
+        int numTracks = 0;
+        for( int i = 0; i < m_files.count(); ++i ) {
+            if( action == COMPUTING_LEVELS && levels[i].isValid() )
+                continue;
+
+            if( action == ADJUSTING_LEVELS ) {
+                if( !levels[i].isValid() )
+                    continue;
+                if( qAbs( levels[i].normalizationGain() ) < s_adjustmentThreshold ) {
+                    emit infoMessage( i18n("Track %1 is already normalized.", i+1 ), MessageInfo );
+                    continue;
+                }
+                qDebug() << "(K3b::AudioNormalizeJob) adjusting track" << i+1 << m_files[i]
+                         << "by" << levels[i].normalizationGain() << "dB";
+            }
 
-    else if( line.contains( "--% done") ) {
-        if( m_currentAction == ADJUSTING_LEVELS ) {
-            emit newTask( i18n("Adjusting volume level for track %1 of %2",m_currentTrack,m_files.count()) );
-            qDebug() << "(K3b::AudioNormalizeJob) adjusting level for track "
-                     << m_currentTrack
-                     << " "
-                     << m_files.at(m_currentTrack-1)
-                     << endl;
+            pool.start( new TrackWorker( Action( action ), m_files[i], &levels[i], cancelFlag, processedBlocks, failed ) );
+            ++numTracks;
         }
-        else {
-            emit newTask( i18n("Computing level for track %1 of %2",m_currentTrack,m_files.count()) );
-            qDebug() << "(K3b::AudioNormalizeJob) computing level for track "
-                     << m_currentTrack
-                     << " "
-                     << m_files.at(m_currentTrack-1)
-                     << endl;
-        }
-
-        m_currentTrack++;
-    }
 
-    else if( int pos = line.indexOf( "% done" ) > 0 ) {
-        // parse progress: "XXX% done" and "batch XXX% done"
-        pos -= 3;
-        bool ok;
-        // TODO: do not use fixed values
-        // track progress starts at position 19 in version 0.7.6
-        int p = line.mid( 19, 3 ).toInt(&ok);
-        if( ok )
-            emit subPercent( p );
-        else
-            qDebug() << "(K3b::AudioNormalizeJob) subPercent parsing error at pos "
-                     << 19 << " in line '" << line.mid( 19, 3 ) << "'" << endl;
-
-        // batch progress starts at position 50 in version 0.7.6
-        p = line.mid( 50, 3 ).toInt(&ok);
-        if( ok && m_currentAction == COMPUTING_LEVELS )
-            emit percent( (int)((double)p/2.0) );
-        else if( ok && m_currentAction == ADJUSTING_LEVELS )
-            emit percent( 50 + (int)((double)p/2.0) );
-        else
-            qDebug() << "(K3b::AudioNormalizeJob) percent parsing error at pos "
-                     << 50 << " in line '" << line.mid( 50, 3 ) << "'" << endl;
+        if( numTracks > 0 ) {
+            if( action == COMPUTING_LEVELS )
+                emit newTask( i18np("Computing level for %1 track", "Computing levels for %1 tracks", numTracks) );
+            else
+                emit newTask( i18np("Adjusting volume level for %1 track", "Adjusting volume levels for %1 tracks", numTracks) );
+        }
 
-    }
-}
+        while( !pool.waitForDone( 200 ) ) {
+            if( canceled() )
+                cancelFlag.store( 1 );
+            emit percent( 100LL * processedBlocks.load() / totalBlocks );
+        }
 
+        if( canceled() )
+            return false;
 
-void K3b::AudioNormalizeJob::slotProcessExited( int exitCode, QProcess::ExitStatus exitStatus )
-{
-    if( exitStatus == QProcess::NormalExit ) {
-        switch( exitCode ) {
-        case 0:
-            emit infoMessage( i18n("Successfully normalized all tracks."), MessageSuccess );
-            jobFinished(true);
-            break;
-        default:
-            if( !m_canceled ) {
-                emit infoMessage( i18n("%1 returned an unknown error (code %2).",QString("normalize"), exitCode),
-                                  K3b::Job::MessageError );
-                emit infoMessage( i18n("Please send me an email with the last output."), K3b::Job::MessageError );
-                emit infoMessage( i18n("Error while normalizing tracks."), MessageError );
-            }
-            else
-                emit canceled();
-            jobFinished(false);
-            break;
+        if( failed.load() ) {
+            emit infoMessage( i18n("Error while normalizing tracks."), MessageError );
+            return false;
         }
     }
-    else {
-        emit infoMessage( i18n("%1 did not exit cleanly.",QString("Normalize")), K3b::Job::MessageError );
-        jobFinished( false );
-    }
-}
-
 
+    emit percent( 100 );
+    emit infoMessage( i18n("Successfully normalized all tracks."), MessageSuccess );
+    return true;
+}
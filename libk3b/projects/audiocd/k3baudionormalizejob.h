@@ -17,15 +17,21 @@
 #define _K3B_AUDIO_NORMALIZE_JOB_H_
 
 
-#include "k3bjob.h"
+#include "k3bthreadjob.h"
+#include "k3baudiolevelanalyzer.h"
 
 #include <QList>
-#include <QProcess>
 
 namespace K3b {
-    class Process;
-
-    class AudioNormalizeJob : public Job
+    /**
+     * Normalizes a set of wave files in place.
+     *
+     * Each track is adjusted to the ReplayGain reference level, limited by its
+     * peak so no clipping is introduced. Levels that are not already known
+     * (see setTrackLevels()) are computed first. Analysis and adjustment of
+     * the tracks run in parallel.
+     */
+    class AudioNormalizeJob : public ThreadJob
     {
         Q_OBJECT
 
@@ -34,28 +40,20 @@ namespace K3b {
         ~AudioNormalizeJob();
 
     public Q_SLOTS:
-        void start();
-        void cancel();
-
         void setFilesToNormalize( const QList<QString>& files ) { m_files = files; }
 
-    private Q_SLOTS:
-        void slotStdLine( const QString& line );
-        void slotProcessExited( int exitCode, QProcess::ExitStatus exitStatus );
+        /**
+         * Set the levels of the files as computed while creating them, for example
+         * by AudioImager. The list has to match the files to normalize. Otherwise
+         * it is ignored and the levels are computed from the files.
+         */
+        void setTrackLevels( const QList<K3b::AudioLevels>& levels ) { m_levels = levels; }
 
     private:
-        Process* m_process;
+        bool run();
 
         QList<QString> m_files;
-        bool m_canceled;
-
-        enum Action {
-            COMPUTING_LEVELS,
-            ADJUSTING_LEVELS
-        };
-
-        int m_currentAction;
-        int m_currentTrack;
+        QList<AudioLevels> m_levels;
     };
 }
 
@@ -0,0 +1,252 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3baudiopeaks.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QSaveFile>
+
+#include <string.h>
+
+
+namespace {
+    const char s_magic[8] = { 'K', '3', 'B', 'P', 'E', 'A', 'K', 'S' };
+    const quint32 s_version = 1;
+
+    inline qint16 fromBigEndian( const char* p )
+    {
+        return qint16( ( ( p[0] << 8 ) & 0xff00 ) | ( p[1] & 0x00ff ) );
+    }
+
+    inline void combine( K3b::AudioPeaks::Peak& p, const K3b::AudioPeaks::Peak& other )
+    {
+        p.min = qMin( p.min, other.min );
+        p.max = qMax( p.max, other.max );
+    }
+}
+
+
+K3b::AudioPeaks::AudioPeaks()
+{
+    clear();
+}
+
+
+void K3b::AudioPeaks::clear()
+{
+    m_levels.clear();
+    m_levels.append( QVector<Peak>() );
+    m_frames = 0;
+    m_samples = 0;
+    m_blockSamples = 0;
+    m_pendingByte = 0;
+    m_hasPendingByte = false;
+}
+
+
+void K3b::AudioPeaks::append( const char* data, qint64 len )
+{
+    if( len <= 0 )
+        return;
+
+    if( m_hasPendingByte ) {
+        const char sample[2] = { m_pendingByte, data[0] };
+        m_hasPendingByte = false;
+        appendSamples( sample, 1 );
+        ++data;
+        --len;
+    }
+
+    while( len >= 2 ) {
+        const int samples = int( qMin<qint64>( len/2, BlockFrames*2 - m_blockSamples ) );
+        appendSamples( data, samples );
+        data += 2*samples;
+        len -= 2*samples;
+    }
+
+    if( len > 0 ) {
+        m_pendingByte = data[0];
+        m_hasPendingByte = true;
+    }
+}
+
+
+void K3b::AudioPeaks::appendSamples( const char* data, int samples )
+{
+    if( m_blockSamples == 0 ) {
+        m_block.min = 32767;
+        m_block.max = -32768;
+    }
+
+    // no branches in here so the compiler is able to vectorize the loop
+    qint16 lo = m_block.min;
+    qint16 hi = m_block.max;
+    for( int i = 0; i < samples; ++i ) {
+        const qint16 s = fromBigEndian( data + 2*i );
+        lo = qMin( lo, s );
+        hi = qMax( hi, s );
+    }
+    m_block.min = lo;
+    m_block.max = hi;
+
+    m_samples += samples;
+    m_blockSamples += samples;
+    if( m_blockSamples == BlockFrames*2 ) {
+        m_levels[0].append( m_block );
+        m_blockSamples = 0;
+    }
+}
+
+
+void K3b::AudioPeaks::finish()
+{
+    if( m_blockSamples > 0 ) {
+        m_levels[0].append( m_block );
+        m_blockSamples = 0;
+    }
+    m_hasPendingByte = false;
+    m_frames = m_samples/2;
+
+    buildLevels();
+}
+
+
+void K3b::AudioPeaks::buildLevels()
+{
+    m_levels.resize( 1 );
+    while( m_levels.last().count() > 1 ) {
+        const QVector<Peak>& prev = m_levels.last();
+        const int pairs = prev.count()/2;
+
+        QVector<Peak> level( ( prev.count() + 1 )/2 );
+        for( int i = 0; i < pairs; ++i ) {
+            level[i].min = qMin( prev[2*i].min, prev[2*i+1].min );
+            level[i].max = qMax( prev[2*i].max, prev[2*i+1].max );
+        }
+        if( prev.count() % 2 )
+            level[pairs] = prev.last();
+
+        m_levels.append( level );
+    }
+}
+
+
+bool K3b::AudioPeaks::isEmpty() const
+{
+    return m_frames == 0;
+}
+
+
+qint64 K3b::AudioPeaks::frames() const
+{
+    return m_frames;
+}
+
+
+int K3b::AudioPeaks::levels() const
+{
+    return m_levels.count();
+}
+
+
+K3b::AudioPeaks::Peak K3b::AudioPeaks::peak( qint64 first, qint64 count ) const
+{
+    first = qMax<qint64>( first, 0 );
+    const qint64 end = qMin( first + count, m_frames );
+    if( end <= first )
+        return Peak();
+
+    //
+    // Walk up the levels from both ends of the range. Whenever a bound is not
+    // aligned to the next level its outermost peak is taken from the current
+    // level.
+    //
+    Peak p;
+    p.min = 32767;
+    p.max = -32768;
+    int lo = int( first/BlockFrames );
+    int hi = int( ( end - 1 )/BlockFrames ) + 1;
+    for( int level = 0; lo < hi; ++level ) {
+        const QVector<Peak>& peaks = m_levels[level];
+        if( lo & 1 )
+            combine( p, peaks[lo++] );
+        if( hi & 1 )
+            combine( p, peaks[--hi] );
+        lo >>= 1;
+        hi >>= 1;
+    }
+    return p;
+}
+
+
+bool K3b::AudioPeaks::save( const QString& filename ) const
+{
+    QSaveFile f( filename );
+    if( !f.open( QIODevice::WriteOnly ) ) {
+        qDebug() << "(K3b::AudioPeaks) could not open" << filename;
+        return false;
+    }
+
+    QDataStream s( &f );
+    s.writeRawData( s_magic, sizeof( s_magic ) );
+    s << s_version << qint32( BlockFrames ) << m_frames << qint32( m_levels[0].count() );
+    Q_FOREACH( const Peak& p, m_levels[0] )
+        s << p.min << p.max;
+
+    return( s.status() == QDataStream::Ok && f.commit() );
+}
+
+
+bool K3b::AudioPeaks::load( const QString& filename )
+{
+    clear();
+
+    QFile f( filename );
+    if( !f.open( QIODevice::ReadOnly ) )
+        return false;
+
+    QDataStream s( &f );
+    char magic[sizeof( s_magic )];
+    quint32 version = 0;
+    qint32 blockFrames = 0;
+    qint64 frames = 0;
+    qint32 count = 0;
+    if( s.readRawData( magic, sizeof( magic ) ) != sizeof( magic ) ||
+        memcmp( magic, s_magic, sizeof( magic ) ) != 0 )
+        return false;
+    s >> version >> blockFrames >> frames >> count;
+    if( s.status() != QDataStream::Ok ||
+        version != s_version ||
+        blockFrames != BlockFrames ||
+        frames < 0 ||
+        count != ( frames + BlockFrames - 1 )/BlockFrames ) {
+        qDebug() << "(K3b::AudioPeaks) invalid peak file" << filename;
+        return false;
+    }
+
+    QVector<Peak> peaks( count );
+    for( int i = 0; i < count; ++i )
+        s >> peaks[i].min >> peaks[i].max;
+    if( s.status() != QDataStream::Ok )
+        return false;
+
+    m_levels[0] = peaks;
+    m_frames = frames;
+    m_samples = frames*2;
+    buildLevels();
+
+    return true;
+}
@@ -0,0 +1,105 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef _K3B_AUDIO_PEAKS_H_
+#define _K3B_AUDIO_PEAKS_H_
+
+#include "k3b_export.h"
+
+#include <QString>
+#include <QVector>
+
+
+namespace K3b {
+    /**
+     * The minimum and maximum samples of a piece of audio data in several
+     * resolutions, used to draw waveforms.
+     *
+     * The first level contains one peak per BlockFrames frames, every
+     * following level combines two peaks of the previous one. Thus the peak of
+     * any range of frames is combined from at most two peaks per level,
+     * independent of the length of the range.
+     *
+     * Both channels are combined into a single peak.
+     */
+    class LIBK3B_EXPORT AudioPeaks
+    {
+    public:
+        struct Peak {
+            Peak()
+                : min( 0 ), max( 0 ) {
+            }
+
+            qint16 min;
+            qint16 max;
+        };
+
+        enum {
+            BlockFrames = 256
+        };
+
+        AudioPeaks();
+
+        /**
+         * Forgets all peaks to start over with append().
+         */
+        void clear();
+
+        /**
+         * Adds 16 bit big endian stereo samples as delivered by AudioDecoder.
+         * The data does not need to be aligned to samples.
+         */
+        void append( const char* data, qint64 len );
+
+        /**
+         * Adds the last incomplete block and builds the coarser levels. Needs
+         * to be called after the last append().
+         */
+        void finish();
+
+        bool isEmpty() const;
+
+        /**
+         * \return The number of frames the peaks have been created from.
+         */
+        qint64 frames() const;
+
+        int levels() const;
+
+        /**
+         * \return The peak of the frames [first, first+count). The frames are
+         * rounded to BlockFrames.
+         */
+        Peak peak( qint64 first, qint64 count ) const;
+
+        bool save( const QString& filename ) const;
+        bool load( const QString& filename );
+
+    private:
+        void appendSamples( const char* data, int samples );
+        void buildLevels();
+
+        QVector<QVector<Peak> > m_levels;
+        qint64 m_frames;
+
+        // the state of append()
+        qint64 m_samples;
+        Peak m_block;
+        int m_blockSamples;
+        char m_pendingByte;
+        bool m_hasPendingByte;
+    };
+}
+
+#endif
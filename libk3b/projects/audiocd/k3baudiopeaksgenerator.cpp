@@ -0,0 +1,345 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3baudiopeaksgenerator.h"
+#include "k3baudiodecoder.h"
+#include "k3baudiofile.h"
+#include "k3brawaudiodatasource.h"
+
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QStandardPaths>
+#include <QThread>
+#include <QUrl>
+
+
+namespace {
+    // decode in blocks of 10 sectors
+    const int s_bufferSize = 10*2352;
+
+    // the oldest peaks are removed once the cache grows beyond this size,
+    // which holds the peaks of about 20 hours of audio
+    const qint64 s_maxCacheSize = 100*1024*1024;
+
+    QString cacheFileName( const QString& filename )
+    {
+        QFileInfo fi( filename );
+        if( !fi.exists() )
+            return QString();
+
+        QCryptographicHash hash( QCryptographicHash::Sha1 );
+        hash.addData( QFile::encodeName( fi.canonicalFilePath() ) );
+        hash.addData( QByteArray::number( fi.size() ) );
+        hash.addData( QByteArray::number( fi.lastModified().toMSecsSinceEpoch() ) );
+        return K3b::AudioPeaksGenerator::cacheDir() + '/' + QString::fromLatin1( hash.result().toHex() ) + ".peaks";
+    }
+
+    void trimCache( const QString& keep )
+    {
+        const QFileInfoList files = QDir( K3b::AudioPeaksGenerator::cacheDir() ).entryInfoList( QStringList() << "*.peaks",
+                                                                                            QDir::Files,
+                                                                                            QDir::Time );
+        qint64 size = 0;
+        Q_FOREACH( const QFileInfo& fi, files ) {
+            size += fi.size();
+            if( size > s_maxCacheSize && fi.absoluteFilePath() != keep )
+                QFile::remove( fi.absoluteFilePath() );
+        }
+    }
+
+
+    /**
+     * Computes the peaks of one source. Once canceled the thread is detached
+     * from the generator and deletes itself and its decoder when done.
+     */
+    class GeneratorThread : public QThread
+    {
+    public:
+        GeneratorThread( K3b::AudioPeaksGenerator* generator,
+                         const QString& filename,
+                         K3b::AudioDecoder* decoder )
+            : m_generator( generator ),
+              m_filename( filename ),
+              m_cacheFile( cacheFileName( filename ) ),
+              m_decoder( decoder ),
+              m_success( false ),
+              m_lastPercent( -1 ) {
+            if( m_decoder )
+                m_decoder->moveToThread( this );
+        }
+
+        ~GeneratorThread() {
+            delete m_decoder;
+        }
+
+        /**
+         * Makes the thread stop as soon as possible and not report to the
+         * generator anymore.
+         */
+        void detach() {
+            m_canceled.store( 1 );
+            QMutexLocker locker( &m_mutex );
+            m_generator = 0;
+        }
+
+        // only valid once the thread has finished
+        bool success() const { return m_success; }
+        K3b::AudioPeaks peaks() const { return m_peaks; }
+
+    protected:
+        void run();
+
+    private:
+        bool decode();
+        bool readRawFile();
+        void emitPercent( qint64 done, qint64 total );
+
+        QMutex m_mutex;
+        K3b::AudioPeaksGenerator* m_generator;
+
+        QString m_filename;
+        QString m_cacheFile;
+        K3b::AudioDecoder* m_decoder;
+        QAtomicInt m_canceled;
+
+        K3b::AudioPeaks m_peaks;
+        bool m_success;
+        int m_lastPercent;
+    };
+
+
+    void GeneratorThread::run()
+    {
+        if( !m_cacheFile.isEmpty() && m_peaks.load( m_cacheFile ) ) {
+            qDebug() << "(K3b::AudioPeaksGenerator) using cached peaks for" << m_filename;
+            m_success = true;
+        }
+        else {
+            m_success = ( m_decoder ? decode() : readRawFile() );
+            if( m_success && !m_cacheFile.isEmpty() && QDir().mkpath( K3b::AudioPeaksGenerator::cacheDir() ) ) {
+                m_peaks.save( m_cacheFile );
+                trimCache( m_cacheFile );
+            }
+        }
+
+        delete m_decoder;
+        m_decoder = 0;
+    }
+
+
+    bool GeneratorThread::decode()
+    {
+        m_decoder->setFilename( m_filename );
+
+        // this also initializes the decoder
+        if( !m_decoder->analyseFile() ) {
+            qDebug() << "(K3b::AudioPeaksGenerator) could not analyse" << m_filename;
+            return false;
+        }
+
+        const qint64 total = m_decoder->length().audioBytes();
+        qint64 done = 0;
+        QByteArray buffer( s_bufferSize, 0 );
+        while( !m_canceled.load() ) {
+            const int len = m_decoder->decode( buffer.data(), buffer.size() );
+            if( len < 0 ) {
+                qDebug() << "(K3b::AudioPeaksGenerator) decoding failed for" << m_filename;
+                m_decoder->cleanup();
+                return false;
+            }
+            else if( len == 0 ) {
+                break;
+            }
+
+            m_peaks.append( buffer.constData(), len );
+            done += len;
+            emitPercent( done, total );
+        }
+        m_decoder->cleanup();
+
+        if( m_canceled.load() )
+            return false;
+
+        m_peaks.finish();
+        return true;
+    }
+
+
+    bool GeneratorThread::readRawFile()
+    {
+        QFile f( m_filename );
+        if( !f.open( QIODevice::ReadOnly ) ) {
+            qDebug() << "(K3b::AudioPeaksGenerator) could not open" << m_filename;
+            return false;
+        }
+
+        const qint64 total = f.size();
+        qint64 done = 0;
+        QByteArray buffer( s_bufferSize, 0 );
+        while( !m_canceled.load() ) {
+            const qint64 len = f.read( buffer.data(), buffer.size() );
+            if( len < 0 )
+                return false;
+            else if( len == 0 )
+                break;
+
+            m_peaks.append( buffer.constData(), len );
+            done += len;
+            emitPercent( done, total );
+        }
+
+        if( m_canceled.load() )
+            return false;
+
+        m_peaks.finish();
+        return true;
+    }
+
+
+    void GeneratorThread::emitPercent( qint64 done, qint64 total )
+    {
+        if( total <= 0 )
+            return;
+
+        const int p = int( qMin<qint64>( 100*done/total, 100 ) );
+        if( p != m_lastPercent ) {
+            m_lastPercent = p;
+
+            // the generator may be deleted once we are detached
+            QMutexLocker locker( &m_mutex );
+            if( m_generator )
+                emit m_generator->percent( p );
+        }
+    }
+}
+
+
+class K3b::AudioPeaksGenerator::Private
+{
+public:
+    Private( AudioPeaksGenerator* parent )
+        : q( parent ),
+          thread( 0 ) {
+    }
+
+    void slotThreadFinished();
+
+    AudioPeaksGenerator* q;
+    GeneratorThread* thread;
+
+    AudioPeaks peaks;
+};
+
+
+void K3b::AudioPeaksGenerator::Private::slotThreadFinished()
+{
+    // ignore runs which have been canceled or replaced in the meantime
+    GeneratorThread* finishedThread = static_cast<GeneratorThread*>( q->sender() );
+    if( !thread || finishedThread != thread || !thread->isFinished() )
+        return;
+
+    thread = 0;
+    const bool success = finishedThread->success();
+    if( success )
+        peaks = finishedThread->peaks();
+    finishedThread->deleteLater();
+
+    emit q->finished( success );
+}
+
+
+K3b::AudioPeaksGenerator::AudioPeaksGenerator( QObject* parent )
+    : QObject( parent ),
+      d( new Private( this ) )
+{
+}
+
+
+K3b::AudioPeaksGenerator::~AudioPeaksGenerator()
+{
+    cancel();
+    delete d;
+}
+
+
+bool K3b::AudioPeaksGenerator::start( AudioDataSource* source )
+{
+    cancel();
+
+    AudioDecoder* decoder = 0;
+    QString filename;
+    if( AudioFile* file = dynamic_cast<AudioFile*>( source ) ) {
+        // the decoder of the file is shared with the project, thus we use our own
+        filename = file->filename();
+        decoder = AudioDecoderFactory::createDecoder( QUrl::fromLocalFile( filename ) );
+        if( !decoder )
+            return false;
+    }
+    else if( RawAudioDataSource* raw = dynamic_cast<RawAudioDataSource*>( source ) ) {
+        filename = raw->path();
+    }
+    else {
+        return false;
+    }
+
+    d->thread = new GeneratorThread( this, filename, decoder );
+    connect( d->thread, SIGNAL(finished()), this, SLOT(slotThreadFinished()) );
+    d->thread->start( QThread::LowPriority );
+
+    return true;
+}
+
+
+void K3b::AudioPeaksGenerator::cancel()
+{
+    if( !d->thread )
+        return;
+
+    GeneratorThread* thread = d->thread;
+    d->thread = 0;
+    thread->detach();
+    disconnect( thread, 0, this, 0 );
+
+    // the thread may have finished before we connected
+    connect( thread, SIGNAL(finished()), thread, SLOT(deleteLater()) );
+    if( thread->isFinished() )
+        thread->deleteLater();
+}
+
+
+bool K3b::AudioPeaksGenerator::isRunning() const
+{
+    return d->thread && d->thread->isRunning();
+}
+
+
+K3b::AudioPeaks K3b::AudioPeaksGenerator::peaks() const
+{
+    return d->peaks;
+}
+
+
+QString K3b::AudioPeaksGenerator::cacheDir()
+{
+    return QStandardPaths::writableLocation( QStandardPaths::CacheLocation ) + QLatin1String( "/audiopeaks" );
+}
+
+#include "moc_k3baudiopeaksgenerator.cpp"
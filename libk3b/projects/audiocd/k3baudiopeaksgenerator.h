@@ -0,0 +1,93 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef _K3B_AUDIO_PEAKS_GENERATOR_H_
+#define _K3B_AUDIO_PEAKS_GENERATOR_H_
+
+#include "k3b_export.h"
+#include "k3baudiopeaks.h"
+
+#include <QObject>
+
+
+namespace K3b {
+    class AudioDataSource;
+
+    /**
+     * Creates the AudioPeaks of an audio source in a background thread.
+     *
+     * The peaks always cover the complete source, ignoring its offsets. They
+     * are cached in the user's cache directory, keyed by the path, size, and
+     * modification time of the file, so opening the same source again does
+     * not need to decode it.
+     *
+     * Only sources backed by a local file (AudioFile and RawAudioDataSource)
+     * are supported. Reading audio CD tracks is far too expensive for a
+     * preview.
+     */
+    class LIBK3B_EXPORT AudioPeaksGenerator : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        explicit AudioPeaksGenerator( QObject* parent = 0 );
+
+        /**
+         * Cancels a running computation without waiting for it.
+         */
+        ~AudioPeaksGenerator();
+
+        /**
+         * Starts creating the peaks of \p source. A running computation is
+         * canceled first. Needs to be called from the GUI thread. The source
+         * is not used once this method returns.
+         *
+         * \return false if the source is not supported. In that case
+         * finished() is not emitted.
+         */
+        bool start( AudioDataSource* source );
+
+        /**
+         * Stops the computation as soon as possible. Does not block: the
+         * thread is left to finish in the background and cleans up after
+         * itself. finished() is not emitted.
+         */
+        void cancel();
+
+        bool isRunning() const;
+
+        /**
+         * \return The peaks of the last successful computation.
+         */
+        AudioPeaks peaks() const;
+
+        /**
+         * The directory the peaks are cached in. The oldest peaks are removed
+         * once the cache exceeds 100 MB.
+         */
+        static QString cacheDir();
+
+    Q_SIGNALS:
+        void percent( int );
+        void finished( bool success );
+
+    private:
+        class Private;
+        Private* const d;
+
+        Q_PRIVATE_SLOT( d, void slotThreadFinished() )
+    };
+}
+
+#endif
@@ -15,9 +15,11 @@
 
 
 #include "k3bdatadoc.h"
+#include "k3bdatadocwatcher.h"
 #include "k3bfileitem.h"
 #include "k3bdataitem.h"
 #include "k3bdiritem.h"
+#include "k3bdataitemiterator.h"
 #include "k3bsessionimportitem.h"
 #include "k3bdatajob.h"
 #include "k3bbootitem.h"
@@ -45,10 +47,20 @@
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QHash>
+#include <QMimeType>
+#include <QSet>
 #include <QStringList>
 #include <QTimer>
 #include <QApplication>
+#include <QAtomicInt>
 #include <QDomElement>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <functional>
 
 #include <string.h>
 #include <stdlib.h>
@@ -66,9 +78,11 @@ public:
         verifyData( false ),
         importedSession( -1 ),
         bootCataloge( 0 ),
+        watcher( 0 ),
         bExistingItemsReplaceAll( false ),
         bExistingItemsIgnoreAll( false ),
-        needToCutFilenames( false )
+        needToCutFilenames( false ),
+        filenamesPrepared( false )
     {
         sizeHandler = new K3b::FileCompilationSizeHandler();
     }
@@ -104,14 +118,69 @@ public:
     DataItem* bootCataloge;
     QList<BootItem*> bootImages;
 
+    DataDocWatcher* watcher;
+
+    // the local folders and mimetypes of the files, see sharedLocalFolder()
+    QSet<QString> localFolders;
+    QHash<QString, QMimeType> mimeTypes;
+
     bool bExistingItemsReplaceAll;
     bool bExistingItemsIgnoreAll;
 
     bool needToCutFilenames;
     QList<DataItem*> needToCutFilenameItems;
+
+    // the options used for the last prepareFilenames() call
+    bool filenamesPrepared;
+    IsoOptions filenameOptions;
 };
 
 
+namespace {
+    // below this number of items the thread overhead is not worth it
+    const int s_minParallelFilenameItems = 4096;
+
+    bool filenameOptionsDiffer( const K3b::IsoOptions& o1, const K3b::IsoOptions& o2 )
+    {
+        return( o1.createJoliet() != o2.createJoliet() ||
+                o1.jolietLong() != o2.jolietLong() ||
+                o1.createRockRidge() != o2.createRockRidge() ||
+                o1.whiteSpaceTreatment() != o2.whiteSpaceTreatment() ||
+                o1.whiteSpaceTreatmentReplaceString() != o2.whiteSpaceTreatmentReplaceString() );
+    }
+
+    bool writtenNameLessThan( const K3b::DataItem* item1, const K3b::DataItem* item2 )
+    {
+        return item1->writtenName() < item2->writtenName();
+    }
+
+    class FilenameWorker : public QRunnable
+    {
+    public:
+        FilenameWorker( const QVector<K3b::DirItem*>& dirs, QAtomicInt& next,
+                        const std::function<void(K3b::DirItem*)>& f )
+            : m_dirs( dirs ),
+              m_next( next ),
+              m_f( f ) {
+        }
+
+        void run() {
+            forever {
+                const int i = m_next.fetchAndAddOrdered( 1 );
+                if( i >= m_dirs.count() )
+                    return;
+                m_f( m_dirs.at( i ) );
+            }
+        }
+
+    private:
+        const QVector<K3b::DirItem*>& m_dirs;
+        QAtomicInt& m_next;
+        const std::function<void(K3b::DirItem*)>& m_f;
+    };
+}
+
+
 /**
  * There are two ways to fill a data project with files and folders:
  * \li Use the addUrl and addUrlsT methods
@@ -122,11 +191,14 @@ K3b::DataDoc::DataDoc( QObject* parent )
     : K3b::Doc( parent ),
       d( new Private )
 {
+    d->watcher = new DataDocWatcher( this );
 }
 
 
 K3b::DataDoc::~DataDoc()
 {
+    // the watcher must not see the items being deleted
+    delete d->watcher;
     delete d;
 }
 
@@ -159,6 +231,8 @@ void K3b::DataDoc::clear()
             removeItem( d->root->children().first() );
     }
     d->sizeHandler->clear();
+    d->localFolders.clear();
+    d->mimeTypes.clear();
     emit importedSessionChanged( importedSession() );
 }
 
@@ -476,6 +550,9 @@ bool K3b::DataDoc::loadDocumentDataOptions( QDomElement elem )
         else if( e.nodeName() == "do_not_cache_inodes" )
             d->isoOptions.setDoNotCacheInodes( e.attributeNode( "activated" ).value() == "yes" );
 
+        else if( e.nodeName() == "share_identical_files" )
+            d->isoOptions.setShareIdenticalFiles( e.attributeNode( "activated" ).value() == "yes" );
+
         else if( e.nodeName() == "whitespace_treatment" ) {
             if( e.text() == "strip" )
                 d->isoOptions.setWhiteSpaceTreatment( K3b::IsoOptions::strip );
@@ -786,6 +863,10 @@ void K3b::DataDoc::saveDocumentDataOptions( QDomElement& optionsElem )
     topElem.setAttribute( "activated", isoOptions().doNotCacheInodes() ? "yes" : "no" );
     optionsElem.appendChild( topElem );
 
+    topElem = doc.createElement( "share_identical_files" );
+    topElem.setAttribute( "activated", isoOptions().shareIdenticalFiles() ? "yes" : "no" );
+    optionsElem.appendChild( topElem );
+
 
     topElem = doc.createElement( "whitespace_treatment" );
     switch( isoOptions().whiteSpaceTreatment() ) {
@@ -1090,7 +1171,6 @@ QString K3b::DataDoc::treatWhitespace( const QString& path )
             }
         }
 
-        qDebug() << "(K3b::DataDoc) converted " << path << " to " << result;
         return result;
     }
     else
@@ -1100,9 +1180,6 @@ QString K3b::DataDoc::treatWhitespace( const QString& path )
 
 void K3b::DataDoc::prepareFilenames()
 {
-    d->needToCutFilenames = false;
-    d->needToCutFilenameItems.clear();
-
     //
     // if joliet is used cut the names and rename if necessary
     // 64 characters for standard joliet and 103 characters for long joliet names
@@ -1111,25 +1188,61 @@ void K3b::DataDoc::prepareFilenames()
     // it to mkisofs for now since handling all the options to alter the ISO9660 standard it just
     // too much.
     //
-
-    K3b::DataItem* item = root();
-    int maxlen = ( isoOptions().jolietLong() ? 103 : 64 );
-    while( (item = item->nextSibling()) ) {
-        item->setWrittenName( treatWhitespace( item->k3bName() ) );
-
-        if( isoOptions().createJoliet() && item->writtenName().length() > maxlen ) {
-            d->needToCutFilenames = true;
-            item->setWrittenName( K3b::cutFilename( item->writtenName(), maxlen ) );
-            d->needToCutFilenameItems.append( item );
+    // The names only depend on the siblings. Thus, only directories which changed since
+    // the last call need to be handled unless the relevant options changed.
+    //
+    const bool all = ( !d->filenamesPrepared || filenameOptionsDiffer( d->filenameOptions, isoOptions() ) );
+    d->filenamesPrepared = true;
+    d->filenameOptions = isoOptions();
+
+    QVector<K3b::DirItem*> dirs;
+    int items = 0;
+    QVector<K3b::DirItem*> stack;
+    stack.append( root() );
+    while( !stack.isEmpty() ) {
+        K3b::DirItem* dir = stack.takeLast();
+        if( !all && !dir->subtreeNamesDirty() )
+            continue;
+
+        if( all || dir->namesDirty() ) {
+            dirs.append( dir );
+            items += dir->children().count();
         }
+        dir->setNamesPrepared();
 
-        // TODO: check the Joliet charset
+        for( K3b::DirItem::Children::const_iterator it = dir->children().constBegin();
+             it != dir->children().constEnd(); ++it ) {
+            if( (*it)->isDir() )
+                stack.append( static_cast<K3b::DirItem*>( *it ) );
+        }
     }
 
     //
-    // 3. check if a directory contains items with the same name
+    // The directories are independent of each other
     //
-    prepareFilenamesInDir( root() );
+    const int threads = qMin( QThread::idealThreadCount(), dirs.count() );
+    if( threads > 1 && items >= s_minParallelFilenameItems ) {
+        QThreadPool pool;
+        pool.setMaxThreadCount( threads );
+        QAtomicInt next( 0 );
+        const std::function<void(K3b::DirItem*)> f = [this]( K3b::DirItem* dir ) { prepareFilenamesInDir( dir ); };
+        for( int i = 0; i < threads; ++i )
+            pool.start( new FilenameWorker( dirs, next, f ) );
+        pool.waitForDone();
+    }
+    else {
+        for( QVector<K3b::DirItem*>::const_iterator it = dirs.constBegin(); it != dirs.constEnd(); ++it )
+            prepareFilenamesInDir( *it );
+    }
+
+    d->needToCutFilenameItems.clear();
+    if( isoOptions().createJoliet() ) {
+        for( K3b::DataItemIterator it( root(), false ); *it; ++it ) {
+            if( (*it)->writtenNameCut() )
+                d->needToCutFilenameItems.append( *it );
+        }
+    }
+    d->needToCutFilenames = !d->needToCutFilenameItems.isEmpty();
 }
 
 
@@ -1138,50 +1251,53 @@ void K3b::DataDoc::prepareFilenamesInDir( K3b::DirItem* dir )
     if( !dir )
         return;
 
-    QList<K3b::DataItem*> sortedChildren;
-    QList<K3b::DataItem*> children( dir->children() );
-    QList<K3b::DataItem*>::const_iterator it = children.constEnd();
-    while ( it != children.constBegin() ) {
-        --it;
+    const int maxlen = ( isoOptions().jolietLong() ? 103 : 64 );
+
+    QVector<K3b::DataItem*> sortedChildren;
+    sortedChildren.reserve( dir->children().count() );
+    for( K3b::DirItem::Children::const_iterator it = dir->children().constBegin();
+         it != dir->children().constEnd(); ++it ) {
         K3b::DataItem* item = *it;
+        item->setWrittenName( treatWhitespace( item->k3bName() ) );
 
-        if( item->isDir() )
-            prepareFilenamesInDir( dynamic_cast<K3b::DirItem*>( item ) );
+        const bool cut = ( isoOptions().createJoliet() && item->writtenName().length() > maxlen );
+        if( cut )
+            item->setWrittenName( K3b::cutFilename( item->writtenName(), maxlen ) );
+        item->setWrittenNameCut( cut );
 
-        // insertion sort
-        int i = 0;
-        while( i < sortedChildren.count() && item->writtenName() > sortedChildren.at(i)->writtenName() )
-            ++i;
+        // TODO: check the Joliet charset
 
-        sortedChildren.insert( i, item );
+        sortedChildren.append( item );
     }
 
+    //
+    // check if the directory contains items with the same name
+    //
     if( isoOptions().createJoliet() || isoOptions().createRockRidge() ) {
-        QList<K3b::DataItem*> sameNameList;
-        while( !sortedChildren.isEmpty() ) {
+        // a stable sort keeps the numbering in the order of the children
+        std::stable_sort( sortedChildren.begin(), sortedChildren.end(), writtenNameLessThan );
 
-            sameNameList.clear();
+        unsigned int maxNumberedLen = 255;
+        if( isoOptions().createJoliet() )
+            maxNumberedLen = maxlen;
 
-            do {
-                sameNameList.append( sortedChildren.takeFirst() );
-            } while( !sortedChildren.isEmpty() &&
-                     sortedChildren.first()->writtenName() == sameNameList.first()->writtenName() );
+        int i = 0;
+        while( i < sortedChildren.count() ) {
+            int j = i + 1;
+            while( j < sortedChildren.count() &&
+                   sortedChildren.at( j )->writtenName() == sortedChildren.at( i )->writtenName() )
+                ++j;
 
-            if( sameNameList.count() > 1 ) {
+            if( j - i > 1 ) {
                 // now we need to rename the items
-                unsigned int maxlen = 255;
-                if( isoOptions().createJoliet() ) {
-                    if( isoOptions().jolietLong() )
-                        maxlen = 103;
-                    else
-                        maxlen = 64;
-                }
-
                 int cnt = 1;
-                Q_FOREACH( K3b::DataItem* item, sameNameList ) {
-                    item->setWrittenName( K3b::appendNumberToFilename( item->writtenName(), cnt++, maxlen ) );
+                for( int k = i; k < j; ++k ) {
+                    K3b::DataItem* item = sortedChildren.at( k );
+                    item->setWrittenName( K3b::appendNumberToFilename( item->writtenName(), cnt++, maxNumberedLen ) );
                 }
             }
+
+            i = j;
         }
     }
 }
@@ -1199,6 +1315,51 @@ QList<K3b::DataItem*> K3b::DataDoc::needToCutFilenameItems() const
 }
 
 
+void K3b::DataDoc::refreshFileItem( FileItem* item )
+{
+    DirItem* parent = item->parent();
+    const bool countSize = !item->isFromOldSession();
+
+    if( parent )
+        parent->updateSize( item, true );
+    if( countSize )
+        d->sizeHandler->removeFile( item );
+
+    item->refreshLocalInfo();
+
+    if( parent )
+        parent->updateSize( item, false );
+    if( countSize )
+        d->sizeHandler->addFile( item );
+
+    emit changed();
+}
+
+
+QString K3b::DataDoc::sharedLocalFolder( const QString& folder )
+{
+    QSet<QString>::const_iterator it = d->localFolders.constFind( folder );
+    if( it == d->localFolders.constEnd() )
+        it = d->localFolders.insert( folder );
+    return *it;
+}
+
+
+QMimeType K3b::DataDoc::sharedMimeType( const QMimeType& mimeType )
+{
+    QHash<QString, QMimeType>::const_iterator it = d->mimeTypes.constFind( mimeType.name() );
+    if( it == d->mimeTypes.constEnd() )
+        it = d->mimeTypes.insert( mimeType.name(), mimeType );
+    return *it;
+}
+
+
+K3b::DataDocWatcher* K3b::DataDoc::watcher() const
+{
+    return d->watcher;
+}
+
+
 void K3b::DataDoc::informAboutNotFoundFiles()
 {
     if( !d->notFoundFiles.isEmpty() ) {
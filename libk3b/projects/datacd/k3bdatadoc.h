@@ -26,11 +26,14 @@
 class QString;
 class QDomDocument;
 class QDomElement;
+class QMimeType;
 
 namespace K3b {
     class DataItem;
+    class DataDocWatcher;
     class RootItem;
     class DirItem;
+    class FileItem;
     class Job;
     class BootItem;
     class Iso9660Directory;
@@ -164,6 +167,10 @@ namespace K3b {
         /**
          * This will prepare the filenames as written to the image.
          * These filenames are saved in DataItem::writtenName
+         *
+         * Only directories which changed since the last call are handled
+         * (see DirItem::setNamesDirty()) unless the relevant iso options
+         * changed. Large sets of directories are handled in parallel.
          */
         void prepareFilenames();
 
@@ -176,6 +183,19 @@ namespace K3b {
 
         QList<DataItem*> needToCutFilenameItems() const;
 
+        /**
+         * Reads the size and id of the local file of \p item again and
+         * corrects the project size accordingly. Used if the file changed
+         * on disk after it has been added to the project.
+         */
+        void refreshFileItem( FileItem* item );
+
+        /**
+         * The watcher which keeps the project in sync with changes of the
+         * local files.
+         */
+        DataDocWatcher* watcher() const;
+
         /**
          * Imports a session into the project. This will create SessionImportItems
          * and properly set the imported session size.
@@ -266,11 +286,24 @@ namespace K3b {
 
         void informAboutNotFoundFiles();
 
+        /**
+         * used by FileItem to share the local folder of its path with the
+         * other files of the folder.
+         */
+        QString sharedLocalFolder( const QString& folder );
+
+        /**
+         * used by FileItem to share the mimetype with the other files of
+         * the same type.
+         */
+        QMimeType sharedMimeType( const QMimeType& mimeType );
+
         class Private;
         Private* d;
 
         friend class MixedDoc;
         friend class DirItem;
+        friend class FileItem;
     };
 }
 
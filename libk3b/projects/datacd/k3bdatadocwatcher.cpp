@@ -0,0 +1,498 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include <config-k3b.h>
+
+#include "k3bdatadocwatcher.h"
+#include "k3bdatadoc.h"
+#include "k3bdataitemiterator.h"
+#include "k3bdiritem.h"
+#include "k3bfileitem.h"
+#include "k3bglobals.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QHash>
+#include <QSet>
+#include <QSocketNotifier>
+#include <QTimer>
+
+#include <errno.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef HAVE_SYS_INOTIFY_H
+#include <sys/inotify.h>
+#endif
+
+
+namespace {
+    const int s_defaultDelay = 500;
+
+    // the folders of the files which cannot be watched are tried again after this
+    const int s_retryInterval = 2000;
+
+#ifdef HAVE_SYS_INOTIFY_H
+    const uint32_t s_watchMask = IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB |
+                                 IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                                 IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+#endif
+
+    bool splitPath( const QByteArray& path, QByteArray& folder, QByteArray& name )
+    {
+        const int slash = path.lastIndexOf( '/' );
+        if( slash < 0 || slash == path.length()-1 )
+            return false;
+
+        folder = ( slash > 0 ? path.left( slash ) : QByteArray( "/" ) );
+        name = path.mid( slash+1 );
+        return true;
+    }
+
+    bool localInfoChanged( const k3b_struct_stat& st, const K3b::FileItem* item )
+    {
+        const K3b::FileItem::Id id = item->localId( false );
+        return( !( id.device == st.st_dev ) ||
+                !( id.inode == st.st_ino ) ||
+                item->localModificationTime( false ) != st.st_mtime ||
+                item->itemSize( false ) != KIO::filesize_t( st.st_size ) );
+    }
+}
+
+
+class K3b::DataDocWatcher::Private
+{
+public:
+    struct Folder {
+        QByteArray path;
+        // the files of the project by their name in the folder
+        QHash<QByteArray, QList<FileItem*> > files;
+    };
+
+    Private()
+        : doc( 0 ),
+          fd( -1 ),
+          notifier( 0 ),
+          overflow( false ) {
+    }
+
+    void addDataItem( DataItem* item );
+    void removeDataItem( DataItem* item );
+    void addFile( FileItem* item );
+    void removeFile( FileItem* item );
+    void removeFolder( int wd );
+    void readEvents();
+    void retryUnwatched();
+    bool hasWork() const;
+
+    DataDoc* doc;
+    int fd;
+    QSocketNotifier* notifier;
+    QTimer timer;
+    QTimer retryTimer;
+
+    // by watch descriptor
+    QHash<int, Folder> folders;
+    QHash<QByteArray, int> watches;
+    QHash<FileItem*, int> items;
+
+    // the names which saw events, by watch descriptor
+    QHash<int, QSet<QByteArray> > pending;
+    // folders whose watch has been removed by the kernel
+    QSet<int> deadFolders;
+    bool overflow;
+
+    // the files whose folder could not be watched, eg. since it has been deleted
+    QSet<FileItem*> unwatched;
+
+    QSet<FileItem*> missing;
+
+    // the objects which suspended the watcher
+    QSet<QObject*> holders;
+};
+
+
+void K3b::DataDocWatcher::Private::addDataItem( DataItem* item )
+{
+    for( DataItemIterator it( item ); *it; ++it ) {
+        if( ( *it )->isFile() && !( *it )->isFromOldSession() )
+            addFile( static_cast<FileItem*>( *it ) );
+    }
+}
+
+
+void K3b::DataDocWatcher::Private::removeDataItem( DataItem* item )
+{
+    for( DataItemIterator it( item ); *it; ++it ) {
+        if( ( *it )->isFile() )
+            removeFile( static_cast<FileItem*>( *it ) );
+    }
+}
+
+
+void K3b::DataDocWatcher::Private::addFile( FileItem* item )
+{
+#ifdef HAVE_SYS_INOTIFY_H
+    QByteArray folderPath, name;
+    if( fd < 0 || items.contains( item ) || !splitPath( QFile::encodeName( item->localPath() ), folderPath, name ) )
+        return;
+
+    int wd = watches.value( folderPath, -1 );
+    if( wd < 0 ) {
+        wd = ::inotify_add_watch( fd, folderPath.constData(), s_watchMask );
+        if( wd < 0 ) {
+            // the folder is gone or the watch limit has been reached
+            qDebug() << "(K3b::DataDocWatcher) unable to watch" << folderPath << ::strerror( errno );
+            unwatched.insert( item );
+            return;
+        }
+
+        // the same folder reached through a symlink shares the descriptor
+        if( !folders.contains( wd ) ) {
+            Folder& folder = folders[wd];
+            folder.path = folderPath;
+        }
+        watches.insert( folderPath, wd );
+    }
+
+    folders[wd].files[name].append( item );
+    items.insert( item, wd );
+    unwatched.remove( item );
+#else
+    Q_UNUSED( item );
+#endif
+}
+
+
+void K3b::DataDocWatcher::Private::removeFile( FileItem* item )
+{
+    missing.remove( item );
+    unwatched.remove( item );
+
+    QHash<FileItem*, int>::iterator it = items.find( item );
+    if( it == items.end() )
+        return;
+
+    const int wd = it.value();
+    items.erase( it );
+
+    QByteArray folderPath, name;
+    splitPath( QFile::encodeName( item->localPath() ), folderPath, name );
+
+    Folder& folder = folders[wd];
+    QHash<QByteArray, QList<FileItem*> >::iterator fileIt = folder.files.find( name );
+    if( fileIt != folder.files.end() ) {
+        fileIt->removeOne( item );
+        if( fileIt->isEmpty() )
+            folder.files.erase( fileIt );
+    }
+
+    if( folder.files.isEmpty() ) {
+#ifdef HAVE_SYS_INOTIFY_H
+        if( !deadFolders.contains( wd ) )
+            ::inotify_rm_watch( fd, wd );
+#endif
+        removeFolder( wd );
+    }
+}
+
+
+void K3b::DataDocWatcher::Private::removeFolder( int wd )
+{
+    Q_FOREACH( const QList<FileItem*>& files, folders.value( wd ).files ) {
+        Q_FOREACH( FileItem* item, files )
+            items.remove( item );
+    }
+
+    folders.remove( wd );
+    pending.remove( wd );
+    deadFolders.remove( wd );
+
+    QHash<QByteArray, int>::iterator it = watches.begin();
+    while( it != watches.end() ) {
+        if( it.value() == wd )
+            it = watches.erase( it );
+        else
+            ++it;
+    }
+}
+
+
+void K3b::DataDocWatcher::Private::readEvents()
+{
+#ifdef HAVE_SYS_INOTIFY_H
+    char buffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+
+    forever {
+        const ssize_t len = ::read( fd, buffer, sizeof(buffer) );
+        if( len <= 0 )
+            break;
+
+        for( char* p = buffer; p < buffer + len; ) {
+            const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>( p );
+            p += sizeof(struct inotify_event) + event->len;
+
+            // events got lost, thus everything needs to be checked
+            if( event->mask & IN_Q_OVERFLOW ) {
+                overflow = true;
+                continue;
+            }
+
+            QHash<int, Folder>::const_iterator folder = folders.constFind( event->wd );
+            if( folder == folders.constEnd() )
+                continue;
+
+            if( event->mask & ( IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED ) ) {
+                QSet<QByteArray>& names = pending[event->wd];
+                Q_FOREACH( const QByteArray& name, folder->files.keys() )
+                    names.insert( name );
+                if( event->mask & IN_IGNORED )
+                    deadFolders.insert( event->wd );
+            }
+            else if( event->len > 0 ) {
+                const QByteArray name( event->name );
+                if( folder->files.contains( name ) )
+                    pending[event->wd].insert( name );
+            }
+        }
+    }
+
+    // Do not restart a running timer, otherwise a constant stream of events
+    // would delay the update forever.
+    if( holders.isEmpty() && hasWork() && !timer.isActive() )
+        timer.start();
+#endif
+}
+
+
+void K3b::DataDocWatcher::Private::retryUnwatched()
+{
+    Q_FOREACH( FileItem* item, unwatched ) {
+        addFile( item );
+
+        // the file might have changed while its folder was not watched
+        QHash<FileItem*, int>::const_iterator it = items.constFind( item );
+        if( it != items.constEnd() ) {
+            QByteArray folderPath, name;
+            splitPath( QFile::encodeName( item->localPath() ), folderPath, name );
+            pending[it.value()].insert( name );
+        }
+    }
+}
+
+
+bool K3b::DataDocWatcher::Private::hasWork() const
+{
+    return( overflow || !pending.isEmpty() || !deadFolders.isEmpty() );
+}
+
+
+K3b::DataDocWatcher::DataDocWatcher( DataDoc* doc )
+    : QObject( doc ),
+      d( new Private )
+{
+    d->doc = doc;
+
+    d->timer.setSingleShot( true );
+    d->timer.setInterval( s_defaultDelay );
+    connect( &d->timer, SIGNAL(timeout()), this, SLOT(flush()) );
+
+    d->retryTimer.setSingleShot( true );
+    d->retryTimer.setInterval( s_retryInterval );
+    connect( &d->retryTimer, SIGNAL(timeout()), this, SLOT(flush()) );
+
+#ifdef HAVE_SYS_INOTIFY_H
+    d->fd = ::inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+    if( d->fd < 0 ) {
+        qDebug() << "(K3b::DataDocWatcher) inotify_init1 failed:" << ::strerror( errno );
+        return;
+    }
+
+    d->notifier = new QSocketNotifier( d->fd, QSocketNotifier::Read, this );
+    connect( d->notifier, SIGNAL(activated(int)), this, SLOT(slotReadEvents()) );
+
+    connect( doc, SIGNAL(itemsInserted(K3b::DirItem*,int,int)),
+             this, SLOT(slotItemsInserted(K3b::DirItem*,int,int)), Qt::DirectConnection );
+    connect( doc, SIGNAL(itemsAboutToBeRemoved(K3b::DirItem*,int,int)),
+             this, SLOT(slotItemsAboutToBeRemoved(K3b::DirItem*,int,int)), Qt::DirectConnection );
+
+    if( doc->root() )
+        d->addDataItem( doc->root() );
+#endif
+}
+
+
+K3b::DataDocWatcher::~DataDocWatcher()
+{
+    delete d->notifier;
+    if( d->fd >= 0 )
+        ::close( d->fd );
+    delete d;
+}
+
+
+bool K3b::DataDocWatcher::isActive() const
+{
+    return d->fd >= 0;
+}
+
+
+bool K3b::DataDocWatcher::isMissing( FileItem* item ) const
+{
+    return d->missing.contains( item );
+}
+
+
+QList<K3b::FileItem*> K3b::DataDocWatcher::missingItems() const
+{
+    return d->missing.toList();
+}
+
+
+void K3b::DataDocWatcher::setDelay( int msecs )
+{
+    d->timer.setInterval( msecs );
+}
+
+
+void K3b::DataDocWatcher::suspend( QObject* holder )
+{
+    if( d->holders.contains( holder ) )
+        return;
+
+    d->holders.insert( holder );
+    connect( holder, SIGNAL(destroyed(QObject*)), this, SLOT(slotHolderDestroyed(QObject*)) );
+    d->timer.stop();
+}
+
+
+void K3b::DataDocWatcher::resume( QObject* holder )
+{
+    if( !d->holders.remove( holder ) )
+        return;
+
+    disconnect( holder, SIGNAL(destroyed(QObject*)), this, SLOT(slotHolderDestroyed(QObject*)) );
+
+    // handle the events collected in the meantime
+    if( d->holders.isEmpty() && ( d->hasWork() || !d->unwatched.isEmpty() ) )
+        d->timer.start();
+}
+
+
+bool K3b::DataDocWatcher::isSuspended() const
+{
+    return !d->holders.isEmpty();
+}
+
+
+void K3b::DataDocWatcher::flush()
+{
+    d->timer.stop();
+    d->retryTimer.stop();
+
+    // the items are in use, resume() brings us back
+    if( !d->holders.isEmpty() )
+        return;
+
+    d->retryUnwatched();
+
+    if( d->overflow ) {
+        for( QHash<int, Private::Folder>::const_iterator it = d->folders.constBegin(); it != d->folders.constEnd(); ++it ) {
+            QSet<QByteArray>& names = d->pending[it.key()];
+            Q_FOREACH( const QByteArray& name, it->files.keys() )
+                names.insert( name );
+        }
+        d->overflow = false;
+    }
+
+    QList<FileItem*> changedItems;
+    QList<FileItem*> missingChangedItems;
+    for( QHash<int, QSet<QByteArray> >::const_iterator it = d->pending.constBegin(); it != d->pending.constEnd(); ++it ) {
+        const Private::Folder& folder = d->folders[it.key()];
+        const QByteArray prefix = ( folder.path.endsWith( '/' ) ? folder.path : folder.path + '/' );
+
+        Q_FOREACH( const QByteArray& name, it.value() ) {
+            // one stat per file, no matter how many events it caused
+            k3b_struct_stat st;
+            const bool exists = ( k3b_lstat( QByteArray( prefix + name ).constData(), &st ) == 0 &&
+                                  !S_ISDIR( st.st_mode ) );
+
+            Q_FOREACH( FileItem* item, folder.files.value( name ) ) {
+                if( !exists ) {
+                    if( !d->missing.contains( item ) ) {
+                        d->missing.insert( item );
+                        missingChangedItems.append( item );
+                    }
+                    continue;
+                }
+
+                if( d->missing.remove( item ) )
+                    missingChangedItems.append( item );
+
+                if( localInfoChanged( st, item ) ) {
+                    d->doc->refreshFileItem( item );
+                    changedItems.append( item );
+                }
+            }
+        }
+    }
+    d->pending.clear();
+
+    // the files stay flagged as missing until their folder can be watched again
+    Q_FOREACH( int wd, d->deadFolders ) {
+        Q_FOREACH( const QList<FileItem*>& files, d->folders.value( wd ).files ) {
+            Q_FOREACH( FileItem* item, files )
+                d->unwatched.insert( item );
+        }
+        d->removeFolder( wd );
+    }
+    if( !d->unwatched.isEmpty() )
+        d->retryTimer.start();
+
+    if( !changedItems.isEmpty() )
+        emit itemsChanged( changedItems );
+    if( !missingChangedItems.isEmpty() )
+        emit itemsMissingChanged( missingChangedItems );
+}
+
+
+void K3b::DataDocWatcher::slotItemsInserted( K3b::DirItem* parent, int start, int end )
+{
+    const QList<DataItem*>& children = parent->children();
+    for( int i = start; i <= end && i < children.count(); ++i )
+        d->addDataItem( children.at( i ) );
+}
+
+
+void K3b::DataDocWatcher::slotItemsAboutToBeRemoved( K3b::DirItem* parent, int start, int end )
+{
+    const QList<DataItem*>& children = parent->children();
+    for( int i = start; i <= end && i < children.count(); ++i )
+        d->removeDataItem( children.at( i ) );
+}
+
+
+void K3b::DataDocWatcher::slotReadEvents()
+{
+    d->readEvents();
+}
+
+
+void K3b::DataDocWatcher::slotHolderDestroyed( QObject* holder )
+{
+    resume( holder );
+}
+
+#include "moc_k3bdatadocwatcher.cpp"
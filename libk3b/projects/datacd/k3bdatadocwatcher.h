@@ -0,0 +1,106 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef _K3B_DATA_DOC_WATCHER_H_
+#define _K3B_DATA_DOC_WATCHER_H_
+
+#include "k3b_export.h"
+
+#include <QList>
+#include <QObject>
+
+
+namespace K3b {
+    class DataDoc;
+    class DirItem;
+    class FileItem;
+
+    /**
+     * Watches the local folders of the files in a data project and keeps the
+     * project in sync with them.
+     *
+     * Every local folder which contains files of the project is watched with
+     * inotify. Events are collected for a short while and each changed file is
+     * handled only once, no matter how many events it caused. Files which
+     * changed are refreshed via DataDoc::refreshFileItem(), which corrects the
+     * project size. Deleted files are flagged as missing until they show up
+     * again or are removed from the project.
+     *
+     * While a job reads the project the watcher is suspended. The events are
+     * collected and handled once the job is done.
+     *
+     * Without inotify support the watcher does nothing and changes are found
+     * by the DataPreparationJob before writing.
+     */
+    class LIBK3B_EXPORT DataDocWatcher : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        explicit DataDocWatcher( DataDoc* doc );
+        ~DataDocWatcher();
+
+        /**
+         * \return false if the local folders cannot be watched on this system.
+         */
+        bool isActive() const;
+
+        bool isMissing( FileItem* item ) const;
+        QList<FileItem*> missingItems() const;
+
+        /**
+         * The time events are collected before they are handled. Defaults to
+         * 500 msecs.
+         */
+        void setDelay( int msecs );
+
+        /**
+         * Stops changing the project while \p holder uses it. The jobs writing the
+         * project read the items from their threads. Events are still collected
+         * and handled once the last holder resumed the watcher or has been deleted.
+         */
+        void suspend( QObject* holder );
+        void resume( QObject* holder );
+        bool isSuspended() const;
+
+    public Q_SLOTS:
+        /**
+         * Handles all collected events now.
+         */
+        void flush();
+
+    Q_SIGNALS:
+        /**
+         * Emitted with the files whose size or id changed on disk.
+         */
+        void itemsChanged( const QList<K3b::FileItem*>& items );
+
+        /**
+         * Emitted with the files which have been deleted or showed up again.
+         */
+        void itemsMissingChanged( const QList<K3b::FileItem*>& items );
+
+    private Q_SLOTS:
+        void slotItemsInserted( K3b::DirItem* parent, int start, int end );
+        void slotItemsAboutToBeRemoved( K3b::DirItem* parent, int start, int end );
+        void slotReadEvents();
+        void slotHolderDestroyed( QObject* holder );
+
+    private:
+        class Private;
+        Private* const d;
+    };
+}
+
+#endif
@@ -22,26 +22,19 @@
 #include <math.h>
 
 
-class K3b::DataItem::Private
-{
-public:
-    K3b::DataItem::ItemFlags flags;
-};
-
-
 K3b::DataItem::DataItem( const ItemFlags& flags )
     : m_parentDir(0),
       m_sortWeight(0),
+      m_flags(flags),
       m_bHideOnRockRidge(false),
       m_bHideOnJoliet(false),
       m_bRemoveable(true),
       m_bRenameable(true),
       m_bMovable(true),
       m_bHideable(true),
-      m_bWriteToCd(true)
+      m_bWriteToCd(true),
+      m_bWrittenNameCut(false)
 {
-    d = new Private;
-    d->flags = flags;
 }
 
 
@@ -50,70 +43,69 @@ K3b::DataItem::DataItem( const K3b::DataItem& item )
       m_extraInfo( item.m_extraInfo ),
       m_parentDir( 0 ),
       m_sortWeight( item.m_sortWeight ),
+      m_flags( item.m_flags ),
       m_bHideOnRockRidge( item.m_bHideOnRockRidge ),
       m_bHideOnJoliet( item.m_bHideOnJoliet ),
       m_bRemoveable( item.m_bRemoveable ),
       m_bRenameable( item.m_bRenameable ),
       m_bMovable( item.m_bMovable ),
       m_bHideable( item.m_bHideable ),
-      m_bWriteToCd( item.m_bWriteToCd )
+      m_bWriteToCd( item.m_bWriteToCd ),
+      m_bWrittenNameCut( false )
 {
-    d = new Private;
-    d->flags = item.d->flags;
 }
 
 
 K3b::DataItem::~DataItem()
 {
-    delete d;
 }
 
 
 const K3b::DataItem::ItemFlags& K3b::DataItem::flags() const
 {
-   return d->flags;
+   return m_flags;
 }
 
 
 void K3b::DataItem::setFlags( const ItemFlags& flags )
 {
-    d->flags = flags;
+    m_flags = flags;
 }
 
 
 bool K3b::DataItem::isDir() const
 {
-   return d->flags & DIR;
+   return m_flags & DIR;
 }
 
 
 bool K3b::DataItem::isFile() const
 {
-   return d->flags & FILE;
+   return m_flags & FILE;
 }
 
 
 bool K3b::DataItem::isSpecialFile() const
 {
-   return d->flags & SPECIALFILE;
+   return m_flags & SPECIALFILE;
 }
 
 
 bool K3b::DataItem::isSymLink() const
 {
-   return d->flags & SYMLINK;
+   return m_flags & SYMLINK;
 }
 
 
 bool K3b::DataItem::isFromOldSession() const
 {
-   return d->flags & OLD_SESSION;
+   return m_flags & OLD_SESSION;
 }
 
 
 bool K3b::DataItem::isBootItem() const
 {
-   return d->flags & BOOT_IMAGE;
+   return m_flags & BOOT_IMAGE;
 }
 
 
@@ -163,6 +155,9 @@ void K3b::DataItem::setK3bName( const QString& name ) {
 
         m_k3bName = name;
 
+        if( parent() )
+            parent()->setNamesDirty();
+
         if( DataDoc* doc = getDoc() ) {
             doc->setModified();
         }
@@ -182,6 +177,16 @@ QString K3b::DataItem::k3bName() const
 }
 
 
+void K3b::DataItem::setWrittenName( const QString& s )
+{
+    // most names are written unchanged, there is no need to store them twice
+    if( s == m_k3bName )
+        m_writtenName = m_k3bName;
+    else
+        m_writtenName = s;
+}
+
+
 K3b::DataItem* K3b::DataItem::take()
 {
     if( parent() )
@@ -110,14 +110,34 @@ namespace K3b {
 
         /**
          * Used to set the written name by @p DataDoc::prepareFilenames()
+         *
+         * A name equal to k3bName() shares its data.
          */
-        void setWrittenName( const QString& s ) { m_writtenName = s; }
+        void setWrittenName( const QString& s );
 
         /**
          * Used to set the pure Iso9660 name by @p DataDoc::prepareFilenames()
          */
         void setIso9660Name( const QString& s ) { m_rawIsoName = s; }
 
+        /**
+         * \return true if the written name had to be cut to fit into the
+         * Joliet limits.
+         *
+         * This is only valid after a call to @p DataDoc::prepareFilenames()
+         */
+        bool writtenNameCut() const { return m_bWrittenNameCut; }
+
+        /**
+         * Used to mark a cut written name by @p DataDoc::prepareFilenames()
+         */
+        void setWrittenNameCut( bool b ) { m_bWrittenNameCut = b; }
+
+        /**
+         * The next item in a pre-order traversal of the tree.
+         * Each call has to search the parent directories, use
+         * DataItemIterator to traverse a whole tree.
+         */
         virtual DataItem* nextSibling() const;
 
         /** returns the path to the file on the local filesystem */
@@ -201,9 +221,6 @@ namespace K3b {
         void setParentDir( DirItem* parentDir ) { m_parentDir = parentDir; }
 
     private:
-        class Private;
-        Private* d;
-
         QString m_writtenName;
         QString m_rawIsoName;
         QString m_extraInfo;
@@ -211,14 +228,18 @@ namespace K3b {
         DirItem* m_parentDir;
         long m_sortWeight;
 
-        bool m_bHideOnRockRidge;
-        bool m_bHideOnJoliet;
-        bool m_bRemoveable;
-        bool m_bRenameable;
-        bool m_bMovable;
-        bool m_bHideable;
-        bool m_bWriteToCd;
-        
+        ItemFlags m_flags;
+
+        // packed since there is one item per file of a project
+        bool m_bHideOnRockRidge : 1;
+        bool m_bHideOnJoliet : 1;
+        bool m_bRemoveable : 1;
+        bool m_bRenameable : 1;
+        bool m_bMovable : 1;
+        bool m_bHideable : 1;
+        bool m_bWriteToCd : 1;
+        bool m_bWrittenNameCut : 1;
+
         friend class DirItem;
     };
 }
@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bdataitemiterator.h"
+#include "k3bdataitem.h"
+#include "k3bdiritem.h"
+
+#include <QAtomicInt>
+#include <QList>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+
+namespace {
+    // below this number of items the thread overhead is not worth it
+    const long s_minParallelItems = 4096;
+
+    // single items are handed to the threads in chunks of this size
+    const int s_chunkSize = 1024;
+
+    struct WorkItem {
+        // either a range of items which are visited without their children...
+        QList<K3b::DataItem*>::const_iterator begin;
+        QList<K3b::DataItem*>::const_iterator end;
+        // ...or a complete subtree
+        K3b::DirItem* subtree;
+    };
+
+    class Worker : public QRunnable
+    {
+    public:
+        Worker( const QVector<WorkItem>& items, QAtomicInt& next, const std::function<void(K3b::DataItem*)>& f )
+            : m_items( items ),
+              m_next( next ),
+              m_f( f ) {
+        }
+
+        void run() {
+            forever {
+                const int i = m_next.fetchAndAddOrdered( 1 );
+                if( i >= m_items.count() )
+                    return;
+
+                const WorkItem& w = m_items.at( i );
+                if( w.subtree ) {
+                    for( K3b::DataItemIterator it( w.subtree ); *it; ++it )
+                        m_f( *it );
+                }
+                else {
+                    for( QList<K3b::DataItem*>::const_iterator it = w.begin; it != w.end; ++it )
+                        m_f( *it );
+                }
+            }
+        }
+
+    private:
+        const QVector<WorkItem>& m_items;
+        QAtomicInt& m_next;
+        const std::function<void(K3b::DataItem*)>& m_f;
+    };
+}
+
+
+K3b::DataItemIterator::DataItemIterator( DataItem* start, bool includeStart )
+    : m_current( start ),
+      m_skipChildren( false )
+{
+    if( !includeStart && start )
+        ++(*this);
+}
+
+
+K3b::DataItemIterator& K3b::DataItemIterator::operator++()
+{
+    if( !m_current )
+        return *this;
+
+    // descend
+    if( !m_skipChildren && m_current->isDir() ) {
+        DirItem* dir = static_cast<DirItem*>( m_current );
+        if( !dir->children().isEmpty() ) {
+            Level level = { dir, 0 };
+            m_stack.append( level );
+            m_current = dir->children().first();
+            return *this;
+        }
+    }
+    m_skipChildren = false;
+
+    // next item in the current dir or in one of the parent dirs
+    while( !m_stack.isEmpty() ) {
+        Level& level = m_stack.last();
+        if( ++level.index < level.dir->children().count() ) {
+            m_current = level.dir->children().at( level.index );
+            return *this;
+        }
+        m_stack.removeLast();
+    }
+
+    m_current = 0;
+    return *this;
+}
+
+
+void K3b::parallelForEachDataItem( DirItem* root, const std::function<void(DataItem*)>& f, bool includeRoot )
+{
+    const int threads = qMax( 1, QThread::idealThreadCount() );
+
+    if( threads == 1 || root->numFiles() + root->numDirs() < s_minParallelItems ) {
+        for( DataItemIterator it( root, includeRoot ); *it; ++it )
+            f( *it );
+        return;
+    }
+
+    //
+    // Split the tree breadth-first until there are enough subtrees to keep
+    // all threads busy. The directories which are split up are visited on
+    // their own, their non-directory children in chunks.
+    //
+    QList<DataItem*> singles;
+    QList<DirItem*> subtrees;
+    subtrees.append( root );
+    if( includeRoot )
+        singles.append( root );
+
+    const int wantedSubtrees = 4*threads;
+    while( !subtrees.isEmpty() && subtrees.count() < wantedSubtrees ) {
+        DirItem* dir = subtrees.takeFirst();
+        if( dir != root )
+            singles.append( dir );
+        Q_FOREACH( DataItem* child, dir->children() ) {
+            if( child->isDir() )
+                subtrees.append( static_cast<DirItem*>( child ) );
+            else
+                singles.append( child );
+        }
+    }
+
+    QVector<WorkItem> items;
+    items.reserve( subtrees.count() + singles.count()/s_chunkSize + 1 );
+    Q_FOREACH( DirItem* dir, subtrees ) {
+        WorkItem w = { singles.constEnd(), singles.constEnd(), dir };
+        items.append( w );
+    }
+    for( int i = 0; i < singles.count(); i += s_chunkSize ) {
+        WorkItem w = { singles.constBegin() + i,
+                       singles.constBegin() + qMin( i + s_chunkSize, singles.count() ),
+                       0 };
+        items.append( w );
+    }
+
+    QThreadPool pool;
+    pool.setMaxThreadCount( qMin( threads, items.count() ) );
+    QAtomicInt next( 0 );
+    for( int i = 0; i < pool.maxThreadCount(); ++i )
+        pool.start( new Worker( items, next, f ) );
+    pool.waitForDone();
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef _K3B_DATA_ITEM_ITERATOR_H_
+#define _K3B_DATA_ITEM_ITERATOR_H_
+
+#include "k3b_export.h"
+
+#include <QVector>
+
+#include <functional>
+
+namespace K3b {
+    class DataItem;
+    class DirItem;
+
+    /**
+     * Pre-order iterator over a tree of data items. It visits the items
+     * in the same order as repeated calls to DataItem::nextSibling() but
+     * keeps track of the position in each directory and thus visits a tree
+     * of n items in O(n).
+     *
+     * The tree may not be modified while iterating.
+     *
+     * \code
+     * for( DataItemIterator it( doc->root(), false ); *it; ++it ) {
+     *     ...
+     * }
+     * \endcode
+     */
+    class LIBK3B_EXPORT DataItemIterator
+    {
+    public:
+        /**
+         * \param start The item the iteration starts at. Only \p start
+         *              and the items below it are visited.
+         * \param includeStart If false \p start itself is skipped.
+         */
+        explicit DataItemIterator( DataItem* start, bool includeStart = true );
+
+        /**
+         * \return The current item or 0 once all items have been visited.
+         */
+        DataItem* current() const { return m_current; }
+        DataItem* operator*() const { return m_current; }
+
+        DataItemIterator& operator++();
+
+        /**
+         * Do not descend into the children of the current item
+         * on the next increment.
+         */
+        void skipChildren() { m_skipChildren = true; }
+
+    private:
+        struct Level {
+            DirItem* dir;
+            int index;
+        };
+
+        QVector<Level> m_stack;
+        DataItem* m_current;
+        bool m_skipChildren;
+    };
+
+    /**
+     * Calls \p f for each item below \p root. The tree is split into
+     * independent subtrees which are visited in parallel, thus \p f has to
+     * be thread-safe and the order of the calls is undefined. Small trees
+     * are visited in the calling thread.
+     *
+     * The tree may not be modified until the function returns.
+     *
+     * \param includeRoot If true \p f is also called for \p root.
+     */
+    LIBK3B_EXPORT void parallelForEachDataItem( DirItem* root,
+                                                const std::function<void(DataItem*)>& f,
+                                                bool includeRoot = false );
+}
+
+#endif
@@ -15,6 +15,7 @@
 
 #include "k3bdatajob.h"
 #include "k3bdatadoc.h"
+#include "k3bdatadocwatcher.h"
 #include "k3bisoimager.h"
 #include "k3bdatamultisessionparameterjob.h"
 #include "k3bchecksumpipe.h"
@@ -36,6 +37,7 @@
 #include "k3bisooptions.h"
 #include "k3bdeviceglobals.h"
 #include "k3bgrowisofswriter.h"
+#include "k3bnativewriter.h"
 #include "k3b_i18n.h"
 
 #include <KIOCore/KIO/Global>
@@ -100,6 +102,10 @@ K3b::DataJob::DataJob( K3b::DataDoc* doc, K3b::JobHandler* hdl, QObject* parent
     m_writerJob = 0;
     d->tocFile = 0;
     m_isoImager = 0;
+
+    // the items must not change while the imager threads read them
+    connect( this, &Job::started, this, [this]() { d->doc->watcher()->suspend( this ); } );
+    connect( this, &Job::finished, this, [this]() { d->doc->watcher()->resume( this ); } );
 }
 
 
@@ -685,6 +691,11 @@ bool K3b::DataJob::prepareWriterJob()
             return false;
         }
     }
+    else if ( d->usedWritingApp == K3b::WritingAppNative ) {
+        if ( !setupNativeJob() ) {
+            return false;
+        }
+    }
     else {
         if ( !setupGrowisofsJob() ) {
             return false;
@@ -776,8 +787,9 @@ bool K3b::DataJob::waitForBurnMedium()
             d->usedWritingMode = d->doc->writingMode();
 
 
-        if ( writingApp() == K3b::WritingAppGrowisofs ) {
-            emit infoMessage( i18n( "Cannot write %1 media using %2. Falling back to default application." , QString("CD") , QString("growisofs") ), MessageWarning );
+        if ( writingApp() == K3b::WritingAppGrowisofs || writingApp() == K3b::WritingAppNative ) {
+            emit infoMessage( i18n( "Cannot write %1 media using %2. Falling back to default application." , QString("CD") ,
+                                    K3b::writingAppToString( writingApp() ) ), MessageWarning );
             setWritingApp( K3b::WritingAppAuto );
         }
         // cdrecord seems to have problems writing xa 1 disks in dao mode? At least on my system!
@@ -973,6 +985,15 @@ bool K3b::DataJob::waitForBurnMedium()
             emit infoMessage( i18n("Writing %1.", Device::mediaTypeString(foundMedium, true)), MessageInfo );
     }
 
+    // the native writer only writes the first session of a medium
+    if( d->usedWritingApp == K3b::WritingAppNative &&
+        ( usedMultiSessionMode() == K3b::DataDoc::CONTINUE ||
+          usedMultiSessionMode() == K3b::DataDoc::FINISH ) ) {
+        emit infoMessage( i18n( "Cannot append sessions using %1. Falling back to %2.",
+                                QString("native"), QString("growisofs") ), MessageWarning );
+        d->usedWritingApp = K3b::WritingAppGrowisofs;
+    }
+
     return true;
 }
 
@@ -1130,6 +1151,22 @@ bool K3b::DataJob::setupCdrdaoJob()
 }
 
 
+bool K3b::DataJob::setupNativeJob()
+{
+    K3b::NativeWriter* writer = new K3b::NativeWriter( d->doc->burner(), this, this );
+
+    writer->setSimulate( d->doc->dummy() );
+    writer->setBurnSpeed( d->doc->speed() );
+    writer->setMultiSession( usedMultiSessionMode() == K3b::DataDoc::START );
+    writer->setImageToWrite( QString() );  // read from ioDevice()
+    writer->setTrackSize( m_isoImager->size() );
+
+    setWriterJob( writer );
+
+    return true;
+}
+
+
 bool K3b::DataJob::setupGrowisofsJob()
 {
     K3b::GrowisofsWriter* writer = new K3b::GrowisofsWriter( d->doc->burner(), this, this );
@@ -18,15 +18,28 @@
 #include "k3bthreadjob.h"
 #include "k3bthread.h"
 #include "k3bdiritem.h"
+#include "k3bdataitemiterator.h"
+#include "k3bduplicatefinder.h"
 #include "k3bfileitem.h"
 #include "k3bglobals.h"
 #include "k3b_i18n.h"
 
 #include <KCoreAddons/KStringHandler>
 
+#include <QAtomicInt>
 #include <QFile>
-#include <QFileInfo>
+#include <QHash>
 #include <QList>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
+
+#include <functional>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace {
     QString createItemsString( const QList<K3b::DataItem*>& items, int max )
@@ -50,6 +63,108 @@ namespace {
 
         return s;
     }
+
+
+    // below this number of files the thread overhead is not worth it
+    const int s_minParallelFiles = 256;
+
+    enum FileState {
+        FileUnchanged,
+        FileChanged,
+        FileMissing,
+        FileFolderSymLink
+    };
+
+    struct FileCheck {
+        K3b::FileItem* item;
+        QByteArray path;
+        int nameOffset;
+        FileState state;
+    };
+
+    /**
+     * All files in one local folder. They are checked relative to the
+     * opened folder to avoid resolving the full path for each file.
+     */
+    struct FolderCheck {
+        QByteArray path;
+        QVector<FileCheck> files;
+    };
+
+    bool localInfoChanged( const k3b_struct_stat& st, const K3b::FileItem* item, bool followSymlinks )
+    {
+        const K3b::FileItem::Id id = item->localId( followSymlinks );
+        return( st.st_ino != id.inode ||
+                st.st_dev != id.device ||
+                st.st_mtime != item->localModificationTime( followSymlinks ) ||
+                (KIO::filesize_t)st.st_size != item->itemSize( followSymlinks ) );
+    }
+
+    void checkFolder( FolderCheck& folder, bool followSymlinks )
+    {
+        const int fd = ::open( folder.path.constData(), O_RDONLY|O_DIRECTORY|O_CLOEXEC );
+
+        for( QVector<FileCheck>::iterator it = folder.files.begin(); it != folder.files.end(); ++it ) {
+            FileCheck& file = *it;
+            const int dirFd = ( fd >= 0 ? fd : AT_FDCWD );
+            const char* name = file.path.constData() + ( fd >= 0 ? file.nameOffset : 0 );
+
+            k3b_struct_stat st;
+            if( k3b_fstatat( dirFd, name, &st, AT_SYMLINK_NOFOLLOW ) != 0 ) {
+                file.state = FileMissing;
+                continue;
+            }
+
+            bool changed = localInfoChanged( st, file.item, false );
+
+            if( file.item->isSymLink() ) {
+                k3b_struct_stat followedSt;
+                const bool haveTarget = ( k3b_fstatat( dirFd, name, &followedSt, 0 ) == 0 );
+                if( followSymlinks ) {
+                    if( !haveTarget ) {
+                        file.state = FileMissing;
+                        continue;
+                    }
+                    else if( S_ISDIR( followedSt.st_mode ) ) {
+                        file.state = FileFolderSymLink;
+                        continue;
+                    }
+                }
+                if( haveTarget && !changed )
+                    changed = localInfoChanged( followedSt, file.item, true );
+            }
+
+            file.state = ( changed ? FileChanged : FileUnchanged );
+        }
+
+        if( fd >= 0 )
+            ::close( fd );
+    }
+
+    class FolderCheckWorker : public QRunnable
+    {
+    public:
+        FolderCheckWorker( QVector<FolderCheck>& folders, QAtomicInt& next,
+                           const std::function<void(FolderCheck&)>& f )
+            : m_folders( folders ),
+              m_next( next ),
+              m_f( f ) {
+        }
+
+        void run() {
+            forever {
+                const int i = m_next.fetchAndAddOrdered( 1 );
+                if( i >= m_folders.count() )
+                    return;
+                m_f( m_folders[i] );
+            }
+        }
+
+    private:
+        QVector<FolderCheck>& m_folders;
+        QAtomicInt& m_next;
+        const std::function<void(FolderCheck&)>& m_f;
+    };
 }
 
 
@@ -61,6 +176,11 @@ public:
     QList<K3b::DataItem*> nonExistingItems;
     QString listOfRenamedItems;
     QList<K3b::DataItem*> folderSymLinkItems;
+
+    // refreshed in the GUI thread
+    QList<K3b::FileItem*> changedItems;
+
+    QHash<K3b::FileItem*, QString> identicalFiles;
 };
 
 
@@ -79,12 +199,19 @@ K3b::DataPreparationJob::~DataPreparationJob()
 }
 
 
+QHash<K3b::FileItem*, QString> K3b::DataPreparationJob::identicalFiles() const
+{
+    return d->identicalFiles;
+}
+
+
 bool K3b::DataPreparationJob::run()
 {
     // clean up
     d->nonExistingItems.clear();
     d->listOfRenamedItems.truncate(0);
     d->folderSymLinkItems.clear();
+    d->identicalFiles.clear();
 
     // initialize filenames in the project
     d->doc->prepareFilenames();
@@ -108,31 +235,86 @@ bool K3b::DataPreparationJob::run()
     }
 
     //
-    // Check for missing files and folder symlinks
+    // Check for missing, changed files and folder symlinks
     //
-    K3b::DataItem* item = d->doc->root();
-    while( (item = item->nextSibling()) ) {
-
-        if( item->isSymLink() ) {
-            if( d->doc->isoOptions().followSymbolicLinks() ) {
-                QFileInfo f( K3b::resolveLink( item->localPath() ) );
-                if( !f.exists() ) {
-                    d->nonExistingItems.append( item );
-                }
-                else if( f.isDir() ) {
-                    d->folderSymLinkItems.append( item );
-                }
-            }
-        }
-        else if( item->isFile() && !QFile::exists( item->localPath() ) ) {
-            d->nonExistingItems.append( item );
+    QVector<FolderCheck> folders;
+    QHash<QByteArray, int> folderIndex;
+    int files = 0;
+    for( K3b::DataItemIterator it( d->doc->root(), false ); *it; ++it ) {
+        if( !(*it)->isFile() )
+            continue;
+
+        FileCheck file;
+        file.item = static_cast<K3b::FileItem*>( *it );
+        file.path = QFile::encodeName( file.item->localPath() );
+        file.nameOffset = file.path.lastIndexOf( '/' ) + 1;
+        file.state = FileUnchanged;
+
+        const QByteArray folderPath = ( file.nameOffset > 1 ? file.path.left( file.nameOffset - 1 ) : QByteArray( "/" ) );
+        QHash<QByteArray, int>::const_iterator folderIt = folderIndex.constFind( folderPath );
+        if( folderIt == folderIndex.constEnd() ) {
+            folderIt = folderIndex.insert( folderPath, folders.count() );
+            FolderCheck folder;
+            folder.path = folderPath;
+            folders.append( folder );
         }
+        folders[folderIt.value()].files.append( file );
+        ++files;
+    }
 
-        if( canceled() ) {
-            return false;
+    const bool followSymlinks = d->doc->isoOptions().followSymbolicLinks();
+    const std::function<void(FolderCheck&)> check = [this, followSymlinks]( FolderCheck& folder ) {
+        if( !canceled() )
+            checkFolder( folder, followSymlinks );
+    };
+
+    // the checks are mostly waiting for the filesystem, thus more threads than cores are fine
+    const int threads = qMin( 4*QThread::idealThreadCount(), folders.count() );
+    if( threads > 1 && files >= s_minParallelFiles ) {
+        QThreadPool pool;
+        pool.setMaxThreadCount( threads );
+        QAtomicInt next( 0 );
+        for( int i = 0; i < threads; ++i )
+            pool.start( new FolderCheckWorker( folders, next, check ) );
+        pool.waitForDone();
+    }
+    else {
+        for( QVector<FolderCheck>::iterator it = folders.begin(); it != folders.end(); ++it )
+            check( *it );
+    }
+
+    if( canceled() ) {
+        return false;
+    }
+
+    d->changedItems.clear();
+    for( QVector<FolderCheck>::const_iterator folderIt = folders.constBegin(); folderIt != folders.constEnd(); ++folderIt ) {
+        for( QVector<FileCheck>::const_iterator it = folderIt->files.constBegin(); it != folderIt->files.constEnd(); ++it ) {
+            switch( it->state ) {
+            case FileMissing:
+                d->nonExistingItems.append( it->item );
+                break;
+            case FileFolderSymLink:
+                d->folderSymLinkItems.append( it->item );
+                break;
+            case FileChanged:
+                d->changedItems.append( it->item );
+                break;
+            case FileUnchanged:
+                break;
+            }
         }
     }
 
+    if( !d->changedItems.isEmpty() ) {
+        // correct the project size before the image is created. The doc belongs
+        // to the GUI thread which also refreshes items via the DataDocWatcher.
+        QMetaObject::invokeMethod( this, "slotRefreshChangedItems", Qt::BlockingQueuedConnection );
+        emit infoMessage( i18np( "1 file changed on disk after it was added to the project.",
+                                 "%1 files changed on disk after they were added to the project.",
+                                 d->changedItems.count() ), K3b::Job::MessageInfo );
+    }
+
 
     //
     // Now ask the user
@@ -213,6 +395,64 @@ bool K3b::DataPreparationJob::run()
         }
     }
 
+    //
+    // Find files whose data can be shared in the image
+    //
+    if( d->doc->isoOptions().shareIdenticalFiles() &&
+        !d->doc->isoOptions().doNotCacheInodes() ) {
+        if( !findIdenticalFiles() )
+            return false;
+    }
+
+    return true;
+}
+
+
+void K3b::DataPreparationJob::slotRefreshChangedItems()
+{
+    Q_FOREACH( K3b::FileItem* item, d->changedItems )
+        d->doc->refreshFileItem( item );
+}
+
+
+bool K3b::DataPreparationJob::findIdenticalFiles()
+{
+    //
+    // mkisofs writes the data of a local file only once if it is used several
+    // times in the path spec, thus the IsoImager replaces the duplicates with
+    // the local path of the first file with the same content.
+    // Symlinks and boot images are written as they are.
+    //
+    K3b::DuplicateFinder finder;
+    QList<K3b::FileItem*> items;
+    for( K3b::DataItemIterator it( d->doc->root(), false ); *it; ++it ) {
+        if( !(*it)->isFile() || (*it)->isSymLink() || (*it)->isBootItem() )
+            continue;
+
+        K3b::FileItem* item = static_cast<K3b::FileItem*>( *it );
+        finder.addFile( item->localPath(), item->itemSize( false ), item->localId( false ) );
+        items.append( item );
+    }
+
+    if( !finder.find( [this]() { return canceled(); } ) )
+        return false;
+
+    for( int i = 0; i < items.count(); ++i ) {
+        const int original = finder.original( i );
+        if( original != i )
+            d->identicalFiles.insert( items[i], items[original]->localPath() );
+    }
+
+    if( finder.duplicates() > 0 ) {
+        emit infoMessage( i18np( "Found 1 file with the same content as another file in the project. "
+                                 "Writing its data only once saves %2.",
+                                 "Found %1 files with the same content as other files in the project. "
+                                 "Writing their data only once saves %2.",
+                                 finder.duplicates(),
+                                 KIO::convertSize( finder.reclaimableSize() ) ),
+                          K3b::Job::MessageInfo );
+    }
+
     return true;
 }
 
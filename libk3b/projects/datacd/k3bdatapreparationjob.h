@@ -17,9 +17,13 @@
 
 #include "k3bthreadjob.h"
 
+#include <QHash>
+#include <QString>
+
 
 namespace K3b {
     class DataDoc;
+    class FileItem;
     class JobHandler;
 
     /**
@@ -34,8 +38,19 @@ namespace K3b {
         DataPreparationJob( DataDoc* doc, JobHandler* hdl, QObject* parent );
         ~DataPreparationJob();
 
+        /**
+         * Maps the files which have the same content as another file in the
+         * project to the local path of that file. Only filled if
+         * IsoOptions::shareIdenticalFiles() is enabled.
+         */
+        QHash<FileItem*, QString> identicalFiles() const;
+
+    private Q_SLOTS:
+        void slotRefreshChangedItems();
+
     private:
         bool run();
+        bool findIdenticalFiles();
 
         class Private;
         Private* const d;
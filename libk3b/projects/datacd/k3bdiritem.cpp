@@ -32,7 +32,9 @@ K3b::DirItem::DirItem(const QString& name, const ItemFlags& flags)
       m_blocks(0),
       m_followSymlinksBlocks(0),
       m_files(0),
-      m_dirs(0)
+      m_dirs(0),
+      m_namesDirty(true),
+      m_subtreeNamesDirty(true)
 {
     m_k3bName = name;
 }
@@ -46,6 +48,8 @@ K3b::DirItem::DirItem( const K3b::DirItem& item )
       m_followSymlinksBlocks(0),
       m_files(0),
       m_dirs(0),
+      m_namesDirty(true),
+      m_subtreeNamesDirty(true),
       m_localPath( item.m_localPath )
 {
     Q_FOREACH( K3b::DataItem* _item, item.children() ) {
@@ -204,6 +208,8 @@ K3b::DirItem::Children K3b::DirItem::takeDataItems( int start, int count )
             m_children.pop_back();
         }
 
+        setNamesDirty();
+
         // inform the doc
         if( DataDoc* doc = getDoc() ) {
             doc->endRemoveItems( this, start, start+count-1 );
@@ -408,6 +414,16 @@ void K3b::DirItem::updateFiles( long files, long dirs )
 }
 
 
+void K3b::DirItem::setNamesDirty()
+{
+    m_namesDirty = true;
+
+    // the directories above need to know that they have to descend
+    for( DirItem* dir = this; dir && !dir->m_subtreeNamesDirty; dir = dir->parent() )
+        dir->m_subtreeNamesDirty = true;
+}
+
+
 void K3b::DirItem::updateOldSessionFlag()
 {
     if( flags().testFlag( OLD_SESSION ) ) {
@@ -483,6 +499,7 @@ void K3b::DirItem::addDataItemImpl( DataItem* item )
     }
 
     m_children.append( item );
+    setNamesDirty();
     updateSize( item, false );
     if( item->isDir() )
         updateFiles( ((DirItem*)item)->numFiles(), ((DirItem*)item)->numDirs()+1 );
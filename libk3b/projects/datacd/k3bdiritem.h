@@ -76,6 +76,32 @@ namespace K3b {
 
         virtual bool isRemoveable() const;
 
+        /**
+         * Marks the written names of the children as outdated. The next call
+         * to DataDoc::prepareFilenames() only recomputes the names in
+         * directories marked this way.
+         *
+         * This is done automatically when children are added, removed, or
+         * renamed.
+         */
+        void setNamesDirty();
+
+        /**
+         * \return true if the written names of the children are outdated.
+         */
+        bool namesDirty() const { return m_namesDirty; }
+
+        /**
+         * \return true if this directory or any directory below it has
+         *         outdated written names.
+         */
+        bool subtreeNamesDirty() const { return m_subtreeNamesDirty; }
+
+        /**
+         * Used by DataDoc::prepareFilenames() to reset the dirty flags.
+         */
+        void setNamesPrepared() { m_namesDirty = m_subtreeNamesDirty = false; }
+
         /**
          * Recursively creates a directory.
          */
@@ -107,6 +133,8 @@ namespace K3b {
         Msf itemBlocks( bool followSymlinks ) const;
 
     private:
+        friend class DataDoc;
+
         /**
          * this recursivly updates the size of the directories.
          * The size of this dir and the parent dir is updated.
@@ -140,6 +168,9 @@ namespace K3b {
         long m_files;
         long m_dirs;
 
+        bool m_namesDirty;
+        bool m_subtreeNamesDirty;
+
         // HACK: store the original path to be able to use it's permissions
         //       remove this once we have a backup project
         QString m_localPath;
@@ -0,0 +1,281 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bduplicatefinder.h"
+
+#include <QAtomicInt>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QFile>
+#include <QHash>
+#include <QMap>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+
+
+namespace {
+    // the part of a file hashed to rule out most files of the same size
+    const qint64 s_partialSize = 64*1024;
+
+    const int s_bufferSize = 256*1024;
+
+    KIO::filesize_t usedBlocks( KIO::filesize_t bytes )
+    {
+        return ( bytes + 2047 )/2048;
+    }
+
+    QByteArray hashFile( const QString& path, qint64 maxBytes, const std::function<bool()>& canceled )
+    {
+        QFile f( path );
+        if( !f.open( QIODevice::ReadOnly ) ) {
+            qDebug() << "(K3b::DuplicateFinder) could not open" << path;
+            return QByteArray();
+        }
+
+        QCryptographicHash hash( QCryptographicHash::Sha256 );
+        QByteArray buffer( s_bufferSize, Qt::Uninitialized );
+        qint64 remaining = ( maxBytes >= 0 ? maxBytes : f.size() );
+        while( remaining > 0 ) {
+            if( canceled && canceled() )
+                return QByteArray();
+
+            const qint64 len = f.read( buffer.data(), qMin<qint64>( remaining, buffer.size() ) );
+            if( len < 0 ) {
+                qDebug() << "(K3b::DuplicateFinder) could not read" << path;
+                return QByteArray();
+            }
+            else if( len == 0 ) {
+                break;
+            }
+            hash.addData( buffer.constData(), len );
+            remaining -= len;
+        }
+
+        return hash.result();
+    }
+
+    QByteArray groupKey( KIO::filesize_t size, const QByteArray& hash )
+    {
+        return QByteArray::number( size ) + ':' + hash;
+    }
+}
+
+
+K3b::DuplicateFinder::DuplicateFinder()
+{
+}
+
+
+K3b::DuplicateFinder::~DuplicateFinder()
+{
+}
+
+
+int K3b::DuplicateFinder::addFile( const QString& path, KIO::filesize_t size, const FileItem::Id& id )
+{
+    Entry e;
+    e.path = path;
+    e.size = size;
+    e.id = id;
+    e.original = m_files.count();
+    m_files.append( e );
+    return e.original;
+}
+
+
+int K3b::DuplicateFinder::count() const
+{
+    return m_files.count();
+}
+
+
+void K3b::DuplicateFinder::clear()
+{
+    m_files.clear();
+}
+
+
+bool K3b::DuplicateFinder::hashFiles( const QVector<int>& files, qint64 maxBytes,
+                                      const std::function<bool()>& canceled )
+{
+    class HashWorker : public QRunnable
+    {
+    public:
+        HashWorker( Entry* entries, const QVector<int>& files, QAtomicInt& next,
+                    qint64 maxBytes, const std::function<bool()>& canceled )
+            : m_entries( entries ),
+              m_files( files ),
+              m_next( next ),
+              m_maxBytes( maxBytes ),
+              m_canceled( canceled ) {
+        }
+
+        void run() {
+            forever {
+                const int i = m_next.fetchAndAddOrdered( 1 );
+                if( i >= m_files.count() || ( m_canceled && m_canceled() ) )
+                    return;
+                Entry& e = m_entries[m_files[i]];
+                e.hash = hashFile( e.path, m_maxBytes, m_canceled );
+            }
+        }
+
+    private:
+        Entry* m_entries;
+        const QVector<int>& m_files;
+        QAtomicInt& m_next;
+        qint64 m_maxBytes;
+        const std::function<bool()>& m_canceled;
+    };
+
+    // detach before the workers write into the entries
+    Entry* entries = m_files.data();
+
+    const int threads = qMin( QThread::idealThreadCount(), files.count() );
+    QAtomicInt next( 0 );
+    if( threads > 1 ) {
+        QThreadPool pool;
+        pool.setMaxThreadCount( threads );
+        for( int i = 0; i < threads; ++i )
+            pool.start( new HashWorker( entries, files, next, maxBytes, canceled ) );
+        pool.waitForDone();
+    }
+    else {
+        HashWorker( entries, files, next, maxBytes, canceled ).run();
+    }
+
+    return !( canceled && canceled() );
+}
+
+
+bool K3b::DuplicateFinder::find( const std::function<bool()>& canceled )
+{
+    //
+    // Hard links share their data anyway. Only one file per id takes part in
+    // the comparison and the others follow it.
+    //
+    QMap<FileItem::Id, int> ids;
+    QHash<KIO::filesize_t, QVector<int> > sizes;
+    for( int i = 0; i < m_files.count(); ++i ) {
+        Entry& e = m_files[i];
+        e.original = i;
+        e.hash.clear();
+
+        QMap<FileItem::Id, int>::const_iterator it = ids.constFind( e.id );
+        if( it != ids.constEnd() ) {
+            e.original = it.value();
+        }
+        else {
+            ids.insert( e.id, i );
+            if( e.size > 0 )
+                sizes[e.size].append( i );
+        }
+    }
+
+    // only files sharing their size with another file may be duplicates
+    QVector<int> candidates;
+    for( QHash<KIO::filesize_t, QVector<int> >::const_iterator it = sizes.constBegin(); it != sizes.constEnd(); ++it ) {
+        if( it.value().count() > 1 )
+            candidates += it.value();
+    }
+    std::sort( candidates.begin(), candidates.end() );
+
+    if( !hashFiles( candidates, s_partialSize, canceled ) )
+        return false;
+
+    // large files with an equal beginning need to be compared completely
+    QHash<QByteArray, int> partialCount;
+    Q_FOREACH( int i, candidates ) {
+        if( !m_files[i].hash.isEmpty() )
+            ++partialCount[groupKey( m_files[i].size, m_files[i].hash )];
+    }
+    QVector<int> fullCandidates;
+    Q_FOREACH( int i, candidates ) {
+        const Entry& e = m_files[i];
+        if( qint64( e.size ) > s_partialSize && partialCount.value( groupKey( e.size, e.hash ) ) > 1 )
+            fullCandidates.append( i );
+    }
+
+    if( !hashFiles( fullCandidates, -1, canceled ) )
+        return false;
+
+    //
+    // Files with equal size and hash are duplicates. Files which were not hashed
+    // completely are unique anyway.
+    //
+    QHash<QByteArray, int> firstFile;
+    Q_FOREACH( int i, candidates ) {
+        Entry& e = m_files[i];
+        if( e.hash.isEmpty() )
+            continue;
+        const QByteArray key = groupKey( e.size, e.hash );
+        QHash<QByteArray, int>::const_iterator it = firstFile.constFind( key );
+        if( it != firstFile.constEnd() )
+            e.original = it.value();
+        else
+            firstFile.insert( key, i );
+    }
+
+    // let the hard links follow their file
+    for( int i = 0; i < m_files.count(); ++i ) {
+        Entry& e = m_files[i];
+        e.original = m_files[e.original].original;
+    }
+
+    return true;
+}
+
+
+int K3b::DuplicateFinder::original( int file ) const
+{
+    if( file < 0 || file >= m_files.count() )
+        return -1;
+    return m_files[file].original;
+}
+
+
+int K3b::DuplicateFinder::duplicates() const
+{
+    return countDuplicates( 0 );
+}
+
+
+KIO::filesize_t K3b::DuplicateFinder::reclaimableSize() const
+{
+    KIO::filesize_t size = 0;
+    countDuplicates( &size );
+    return size;
+}
+
+
+int K3b::DuplicateFinder::countDuplicates( KIO::filesize_t* size ) const
+{
+    // hard links of a duplicate are counted once
+    QMap<FileItem::Id, int> ids;
+    int n = 0;
+    for( int i = 0; i < m_files.count(); ++i ) {
+        const Entry& e = m_files[i];
+        if( e.original == i || m_files[e.original].id == e.id || ids.contains( e.id ) )
+            continue;
+
+        ids.insert( e.id, i );
+        ++n;
+        if( size )
+            *size += usedBlocks( e.size )*2048;
+    }
+    return n;
+}
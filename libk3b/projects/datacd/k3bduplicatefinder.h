@@ -0,0 +1,102 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef _K3B_DUPLICATE_FINDER_H_
+#define _K3B_DUPLICATE_FINDER_H_
+
+#include "k3b_export.h"
+#include "k3bfileitem.h"
+
+#include <KIOCore/KIO/Global>
+
+#include <QList>
+#include <QString>
+#include <QVector>
+
+#include <functional>
+
+
+namespace K3b {
+    /**
+     * Finds local files with identical content.
+     *
+     * Only files of equal size are compared. Their first 64 KB are hashed
+     * first and only files which are still equal after that are hashed
+     * completely. The hashing is spread over several threads.
+     *
+     * Files with the same id (hard links) are the same file and never
+     * reported as duplicates of each other.
+     *
+     * find() blocks and is meant to be called from a ThreadJob.
+     */
+    class LIBK3B_EXPORT DuplicateFinder
+    {
+    public:
+        DuplicateFinder();
+        ~DuplicateFinder();
+
+        /**
+         * \return The index of the file to be used with original().
+         */
+        int addFile( const QString& path, KIO::filesize_t size, const FileItem::Id& id );
+
+        int count() const;
+        void clear();
+
+        /**
+         * Searches the added files for identical content.
+         *
+         * \param canceled Polled regularly. find() returns false once it
+         * returns true.
+         */
+        bool find( const std::function<bool()>& canceled = std::function<bool()>() );
+
+        /**
+         * \return The index of the first added file with the same content as
+         * \p file. Files without duplicates (and the first file of each
+         * group) are their own original.
+         */
+        int original( int file ) const;
+
+        /**
+         * \return The number of files which do not need to be written
+         * because a different file with the same content is written.
+         * Hard links of such files are not counted.
+         */
+        int duplicates() const;
+
+        /**
+         * \return The space the duplicates occupy in an ISO9660 image, i.e.
+         * their sizes rounded to full blocks of 2048 bytes.
+         */
+        KIO::filesize_t reclaimableSize() const;
+
+    private:
+        struct Entry {
+            QString path;
+            KIO::filesize_t size;
+            FileItem::Id id;
+            int original;
+            QByteArray hash;
+        };
+
+        int countDuplicates( KIO::filesize_t* size ) const;
+        bool hashFiles( const QVector<int>& files, qint64 maxBytes,
+                        const std::function<bool()>& canceled );
+
+        QVector<Entry> m_files;
+    };
+}
+
+#endif
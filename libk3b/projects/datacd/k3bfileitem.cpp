@@ -58,7 +58,7 @@ bool K3b::operator>( const K3b::FileItem::Id& id1, const K3b::FileItem::Id& id2
 K3b::FileItem::FileItem( const QString& filePath, K3b::DataDoc& doc, const QString& k3bName, const ItemFlags& flags )
     : K3b::DataItem( flags | FILE ),
       m_replacedItemFromOldSession(0),
-      m_localPath(filePath)
+      m_linkTarget(0)
 {
     k3b_struct_stat statBuf;
     k3b_struct_stat followedStatBuf;
@@ -92,7 +92,7 @@ K3b::FileItem::FileItem( const k3b_struct_stat* stat,
                           const QString& filePath, K3b::DataDoc& doc, const QString& k3bName, const ItemFlags& flags )
     : K3b::DataItem( flags | FILE ),
       m_replacedItemFromOldSession(0),
-      m_localPath(filePath)
+      m_linkTarget(0)
 {
     init( filePath, k3bName, doc, stat, followedStat );
 }
@@ -102,10 +102,11 @@ K3b::FileItem::FileItem( const K3b::FileItem& item )
     : K3b::DataItem( item ),
       m_replacedItemFromOldSession(0),
       m_size( item.m_size ),
-      m_sizeFollowed( item.m_sizeFollowed ),
       m_id( item.m_id ),
-      m_idFollowed( item.m_idFollowed ),
-      m_localPath( item.m_localPath ),
+      m_mtime( item.m_mtime ),
+      m_linkTarget( item.m_linkTarget ? new LinkTarget( *item.m_linkTarget ) : 0 ),
+      m_localFolder( item.m_localFolder ),
+      m_localName( item.m_localName ),
       m_mimeType( item.m_mimeType )
 {
 }
@@ -115,6 +116,8 @@ K3b::FileItem::~FileItem()
 {
     // remove this from parentdir
     take();
+
+    delete m_linkTarget;
 }
 
 
@@ -132,8 +135,8 @@ QMimeType K3b::FileItem::mimeType() const
 
 KIO::filesize_t K3b::FileItem::itemSize( bool followSymlinks ) const
 {
-    if( followSymlinks )
-        return m_sizeFollowed;
+    if( followSymlinks && m_linkTarget )
+        return m_linkTarget->size;
     else
         return m_size;
 }
@@ -150,13 +153,22 @@ K3b::FileItem::Id K3b::FileItem::localId() const
 
 K3b::FileItem::Id K3b::FileItem::localId( bool followSymlinks ) const
 {
-    if( followSymlinks )
-        return m_idFollowed;
+    if( followSymlinks && m_linkTarget )
+        return m_linkTarget->id;
     else
         return m_id;
 }
 
 
+time_t K3b::FileItem::localModificationTime( bool followSymlinks ) const
+{
+    if( followSymlinks && m_linkTarget )
+        return m_linkTarget->mtime;
+    else
+        return m_mtime;
+}
+
+
 bool K3b::FileItem::exists() const
 {
     return true;
@@ -171,7 +183,7 @@ QString K3b::FileItem::absIsoPath()
 
 QString K3b::FileItem::localPath() const
 {
-    return m_localPath;
+    return m_localFolder + m_localName;
 }
 
 
@@ -248,21 +260,11 @@ bool K3b::FileItem::isValid() const
 }
 
 
-void K3b::FileItem::init( const QString& filePath,
-                          const QString& k3bName,
-                          DataDoc& doc,
-                          const k3b_struct_stat* stat,
-                          const k3b_struct_stat* followedStat )
+void K3b::FileItem::setLocalInfo( const k3b_struct_stat* stat,
+                                  const k3b_struct_stat* followedStat )
 {
-    if( k3bName.isEmpty() )
-        m_k3bName = filePath.section( '/', -1 );
-    else
-        m_k3bName = k3bName;
-
     if( stat != 0 ) {
         m_size = (KIO::filesize_t)stat->st_size;
-        if( S_ISLNK(stat->st_mode) )
-            setFlags( flags() | SYMLINK );
 
         //
         // integrate the device number into the inode since files on different
@@ -270,40 +272,85 @@ void K3b::FileItem::init( const QString& filePath,
         //
         m_id.inode = stat->st_ino;
         m_id.device = stat->st_dev;
+        m_mtime = stat->st_mtime;
     }
     else {
-        m_size = QFileInfo(filePath).size();
+        m_size = QFileInfo( localPath() ).size();
         m_id.inode = 0;
         m_id.device = 0;
-
-        // since we have no proper inode info, disable the inode caching in the doc
-        K3b::IsoOptions o( doc.isoOptions() );
-        o.setDoNotCacheInodes( true );
-        doc.setIsoOptions( o );
+        m_mtime = 0;
     }
 
     if( isSymLink() ) {
-        if( QFile::exists( K3b::resolveLink( filePath ) ) && followedStat != 0 ) {
-            m_sizeFollowed = (KIO::filesize_t)followedStat->st_size;
-            m_idFollowed.inode = followedStat->st_ino;
-            m_idFollowed.device = followedStat->st_dev;
+        if( !m_linkTarget )
+            m_linkTarget = new LinkTarget();
+
+        if( QFile::exists( K3b::resolveLink( localPath() ) ) && followedStat != 0 ) {
+            m_linkTarget->size = (KIO::filesize_t)followedStat->st_size;
+            m_linkTarget->id.inode = followedStat->st_ino;
+            m_linkTarget->id.device = followedStat->st_dev;
+            m_linkTarget->mtime = followedStat->st_mtime;
         }
         else if( followedStat == 0 ) {
-            m_sizeFollowed = m_size;
-            m_idFollowed.inode = 0;
-            m_idFollowed.device = 0;
+            m_linkTarget->size = m_size;
+            m_linkTarget->id.inode = 0;
+            m_linkTarget->id.device = 0;
+            m_linkTarget->mtime = 0;
         }
         else {
             // This means the link is broken, so size of target equals 0
-            m_sizeFollowed = 0;
+            m_linkTarget->size = 0;
+            m_linkTarget->mtime = 0;
         }
     }
     else {
-        m_sizeFollowed = m_size;
-        m_idFollowed = m_id;
+        delete m_linkTarget;
+        m_linkTarget = 0;
     }
+}
+
+
+void K3b::FileItem::refreshLocalInfo()
+{
+    const QByteArray path = QFile::encodeName( localPath() );
+    k3b_struct_stat statBuf;
+    k3b_struct_stat followedStatBuf;
+    const bool haveStat = ( k3b_lstat( path, &statBuf ) == 0 );
+    const bool haveFollowedStat = ( k3b_stat( path, &followedStatBuf ) == 0 );
+    setLocalInfo( haveStat ? &statBuf : 0, haveFollowedStat ? &followedStatBuf : 0 );
+}
+
+
+void K3b::FileItem::init( const QString& filePath,
+                          const QString& k3bName,
+                          DataDoc& doc,
+                          const k3b_struct_stat* stat,
+                          const k3b_struct_stat* followedStat )
+{
+    const int slash = filePath.lastIndexOf( '/' );
+    const QString name = filePath.mid( slash+1 );
+    if( k3bName.isEmpty() )
+        m_k3bName = name;
+    else
+        m_k3bName = k3bName;
+
+    m_localFolder = doc.sharedLocalFolder( filePath.left( slash+1 ) );
+    m_localName = ( name == m_k3bName ? m_k3bName : name );
+
+    if( stat != 0 ) {
+        if( S_ISLNK(stat->st_mode) )
+            setFlags( flags() | SYMLINK );
+    }
+    else {
+        // since we have no proper inode info, disable the inode caching in the doc
+        K3b::IsoOptions o( doc.isoOptions() );
+        o.setDoNotCacheInodes( true );
+        doc.setIsoOptions( o );
+    }
+
+    setLocalInfo( stat, followedStat );
 
-    m_mimeType = QMimeDatabase().mimeTypeForFile( filePath );
+    m_mimeType = doc.sharedMimeType( QMimeDatabase().mimeTypeForFile( filePath ) );
 
     // add automagically like a qlistviewitem
     if( parent() )
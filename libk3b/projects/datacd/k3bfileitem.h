@@ -83,6 +83,13 @@ namespace K3b {
          */
         Id localId( bool followSymlinks ) const;
 
+        /**
+         * The modification time of the local file (or the file the symlink
+         * is pointing to) as seen when the item was created or last refreshed
+         * via DataDoc::refreshFileItem().
+         */
+        time_t localModificationTime( bool followSymlinks ) const;
+
         DirItem* getDirItem() const;
 
         QString linkDest() const;
@@ -102,21 +109,49 @@ namespace K3b {
         KIO::filesize_t itemSize( bool followSymlinks ) const;
         
     private:
+        friend class DataDoc;
+
         void init( const QString& filePath,
                    const QString& k3bName,
                    DataDoc& doc,
                    const k3b_struct_stat* stat,
                    const k3b_struct_stat* followedStat );
 
+        /**
+         * Sets size, id, and modification time from the given stat
+         * info. Either may be 0 if the stat call failed.
+         */
+        void setLocalInfo( const k3b_struct_stat* stat,
+                           const k3b_struct_stat* followedStat );
+
+        /**
+         * Reads the local file info again. Used by DataDoc::refreshFileItem().
+         */
+        void refreshLocalInfo();
+
     private:
+        /**
+         * The local info of the file a symlink is pointing to. Only
+         * symlinks have one, all other files use their own info.
+         */
+        struct LinkTarget {
+            KIO::filesize_t size;
+            Id id;
+            time_t mtime;
+        };
+
         DataItem* m_replacedItemFromOldSession;
 
         KIO::filesize_t m_size;
-        KIO::filesize_t m_sizeFollowed;
         Id m_id;
-        Id m_idFollowed;
-
-        QString m_localPath;
+        time_t m_mtime;
+        LinkTarget* m_linkTarget;
+
+        // The local path is split into the folder, which is shared by all
+        // files of the folder, and the name, which shares the k3bName unless
+        // the item has been added under a different name.
+        QString m_localFolder;
+        QString m_localName;
 
         QMimeType m_mimeType;
     };
@@ -17,6 +17,8 @@
 
 #include "k3bisoimager.h"
 #include "k3bdiritem.h"
+#include "k3bfileitem.h"
+#include "k3bdataitemiterator.h"
 #include "k3bbootitem.h"
 #include "k3bdatadoc.h"
 #include "k3bdatapreparationjob.h"
@@ -26,6 +28,7 @@
 #include "k3bcore.h"
 #include "k3bversion.h"
 #include "k3bfilesplitter.h"
+#include "k3bfileprefetcher.h"
 #include "k3bisooptions.h"
 #include "k3b_i18n.h"
 
@@ -37,6 +40,7 @@
 #include <QDebug>
 #include <QDir>
 #include <QFile>
+#include <QPair>
 #include <QRegExp>
 #include <QStandardPaths>
 #include <QTemporaryFile>
@@ -47,10 +51,105 @@
 #include <unistd.h>
 #include <utime.h>
 
+#include <algorithm>
+
 
 int K3b::IsoImager::s_imagerSessionCounter = 0;
 
 
+namespace {
+    /**
+     * The name mkisofs gives \p item in the ISO 9660 tree without the
+     * shortening of too long names.
+     */
+    QByteArray iso9660SortName( const K3b::DataItem* item, const K3b::IsoOptions& options )
+    {
+        QString name = item->writtenName();
+        if( name.isEmpty() )
+            name = item->k3bName();
+
+        if( !options.ISOuntranslatedFilenames() && options.ISOLevel() < 4 ) {
+            if( !options.ISOallowLowercase() )
+                name = name.toUpper();
+
+            // only the last dot of a file name separates the extension
+            const int extensionDot = ( item->isDir() ? -1 : name.lastIndexOf( '.' ) );
+            for( int i = 0; i < name.length(); ++i ) {
+                const ushort c = name[i].unicode();
+                if( c == '.' ) {
+                    if( i == 0 ? !options.ISOallowPeriodAtBegin()
+                        : ( i != extensionDot && !options.ISOallowMultiDot() ) )
+                        name[i] = '_';
+                }
+                else if( !( ( c >= 'A' && c <= 'Z' ) ||
+                            ( c >= '0' && c <= '9' ) ||
+                            c == '_' ||
+                            ( c >= 'a' && c <= 'z' && options.ISOallowLowercase() ) ||
+                            ( c > ' ' && c < 0x7f && c != '/' && options.ISOrelaxedFilenames() ) ) ) {
+                    name[i] = '_';
+                }
+            }
+        }
+
+        QByteArray iso = name.toUtf8();
+        if( !item->isDir() ) {
+            if( !iso.contains( '.' ) && !options.ISOomitTrailingPeriod() )
+                iso += '.';
+            if( !options.ISOomitVersionNumbers() )
+                iso += ";1";
+        }
+        return iso;
+    }
+
+
+    /**
+     * Compares like compare_dirs() in mkisofs: the version separator sorts
+     * before the extension dot, which sorts before all other characters.
+     */
+    bool iso9660NameLessThan( const QByteArray& a, const QByteArray& b )
+    {
+        const int len = qMin( a.length(), b.length() );
+        for( int i = 0; i < len; ++i ) {
+            const char ca = a[i];
+            const char cb = b[i];
+            if( ca == cb ) {
+                if( ca == ';' )
+                    return false;
+                continue;
+            }
+            if( ca == ';' || cb == ';' )
+                return ca == ';';
+            if( ca == '.' || cb == '.' )
+                return ca == '.';
+            return (unsigned char)ca < (unsigned char)cb;
+        }
+        return a.length() < b.length();
+    }
+
+
+    void appendWriteOrder( K3b::DirItem* dir, const K3b::IsoOptions& options, QList<K3b::FileItem*>& order )
+    {
+        QList<QPair<QByteArray, K3b::DataItem*> > entries;
+        Q_FOREACH( K3b::DataItem* item, dir->children() )
+            entries.append( qMakePair( iso9660SortName( item, options ), item ) );
+        std::stable_sort( entries.begin(), entries.end(),
+                          []( const QPair<QByteArray, K3b::DataItem*>& a, const QPair<QByteArray, K3b::DataItem*>& b ) {
+                              return iso9660NameLessThan( a.first, b.first );
+                          } );
+
+        // mkisofs assigns the data of the files of a folder before descending into its subfolders
+        for( int i = 0; i < entries.count(); ++i ) {
+            if( entries[i].second->isFile() )
+                order.append( static_cast<K3b::FileItem*>( entries[i].second ) );
+        }
+        for( int i = 0; i < entries.count(); ++i ) {
+            if( entries[i].second->isDir() )
+                appendWriteOrder( static_cast<K3b::DirItem*>( entries[i].second ), options, order );
+        }
+    }
+}
+
+
 class K3b::IsoImager::Private
 {
 public:
@@ -68,9 +167,50 @@ public:
     bool knownError;
 
     K3b::DataPreparationJob* dataPreparationJob;
+
+    // the local files written to the image
+    QHash<K3b::FileItem*, QString> prefetchFiles;
+    K3b::FilePrefetcher* prefetcher;
+
+    // files which share the data of another local file, see DataPreparationJob
+    QHash<K3b::FileItem*, QString> identicalFiles;
+
+    void startPrefetcher( K3b::DataDoc* doc, qint64 pid );
 };
 
 
+QList<K3b::FileItem*> K3b::mkisofsWriteOrder( K3b::DirItem* root, const K3b::IsoOptions& options )
+{
+    QList<FileItem*> order;
+    appendWriteOrder( root, options, order );
+
+    // with -sort mkisofs keeps the order of the files with equal weight
+    std::stable_sort( order.begin(), order.end(),
+                      []( const FileItem* a, const FileItem* b ) {
+                          return a->sortWeight() > b->sortWeight();
+                      } );
+    return order;
+}
+
+
+void K3b::IsoImager::Private::startPrefetcher( K3b::DataDoc* doc, qint64 pid )
+{
+    // read the files in the order mkisofs asks for them
+    QStringList files;
+    Q_FOREACH( K3b::FileItem* item, K3b::mkisofsWriteOrder( doc->root(), doc->isoOptions() ) ) {
+        const QString path = prefetchFiles.value( item );
+        if( !path.isEmpty() )
+            files.append( path );
+    }
+    prefetchFiles.clear();
+
+    prefetcher = new K3b::FilePrefetcher();
+    prefetcher->setFiles( files );
+    prefetcher->setConsumerProcess( pid );
+    prefetcher->start();
+}
+
+
 K3b::IsoImager::IsoImager( K3b::DataDoc* doc, K3b::JobHandler* hdl, QObject* parent )
     : K3b::Job( hdl, parent ),
       m_pathSpecFile(0),
@@ -85,6 +225,7 @@ K3b::IsoImager::IsoImager( K3b::DataDoc* doc, K3b::JobHandler* hdl, QObject* par
       m_mkisofsPrintSizeResult( 0 )
 {
     d = new Private();
+    d->prefetcher = 0;
     d->dataPreparationJob = new K3b::DataPreparationJob( doc, this, this );
     connectSubJob( d->dataPreparationJob,
                    SLOT(slotDataPreparationDone(bool)),
@@ -115,6 +256,10 @@ void K3b::IsoImager::slotReceivedStderr( const QString& line )
 
 void K3b::IsoImager::handleMkisofsProgress( int p )
 {
+    // only a fallback, the prefetcher prefers the I/O statistics of mkisofs
+    if( d->prefetcher )
+        d->prefetcher->setConsumedBytes( qint64( m_mkisofsPrintSizeResult )*2048LL*qint64( p )/100LL );
+
     emit percent( p );
 }
 
@@ -131,6 +276,11 @@ void K3b::IsoImager::slotProcessExited( int exitCode, QProcess::ExitStatus exitS
 {
     qDebug();
 
+    if( d->prefetcher ) {
+        d->prefetcher->stop();
+        emit debuggingOutput( "K3b::IsoImager", d->prefetcher->report() );
+    }
+
     cleanup();
 
     if( m_canceled ) {
@@ -188,6 +338,10 @@ void K3b::IsoImager::cleanup()
 {
     qDebug();
 
+    delete d->prefetcher;
+    d->prefetcher = 0;
+    d->prefetchFiles.clear();
+
     // remove all temp files
     delete m_pathSpecFile;
     delete m_rrHideFile;
@@ -219,6 +373,8 @@ void K3b::IsoImager::init()
 void K3b::IsoImager::slotDataPreparationDone( bool success )
 {
     if( success ) {
+        d->identicalFiles = d->dataPreparationJob->identicalFiles();
+
         //
         // We always calculate the image size. It does not take long and at least the mixed job needs it
         // anyway
@@ -449,6 +605,10 @@ void K3b::IsoImager::start()
         jobFinished( false );
         cleanup();
     }
+    else {
+        // keep mkisofs fed when reading many small files from slow sources
+        d->startPrefetcher( m_doc, m_process->pid() );
+    }
 }
 
 
@@ -599,8 +759,8 @@ bool K3b::IsoImager::addMkisofsParameters( bool printSize )
     //
     bool filesGreaterThan2Gb = false;
     bool filesGreaterThan4Gb = false;
-    K3b::DataItem* item = m_doc->root();
-    while( (item = item->nextSibling()) ) {
+    for( K3b::DataItemIterator it( m_doc->root(), false ); *it; ++it ) {
+        K3b::DataItem* item = *it;
         if ( item->isFile() && item->size() >= 0xFFFFFFFFULL ) {
             filesGreaterThan4Gb = filesGreaterThan2Gb = true;
             break;
@@ -846,10 +1006,23 @@ void K3b::IsoImager::writePathSpecForFile( K3b::FileItem* item, QTextStream& str
         m_tempFiles.append(tempPath);
         stream << escapeGraftPoint( tempPath ) << "\n";
     }
-    else if( item->isSymLink() && d->usedLinkHandling == Private::FOLLOW )
-        stream << escapeGraftPoint( K3b::resolveLink( item->localPath() ) ) << "\n";
-    else
-        stream << escapeGraftPoint( item->localPath() ) << "\n";
+    else {
+        // mkisofs writes the data of the first file only once for all files with the same content
+        const QString identicalFile = d->identicalFiles.value( item );
+        if( !identicalFile.isEmpty() ) {
+            stream << escapeGraftPoint( identicalFile ) << "\n";
+            return;
+        }
+
+        QString path;
+        if( item->isSymLink() && d->usedLinkHandling == Private::FOLLOW )
+            path = K3b::resolveLink( item->localPath() );
+        else
+            path = item->localPath();
+        d->prefetchFiles.insert( item, path );
+
+        stream << escapeGraftPoint( path ) << "\n";
+    }
 }
 
 
@@ -861,13 +1034,12 @@ bool K3b::IsoImager::writeRRHideFile()
 
     QTextStream s( m_rrHideFile );
 
-    K3b::DataItem* item = m_doc->root();
-    while( item ) {
+    for( K3b::DataItemIterator it( m_doc->root() ); *it; ++it ) {
+        K3b::DataItem* item = *it;
         if( item->hideOnRockRidge() ) {
             if( !item->isDir() )  // hiding directories does not work (all dirs point to the dummy-dir)
                 s << escapeGraftPoint( item->localPath() ) << endl;
         }
-        item = item->nextSibling();
     }
 
     return true;
@@ -882,13 +1054,12 @@ bool K3b::IsoImager::writeJolietHideFile()
 
     QTextStream s( m_jolietHideFile );
 
-    K3b::DataItem* item = m_doc->root();
-    while( item ) {
+    for( K3b::DataItemIterator it( m_doc->root() ); *it; ++it ) {
+        K3b::DataItem* item = *it;
         if( item->hideOnRockRidge() ) {
             if( !item->isDir() )  // hiding directories does not work (all dirs point to the dummy-dir but we could introduce a second hidden dummy dir)
                 s << escapeGraftPoint( item->localPath() ) << endl;
         }
-        item = item->nextSibling();
     }
 
     return true;
@@ -908,8 +1079,8 @@ bool K3b::IsoImager::writeSortWeightFile()
     // mkisofs will take care of multiple entries for one local file and always
     // use the highest weight
     //
-    K3b::DataItem* item = m_doc->root();
-    while( (item = item->nextSibling()) ) {  // we skip the root here
+    for( K3b::DataItemIterator it( m_doc->root(), false ); *it; ++it ) {  // we skip the root here
+        K3b::DataItem* item = *it;
         if( item->sortWeight() != 0 ) {
             if( m_doc->bootImages().contains( dynamic_cast<K3b::BootItem*>(item) ) ) { // boot-image-backup-hack
                 s << escapeGraftPoint( static_cast<K3b::BootItem*>(item)->tempPath() ) << " " << item->sortWeight() << endl;
@@ -18,6 +18,7 @@
 #include "k3bjob.h"
 #include "k3bmkisofshandler.h"
 #include "k3bprocess.h"
+#include "k3b_export.h"
 
 #include <QStringList>
 
@@ -28,6 +29,7 @@ namespace K3b {
     class DataDoc;
     class DirItem;
     class FileItem;
+    class IsoOptions;
 
     class IsoImager : public Job, public MkisofsHandler
     {
@@ -166,6 +168,17 @@ namespace K3b {
 
         int m_sessionNumber;
     };
+
+    /**
+     * The order in which mkisofs writes the data of the files below \p root:
+     * the highest sort weight first and, for equal weights, the order of the
+     * directory tree sorted by ISO 9660 names with the files of a folder
+     * before its subfolders.
+     *
+     * The ISO 9660 names are derived from the written names like mkisofs does
+     * except for the shortening of too long names.
+     */
+    LIBK3B_EXPORT QList<FileItem*> mkisofsWriteOrder( DirItem* root, const IsoOptions& options );
 }
 
 #endif
@@ -49,6 +49,7 @@ K3b::IsoOptions::IsoOptions()
     m_jolietLong = true;
 
     m_doNotCacheInodes = true;
+    m_shareIdenticalFiles = false;
     m_doNotImportSession = false;
 
     m_isoLevel = 3;
@@ -121,6 +122,7 @@ void K3b::IsoOptions::save( KConfigGroup c, bool saveVolumeDesc )
     c.writeEntry( "joliet long", m_jolietLong );
 
     c.writeEntry( "do not cache inodes", m_doNotCacheInodes );
+    c.writeEntry( "share identical files", m_shareIdenticalFiles );
     c.writeEntry( "do not import last session", m_doNotImportSession );
 
     // save whitespace-treatment
@@ -196,6 +198,7 @@ K3b::IsoOptions K3b::IsoOptions::load( const KConfigGroup& c, bool loadVolumeDes
     options.setJolietLong( c.readEntry( "joliet long", options.jolietLong() ) );
 
     options.setDoNotCacheInodes( c.readEntry( "do not cache inodes", options.doNotCacheInodes() ) );
+    options.setShareIdenticalFiles( c.readEntry( "share identical files", options.shareIdenticalFiles() ) );
     options.setDoNotImportSession( c.readEntry( "no not import last session", options.doNotImportSession() ) );
 
     QString w = c.readEntry( "white_space_treatment", "noChange" );
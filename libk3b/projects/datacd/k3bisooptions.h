@@ -116,6 +116,14 @@ namespace K3b {
         bool doNotCacheInodes() const { return m_doNotCacheInodes; }
         void setDoNotCacheInodes( bool b ) { m_doNotCacheInodes = b; }
 
+        /**
+         * Search the project for files with identical content and write their
+         * data only once. This needs inode caching and is ignored if
+         * doNotCacheInodes() is set.
+         */
+        bool shareIdenticalFiles() const { return m_shareIdenticalFiles; }
+        void setShareIdenticalFiles( bool b ) { m_shareIdenticalFiles = b; }
+
         bool doNotImportSession() const { return m_doNotImportSession; }
         void setDoNotImportSession( bool b ) { m_doNotImportSession = b; }
 
@@ -167,6 +175,7 @@ namespace K3b {
         bool m_jolietLong;
 
         bool m_doNotCacheInodes;
+        bool m_shareIdenticalFiles;
         bool m_doNotImportSession;
 
         int m_isoLevel;
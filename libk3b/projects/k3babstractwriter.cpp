@@ -29,6 +29,19 @@ K3b::AbstractWriter::AbstractWriter( K3b::Device::Device* dev, K3b::JobHandler*
       m_simulate(false),
       m_sourceUnreadable(false)
 {
+    // writers wrapping another writer forward its signals
+    connect( this, &K3b::AbstractWriter::buffer, this, [this]( int fill ) {
+        if( numRunningSubJobs() == 0 )
+            recordTelemetry( K3b::JobTelemetry::FifoFill, fill );
+    } );
+    connect( this, &K3b::AbstractWriter::deviceBuffer, this, [this]( int fill ) {
+        if( numRunningSubJobs() == 0 )
+            recordTelemetry( K3b::JobTelemetry::DeviceBuffer, fill );
+    } );
+    connect( this, &K3b::AbstractWriter::writeSpeed, this, [this]( int speed, K3b::Device::SpeedMultiplicator ) {
+        if( numRunningSubJobs() == 0 )
+            recordTelemetry( K3b::JobTelemetry::WriteSpeed, speed );
+    } );
 }
 
 
@@ -544,6 +544,7 @@ void K3b::CdrdaoWriter::start()
 
     // lock the device for good in this process since it will
     // be opened in the growisofs process
+    burnDevice()->releaseHandle();
     burnDevice()->close();
     burnDevice()->usageLock();
 
@@ -686,6 +687,7 @@ void K3b::CdrdaoWriter::slotProcessExited( int exitCode, QProcess::ExitStatus ex
 {
     // release the device within this process
     burnDevice()->usageUnlock();
+    burnDevice()->holdHandle();
 
     // unblock the device
     k3bcore->unblockDevice( burnDevice() );
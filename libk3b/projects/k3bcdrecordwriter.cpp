@@ -431,6 +431,7 @@ void K3b::CdrecordWriter::start()
 
     // lock the device for good in this process since it will
     // be opened in the cdrecord process
+    burnDevice()->releaseHandle();
     burnDevice()->close();
     burnDevice()->usageLock();
 
@@ -567,6 +568,7 @@ void K3b::CdrecordWriter::slotStdLine( const QString& line )
             }
 
             d->speedEst->dataWritten( (d->alreadyWritten+made)*1024 );
+            recordTelemetry( K3b::JobTelemetry::Bytes, qint64( d->alreadyWritten+made )*1024LL*1024LL );
         }
     }
 
@@ -773,6 +775,7 @@ void K3b::CdrecordWriter::slotProcessExited( int exitCode, QProcess::ExitStatus
 
     // release the device within this process
     burnDevice()->usageUnlock();
+    burnDevice()->holdHandle();
 
     // unblock the device
     k3bcore->unblockDevice( burnDevice() );
@@ -442,6 +442,7 @@ void K3b::CdrskinWriter::start()
 
     // lock the device for good in this process since it will
     // be opened in the cdrskin process
+    burnDevice()->releaseHandle();
     burnDevice()->close();
     burnDevice()->usageLock();
 
@@ -785,6 +786,7 @@ void K3b::CdrskinWriter::slotProcessExited( int exitCode, QProcess::ExitStatus e
 
     // release the device within this process
     burnDevice()->usageUnlock();
+    burnDevice()->holdHandle();
 
     // unblock the device
     k3bcore->unblockDevice( burnDevice() );
@@ -351,6 +351,7 @@ void K3b::GrowisofsWriter::start()
 
         // lock the device for good in this process since it will
         // be opened in the growisofs process
+        burnDevice()->releaseHandle();
         burnDevice()->close();
         burnDevice()->usageLock();
 
@@ -447,6 +448,7 @@ void K3b::GrowisofsWriter::slotReceivedStderr( const QString& line )
         done -= d->firstSizeFromOutput;
         d->overallSizeFromOutput -= d->firstSizeFromOutput;
         if( ok ) {
+            recordTelemetry( K3b::JobTelemetry::Bytes, qint64( done ) );
             int p = (int)(100 * done / d->overallSizeFromOutput);
             if( p > d->lastProgress ) {
                 emit percent( p );
@@ -496,6 +498,7 @@ void K3b::GrowisofsWriter::slotProcessExited( int exitCode, QProcess::ExitStatus
 
     // release the device within this process
     burnDevice()->usageUnlock();
+    burnDevice()->holdHandle();
 
     // unblock the device
     k3bcore->unblockDevice( burnDevice() );
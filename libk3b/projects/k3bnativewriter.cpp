@@ -0,0 +1,480 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bnativewriter.h"
+#include "k3bnativewritersink.h"
+
+#include "k3bcore.h"
+#include "k3bdevice.h"
+#include "k3bdeviceglobals.h"
+#include "k3bglobals.h"
+#include "k3bglobalsettings.h"
+#include "k3bfanoutbuffer.h"
+#include "k3bactivepipe.h"
+#include "k3bfilesplitter.h"
+#include "k3bthroughputestimator.h"
+#include "k3b_i18n.h"
+
+#include <QDebug>
+#include <QTimer>
+#include <QUrl>
+
+
+namespace {
+    const K3b::Device::MediaTypes s_overwriteMedia = K3b::Device::MEDIA_DVD_PLUS_RW|
+                                                     K3b::Device::MEDIA_DVD_RW_OVWR|
+                                                     K3b::Device::MEDIA_BD_RE;
+
+    const K3b::Device::MediaTypes s_incrementalMedia = K3b::Device::MEDIA_DVD_R|
+                                                       K3b::Device::MEDIA_DVD_R_SEQ|
+                                                       K3b::Device::MEDIA_DVD_R_DL_SEQ|
+                                                       K3b::Device::MEDIA_DVD_RW|
+                                                       K3b::Device::MEDIA_DVD_RW_SEQ;
+
+    const K3b::Device::MediaTypes s_writeOnceMedia = K3b::Device::MEDIA_DVD_PLUS_R|
+                                                     K3b::Device::MEDIA_DVD_PLUS_R_DL|
+                                                     K3b::Device::MEDIA_BD_R|
+                                                     K3b::Device::MEDIA_BD_R_SRM|
+                                                     K3b::Device::MEDIA_BD_R_SRM_POW;
+}
+
+
+class K3b::NativeWriter::Private
+{
+public:
+    /**
+     * The sink of the fan out buffer. It is fed from the buffer's thread
+     * and thus all drive commands are sent from there.
+     */
+    class DriveSink : public NativeWriterSink
+    {
+    public:
+        explicit DriveSink( NativeWriter* writer )
+            : m_writer( writer ) {
+        }
+
+    protected:
+        void blockWritten( qint64 sectorsWritten, int retries ) {
+            if( retries > 0 )
+                m_writer->recordTelemetry( JobTelemetry::Retry, retries );
+            m_writer->recordTelemetry( JobTelemetry::Bytes, sectorsWritten * 2048 );
+        }
+
+    private:
+        NativeWriter* m_writer;
+    };
+
+    Private( NativeWriter* writer )
+        : trackSize( 0 ),
+          trackBytes( 0 ),
+          multiSession( false ),
+          buffer( 0 ),
+          sink( writer ),
+          mediaType( Device::MEDIA_UNKNOWN ),
+          canceled( false ),
+          finished( true ),
+          stopping( false ) {
+    }
+
+    long trackSize;
+    // the exact size of the data, the last sector may be incomplete
+    qint64 trackBytes;
+    bool multiSession;
+    QString image;
+
+    FanOutBuffer* buffer;
+    DriveSink sink;
+    FileSplitter imageFile;
+    ActivePipe imagePipe;
+    ThroughputEstimator* speedEst;
+    QTimer progressTimer;
+
+    Device::MediaType mediaType;
+
+    // GUI thread status
+    bool canceled;
+    bool finished;
+    bool stopping;      // waiting for the buffer thread to stop
+    int lastState;
+    int lastProgress;
+    int lastProcessed;
+};
+
+
+K3b::NativeWriter::NativeWriter( K3b::Device::Device* dev, K3b::JobHandler* hdl,
+                                  QObject* parent )
+    : K3b::AbstractWriter( dev, hdl, parent )
+{
+    d = new Private( this );
+    d->speedEst = new K3b::ThroughputEstimator( this );
+    connect( d->speedEst, SIGNAL(throughput(int)),
+             this, SLOT(slotThroughput(int)) );
+    connect( &d->progressTimer, SIGNAL(timeout()),
+             this, SLOT(slotUpdateProgress()) );
+}
+
+
+K3b::NativeWriter::~NativeWriter()
+{
+    // the job is done by now and the buffer thread has stopped or stops after the current command
+    d->sink.abort();
+    if( d->buffer )
+        d->buffer->abort();
+    delete d->buffer;
+    delete d;
+}
+
+
+bool K3b::NativeWriter::active() const
+{
+    return !d->finished;
+}
+
+
+QIODevice* K3b::NativeWriter::ioDevice() const
+{
+    return d->buffer;
+}
+
+
+void K3b::NativeWriter::setTrackSize( long size )
+{
+    d->trackSize = size;
+}
+
+
+void K3b::NativeWriter::setMultiSession( bool b )
+{
+    d->multiSession = b;
+}
+
+
+void K3b::NativeWriter::setImageToWrite( const QString& filename )
+{
+    d->image = filename;
+}
+
+
+void K3b::NativeWriter::start()
+{
+    jobStarted();
+
+    d->canceled = false;
+    d->finished = false;
+    d->stopping = false;
+    d->lastState = NativeWriterSink::StateIdle;
+    d->lastProgress = 0;
+    d->lastProcessed = 0;
+    d->speedEst->reset();
+
+    emit newSubTask( i18n("Preparing write process...") );
+
+    if( !d->image.isEmpty() ) {
+        d->trackBytes = K3b::imageFilesize( QUrl::fromLocalFile( d->image ) );
+        d->trackSize = ( d->trackBytes + 2047 ) / 2048;
+    }
+    else {
+        d->trackBytes = qint64( d->trackSize ) * 2048;
+    }
+
+    if( d->trackSize <= 0 ) {
+        emit infoMessage( QLatin1String("Internal error: job not setup properly: no track size set! "
+                                        "The application needs fixing!"), MessageError );
+        d->finished = true;
+        jobFinished( false );
+        return;
+    }
+
+    d->mediaType = burnDevice()->mediaType();
+    if( !( d->mediaType & ( s_overwriteMedia|s_incrementalMedia|s_writeOnceMedia ) ) ) {
+        emit infoMessage( i18n("%1 media cannot be written without an external application.",
+                               K3b::Device::mediaTypeString( d->mediaType, true ) ), MessageError );
+        d->finished = true;
+        jobFinished( false );
+        return;
+    }
+
+    // only incremental media know the test write bit, everything else would really be written
+    if( simulate() && !( d->mediaType & s_incrementalMedia ) ) {
+        emit infoMessage( i18n("%1 media do not support write simulation.",
+                               K3b::Device::mediaTypeString( d->mediaType, true ) ), MessageError );
+        d->finished = true;
+        jobFinished( false );
+        return;
+    }
+
+    emit debuggingOutput( "Burned media", K3b::Device::mediaTypeString( d->mediaType ) );
+
+    // FIXME: check the return value
+    if( K3b::isMounted( burnDevice() ) ) {
+        emit infoMessage( i18n("Unmounting medium"), MessageInfo );
+        K3b::unmount( burnDevice() );
+    }
+
+    // block the device (including certain checks)
+    k3bcore->blockDevice( burnDevice() );
+
+    if( !burnDevice()->open( true ) ) {
+        emit infoMessage( i18n("Could not open device %1", burnDevice()->blockDeviceName()), MessageError );
+        k3bcore->unblockDevice( burnDevice() );
+        d->finished = true;
+        jobFinished( false );
+        return;
+    }
+
+    if( d->mediaType & s_incrementalMedia ) {
+        if( !burnDevice()->setIncrementalWriteParameters( simulate(), d->multiSession ) ) {
+            emit infoMessage( i18n("Writing mode Incremental Streaming not available"), MessageError );
+            burnDevice()->close();
+            k3bcore->unblockDevice( burnDevice() );
+            d->finished = true;
+            jobFinished( false );
+            return;
+        }
+    }
+
+    int speed = burnSpeed();
+    if( speed == 0 )
+        speed = burnDevice()->determineMaximalWriteSpeed();
+    if( speed > 0 ) {
+        if( !burnDevice()->setStreaming( speed, d->trackSize - 1 ) &&
+            !burnDevice()->setSpeed( 0xFFFF, speed ) )
+            emit infoMessage( i18n("Unable to set writing speed."), MessageWarning );
+    }
+
+    // overwrite media do not know tracks and sessions
+    int closeFunction = 0;
+    if( !( d->mediaType & s_overwriteMedia ) && !simulate() ) {
+        if( !d->multiSession && ( d->mediaType & s_writeOnceMedia ) )
+            closeFunction = 0x6;  // finalize the disc
+        else
+            closeFunction = 0x2;
+    }
+
+    int bufSize = 32;
+    if( k3bcore->globalSettings()->useManualBufferSize() )
+        bufSize = k3bcore->globalSettings()->bufferSize();
+
+    if( d->buffer )
+        d->buffer->abort();
+    delete d->buffer;
+    d->buffer = new FanOutBuffer( bufSize*1024*1024 );
+    d->buffer->addSink( &d->sink );
+    connect( d->buffer, SIGNAL(sinkFailed(int)), this, SLOT(slotUpdateProgress()) );
+    connect( d->buffer, SIGNAL(sinkFinished(int)), this, SLOT(slotSinkFinished()) );
+    connect( d->buffer, SIGNAL(finished()), this, SLOT(slotBufferFinished()) );
+
+    d->sink.setDevice( burnDevice() );
+    d->sink.prepare( d->trackBytes, closeFunction );
+    d->buffer->open();
+
+    if( !d->image.isEmpty() ) {
+        d->imageFile.close();
+        d->imageFile.setName( d->image );
+        d->imagePipe.close();
+        d->imagePipe.readFrom( &d->imageFile, true );
+        d->imagePipe.writeTo( d->buffer, true );
+        if( !d->imagePipe.open( true ) ) {
+            emit infoMessage( i18n("Could not open file %1.", d->image), MessageError );
+            d->sink.endOfData();
+            slotUpdateProgress();
+            return;
+        }
+    }
+
+    if( simulate() ) {
+        emit newTask( i18n("Simulating") );
+        emit infoMessage( i18n("Starting simulation..."), MessageInfo );
+    }
+    else {
+        emit newTask( i18n("Writing") );
+        emit infoMessage( i18n("Starting disc write..."), MessageInfo );
+    }
+    emit newSubTask( i18n("Writing data") );
+
+    d->progressTimer.start( 500 );
+}
+
+
+void K3b::NativeWriter::cancel()
+{
+    if( active() ) {
+        d->canceled = true;
+        d->sink.abort();
+        finishJob();
+    }
+}
+
+
+void K3b::NativeWriter::slotSinkFinished()
+{
+    // the data source closed the stream before the whole track was written
+    d->sink.endOfData();
+    slotUpdateProgress();
+}
+
+
+void K3b::NativeWriter::slotUpdateProgress()
+{
+    if( d->finished || d->stopping )
+        return;
+
+    const int state = d->sink.state();
+    const qint64 sectors = d->sink.sectorsWritten();
+
+    const int p = int( 100 * sectors / d->trackSize );
+    if( p > d->lastProgress ) {
+        d->lastProgress = p;
+        emit percent( p );
+        emit subPercent( p );
+    }
+
+    // 512 sectors are one MB
+    const int processed = int( sectors / 512 );
+    if( processed > d->lastProcessed ) {
+        d->lastProcessed = processed;
+        emit processedSize( processed, int( d->trackSize / 512 ) );
+        emit processedSubSize( processed, int( d->trackSize / 512 ) );
+    }
+
+    d->speedEst->dataWritten( sectors * 2 );
+
+    if( d->buffer )
+        emit buffer( d->buffer->fillLevel( 0 ) );
+    if( d->sink.deviceBufferFill() >= 0 )
+        emit deviceBuffer( d->sink.deviceBufferFill() );
+
+    if( state != d->lastState ) {
+        d->lastState = state;
+        if( state == NativeWriterSink::StateFlushing ) {
+            emit newSubTask( i18n("Flushing Cache") );
+            emit infoMessage( i18n("Flushing the cache may take some time."), MessageInfo );
+        }
+        else if( state == NativeWriterSink::StateClosing ) {
+            emit newSubTask( i18n("Closing Session") );
+            emit infoMessage( i18n("Closing Session..."), MessageInfo );
+        }
+    }
+
+    if( state == NativeWriterSink::StateDone || state == NativeWriterSink::StateFailed )
+        finishJob();
+}
+
+
+void K3b::NativeWriter::slotThroughput( int t )
+{
+    emit writeSpeed( t, K3b::speedMultiplicatorForMediaType( d->mediaType ) );
+}
+
+
+void K3b::NativeWriter::slotBufferFinished()
+{
+    if( d->stopping )
+        completeJob();
+}
+
+
+void K3b::NativeWriter::finishJob()
+{
+    if( d->stopping )
+        return;
+    d->stopping = true;
+    d->progressTimer.stop();
+
+    //
+    // The buffer thread has either finished writing or stops after the current drive
+    // command. We do not wait for it here, that might take a while. The device is
+    // closed once it is done, see slotBufferFinished().
+    //
+    if( d->buffer )
+        d->buffer->stop();
+    d->imagePipe.close();
+
+    if( !d->buffer || !d->buffer->running() )
+        completeJob();
+}
+
+
+void K3b::NativeWriter::completeJob()
+{
+    d->stopping = false;
+    d->finished = true;
+
+    burnDevice()->close();
+    k3bcore->unblockDevice( burnDevice() );
+
+    if( d->canceled ) {
+        // this will unblock and eject the drive and emit the finished/canceled signals
+        K3b::AbstractWriter::cancel();
+        return;
+    }
+
+    const bool success = ( d->sink.state() == NativeWriterSink::StateDone );
+
+    if( d->sink.deviceBufferSamples() > 0 ) {
+        emit infoMessage( i18n("Drive buffer fill: %1% on average, %2% minimum.",
+                               d->sink.averageDeviceBufferFill(), d->sink.minDeviceBufferFill() ), MessageInfo );
+        if( d->sink.deviceBufferEmptyCount() > 0 )
+            emit infoMessage( i18np("The drive buffer ran empty once.",
+                                    "The drive buffer ran empty %1 times.",
+                                    d->sink.deviceBufferEmptyCount() ), MessageWarning );
+    }
+    emit debuggingOutput( "Native writer",
+                          QString::fromLatin1( "sectors written: %1, write retries: %2, drive buffer samples: %3, drive buffer empty: %4" )
+                          .arg( d->sink.sectorsWritten() )
+                          .arg( d->sink.writeRetries() )
+                          .arg( d->sink.deviceBufferSamples() )
+                          .arg( d->sink.deviceBufferEmptyCount() ) );
+
+    if( success ) {
+        emit percent( 100 );
+        emit processedSize( d->trackSize / 512, d->trackSize / 512 );
+
+        int s = d->speedEst->average();
+        if( s > 0 ) {
+            const int m = K3b::speedMultiplicatorForMediaType( d->mediaType );
+            emit infoMessage( ki18n("Average overall write speed: %1 KB/s (%2x)")
+                              .subs( s )
+                              .subs( ( double )s/( double )m, 0, 'g', 2 ).toString(), MessageInfo );
+        }
+
+        if( simulate() )
+            emit infoMessage( i18n("Simulation successfully completed"), MessageSuccess );
+        else
+            emit infoMessage( i18n("Writing successfully completed"), MessageSuccess );
+    }
+    else if( !wasSourceUnreadable() ) {
+        switch( d->sink.error() ) {
+        case NativeWriterSink::ErrorNone:
+        case NativeWriterSink::ErrorAborted:
+            break;
+        case NativeWriterSink::ErrorWrite:
+            emit infoMessage( i18n("Write error"), MessageError );
+            break;
+        case NativeWriterSink::ErrorTooMuchData:
+            emit infoMessage( i18n("Data does not fit on disk."), MessageError );
+            break;
+        case NativeWriterSink::ErrorTooLittleData:
+            emit infoMessage( i18n("The data stream ended before the whole track was written."), MessageError );
+            break;
+        case NativeWriterSink::ErrorFlush:
+            emit infoMessage( i18n("Unable to flush the drive cache."), MessageError );
+            break;
+        case NativeWriterSink::ErrorClose:
+            emit infoMessage( i18n("Unable to close the track or session."), MessageError );
+            break;
+        }
+    }
+
+    jobFinished( success );
+}
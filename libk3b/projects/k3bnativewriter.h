@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef _K3B_NATIVE_WRITER_H_
+#define _K3B_NATIVE_WRITER_H_
+
+#include "k3babstractwriter.h"
+
+
+namespace K3b {
+    namespace Device {
+        class Device;
+    }
+
+    /**
+     * The native writer writes a single data track to DVD and Blu-ray media
+     * without the help of an external application. The data is buffered in
+     * a FanOutBuffer and written to the drive via WRITE 10 from a separate
+     * thread, see NativeWriterSink.
+     *
+     * Supported are empty DVD+R(W), DVD-R(W), BD-R, and BD-RE media.
+     * Appending sessions to non-empty media is not supported.
+     *
+     * Since the track size is known in advance, progress is reported with
+     * sector granularity and the drive buffer fill level is read directly
+     * via READ BUFFER CAPACITY.
+     */
+    class NativeWriter : public AbstractWriter
+    {
+        Q_OBJECT
+
+    public:
+        NativeWriter( Device::Device*, JobHandler*,
+                      QObject* parent = 0 );
+        ~NativeWriter();
+
+        bool active() const;
+
+        /**
+         * The data to write. Only valid while the writer is active and
+         * no image has been set via setImageToWrite().
+         */
+        QIODevice* ioDevice() const;
+
+    public Q_SLOTS:
+        void start();
+        void cancel();
+
+        /**
+         * @param size size in blocks. Mandatory when writing from ioDevice().
+         */
+        void setTrackSize( long size );
+
+        /**
+         * If false the disc is finalized after writing.
+         */
+        void setMultiSession( bool b );
+
+        /**
+         * set this to QString() or an empty string to let the writer
+         * read it's data from ioDevice()
+         */
+        void setImageToWrite( const QString& );
+
+    private Q_SLOTS:
+        void slotUpdateProgress();
+        void slotSinkFinished();
+        void slotThroughput( int t );
+        void slotBufferFinished();
+
+    private:
+        void finishJob();
+        void completeJob();
+
+        class Private;
+        Private* d;
+    };
+}
+
+#endif
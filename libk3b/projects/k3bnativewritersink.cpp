@@ -0,0 +1,411 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bnativewritersink.h"
+
+#include "k3bdevice.h"
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QThread>
+
+#include <string.h>
+
+
+namespace {
+    // 32 sectors are two DVD ECC blocks and one BD cluster
+    const int s_blockSectors = 32;
+    const int s_blockSize = s_blockSectors*2048;
+
+    // a busy drive rejects writes while it empties its buffer ("long write in progress")
+    const int s_writeRetryTimeout = 30*1000;
+    const int s_writeRetryInterval = 20;
+    const int s_senseLongWriteInProgress = 0x020408;  // NOT READY, 04/08
+
+    // flushing the cache and closing the disc may take several minutes
+    const int s_closeTimeout = 15*60*1000;
+    const int s_readyPollInterval = 100;
+
+    // the minimal interval between two READ BUFFER CAPACITY commands
+    const int s_bufferQueryInterval = 250;
+}
+
+
+class K3b::NativeWriterSink::Private
+{
+public:
+    Private( NativeWriterSink* q_ )
+        : q( q_ ),
+          device( 0 ),
+          trackBytes( 0 ),
+          closeFunction( 0 ),
+          blockFill( 0 ),
+          nextLba( 0 ) {
+    }
+
+    bool writeBlock( const char* data, int sectors );
+    void queryDeviceBuffer();
+    void finishWriting();
+    bool waitUntilReady();
+    void fail( Error e );
+
+    NativeWriterSink* q;
+    Device::Device* device;
+
+    qint64 trackBytes;
+    int closeFunction;
+
+    // only touched in the writing thread
+    QByteArray block;
+    int blockFill;
+    unsigned long nextLba;
+    QElapsedTimer lastBufferQuery;
+
+    // shared with the other threads
+    QAtomicInt state;
+    QAtomicInt error;
+    QAtomicInt sectorsWritten;
+    QAtomicInt deviceFill;
+    QAtomicInt abortRequested;
+    QAtomicInt writeRetries;
+
+    // statistics, only read once the state is done or failed
+    int bufferSamples;
+    qint64 bufferFillSum;
+    int bufferMinFill;
+    int bufferEmptyCount;
+};
+
+
+bool K3b::NativeWriterSink::Private::writeBlock( const char* data, int sectors )
+{
+    QElapsedTimer timer;
+    timer.start();
+    int retries = 0;
+    int ret = 0;
+    while( ( ret = q->writeSectors( reinterpret_cast<const unsigned char*>( data ), nextLba, sectors ) ) != 0 ) {
+        // everything but a busy drive is fatal
+        if( ret != s_senseLongWriteInProgress ) {
+            qDebug() << "(K3b::NativeWriterSink) write failed at" << nextLba << "with sense" << QString::number( ret, 16 );
+            fail( ErrorWrite );
+            return false;
+        }
+        if( abortRequested.load() ) {
+            fail( ErrorAborted );
+            return false;
+        }
+        if( timer.elapsed() > s_writeRetryTimeout ) {
+            fail( ErrorWrite );
+            return false;
+        }
+        writeRetries.ref();
+        ++retries;
+        QThread::msleep( s_writeRetryInterval );
+    }
+
+    nextLba += sectors;
+    const int written = sectorsWritten.fetchAndAddOrdered( sectors ) + sectors;
+    q->blockWritten( written, retries );
+
+    if( !lastBufferQuery.isValid() || lastBufferQuery.elapsed() >= s_bufferQueryInterval )
+        queryDeviceBuffer();
+
+    return true;
+}
+
+
+void K3b::NativeWriterSink::Private::queryDeviceBuffer()
+{
+    lastBufferQuery.start();
+
+    long long length = 0, available = 0;
+    if( q->readBufferCapacity( length, available ) && length > 0 ) {
+        const int fill = int( 100 * ( length - available ) / length );
+        deviceFill.store( fill );
+
+        if( fill == 0 && bufferSamples > 0 )
+            ++bufferEmptyCount;
+        ++bufferSamples;
+        bufferFillSum += fill;
+        bufferMinFill = qMin( bufferMinFill, fill );
+    }
+}
+
+
+bool K3b::NativeWriterSink::Private::waitUntilReady()
+{
+    QElapsedTimer timer;
+    timer.start();
+    while( !q->unitReady() ) {
+        if( abortRequested.load() || timer.elapsed() > s_closeTimeout )
+            return false;
+        QThread::msleep( s_readyPollInterval );
+    }
+    return true;
+}
+
+
+void K3b::NativeWriterSink::Private::finishWriting()
+{
+    if( abortRequested.load() ) {
+        fail( ErrorAborted );
+        return;
+    }
+
+    state.storeRelease( StateFlushing );
+    if( !q->flushCache() || !waitUntilReady() ) {
+        fail( abortRequested.load() ? ErrorAborted : ErrorFlush );
+        return;
+    }
+
+    if( closeFunction != 0 ) {
+        state.storeRelease( StateClosing );
+
+        // we always write the first track of the first session
+        if( !q->closeTrackSession( 0x1, 1 ) || !waitUntilReady() ||
+            !q->closeTrackSession( closeFunction, 0 ) || !waitUntilReady() ) {
+            fail( abortRequested.load() ? ErrorAborted : ErrorClose );
+            return;
+        }
+    }
+
+    state.storeRelease( StateDone );
+}
+
+
+void K3b::NativeWriterSink::Private::fail( Error e )
+{
+    if( state.load() == StateFailed )
+        return;
+    error.store( e );
+    state.storeRelease( StateFailed );
+}
+
+
+K3b::NativeWriterSink::NativeWriterSink( Device::Device* dev )
+    : d( new Private( this ) )
+{
+    d->device = dev;
+    prepare( 0, 0 );
+    d->state.store( StateIdle );
+}
+
+
+K3b::NativeWriterSink::~NativeWriterSink()
+{
+    delete d;
+}
+
+
+void K3b::NativeWriterSink::setDevice( Device::Device* dev )
+{
+    d->device = dev;
+}
+
+
+K3b::Device::Device* K3b::NativeWriterSink::device() const
+{
+    return d->device;
+}
+
+
+void K3b::NativeWriterSink::prepare( qint64 bytes, int closeFunction )
+{
+    d->trackBytes = bytes;
+    d->closeFunction = closeFunction;
+
+    d->block.resize( s_blockSize );
+    d->blockFill = 0;
+    d->nextLba = 0;
+    d->lastBufferQuery.invalidate();
+
+    d->state.store( StateWriting );
+    d->error.store( ErrorNone );
+    d->sectorsWritten.store( 0 );
+    d->deviceFill.store( -1 );
+    d->abortRequested.store( 0 );
+    d->writeRetries.store( 0 );
+
+    d->bufferSamples = 0;
+    d->bufferFillSum = 0;
+    d->bufferMinFill = 100;
+    d->bufferEmptyCount = 0;
+}
+
+
+void K3b::NativeWriterSink::abort()
+{
+    d->abortRequested.store( 1 );
+}
+
+
+bool K3b::NativeWriterSink::abortRequested() const
+{
+    return d->abortRequested.load() != 0;
+}
+
+
+void K3b::NativeWriterSink::endOfData()
+{
+    if( d->state.load() == StateWriting )
+        d->fail( ErrorTooLittleData );
+}
+
+
+K3b::NativeWriterSink::State K3b::NativeWriterSink::state() const
+{
+    return State( d->state.loadAcquire() );
+}
+
+
+K3b::NativeWriterSink::Error K3b::NativeWriterSink::error() const
+{
+    return Error( d->error.load() );
+}
+
+
+qint64 K3b::NativeWriterSink::sectorsWritten() const
+{
+    return d->sectorsWritten.load();
+}
+
+
+int K3b::NativeWriterSink::writeRetries() const
+{
+    return d->writeRetries.load();
+}
+
+
+int K3b::NativeWriterSink::deviceBufferFill() const
+{
+    return d->deviceFill.load();
+}
+
+
+int K3b::NativeWriterSink::deviceBufferSamples() const
+{
+    return d->bufferSamples;
+}
+
+
+int K3b::NativeWriterSink::averageDeviceBufferFill() const
+{
+    return d->bufferSamples > 0 ? int( d->bufferFillSum / d->bufferSamples ) : 0;
+}
+
+
+int K3b::NativeWriterSink::minDeviceBufferFill() const
+{
+    return d->bufferMinFill;
+}
+
+
+int K3b::NativeWriterSink::deviceBufferEmptyCount() const
+{
+    return d->bufferEmptyCount;
+}
+
+
+qint64 K3b::NativeWriterSink::readData( char*, qint64 )
+{
+    return -1;
+}
+
+
+qint64 K3b::NativeWriterSink::writeData( const char* data, qint64 len )
+{
+    if( d->abortRequested.load() ) {
+        d->fail( ErrorAborted );
+        return -1;
+    }
+
+    if( d->state.load() != StateWriting ) {
+        d->fail( ErrorTooMuchData );
+        return -1;
+    }
+
+    const char* p = data;
+    qint64 remaining = len;
+
+    while( remaining > 0 ) {
+        const qint64 n = qMin<qint64>( remaining, s_blockSize - d->blockFill );
+        ::memcpy( d->block.data() + d->blockFill, p, n );
+        d->blockFill += n;
+        p += n;
+        remaining -= n;
+
+        const qint64 bytesSoFar = qint64( d->sectorsWritten.load() ) * 2048 + d->blockFill;
+        if( bytesSoFar > d->trackBytes ) {
+            d->fail( ErrorTooMuchData );
+            return -1;
+        }
+
+        const bool lastBlock = ( bytesSoFar == d->trackBytes );
+        if( d->blockFill == s_blockSize || lastBlock ) {
+            // pad an incomplete last sector
+            const int sectors = ( d->blockFill + 2047 ) / 2048;
+            ::memset( d->block.data() + d->blockFill, 0, sectors*2048 - d->blockFill );
+
+            if( !d->writeBlock( d->block.constData(), sectors ) )
+                return -1;
+            d->blockFill = 0;
+
+            if( lastBlock ) {
+                if( remaining > 0 ) {
+                    d->fail( ErrorTooMuchData );
+                    return -1;
+                }
+                d->finishWriting();
+            }
+        }
+    }
+
+    return len;
+}
+
+
+int K3b::NativeWriterSink::writeSectors( const unsigned char* data, unsigned long lba, int sectors )
+{
+    return d->device->write10( data, sectors*2048, lba, sectors );
+}
+
+
+bool K3b::NativeWriterSink::flushCache()
+{
+    return d->device->synchronizeCache( true );
+}
+
+
+bool K3b::NativeWriterSink::closeTrackSession( int function, int trackNumber )
+{
+    return d->device->closeTrackSession( function, trackNumber, true );
+}
+
+
+bool K3b::NativeWriterSink::unitReady()
+{
+    return d->device->testUnitReady();
+}
+
+
+bool K3b::NativeWriterSink::readBufferCapacity( long long& length, long long& available )
+{
+    return d->device->readBufferCapacity( length, available ) == 0;
+}
+
+
+void K3b::NativeWriterSink::blockWritten( qint64, int )
+{
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef _K3B_NATIVE_WRITER_SINK_H_
+#define _K3B_NATIVE_WRITER_SINK_H_
+
+#include "k3b_export.h"
+
+#include <QIODevice>
+
+
+namespace K3b {
+    namespace Device {
+        class Device;
+    }
+
+    /**
+     * The device the NativeWriter writes its data to. It collects the data in
+     * blocks of 32 sectors and writes them to the drive via WRITE 10. Once the
+     * whole track has been written the drive cache is flushed and the track
+     * and session are closed.
+     *
+     * The sink is fed from the thread of a FanOutBuffer and thus all drive
+     * commands are sent from there. The status may be read from any thread.
+     */
+    class LIBK3B_EXPORT NativeWriterSink : public QIODevice
+    {
+    public:
+        enum State {
+            StateIdle,
+            StateWriting,
+            StateFlushing,
+            StateClosing,
+            StateDone,
+            StateFailed
+        };
+
+        enum Error {
+            ErrorNone,
+            ErrorWrite,
+            ErrorTooMuchData,
+            ErrorTooLittleData,
+            ErrorFlush,
+            ErrorClose,
+            ErrorAborted
+        };
+
+        explicit NativeWriterSink( Device::Device* dev = 0 );
+        ~NativeWriterSink();
+
+        void setDevice( Device::Device* dev );
+        Device::Device* device() const;
+
+        /**
+         * Prepares writing a track of \p bytes bytes. An incomplete last
+         * sector is padded with zeros.
+         *
+         * \param closeFunction The CLOSE TRACK/SESSION function used to close
+         *        the session once the track has been written or 0 to leave
+         *        the track and session open.
+         */
+        void prepare( qint64 bytes, int closeFunction );
+
+        /**
+         * Makes the writing thread stop as soon as possible, including the
+         * waits for a busy drive. May be called from any thread.
+         */
+        void abort();
+        bool abortRequested() const;
+
+        /**
+         * To be called once the data source is done. Fails the track if
+         * it has not been written completely.
+         */
+        void endOfData();
+
+        State state() const;
+        Error error() const;
+        qint64 sectorsWritten() const;
+        int writeRetries() const;
+
+        /**
+         * \return The fill level of the drive buffer in percent or -1 if unknown.
+         */
+        int deviceBufferFill() const;
+
+        /**
+         * Drive buffer statistics. Only valid once the state is done or failed.
+         */
+        int deviceBufferSamples() const;
+        int averageDeviceBufferFill() const;
+        int minDeviceBufferFill() const;
+        int deviceBufferEmptyCount() const;
+
+    protected:
+        qint64 readData( char* data, qint64 max );
+        qint64 writeData( const char* data, qint64 len );
+
+        /**
+         * The drive commands. They are called from the writing thread.
+         *
+         * \return The sense data of a failed WRITE 10 as returned by
+         *         Device::write10() or 0 on success.
+         */
+        virtual int writeSectors( const unsigned char* data, unsigned long lba, int sectors );
+        virtual bool flushCache();
+        virtual bool closeTrackSession( int function, int trackNumber );
+        virtual bool unitReady();
+        virtual bool readBufferCapacity( long long& length, long long& available );
+
+        /**
+         * Called from the writing thread after each block written to the drive.
+         * The default implementation does nothing.
+         */
+        virtual void blockWritten( qint64 sectorsWritten, int retries );
+
+    private:
+        class Private;
+        Private* const d;
+    };
+}
+
+#endif
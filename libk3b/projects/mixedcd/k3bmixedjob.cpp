@@ -18,6 +18,7 @@
 #include "k3bfilesplitter.h"
 
 #include "k3bdatadoc.h"
+#include "k3bdatadocwatcher.h"
 #include "k3bisoimager.h"
 #include "k3bisooptions.h"
 #include "k3bmsinfofetcher.h"
@@ -82,7 +83,12 @@ class K3b::MixedJob::Private
 {
 public:
     Private()
-        : maxSpeedJob(0) {
+        : maxSpeedJob(0),
+          concurrentImaging(false),
+          isoImageCreated(false),
+          audioImageCreated(false),
+          isoImagePercent(0),
+          audioImagePercent(0) {
     }
 
 
@@ -95,6 +101,13 @@ public:
     ActivePipe pipe;
 
     FileSplitter dataImageFile;
+
+    // the audio and the data image are created at the same time
+    bool concurrentImaging;
+    bool isoImageCreated;
+    bool audioImageCreated;
+    int isoImagePercent;
+    int audioImagePercent;
 };
 
 
@@ -127,6 +140,10 @@ K3b::MixedJob::MixedJob( K3b::MixedDoc* doc, K3b::JobHandler* hdl, QObject* pare
 
     m_writer = 0;
     m_tocFile = 0;
+
+    // the items must not change while the imager threads read them
+    connect( this, &Job::started, this, [this]() { m_doc->dataDoc()->watcher()->suspend( this ); } );
+    connect( this, &Job::finished, this, [this]() { m_doc->dataDoc()->watcher()->resume( this ); } );
 }
 
 
@@ -162,10 +179,14 @@ void K3b::MixedJob::start()
     d->copies = m_doc->copies();
     m_currentAction = PREPARING_DATA;
     d->maxSpeed = false;
+    d->concurrentImaging = false;
 
     if( m_doc->dummy() )
         d->copies = 1;
 
+    // the levels are computed while decoding and handed to the normalize job
+    m_audioImager->setAnalyzeLevels( m_doc->audioDoc()->normalize() && !m_doc->onTheFly() );
+
     prepareProgressInformation();
 
     //
@@ -237,8 +258,8 @@ void K3b::MixedJob::start()
 void K3b::MixedJob::startFirstCopy()
 {
     //
-    // if not onthefly create the iso image and then the wavs
-    // and write then
+    // if not onthefly create the iso image and the wavs at the same time
+    // and write them
     // if onthefly calculate the iso size
     //
     if( m_doc->onTheFly() ) {
@@ -274,8 +295,6 @@ void K3b::MixedJob::startFirstCopy()
     else {
         emit burning(false);
 
-        emit infoMessage( i18n("Creating audio image files in %1",m_doc->tempDir()), MessageInfo );
-
         m_tempFilePrefix = K3b::findUniqueFilePrefix( ( !m_doc->audioDoc()->title().isEmpty()
                                                         ? m_doc->audioDoc()->title()
                                                         : m_doc->dataDoc()->isoOptions().volumeID() ),
@@ -284,9 +303,20 @@ void K3b::MixedJob::startFirstCopy()
         m_tempData->prepareTempFileNames( m_doc->tempDir() );
 
         if( m_doc->mixedType() != K3b::MixedDoc::DATA_SECOND_SESSION ) {
-            createIsoImage();
+            createImages();
         }
         else {
+            //
+            // The data image of the second session depends on the msinfo which we
+            // only get after writing the first session.
+            //
+            if( !checkTempSpace( m_doc->audioDoc()->length().audioBytes() ) ) {
+                cleanupAfterError();
+                jobFinished( false );
+                return;
+            }
+
+            emit infoMessage( i18n("Creating audio image files in %1",m_doc->tempDir()), MessageInfo );
             emit newTask( i18n("Creating audio image files") );
             m_currentAction = CREATING_AUDIO_IMAGE;
             m_audioImager->start();
@@ -501,9 +531,9 @@ void K3b::MixedJob::slotIsoImagerFinished( bool success )
                 }
             }
             else {
-                emit newTask( i18n("Creating audio image files") );
-                m_currentAction = CREATING_AUDIO_IMAGE;
-                m_audioImager->start();
+                d->isoImageCreated = true;
+                if( d->audioImageCreated )
+                    imagesCreated();
             }
         }
     }
@@ -593,19 +623,29 @@ void K3b::MixedJob::slotAudioDecoderFinished( bool success )
     else {
         emit infoMessage( i18n("Audio images successfully created."), MessageSuccess );
 
-        if( m_doc->audioDoc()->normalize() ) {
-            normalizeFiles();
-        }
-        else {
-            if( m_doc->mixedType() == K3b::MixedDoc::DATA_FIRST_TRACK )
-                m_currentAction = WRITING_ISO_IMAGE;
-            else
-                m_currentAction = WRITING_AUDIO_IMAGE;
+        d->audioImageCreated = true;
+        if( !d->concurrentImaging || d->isoImageCreated )
+            imagesCreated();
+    }
+}
 
-            if( !prepareWriter() || !startWriting() ) {
-                cleanupAfterError();
-                jobFinished(false);
-            }
+
+void K3b::MixedJob::imagesCreated()
+{
+    d->concurrentImaging = false;
+
+    if( m_doc->audioDoc()->normalize() ) {
+        normalizeFiles();
+    }
+    else {
+        if( m_doc->mixedType() == K3b::MixedDoc::DATA_FIRST_TRACK )
+            m_currentAction = WRITING_ISO_IMAGE;
+        else
+            m_currentAction = WRITING_AUDIO_IMAGE;
+
+        if( !prepareWriter() || !startWriting() ) {
+            cleanupAfterError();
+            jobFinished(false);
         }
     }
 }
@@ -931,8 +971,11 @@ void K3b::MixedJob::slotWriterJobPercent( int p )
 
 void K3b::MixedJob::slotAudioDecoderPercent( int p )
 {
-    // the only thing finished here might be the isoimager which is part of this task
-    if( !m_doc->onTheFly() ) {
+    if( d->concurrentImaging ) {
+        d->audioImagePercent = p;
+        emitImageCreationProgress();
+    }
+    else if( !m_doc->onTheFly() ) {
         double totalTasks = d->copies+1;
         if( m_doc->audioDoc()->normalize() )
             totalTasks+=1.0;
@@ -949,7 +992,8 @@ void K3b::MixedJob::slotAudioDecoderPercent( int p )
 
 void K3b::MixedJob::slotAudioDecoderSubPercent( int p )
 {
-    if( !m_doc->onTheFly() ) {
+    // while creating both images the sub progress is the combined one
+    if( !m_doc->onTheFly() && !d->concurrentImaging ) {
         emit subPercent( p );
     }
 }
@@ -957,7 +1001,11 @@ void K3b::MixedJob::slotAudioDecoderSubPercent( int p )
 
 void K3b::MixedJob::slotIsoImagerPercent( int p )
 {
-    if( !m_doc->onTheFly() ) {
+    if( d->concurrentImaging ) {
+        d->isoImagePercent = p;
+        emitImageCreationProgress();
+    }
+    else if( !m_doc->onTheFly() ) {
         emit subPercent( p );
         if( m_doc->mixedType() == K3b::MixedDoc::DATA_SECOND_SESSION ) {
 
@@ -1075,6 +1123,71 @@ bool K3b::MixedJob::startWriting()
 }
 
 
+void K3b::MixedJob::emitImageCreationProgress()
+{
+    // both imagers contribute to the first task according to their share of the project
+    const int p = (int)((double)d->isoImagePercent*(1.0-m_audioDocPartOfProcess) +
+                        (double)d->audioImagePercent*m_audioDocPartOfProcess);
+
+    double totalTasks = d->copies+1.0;
+    if( m_doc->audioDoc()->normalize() )
+        totalTasks+=1.0;
+
+    emit subPercent( p );
+    emit percent( (int)((double)p / totalTasks) );
+}
+
+
+bool K3b::MixedJob::checkTempSpace( KIO::filesize_t bytesNeeded )
+{
+    unsigned long avail, size;
+    QString pathToTest = m_doc->tempDir();
+    if( !K3b::kbFreeOnFs( pathToTest, size, avail ) ) {
+        emit infoMessage( i18n("Unable to determine free space in temporary folder '%1'.",pathToTest), MessageError );
+        return false;
+    }
+    else if( avail < bytesNeeded/1024 ) {
+        emit infoMessage( i18n("Not enough space left in temporary folder."), MessageError );
+        return false;
+    }
+    return true;
+}
+
+
+void K3b::MixedJob::createImages()
+{
+    //
+    // Decoding the audio tracks is mostly CPU bound while mkisofs mostly waits for the
+    // disk. Thus we create both images at the same time. They both end up in the temp
+    // folder which needs to hold them at once.
+    //
+    KIO::filesize_t spaceNeeded = (KIO::filesize_t)m_isoImager->size()*2048;
+    K3b::AudioTrack* track = m_doc->audioDoc()->firstTrack();
+    while( track ) {
+        spaceNeeded += track->length().audioBytes() + 44;  // wave header
+        track = track->next();
+    }
+    if( !checkTempSpace( spaceNeeded ) ) {
+        cleanupAfterError();
+        jobFinished( false );
+        return;
+    }
+
+    emit newTask( i18n("Creating image files") );
+    emit infoMessage( i18n("Creating audio image files in %1",m_doc->tempDir()), MessageInfo );
+
+    d->concurrentImaging = true;
+    d->isoImageCreated = d->audioImageCreated = false;
+    d->isoImagePercent = d->audioImagePercent = 0;
+
+    createIsoImage();
+    if( m_errorOccuredAndAlreadyReported )
+        return;
+
+    m_audioImager->start();
+}
+
+
 void K3b::MixedJob::createIsoImage()
 {
     m_currentAction = CREATING_ISO_IMAGE;
@@ -1082,7 +1195,7 @@ void K3b::MixedJob::createIsoImage()
     // prepare iso image file
     m_isoImageFilePath = m_tempFilePrefix + "_datatrack.iso";
 
-    if( !m_doc->onTheFly() )
+    if( !m_doc->onTheFly() && !d->concurrentImaging )
         emit newTask( i18n("Creating ISO image file") );
     emit newSubTask( i18n("Creating ISO image in %1", m_isoImageFilePath) );
     emit infoMessage( i18n("Creating ISO image in %1", m_isoImageFilePath), MessageInfo );
@@ -1106,6 +1219,9 @@ void K3b::MixedJob::cleanupAfterError()
 {
     m_errorOccuredAndAlreadyReported = true;
     //  m_audioImager->cancel();
+    if( d->concurrentImaging && m_audioImager->active() )
+        m_audioImager->cancel();
+    d->concurrentImaging = false;
     m_isoImager->cancel();
     if( m_writer && m_writer->active() )
         m_writer->cancel();
@@ -1271,6 +1387,7 @@ void K3b::MixedJob::normalizeFiles()
     }
 
     m_normalizeJob->setFilesToNormalize( files );
+    m_normalizeJob->setTrackLevels( m_audioImager->trackLevels() );
 
     emit newTask( i18n("Normalizing volume levels") );
     m_normalizeJob->start();
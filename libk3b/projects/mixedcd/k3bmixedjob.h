@@ -18,6 +18,8 @@
 
 #include "k3bjob.h"
 
+#include <KIOCore/KIO/Global>
+
 class QTemporaryFile;
 
 namespace K3b {
@@ -94,6 +96,10 @@ namespace K3b {
         void cleanupAfterError();
         void removeBufferFiles();
         void createIsoImage();
+        void createImages();
+        void imagesCreated();
+        bool checkTempSpace( KIO::filesize_t bytesNeeded );
+        void emitImageCreationProgress();
         void determineWritingMode();
         void normalizeFiles();
         void prepareProgressInformation();
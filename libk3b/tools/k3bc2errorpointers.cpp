@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bc2errorpointers.h"
+
+#include <QDebug>
+
+
+K3b::C2ErrorPointers::C2ErrorPointers()
+    : m_enabled( false ),
+      m_driveSupport( false ),
+      m_verified( false )
+{
+}
+
+
+bool K3b::C2ErrorPointers::supportedByDrive( const unsigned char* modePage, int len )
+{
+    // byte 5, bit 4 of the page: C2 Pointers are supported
+    return( len > 8+5 && ( modePage[8+5] & 0x10 ) );
+}
+
+
+void K3b::C2ErrorPointers::setEnabled( bool b )
+{
+    m_enabled = b;
+}
+
+
+bool K3b::C2ErrorPointers::enabled() const
+{
+    return m_enabled;
+}
+
+
+void K3b::C2ErrorPointers::setDriveSupport( bool b )
+{
+    m_driveSupport = b;
+    m_verified = false;
+}
+
+
+bool K3b::C2ErrorPointers::active() const
+{
+    return( m_enabled && m_driveSupport );
+}
+
+
+void K3b::C2ErrorPointers::readFinished( bool success )
+{
+    if( success ) {
+        m_verified = true;
+    }
+    else if( !m_verified && m_driveSupport ) {
+        qDebug() << "(K3b::C2ErrorPointers) reading with C2 error pointers failed. Disabling C2 mode.";
+        m_driveSupport = false;
+    }
+}
+
+
+void K3b::C2ErrorPointers::countReRead( unsigned int track )
+{
+    ++m_reReadSectors[track];
+}
+
+
+void K3b::C2ErrorPointers::resetCounters()
+{
+    m_reReadSectors.clear();
+}
+
+
+long K3b::C2ErrorPointers::reReadSectors( unsigned int track ) const
+{
+    if( active() )
+        return m_reReadSectors.value( track, 0 );
+    else
+        return -1;
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef _K3B_C2_ERROR_POINTERS_H_
+#define _K3B_C2_ERROR_POINTERS_H_
+
+#include "k3b_export.h"
+
+#include <QHash>
+
+
+namespace K3b {
+    /**
+     * Decides if audio is read with C2 error pointers and counts the sectors
+     * which had to be read again because of C2 errors. Used by CdparanoiaLib.
+     *
+     * C2 error pointers are used once they have been requested via setEnabled()
+     * and the drive reports support for them, regardless of the order in which
+     * both are set. A drive which fails the very first C2 read does not really
+     * support it and C2 mode is disabled.
+     */
+    class LIBK3B_EXPORT C2ErrorPointers
+    {
+    public:
+        C2ErrorPointers();
+
+        /**
+         * \return true if the CD capabilities mode page (0x2A) including its
+         * 8 byte mode parameter header states that the drive reports C2 errors.
+         */
+        static bool supportedByDrive( const unsigned char* modePage, int len );
+
+        void setEnabled( bool b );
+        bool enabled() const;
+
+        /**
+         * Set from the capabilities of a newly opened drive. Resets
+         * the verification of the first read.
+         */
+        void setDriveSupport( bool b );
+
+        /**
+         * \return true if the audio data is read with C2 error pointers.
+         */
+        bool active() const;
+
+        /**
+         * To be called after each C2 read.
+         */
+        void readFinished( bool success );
+
+        void countReRead( unsigned int track );
+        void resetCounters();
+
+        /**
+         * \return The number of sectors of \p track which had to be read again
+         * or -1 if C2 error pointers are not active.
+         */
+        long reReadSectors( unsigned int track ) const;
+
+    private:
+        bool m_enabled;
+        bool m_driveSupport;
+        bool m_verified;
+        QHash<unsigned int, long> m_reReadSectors;
+    };
+}
+
+#endif
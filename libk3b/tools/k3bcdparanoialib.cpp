@@ -16,24 +16,36 @@
 #include <config-k3b.h>
 
 #include "k3bcdparanoialib.h"
+#include "k3bc2errorpointers.h"
 
 #include "k3bdevice.h"
 #include "k3btoc.h"
 #include "k3bmsf.h"
 
+#include <QByteArray>
 #include <QDebug>
 #include <QFile>
 #include <QGlobalStatic>
+#include <QHash>
 #include <QLibrary>
 #include <QMutex>
 #include <QMutexLocker>
 
+#include <string.h>
+
 #ifdef Q_OS_WIN32
 typedef short int int16_t;
 #endif
 
 static bool s_haveLibCdio = false;
 
+// one C2 error bit for each byte of a raw audio sector
+#define CD_C2_POINTERS_SIZE 294
+#define CD_C2_SECTOR_SIZE (CD_FRAMESIZE_RAW + CD_C2_POINTERS_SIZE)
+
+// number of sectors read at once in C2 mode
+static const int s_c2ReadSectors = 24;
+
 
 
 #define CDDA_IDENTIFY          s_haveLibCdio ? "cdio_cddap_identify" : "cdda_identify"
@@ -183,6 +195,12 @@ namespace K3b {
         long lastSector( int );
         long sector() const { return m_currentSector; }
 
+        /**
+         * Reads raw audio sectors followed by their C2 error pointers
+         * directly from the device.
+         */
+        bool readC2( unsigned char* data, long sector, int sectors );
+
         static CdparanoiaLibData* data( Device::Device* dev )
         {
             QMap<Device::Device*, CdparanoiaLibData*>::const_iterator it = s_dataMap.constFind( dev );
@@ -296,6 +314,26 @@ int16_t* K3b::CdparanoiaLibData::paranoiaRead( void(*callback)(long,int), int ma
 }
 
 
+bool K3b::CdparanoiaLibData::readC2( unsigned char* data, long sector, int sectors )
+{
+    QMutexLocker locker( &m_mutex );
+
+    return m_device->readCd( data,
+                             sectors*CD_C2_SECTOR_SIZE,
+                             1,     // CD-DA
+                             false, // no dap
+                             sector,
+                             sectors,
+                             false, // no sync
+                             false, // no header
+                             false, // no subheader
+                             true,  // user data
+                             false, // no edc/ecc
+                             1,     // one c2 bit per byte
+                             0 );   // no subchannel data
+}
+
+
 long K3b::CdparanoiaLibData::firstSector( int track )
 {
     if( m_drive ) {
@@ -344,6 +382,9 @@ public:
           paranoiaLevel(0),
           neverSkip(true),
           maxRetries(5),
+          c2BufferStart(0),
+          c2BufferSectors(0),
+          c2BufferValid(false),
           data(0) {
     }
 
@@ -375,6 +416,36 @@ public:
         data->paranoiaModeSet( paranoiaMode );
     }
 
+    void resetC2() {
+        c2BufferStart = c2BufferSectors = 0;
+        c2BufferValid = false;
+        c2.resetCounters();
+    }
+
+    /**
+     * \return The data of the current sector if the drive read it without
+     *         C2 errors, 0 if it has to be read via paranoia.
+     */
+    const char* c2CleanSector() {
+        if( currentSector < c2BufferStart || currentSector >= c2BufferStart + c2BufferSectors ) {
+            c2BufferStart = currentSector;
+            c2BufferSectors = qMin<long>( s_c2ReadSectors, lastSector - currentSector + 1 );
+            c2Buffer.resize( c2BufferSectors*CD_C2_SECTOR_SIZE );
+            c2BufferValid = data->readC2( reinterpret_cast<unsigned char*>( c2Buffer.data() ), c2BufferStart, c2BufferSectors );
+            c2.readFinished( c2BufferValid );
+        }
+
+        if( !c2BufferValid )
+            return 0;
+
+        const char* sector = c2Buffer.constData() + ( currentSector - c2BufferStart )*CD_C2_SECTOR_SIZE;
+        for( int i = CD_FRAMESIZE_RAW; i < CD_C2_SECTOR_SIZE; ++i ) {
+            if( sector[i] )
+                return 0;
+        }
+        return sector;
+    }
+
     // high-level api
     K3b::Device::Device* device;
     K3b::Device::Toc toc;
@@ -387,6 +458,13 @@ public:
     bool neverSkip;
     int maxRetries;
 
+    K3b::C2ErrorPointers c2;
+    QByteArray c2Buffer;
+    long c2BufferStart;
+    long c2BufferSectors;
+    bool c2BufferValid;
+    char sectorBuffer[CD_FRAMESIZE_RAW];
+
     K3b::CdparanoiaLibData* data;
 };
 
@@ -596,6 +674,18 @@ bool K3b::CdparanoiaLib::initParanoia( K3b::Device::Device* dev, const K3b::Devi
     if( d->data->paranoiaInit() ) {
         d->startSector = d->currentSector = d->lastSector = 0;
 
+        //
+        // The CD capabilities page tells us if the drive is able to report
+        // C2 errors at all. It is always checked so setUseC2ErrorPointers()
+        // may also be called after initParanoia().
+        //
+        Device::UByteArray page;
+        const bool c2Supported = ( dev->modeSense( page, 0x2A ) &&
+                                   C2ErrorPointers::supportedByDrive( page.data(), page.size() ) );
+        qDebug() << "(K3b::CdparanoiaLib) drive supports C2 error pointers: " << c2Supported;
+        d->c2.setDriveSupport( c2Supported );
+        d->resetC2();
+
         return true;
     }
     else {
@@ -687,6 +777,7 @@ bool K3b::CdparanoiaLib::initReading( long start, long end )
             d->toc.lastSector().lba() >= end ) {
             d->startSector = d->currentSector = start;
             d->lastSector = end;
+            d->resetC2();
 
             // determine track number
             d->currentTrack = 1;
@@ -721,31 +812,58 @@ char* K3b::CdparanoiaLib::read( int* statusCode, unsigned int* track, bool littl
         return 0;
     }
 
-    if( d->currentSector != d->data->sector() ) {
-        qDebug() << "(K3b::CdparanoiaLib) need to seek before read. Looks as if we are reusing the paranoia instance.";
-        if( d->data->paranoiaSeek( d->currentSector, SEEK_SET ) == -1 )
-            return 0;
-    }
+    char* charData = 0;
+    qint16* data = 0;
 
     //
-    // The paranoia data could have been used by someone else before
-    // and setting the paranoia mode is fast
+    // Sectors the drive read without C2 errors are used directly. The raw
+    // audio data is always little endian.
     //
-    d->updateParanoiaMode();
+    if( d->c2.active() ) {
+        if( const char* sector = d->c2CleanSector() ) {
+            ::memcpy( d->sectorBuffer, sector, CD_FRAMESIZE_RAW );
+            charData = d->sectorBuffer;
+            data = reinterpret_cast<qint16*>( charData );
+            if( !littleEndian ) {
+                for( int i = 0; i < CD_FRAMESIZE_RAW-1; i+=2 ) {
+                    char b = charData[i];
+                    charData[i] = charData[i+1];
+                    charData[i+1] = b;
+                }
+            }
+        }
+        else if( d->c2.active() ) {
+            d->c2.countReRead( d->currentTrack );
+        }
+    }
 
-    qint16* data = d->data->paranoiaRead( paranoiaCallback, d->maxRetries );
+    if( !charData ) {
+        if( d->currentSector != d->data->sector() ) {
+            qDebug() << "(K3b::CdparanoiaLib) need to seek before read to sector " << d->currentSector;
+            if( d->data->paranoiaSeek( d->currentSector, SEEK_SET ) == -1 )
+                return 0;
+        }
 
-    char* charData = reinterpret_cast<char*>(data);
+        //
+        // The paranoia data could have been used by someone else before
+        // and setting the paranoia mode is fast
+        //
+        d->updateParanoiaMode();
 
-    if(
+        data = d->data->paranoiaRead( paranoiaCallback, d->maxRetries );
+
+        charData = reinterpret_cast<char*>(data);
+
+        if( data &&
 #ifndef WORDS_BIGENDIAN // __BYTE_ORDER == __BIG_ENDIAN
-        !
+            !
 #endif
-        littleEndian ) {
-        for( int i = 0; i < CD_FRAMESIZE_RAW-1; i+=2 ) {
-            char b = charData[i];
-            charData[i] = charData[i+1];
-            charData[i+1] = b;
+            littleEndian ) {
+            for( int i = 0; i < CD_FRAMESIZE_RAW-1; i+=2 ) {
+                char b = charData[i];
+                charData[i] = charData[i+1];
+                charData[i+1] = b;
+            }
         }
     }
 
@@ -804,3 +922,15 @@ void K3b::CdparanoiaLib::setMaxRetries( int r )
 {
     d->maxRetries = r;
 }
+
+
+void K3b::CdparanoiaLib::setUseC2ErrorPointers( bool b )
+{
+    d->c2.setEnabled( b );
+}
+
+
+long K3b::CdparanoiaLib::reReadSectors( unsigned int track ) const
+{
+    return d->c2.reReadSectors( track );
+}
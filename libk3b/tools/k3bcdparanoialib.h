@@ -57,6 +57,10 @@ namespace K3b {
      *
      * CdparanoiaLib is thread-safe.
      *
+     * With setUseC2ErrorPointers() the audio data is read directly from the
+     * drive and paranoia is only used for sectors the drive flags with C2
+     * errors. On clean discs this reads at the raw speed of the drive.
+     *
      * Usage:
      * <pre>
      * CdparanoiaLib lib;
@@ -78,6 +82,15 @@ namespace K3b {
         /** default: 5 */
         void setMaxRetries( int );
 
+        /**
+         * Read the audio data together with the C2 error pointers and only
+         * run the sectors which contain C2 errors through paranoia. Ignored
+         * if the drive does not report C2 errors.
+         *
+         * default: false
+         */
+        void setUseC2ErrorPointers( bool b );
+
         /**
          * This will read the Toc and initialize some stuff.
          * It will also call paranoiaInit( const QString& )
@@ -139,6 +152,16 @@ namespace K3b {
 
         long rippedDataLength() const;
 
+        /**
+         * The number of sectors of \p track which had to be read again via
+         * paranoia because the drive reported C2 errors. Counted since the last
+         * call to initReading().
+         *
+         * \return The number of sectors or -1 if the C2 error pointers have
+         *         not been used.
+         */
+        long reReadSectors( unsigned int track ) const;
+
         /**
          * returns 0 if the cdparanoialib could not
          * be found on the system.
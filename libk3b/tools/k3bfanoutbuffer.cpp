@@ -0,0 +1,399 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bfanoutbuffer.h"
+
+#include <QDebug>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <string.h>
+
+
+namespace {
+    // never hand more than this to a sink at once to keep the cursors moving smoothly
+    const qint64 s_maxChunkSize = 1024*1024;
+}
+
+
+class K3b::FanOutBuffer::Private
+{
+public:
+    class SinkThread : public QThread
+    {
+    public:
+        SinkThread( FanOutBuffer::Private* d, int sink )
+            : m_d( d ),
+              m_sink( sink ) {
+        }
+
+    protected:
+        void run() {
+            m_d->feedSink( m_sink );
+        }
+
+    private:
+        FanOutBuffer::Private* m_d;
+        int m_sink;
+    };
+
+    struct Sink {
+        Sink()
+            : device( 0 ),
+              closeWhenDone( false ),
+              thread( 0 ),
+              readPos( 0 ),
+              failed( false ),
+              done( false ),
+              closed( false ) {
+        }
+
+        QIODevice* device;
+        bool closeWhenDone;
+        SinkThread* thread;
+
+        // the following are protected by the mutex
+        qint64 readPos;
+        bool failed;
+        bool done;
+
+        // only touched in the GUI thread
+        bool closed;
+    };
+
+    Private( FanOutBuffer* q_, int size )
+        : q( q_ ),
+          writePos( 0 ),
+          endOfStream( false ),
+          aborted( false ),
+          finishedEmitted( true ) {
+        // keep the ring sector aligned
+        buffer.resize( qMax( 2048, size - size%2048 ) );
+        ring = buffer.data();
+    }
+
+    void feedSink( int i );
+    qint64 slowestReadPos() const;
+    void _k3b_sinkThreadFinished();
+
+    FanOutBuffer* q;
+
+    QByteArray buffer;
+    char* ring;
+    QList<Sink> sinks;
+
+    mutable QMutex mutex;
+    QWaitCondition dataAvailable;
+    QWaitCondition spaceAvailable;
+
+    qint64 writePos;
+    bool endOfStream;
+    bool aborted;
+
+    // only touched in the GUI thread
+    bool finishedEmitted;
+};
+
+
+void K3b::FanOutBuffer::Private::feedSink( int i )
+{
+    const qint64 size = buffer.size();
+
+    forever {
+        QMutexLocker locker( &mutex );
+
+        while( !aborted && sinks[i].readPos == writePos && !endOfStream )
+            dataAvailable.wait( &mutex );
+
+        if( aborted )
+            return;
+
+        if( sinks[i].readPos == writePos ) {
+            // all data has been written
+            sinks[i].done = true;
+            spaceAvailable.wakeAll();
+            locker.unlock();
+            emit q->sinkFinished( i );
+            return;
+        }
+
+        const qint64 offset = sinks[i].readPos % size;
+        const qint64 len = qMin( qMin( writePos - sinks[i].readPos, size - offset ), s_maxChunkSize );
+        const char* data = ring + offset;
+
+        // the writer never touches data which has not been consumed by all sinks
+        // thus we can safely write without holding the lock
+        locker.unlock();
+        const qint64 written = sinks.at( i ).device->write( data, len );
+        locker.relock();
+
+        if( written <= 0 ) {
+            qDebug() << "(K3b::FanOutBuffer) writing to sink" << i << "failed:" << sinks.at( i ).device->errorString();
+            sinks[i].failed = true;
+            spaceAvailable.wakeAll();
+            locker.unlock();
+            emit q->sinkFailed( i );
+            return;
+        }
+
+        sinks[i].readPos += written;
+        spaceAvailable.wakeAll();
+    }
+}
+
+
+qint64 K3b::FanOutBuffer::Private::slowestReadPos() const
+{
+    qint64 pos = -1;
+    for( int i = 0; i < sinks.count(); ++i ) {
+        if( !sinks[i].failed && !sinks[i].done ) {
+            if( pos < 0 || sinks[i].readPos < pos )
+                pos = sinks[i].readPos;
+        }
+    }
+    return pos;
+}
+
+
+void K3b::FanOutBuffer::Private::_k3b_sinkThreadFinished()
+{
+    bool allDone = true;
+    for( int i = 0; i < sinks.count(); ++i ) {
+        if( sinks[i].thread && sinks[i].thread->isFinished() ) {
+            if( !sinks[i].closed ) {
+                sinks[i].closed = true;
+                if( sinks[i].closeWhenDone )
+                    sinks[i].device->close();
+            }
+        }
+        else {
+            allDone = false;
+        }
+    }
+
+    if( allDone && !finishedEmitted ) {
+        finishedEmitted = true;
+        emit q->finished();
+    }
+}
+
+
+K3b::FanOutBuffer::FanOutBuffer( int bufferSize )
+    : d( new Private( this, bufferSize ) )
+{
+}
+
+
+K3b::FanOutBuffer::~FanOutBuffer()
+{
+    abort();
+    clearSinks();
+    delete d;
+}
+
+
+int K3b::FanOutBuffer::addSink( QIODevice* dev, bool close )
+{
+    if( isOpen() )
+        return -1;
+
+    Private::Sink sink;
+    sink.device = dev;
+    sink.closeWhenDone = close;
+    d->sinks.append( sink );
+    return d->sinks.count() - 1;
+}
+
+
+void K3b::FanOutBuffer::clearSinks()
+{
+    if( isOpen() )
+        return;
+
+    for( int i = 0; i < d->sinks.count(); ++i )
+        delete d->sinks[i].thread;
+    d->sinks.clear();
+}
+
+
+int K3b::FanOutBuffer::numSinks() const
+{
+    return d->sinks.count();
+}
+
+
+bool K3b::FanOutBuffer::open( OpenMode mode )
+{
+    if( isOpen() || d->sinks.isEmpty() || ( mode & ReadOnly ) )
+        return false;
+
+    d->writePos = 0;
+    d->endOfStream = false;
+    d->aborted = false;
+    d->finishedEmitted = false;
+
+    for( int i = 0; i < d->sinks.count(); ++i ) {
+        Private::Sink& sink = d->sinks[i];
+        if( !sink.device->isOpen() && !sink.device->open( QIODevice::WriteOnly ) ) {
+            qDebug() << "(K3b::FanOutBuffer) unable to open sink" << i;
+            return false;
+        }
+    }
+
+    QIODevice::open( WriteOnly|Unbuffered );
+
+    for( int i = 0; i < d->sinks.count(); ++i ) {
+        Private::Sink& sink = d->sinks[i];
+        sink.readPos = 0;
+        sink.failed = sink.done = sink.closed = false;
+        delete sink.thread;
+        sink.thread = new Private::SinkThread( d, i );
+        connect( sink.thread, SIGNAL(finished()), this, SLOT(_k3b_sinkThreadFinished()) );
+        sink.thread->start();
+    }
+
+    return true;
+}
+
+
+void K3b::FanOutBuffer::close()
+{
+    if( !isOpen() )
+        return;
+
+    QMutexLocker locker( &d->mutex );
+    d->endOfStream = true;
+    d->dataAvailable.wakeAll();
+    locker.unlock();
+
+    QIODevice::close();
+}
+
+
+void K3b::FanOutBuffer::abort()
+{
+    stop();
+
+    for( int i = 0; i < d->sinks.count(); ++i ) {
+        if( d->sinks[i].thread )
+            d->sinks[i].thread->wait();
+    }
+}
+
+
+void K3b::FanOutBuffer::stop()
+{
+    QMutexLocker locker( &d->mutex );
+    d->aborted = true;
+    d->dataAvailable.wakeAll();
+    d->spaceAvailable.wakeAll();
+    locker.unlock();
+
+    if( isOpen() )
+        QIODevice::close();
+}
+
+
+bool K3b::FanOutBuffer::running() const
+{
+    for( int i = 0; i < d->sinks.count(); ++i ) {
+        if( d->sinks[i].thread && d->sinks[i].thread->isRunning() )
+            return true;
+    }
+    return false;
+}
+
+
+bool K3b::FanOutBuffer::hasSinkFailed( int sink ) const
+{
+    QMutexLocker locker( &d->mutex );
+    return d->sinks[sink].failed;
+}
+
+
+int K3b::FanOutBuffer::activeSinks() const
+{
+    QMutexLocker locker( &d->mutex );
+    int cnt = 0;
+    for( int i = 0; i < d->sinks.count(); ++i ) {
+        if( !d->sinks[i].failed && !d->sinks[i].done )
+            ++cnt;
+    }
+    return cnt;
+}
+
+
+quint64 K3b::FanOutBuffer::bytesWrittenToSink( int sink ) const
+{
+    QMutexLocker locker( &d->mutex );
+    return d->sinks[sink].readPos;
+}
+
+
+int K3b::FanOutBuffer::fillLevel( int sink ) const
+{
+    QMutexLocker locker( &d->mutex );
+    if( d->sinks[sink].failed || d->sinks[sink].done )
+        return 0;
+    return 100LL * ( d->writePos - d->sinks[sink].readPos ) / d->buffer.size();
+}
+
+
+qint64 K3b::FanOutBuffer::readData( char*, qint64 )
+{
+    return -1;
+}
+
+
+qint64 K3b::FanOutBuffer::writeData( const char* data, qint64 len )
+{
+    const qint64 size = d->buffer.size();
+    qint64 written = 0;
+
+    QMutexLocker locker( &d->mutex );
+
+    while( written < len ) {
+        qint64 slowest = 0;
+        while( !d->aborted &&
+               ( slowest = d->slowestReadPos() ) >= 0 &&
+               d->writePos - slowest >= size ) {
+            d->spaceAvailable.wait( &d->mutex );
+        }
+
+        if( d->aborted || slowest < 0 ) {
+            // all sinks are gone
+            qDebug() << "(K3b::FanOutBuffer) no sinks left to write to.";
+            break;
+        }
+
+        const qint64 offset = d->writePos % size;
+        const qint64 chunk = qMin( qMin( len - written, size - ( d->writePos - slowest ) ), size - offset );
+
+        // this region has been consumed by all sinks, no need to hold the lock while copying
+        locker.unlock();
+        ::memcpy( d->ring + offset, data + written, chunk );
+        locker.relock();
+
+        d->writePos += chunk;
+        written += chunk;
+        d->dataAvailable.wakeAll();
+    }
+
+    return written > 0 ? written : -1;
+}
+
+#include "moc_k3bfanoutbuffer.cpp"
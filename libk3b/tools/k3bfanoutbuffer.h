@@ -0,0 +1,147 @@
+/*
+ *
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef _K3B_FAN_OUT_BUFFER_H_
+#define _K3B_FAN_OUT_BUFFER_H_
+
+#include "k3b_export.h"
+
+#include <QIODevice>
+
+
+namespace K3b {
+    /**
+     * The fan out buffer distributes one data stream to several sinks.
+     *
+     * All data written to the buffer is kept in a ring buffer which is
+     * shared by all sinks. Each sink is fed by its own thread and has its
+     * own read cursor. A write to the buffer blocks as long as the slowest
+     * sink has not consumed enough data to make room for it.
+     *
+     * A sink which fails to accept data is dropped. The remaining sinks
+     * are not affected. Writing to the buffer only fails once all sinks
+     * have been dropped.
+     *
+     * Usage is similar to ActivePipe: add the sinks, open the buffer,
+     * write the data, and call close() to signal the end of the stream.
+     */
+    class LIBK3B_EXPORT FanOutBuffer : public QIODevice
+    {
+        Q_OBJECT
+
+    public:
+        /**
+         * \param bufferSize The size of the shared ring buffer in bytes.
+         */
+        explicit FanOutBuffer( int bufferSize = 32*1024*1024 );
+        virtual ~FanOutBuffer();
+
+        /**
+         * Add a sink. Only possible while the buffer is not open.
+         *
+         * \param close If true the device will be closed once all data has
+         *              been written to it.
+         *
+         * \return The index of the sink.
+         */
+        int addSink( QIODevice* dev, bool close = false );
+
+        /**
+         * Remove all sinks. Only possible while the buffer is not open.
+         */
+        void clearSinks();
+
+        int numSinks() const;
+
+        /**
+         * Opens the buffer for writing and starts feeding the sinks.
+         */
+        bool open( OpenMode mode = WriteOnly );
+
+        /**
+         * Marks the end of the stream. The sinks are closed
+         * once they received all data. This method does not block.
+         */
+        virtual void close();
+
+        /**
+         * Stops feeding all sinks immediately and waits for the sink
+         * threads to finish.
+         */
+        void abort();
+
+        /**
+         * Stops feeding all sinks like abort() but returns at once. A sink
+         * thread which is busy writing finishes its current write first.
+         * finished() is emitted once all sink threads are done.
+         */
+        void stop();
+
+        /**
+         * \return true as long as any sink thread is running.
+         */
+        bool running() const;
+
+        /**
+         * \return true if the sink has been dropped due to a write error.
+         */
+        bool hasSinkFailed( int sink ) const;
+
+        /**
+         * \return The number of sinks which have neither failed nor received
+         *         all data yet.
+         */
+        int activeSinks() const;
+
+        /**
+         * The number of bytes written to a sink so far.
+         */
+        quint64 bytesWrittenToSink( int sink ) const;
+
+        /**
+         * \return The percentage of the buffer filled with data
+         *         not yet consumed by \p sink.
+         */
+        int fillLevel( int sink ) const;
+
+    Q_SIGNALS:
+        /**
+         * Emitted when a sink is dropped because writing to it failed.
+         */
+        void sinkFailed( int sink );
+
+        /**
+         * Emitted once a sink received all data.
+         */
+        void sinkFinished( int sink );
+
+        /**
+         * Emitted once all sink threads are done, be it because all data
+         * has been written, the sinks failed, or the buffer has been stopped.
+         */
+        void finished();
+
+    protected:
+        qint64 readData( char* data, qint64 max );
+        qint64 writeData( const char* data, qint64 len );
+
+    private:
+        class Private;
+        Private* const d;
+
+        Q_PRIVATE_SLOT( d, void _k3b_sinkThreadFinished() )
+    };
+}
+
+#endif
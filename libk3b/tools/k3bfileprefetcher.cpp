@@ -0,0 +1,455 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include <config-k3b.h>
+
+#include "k3bfileprefetcher.h"
+#include "k3bglobals.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+namespace {
+    // the kernel is asked to read ahead at most this much at once
+    const qint64 s_chunkSize = 4*1024*1024;
+
+    // files starting less than this ahead of the consumer are checked for cache hits
+    const qint64 s_checkWindow = 8*1024*1024;
+
+    // the size of the mappings used to determine the cached pages
+    const qint64 s_mapSize = 64*1024*1024;
+
+    // how often the position of the consumer process is polled
+    const unsigned long s_pollInterval = 100;
+
+    /**
+     * The number of bytes of the file which are in the page cache or -1
+     * if this cannot be determined.
+     */
+    qint64 cachedBytes( int fd, qint64 size )
+    {
+#ifdef HAVE_MINCORE
+        const qint64 pageSize = ::sysconf( _SC_PAGESIZE );
+        QVector<unsigned char> pages;
+        qint64 cached = 0;
+        for( qint64 offset = 0; offset < size; offset += s_mapSize ) {
+            const qint64 len = qMin( s_mapSize, size - offset );
+            void* map = ::mmap( 0, len, PROT_READ, MAP_SHARED, fd, offset );
+            if( map == MAP_FAILED )
+                return -1;
+
+            pages.resize( ( len + pageSize - 1 ) / pageSize );
+#ifdef Q_OS_LINUX
+            const int r = ::mincore( map, len, pages.data() );
+#else
+            const int r = ::mincore( map, len, reinterpret_cast<char*>( pages.data() ) );
+#endif
+            ::munmap( map, len );
+            if( r != 0 )
+                return -1;
+
+            for( int i = 0; i < pages.count(); ++i ) {
+                if( pages[i] & 0x1 )
+                    cached += pageSize;
+            }
+        }
+        return qMin( cached, size );
+#else
+        Q_UNUSED( fd );
+        Q_UNUSED( size );
+        return -1;
+#endif
+    }
+
+    /**
+     * The number of bytes read by process \p pid so far or -1 if the
+     * system does not tell.
+     */
+    qint64 processReadBytes( qint64 pid )
+    {
+#ifdef Q_OS_LINUX
+        if( pid <= 0 )
+            return -1;
+
+        QFile f( QString::fromLatin1( "/proc/%1/io" ).arg( pid ) );
+        if( !f.open( QIODevice::ReadOnly ) )
+            return -1;
+
+        // rchar also counts reads which are not served by the disk
+        Q_FOREACH( const QByteArray& line, f.readAll().split( '\n' ) ) {
+            if( line.startsWith( "rchar:" ) ) {
+                bool ok = false;
+                const qint64 bytes = line.mid( 6 ).trimmed().toLongLong( &ok );
+                return ok ? bytes : -1;
+            }
+        }
+        return -1;
+#else
+        Q_UNUSED( pid );
+        return -1;
+#endif
+    }
+}
+
+
+K3b::FilePrefetcher::Statistics::Statistics()
+    : files( 0 ),
+      prefetchedFiles( 0 ),
+      prefetchedBytes( 0 ),
+      readBytes( 0 ),
+      hits( 0 ),
+      misses( 0 ),
+      hitBytes( 0 ),
+      missBytes( 0 ),
+      unchecked( 0 )
+{
+}
+
+
+class K3b::FilePrefetcher::Private
+{
+public:
+    class PrefetchThread : public QThread
+    {
+    public:
+        PrefetchThread( FilePrefetcher::Private* d )
+            : m_d( d ) {
+        }
+
+    protected:
+        void run() {
+            m_d->run();
+        }
+
+    private:
+        FilePrefetcher::Private* m_d;
+    };
+
+    Private()
+        : thread( this ),
+          budget( 256*1024*1024 ),
+          pid( 0 ),
+          consumed( 0 ),
+          stopped( false ) {
+    }
+
+    void run();
+    void determineSizes();
+    bool prefetch( int fd, qint64 offset, qint64 len );
+    void check( int i, qint64 consumedBytes );
+
+    PrefetchThread thread;
+
+    QStringList files;
+    QVector<qint64> sizes;
+    QVector<qint64> starts;
+
+    qint64 budget;
+    qint64 pid;
+
+    // the following are protected by the mutex
+    mutable QMutex mutex;
+    QWaitCondition consumerMoved;
+    qint64 consumed;
+    bool stopped;
+    Statistics stats;
+
+    QByteArray readBuffer;
+};
+
+
+void K3b::FilePrefetcher::Private::determineSizes()
+{
+    sizes.resize( files.count() );
+    starts.resize( files.count() );
+
+    qint64 pos = 0;
+    int nonEmpty = 0;
+    for( int i = 0; i < files.count(); ++i ) {
+        k3b_struct_stat s;
+        if( k3b_stat( QFile::encodeName( files.at( i ) ), &s ) == 0 && S_ISREG( s.st_mode ) )
+            sizes[i] = s.st_size;
+        else
+            sizes[i] = 0;
+        starts[i] = pos;
+        pos += sizes[i];
+        if( sizes[i] > 0 )
+            ++nonEmpty;
+    }
+
+    QMutexLocker locker( &mutex );
+    stats.files = nonEmpty;
+}
+
+
+bool K3b::FilePrefetcher::Private::prefetch( int fd, qint64 offset, qint64 len )
+{
+#ifdef HAVE_POSIX_FADVISE
+    if( ::posix_fadvise( fd, offset, len, POSIX_FADV_WILLNEED ) == 0 )
+        return true;
+#endif
+
+    // reading the data fills the page cache just the same
+    if( readBuffer.isEmpty() )
+        readBuffer.resize( 1024*1024 );
+    qint64 done = 0;
+    while( done < len ) {
+        const ssize_t r = ::pread( fd, readBuffer.data(), qMin( len - done, qint64( readBuffer.size() ) ), offset + done );
+        if( r <= 0 )
+            break;
+        done += r;
+    }
+
+    QMutexLocker locker( &mutex );
+    stats.readBytes += done;
+    return done > 0;
+}
+
+
+void K3b::FilePrefetcher::Private::check( int i, qint64 consumedBytes )
+{
+    if( sizes[i] == 0 )
+        return;
+
+    //
+    // If the consumer already passed the file it has been cached by reading
+    // it. Counting it as a hit would be cheating.
+    //
+    if( starts[i] + sizes[i] <= consumedBytes ) {
+        QMutexLocker locker( &mutex );
+        ++stats.unchecked;
+        return;
+    }
+
+    qint64 cached = -1;
+    const int fd = ::open( QFile::encodeName( files.at( i ) ), O_RDONLY );
+    if( fd >= 0 ) {
+        cached = cachedBytes( fd, sizes[i] );
+        ::close( fd );
+    }
+
+    QMutexLocker locker( &mutex );
+    if( cached < 0 ) {
+        ++stats.unchecked;
+    }
+    else {
+        if( cached >= sizes[i] )
+            ++stats.hits;
+        else
+            ++stats.misses;
+        stats.hitBytes += cached;
+        stats.missBytes += sizes[i] - cached;
+    }
+}
+
+
+void K3b::FilePrefetcher::Private::run()
+{
+    determineSizes();
+
+    int next = 0;             // the file to prefetch next
+    qint64 nextOffset = 0;    // the position in that file
+    int nextFd = -1;
+    int checked = 0;          // the file to check for cache hits next
+
+    forever {
+        QMutexLocker locker( &mutex );
+        if( stopped )
+            break;
+        consumed = qMax( consumed, processReadBytes( pid ) );
+        const qint64 consumedBytes = consumed;
+        locker.unlock();
+
+        while( checked < files.count() && starts[checked] < consumedBytes + s_checkWindow ) {
+            check( checked, consumedBytes );
+            ++checked;
+        }
+
+        //
+        // Skip the files the consumer has already passed and advise the kernel to read
+        // everything up to the budget.
+        //
+        const qint64 limit = consumedBytes + budget;
+        while( next < files.count() && starts[next] + nextOffset < limit ) {
+            if( sizes[next] == 0 || starts[next] + sizes[next] <= consumedBytes ) {
+                if( nextFd >= 0 ) {
+                    ::close( nextFd );
+                    nextFd = -1;
+                }
+                ++next;
+                nextOffset = 0;
+                continue;
+            }
+
+            if( nextFd < 0 ) {
+                nextFd = ::open( QFile::encodeName( files.at( next ) ), O_RDONLY );
+                if( nextFd < 0 ) {
+                    qDebug() << "(K3b::FilePrefetcher) could not open" << files.at( next );
+                    ++next;
+                    nextOffset = 0;
+                    continue;
+                }
+                nextOffset = qMax( nextOffset, consumedBytes - starts[next] );
+            }
+
+            const qint64 len = qMin( qMin( sizes[next] - nextOffset, limit - starts[next] - nextOffset ), s_chunkSize );
+            const bool success = prefetch( nextFd, nextOffset, len );
+            nextOffset += len;
+
+            if( !success || nextOffset >= sizes[next] ) {
+                ::close( nextFd );
+                nextFd = -1;
+                locker.relock();
+                if( success ) {
+                    ++stats.prefetchedFiles;
+                    stats.prefetchedBytes += sizes[next];
+                }
+                locker.unlock();
+                ++next;
+                nextOffset = 0;
+            }
+
+            locker.relock();
+            const bool stop = stopped;
+            locker.unlock();
+            if( stop )
+                break;
+        }
+
+        if( next >= files.count() && checked >= files.count() )
+            break;
+
+        locker.relock();
+        if( !stopped )
+            consumerMoved.wait( &mutex, s_pollInterval );
+    }
+
+    if( nextFd >= 0 )
+        ::close( nextFd );
+}
+
+
+K3b::FilePrefetcher::FilePrefetcher()
+    : d( new Private() )
+{
+}
+
+
+K3b::FilePrefetcher::~FilePrefetcher()
+{
+    stop();
+    delete d;
+}
+
+
+void K3b::FilePrefetcher::setFiles( const QStringList& files )
+{
+    if( !isRunning() )
+        d->files = files;
+}
+
+
+void K3b::FilePrefetcher::setBudget( qint64 bytes )
+{
+    d->budget = qMax( bytes, s_chunkSize );
+}
+
+
+qint64 K3b::FilePrefetcher::budget() const
+{
+    return d->budget;
+}
+
+
+void K3b::FilePrefetcher::setConsumerProcess( qint64 pid )
+{
+    d->pid = pid;
+}
+
+
+void K3b::FilePrefetcher::setConsumedBytes( qint64 bytes )
+{
+    QMutexLocker locker( &d->mutex );
+    if( bytes > d->consumed ) {
+        d->consumed = bytes;
+        d->consumerMoved.wakeAll();
+    }
+}
+
+
+void K3b::FilePrefetcher::start()
+{
+    if( isRunning() )
+        return;
+
+    d->consumed = 0;
+    d->stopped = false;
+    d->stats = Statistics();
+    d->thread.start( QThread::LowPriority );
+}
+
+
+void K3b::FilePrefetcher::stop()
+{
+    QMutexLocker locker( &d->mutex );
+    d->stopped = true;
+    d->consumerMoved.wakeAll();
+    locker.unlock();
+
+    d->thread.wait();
+}
+
+
+bool K3b::FilePrefetcher::isRunning() const
+{
+    return d->thread.isRunning();
+}
+
+
+K3b::FilePrefetcher::Statistics K3b::FilePrefetcher::statistics() const
+{
+    QMutexLocker locker( &d->mutex );
+    return d->stats;
+}
+
+
+QString K3b::FilePrefetcher::report() const
+{
+    const Statistics s = statistics();
+    const int checked = s.hits + s.misses;
+    return QString::fromLatin1( "Prefetched %1 of %2 files (%3 MB, %4 MB read directly) with a budget of %5 MB. "
+                                "Cache hits: %6 of %7 checked files (%8%), %9 MB cached, %10 MB missing, %11 unchecked." )
+        .arg( s.prefetchedFiles )
+        .arg( s.files )
+        .arg( s.prefetchedBytes/1024/1024 )
+        .arg( s.readBytes/1024/1024 )
+        .arg( d->budget/1024/1024 )
+        .arg( s.hits )
+        .arg( checked )
+        .arg( checked > 0 ? 100*s.hits/checked : 0 )
+        .arg( s.hitBytes/1024/1024 )
+        .arg( s.missBytes/1024/1024 )
+        .arg( s.unchecked );
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef _K3B_FILE_PREFETCHER_H_
+#define _K3B_FILE_PREFETCHER_H_
+
+#include "k3b_export.h"
+
+#include <QString>
+#include <QStringList>
+
+
+namespace K3b {
+    /**
+     * The file prefetcher pulls a list of files into the page cache ahead of
+     * a consumer which reads them in the given order, typically mkisofs.
+     *
+     * A background thread asks the kernel to read ahead the files
+     * (posix_fadvise) or reads them itself if that is not possible. It never
+     * gets further ahead of the consumer than the budget allows, so files
+     * prefetched early are not evicted again before they are used.
+     *
+     * The position of the consumer in the stream of files is taken from the
+     * I/O statistics of the consumer process if available and from
+     * setConsumedBytes() otherwise.
+     *
+     * Right before the consumer reaches a file the prefetcher checks how much
+     * of it is cached. These checks form the hit and miss counters.
+     */
+    class LIBK3B_EXPORT FilePrefetcher
+    {
+    public:
+        struct Statistics {
+            Statistics();
+
+            int files;               /**< non-empty files in the list */
+            int prefetchedFiles;
+            qint64 prefetchedBytes;
+            qint64 readBytes;        /**< bytes read by the prefetcher itself when read-ahead was not possible */
+
+            int hits;                /**< files which were completely cached when the consumer reached them */
+            int misses;
+            qint64 hitBytes;         /**< cached bytes of the checked files */
+            qint64 missBytes;
+            int unchecked;           /**< files the consumer passed before they could be checked */
+        };
+
+        FilePrefetcher();
+        ~FilePrefetcher();
+
+        /**
+         * The files in the order the consumer will read them.
+         * Only possible while the prefetcher is not running.
+         */
+        void setFiles( const QStringList& files );
+
+        /**
+         * The maximum number of bytes the prefetcher reads ahead of the consumer.
+         * Defaults to 256 MB.
+         */
+        void setBudget( qint64 bytes );
+        qint64 budget() const;
+
+        /**
+         * The process reading the files. On Linux its I/O statistics are used to
+         * follow its position.
+         */
+        void setConsumerProcess( qint64 pid );
+
+        /**
+         * Tells the prefetcher how many bytes of the files the consumer has read.
+         * Values lower than the current position are ignored.
+         *
+         * Thread-safe.
+         */
+        void setConsumedBytes( qint64 bytes );
+
+        /**
+         * Starts the prefetching thread.
+         */
+        void start();
+
+        /**
+         * Stops the prefetching and waits for the thread to finish.
+         */
+        void stop();
+
+        bool isRunning() const;
+
+        Statistics statistics() const;
+
+        /**
+         * A human readable summary of the statistics for the debugging output.
+         */
+        QString report() const;
+
+    private:
+        class Private;
+        Private* const d;
+
+        Q_DISABLE_COPY( FilePrefetcher )
+    };
+}
+
+#endif
@@ -214,50 +214,11 @@ int K3b::Iso9660File::read( unsigned int pos, char* data, int maxlen ) const
     if( pos >= size() )
         return 0;
 
-    unsigned long startSec = m_startSector + pos/2048;
-    int startSecOffset = pos%2048;
-    char* buffer = data;
-    bool buffered = false;
-    unsigned long bufferLen = maxlen+startSecOffset;
-
     // cut to size
     if( pos + maxlen > size() )
-        bufferLen = size() - pos + startSecOffset;
-
-    // pad to 2048
-    if( bufferLen%2048 )
-        bufferLen += (2048-(bufferLen%2048));
-
-    // we need to buffer if we changed the startSec or need a bigger buffer
-    if( startSecOffset || bufferLen > (unsigned int)maxlen ) {
-        buffered = true;
-        buffer = new char[bufferLen];
-    }
-
-    int read = archive()->read( startSec, buffer, bufferLen/2048 )*2048;
-
-    if( buffered ) {
-        if( read > 0 ) {
-            // cut to requested data
-            read -= startSecOffset;
-            if( read + pos > size() )
-                read = size() - pos;
-            if( read > maxlen )
-                read = maxlen;
-
-            ::memcpy( data, buffer+startSecOffset, read );
-        }
-        delete [] buffer;
+        maxlen = size() - pos;
 
-        return read;
-    }
-    else {
-        // cut read data
-        if( read + pos > size() )
-            read = size() - pos;
-
-        return read;
-    }
+    return archive()->readBytes( static_cast<quint64>(m_startSector)*2048 + pos, data, maxlen );
 }
 
 
@@ -460,6 +421,7 @@ public:
           isOpen(false),
           startSector(0),
           plainIso9660(false),
+          cacheSize(K3b::Iso9660CachingBackend::DefaultCacheSize),
           backend(0) {
     }
 
@@ -480,6 +442,8 @@ public:
 
     bool plainIso9660;
 
+    int cacheSize;
+
     K3b::Iso9660Backend* backend;
 };
 
@@ -548,6 +512,43 @@ int K3b::Iso9660::read( unsigned int sector, char* data, int count )
 }
 
 
+int K3b::Iso9660::readBytes( quint64 pos, char* data, int len )
+{
+    if( len <= 0 )
+        return 0;
+
+    if( K3b::Iso9660CachingBackend* cache = dynamic_cast<K3b::Iso9660CachingBackend*>( d->backend ) )
+        return cache->readBytes( pos, data, len );
+
+    //
+    // Without a cache we need to read complete sectors
+    //
+    const quint64 startSec = pos/2048;
+    const int startSecOffset = pos%2048;
+
+    if( !startSecOffset && !(len%2048) ) {
+        const int read = this->read( startSec, data, len/2048 );
+        return ( read < 0 ? -1 : read*2048 );
+    }
+
+    const int sectors = ( startSecOffset + len + 2047 )/2048;
+    QByteArray buffer( sectors*2048, Qt::Uninitialized );
+    int read = this->read( startSec, buffer.data(), sectors );
+    if( read <= 0 )
+        return -1;
+
+    read = qMin( read*2048 - startSecOffset, len );
+    ::memcpy( data, buffer.constData() + startSecOffset, read );
+    return read;
+}
+
+
+void K3b::Iso9660::setCacheSize( int size )
+{
+    d->cacheSize = size;
+}
+
+
 void K3b::Iso9660::addBoot(struct el_torito_boot_descriptor* bootdesc)
 {
     int i,size;
@@ -621,6 +622,9 @@ bool K3b::Iso9660::open()
             return false;
     }
 
+    if( d->cacheSize > 0 && !dynamic_cast<K3b::Iso9660CachingBackend*>( d->backend ) )
+        d->backend = new K3b::Iso9660CachingBackend( d->backend, d->cacheSize );
+
     d->isOpen = d->backend->open();
     if( !d->isOpen )
         return false;
@@ -403,6 +403,22 @@ namespace K3b {
          */
         int read( unsigned int sector, char* data, int len );
 
+        /**
+         * Reads \p len bytes starting at byte \p pos. This is used by
+         * Iso9660File to serve unaligned reads.
+         *
+         * @return number of bytes read or -1 on error
+         */
+        int readBytes( quint64 pos, char* data, int len );
+
+        /**
+         * Set the size of the sector cache in bytes. The cache is put in
+         * front of the backend on open(). 0 disables the cache.
+         *
+         * Defaults to Iso9660CachingBackend::DefaultCacheSize.
+         */
+        void setCacheSize( int size );
+
         /**
          * The name of the os file, as passed to the constructor
          * Null if you did not use the QString constructor.
@@ -20,7 +20,13 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 
+#include <QByteArray>
+#include <QDebug>
 #include <QFile>
+#include <QHash>
+#include <QVector>
+
+#include <string.h>
 
 #include "k3bdevice.h"
 
@@ -70,10 +76,13 @@ int K3b::Iso9660DeviceBackend::read( unsigned int sector, char* data, int len )
 {
     if( isOpen() ) {
         //
-        // split the number of sectors to be read
-        // FIXME: use a "real" value, not some arbitrary one
+        // split the number of sectors to be read into the largest commands
+        // the kernel accepts (64 sectors if that is unknown)
         //
-        static const int maxReadSectors = 20;
+        int maxReadSectors = m_device->maxTransferLength() / 2048;
+        if( maxReadSectors <= 0 )
+            maxReadSectors = 64;
+        maxReadSectors = qMin( maxReadSectors, 0xFFFF );
         int sectorsRead = 0;
         int retries = 10;  // TODO: no fixed value
         while( retries ) {
@@ -236,3 +245,268 @@ int K3b::Iso9660LibDvdCssBackend::read( unsigned int sector, char* data, int len
     return read;
 }
 
+
+
+//
+// K3b::Iso9660CachingBackend -----------------------------------
+//
+
+namespace {
+    const int s_blockBytes = K3b::Iso9660CachingBackend::BlockSectors*2048;
+
+    // the maximum number of blocks read at once in sequential mode
+    const int s_maxReadAheadBlocks = 8;
+
+    // number of reads following each other before we consider the access sequential
+    const int s_sequentialThreshold = 2;
+}
+
+
+class K3b::Iso9660CachingBackend::Private
+{
+public:
+    struct Block {
+        quint64 index;     // first sector / BlockSectors
+        int sectors;       // number of valid sectors
+        quint64 lastUse;
+    };
+
+    Iso9660Backend* backend;
+    int cacheBlocks;
+    int readAheadBlocks;
+
+    QByteArray buffer;
+    QByteArray readAheadBuffer;
+    QVector<Block> blocks;
+    QHash<quint64, int> blockMap;
+    quint64 useCounter;
+
+    quint64 nextSector;
+    int sequentialReads;
+
+    char* blockData( int slot ) {
+        return buffer.data() + slot*s_blockBytes;
+    }
+
+    void clear() {
+        blocks.clear();
+        blockMap.clear();
+        useCounter = 0;
+        nextSector = 0;
+        sequentialReads = 0;
+    }
+
+    void updateAccessPattern( quint64 firstSector, quint64 endSector ) {
+        if( firstSector == nextSector || ( firstSector < nextSector && endSector > nextSector ) )
+            ++sequentialReads;
+        else
+            sequentialReads = 0;
+        nextSector = endSector;
+    }
+
+    int freeSlot();
+    int loadBlocks( quint64 index, int count );
+    int block( quint64 index );
+};
+
+
+int K3b::Iso9660CachingBackend::Private::freeSlot()
+{
+    if( blocks.count() < cacheBlocks ) {
+        Block b = { 0, 0, 0 };
+        blocks.append( b );
+        return blocks.count()-1;
+    }
+
+    // least recently used
+    int slot = 0;
+    for( int i = 1; i < blocks.count(); ++i ) {
+        if( blocks[i].lastUse < blocks[slot].lastUse )
+            slot = i;
+    }
+
+    if( blocks[slot].sectors > 0 )
+        blockMap.remove( blocks[slot].index );
+    blocks[slot].sectors = 0;
+    blocks[slot].lastUse = 0;
+    return slot;
+}
+
+
+int K3b::Iso9660CachingBackend::Private::loadBlocks( quint64 index, int count )
+{
+    // do not read blocks we already have
+    int n = 1;
+    while( n < count && !blockMap.contains( index+n ) )
+        ++n;
+
+    int read = -1;
+    if( n > 1 ) {
+        read = backend->read( index*BlockSectors, readAheadBuffer.data(), n*BlockSectors );
+        if( read > 0 ) {
+            for( int i = 0; i*BlockSectors < read && i < n; ++i ) {
+                const int slot = freeSlot();
+                blocks[slot].index = index+i;
+                blocks[slot].sectors = qMin( read - i*BlockSectors, (int)BlockSectors );
+                blocks[slot].lastUse = ++useCounter;
+                ::memcpy( blockData( slot ), readAheadBuffer.constData() + i*s_blockBytes, blocks[slot].sectors*2048 );
+                blockMap.insert( index+i, slot );
+            }
+            return blockMap.value( index );
+        }
+        // maybe we hit the end of the medium. Try a single block.
+    }
+
+    const int slot = freeSlot();
+    read = backend->read( index*BlockSectors, blockData( slot ), BlockSectors );
+    if( read <= 0 )
+        return -1;
+
+    blocks[slot].index = index;
+    blocks[slot].sectors = qMin( read, (int)BlockSectors );
+    blocks[slot].lastUse = ++useCounter;
+    blockMap.insert( index, slot );
+    return slot;
+}
+
+
+int K3b::Iso9660CachingBackend::Private::block( quint64 index )
+{
+    QHash<quint64, int>::const_iterator it = blockMap.constFind( index );
+    if( it != blockMap.constEnd() ) {
+        blocks[it.value()].lastUse = ++useCounter;
+        return it.value();
+    }
+    else {
+        return loadBlocks( index, sequentialReads >= s_sequentialThreshold ? readAheadBlocks : 1 );
+    }
+}
+
+
+K3b::Iso9660CachingBackend::Iso9660CachingBackend( Iso9660Backend* backend, int cacheSize )
+    : d( new Private )
+{
+    d->backend = backend;
+    d->cacheBlocks = qMax( 2, ( cacheSize + s_blockBytes - 1 ) / s_blockBytes );
+    d->readAheadBlocks = qMin( s_maxReadAheadBlocks, d->cacheBlocks/2 );
+    d->clear();
+}
+
+
+K3b::Iso9660CachingBackend::~Iso9660CachingBackend()
+{
+    close();
+    delete d->backend;
+    delete d;
+}
+
+
+bool K3b::Iso9660CachingBackend::open()
+{
+    if( !d->backend->open() )
+        return false;
+
+    if( d->buffer.isEmpty() ) {
+        d->buffer.resize( d->cacheBlocks*s_blockBytes );
+        d->readAheadBuffer.resize( d->readAheadBlocks*s_blockBytes );
+    }
+    return true;
+}
+
+
+void K3b::Iso9660CachingBackend::close()
+{
+    d->backend->close();
+    d->clear();
+    d->buffer.clear();
+    d->readAheadBuffer.clear();
+}
+
+
+bool K3b::Iso9660CachingBackend::isOpen() const
+{
+    return d->backend->isOpen();
+}
+
+
+K3b::Iso9660Backend* K3b::Iso9660CachingBackend::backend() const
+{
+    return d->backend;
+}
+
+
+int K3b::Iso9660CachingBackend::read( unsigned int sector, char* data, int len )
+{
+    if( !isOpen() || d->buffer.isEmpty() )
+        return -1;
+    else if( len <= 0 )
+        return 0;
+
+    // large reads do not profit from the cache
+    if( len >= BlockSectors ) {
+        d->updateAccessPattern( sector, static_cast<quint64>(sector) + len );
+        return d->backend->read( sector, data, len );
+    }
+
+    const int read = readBytes( static_cast<quint64>(sector)*2048, data, len*2048 );
+    return ( read < 0 ? -1 : read/2048 );
+}
+
+
+int K3b::Iso9660CachingBackend::readBytes( quint64 pos, char* data, int len )
+{
+    if( !isOpen() || d->buffer.isEmpty() )
+        return -1;
+    else if( len <= 0 )
+        return 0;
+
+    int done = 0;
+
+    // read the aligned part of large reads directly into the destination
+    if( pos % 2048 == 0 && len >= s_blockBytes ) {
+        const int sectors = len/2048;
+        const int read = this->read( pos/2048, data, sectors );
+        if( read < 0 )
+            return -1;
+        else if( read < sectors )
+            return read*2048;
+        done = read*2048;
+    }
+    else {
+        d->updateAccessPattern( pos/2048, ( pos + len + 2047 )/2048 );
+    }
+
+    while( done < len ) {
+        const quint64 p = pos + done;
+        const quint64 index = p/s_blockBytes;
+        const int blockOffset = p - index*s_blockBytes;
+
+        const int slot = d->block( index );
+        if( slot < 0 ) {
+            // the block could not be read as a whole. This happens at the end
+            // of a medium or on a damaged sector. Read the single sector instead.
+            const int sectorOffset = p % 2048;
+            if( d->backend->read( p/2048, d->readAheadBuffer.data(), 1 ) != 1 )
+                break;
+            const int chunk = qMin( 2048 - sectorOffset, len - done );
+            ::memcpy( data + done, d->readAheadBuffer.constData() + sectorOffset, chunk );
+            done += chunk;
+            continue;
+        }
+
+        const Private::Block& b = d->blocks.at( slot );
+        const int available = b.sectors*2048 - blockOffset;
+        if( available <= 0 )
+            break;
+
+        const int chunk = qMin( available, len - done );
+        ::memcpy( data + done, d->blockData( slot ) + blockOffset, chunk );
+        done += chunk;
+
+        // a short block marks the end of the data
+        if( b.sectors < BlockSectors && chunk == available )
+            break;
+    }
+
+    return ( done > 0 ? done : -1 );
+}
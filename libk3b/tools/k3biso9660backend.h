@@ -18,6 +18,7 @@
 #include "k3b_export.h"
 
 #include <QString>
+#include <QtGlobal>
 
 namespace K3b {
     namespace Device {
@@ -87,6 +88,51 @@ namespace K3b {
         Device::Device* m_device;
         LibDvdCss* m_libDvdCss;
     };
+
+    /**
+     * A read-ahead sector cache in front of another backend.
+     *
+     * Small reads are served from cached blocks of BlockSectors sectors
+     * which are read from the underlying backend with single aligned
+     * reads. Once a sequential access pattern is detected several blocks
+     * are read at once. Large aligned reads bypass the cache.
+     *
+     * Iso9660CachingBackend takes ownership of the backend and deletes it.
+     */
+    class LIBK3B_EXPORT Iso9660CachingBackend : public Iso9660Backend
+    {
+    public:
+        enum {
+            BlockSectors = 32,
+            DefaultCacheSize = 4*1024*1024
+        };
+
+        /**
+         * \param cacheSize The size of the cache in bytes. It is rounded
+         *                  up to at least two blocks.
+         */
+        explicit Iso9660CachingBackend( Iso9660Backend* backend, int cacheSize = DefaultCacheSize );
+        ~Iso9660CachingBackend();
+
+        bool open();
+        void close();
+        bool isOpen() const;
+        int read( unsigned int sector, char* data, int len );
+
+        /**
+         * Reads \p len bytes starting at byte \p pos. Unaligned reads are
+         * copied straight from the cache.
+         *
+         * \return The number of bytes read or -1 on error.
+         */
+        int readBytes( quint64 pos, char* data, int len );
+
+        Iso9660Backend* backend() const;
+
+    private:
+        class Private;
+        Private* d;
+    };
 }
 
 #endif
@@ -60,13 +60,17 @@ void K3b::MediaCache::PollThread::run()
         bool unitReady = m_deviceEntry->medium.device()->testUnitReady();
         bool mediumCached = ( m_deviceEntry->medium.diskInfo().diskState() != K3b::Device::STATE_NO_MEDIA );
 
+        // catches a medium which has been replaced between two polls
+        bool mediaEvent = m_deviceEntry->medium.device()->checkMediaEvent();
+
         //
         // we only get the other information in case the disk state changed or if we have
         // no info at all (FIXME: there are drives around that are not able to provide a proper
         // disk state)
         //
         if( m_deviceEntry->medium.diskInfo().diskState() == K3b::Device::STATE_UNKNOWN ||
-            unitReady != mediumCached ) {
+            unitReady != mediumCached ||
+            mediaEvent ) {
 
             if( m_deviceEntry->blockedId == 0 )
                 emit checkingMedium( m_deviceEntry->medium.device(), QString() );
@@ -78,8 +82,10 @@ void K3b::MediaCache::PollThread::run()
             m_deviceEntry->writeMutex.lock();
 
             //
-            // The medium has changed. We need to update the information.
+            // The medium has changed. We need to update the information and must not
+            // use any response the device cached for the old one.
             //
+            m_deviceEntry->medium.device()->invalidateCachedResponses();
             K3b::Medium m( m_deviceEntry->medium.device() );
             m.update();
 
@@ -383,6 +389,7 @@ void K3b::MediaCache::resetDevice( K3b::Device::Device* dev )
 {
     if( DeviceEntry* e = findDeviceEntry( dev ) ) {
         qDebug() << "Resetting medium in" << dev->blockDeviceName();
+        dev->invalidateCachedResponses();
         e->writeMutex.lock();
         e->readMutex.lock();
         e->medium.reset();
@@ -179,6 +179,9 @@ void K3b::Medium::update()
     if( d->device ) {
         reset();
 
+        // avoid reopening the device for each of the many commands below
+        d->device->holdHandle();
+
         d->diskInfo = d->device->diskInfo();
 
         if( d->diskInfo.diskState() != K3b::Device::STATE_NO_MEDIA ) {
@@ -207,6 +210,8 @@ void K3b::Medium::update()
         }
 
         analyseContent();
+
+        d->device->releaseHandle();
     }
 }
 
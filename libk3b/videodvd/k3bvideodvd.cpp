@@ -22,7 +22,18 @@
 #include "k3bdevice.h"
 #include "k3b_i18n.h"
 
+#include <QAtomicInt>
+#include <QCryptographicHash>
+#include <QDataStream>
 #include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+#include <string.h>
 
 #include <inttypes.h> // needed by dvdreads headers
 #include <dvdread/dvd_reader.h>
@@ -62,6 +73,171 @@ namespace {
             return 0.0;
         }
     }
+
+    //
+    // Parsed discs are kept around for the lifetime of the process so re-opening
+    // the same Video DVD (rip view, preview, title model) does not touch the
+    // title sets again.
+    //
+    const int s_maxCachedDiscs = 8;
+
+    struct CacheEntry
+    {
+        QByteArray mediaId;
+        QVector<K3b::VideoDVD::Title> titles;
+    };
+
+    QMutex s_cacheMutex;
+    QList<CacheEntry> s_cache;
+
+    bool lookupCache( const QByteArray& mediaId, QVector<K3b::VideoDVD::Title>& titles )
+    {
+        QMutexLocker locker( &s_cacheMutex );
+        for( int i = 0; i < s_cache.count(); ++i ) {
+            if( s_cache[i].mediaId == mediaId ) {
+                // most recently used entries are kept at the front
+                s_cache.move( i, 0 );
+                titles = s_cache.first().titles;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void insertIntoCache( const QByteArray& mediaId, const QVector<K3b::VideoDVD::Title>& titles )
+    {
+        QMutexLocker locker( &s_cacheMutex );
+        CacheEntry entry;
+        entry.mediaId = mediaId;
+        entry.titles = titles;
+        s_cache.prepend( entry );
+        while( s_cache.count() > s_maxCachedDiscs )
+            s_cache.removeLast();
+    }
+
+    /**
+     * The volume set identifier of a Video DVD is assigned by the authoring software
+     * and is supposed to be unique. Together with the volume id and the layout of the
+     * VMG this is a reliable fingerprint which is cheap to read.
+     */
+    QByteArray createMediaId( const QString& volumeId, const unsigned char* volSetId, int volSetIdLen, ifo_handle_t* vmg )
+    {
+        QCryptographicHash hash( QCryptographicHash::Sha1 );
+        hash.addData( volumeId.toLatin1() );
+        hash.addData( reinterpret_cast<const char*>( volSetId ), volSetIdLen );
+
+        QByteArray vmgInfo;
+        QDataStream s( &vmgInfo, QIODevice::WriteOnly );
+        s << quint32( vmg->vmgi_mat->vmg_last_sector )
+          << quint32( vmg->vmgi_mat->vmgi_last_sector )
+          << quint32( vmg->vmgi_mat->vmg_category )
+          << quint16( vmg->vmgi_mat->vmg_nr_of_title_sets )
+          << quint16( vmg->tt_srpt->nr_of_srpts );
+        for( unsigned int i = 0; i < vmg->tt_srpt->nr_of_srpts; ++i )
+            s << quint32( vmg->tt_srpt->title[i].title_set_sector );
+        hash.addData( vmgInfo );
+
+        return hash.result().toHex();
+    }
+
+
+    /**
+     * Opens the IFO files of a list of title sets. Each instance works on its own
+     * dvd_reader_t since libdvdread readers must not be shared between threads.
+     */
+    class TitleSetOpener : public QRunnable
+    {
+    public:
+        TitleSetOpener( dvd_reader_t* reader,
+                        const QList<int>& titleSets,
+                        QAtomicInt& nextTitleSet,
+                        QMutex& resultMutex,
+                        QHash<int, ifo_handle_t*>& result )
+            : m_reader( reader ),
+              m_titleSets( titleSets ),
+              m_nextTitleSet( nextTitleSet ),
+              m_resultMutex( resultMutex ),
+              m_result( result ) {
+            setAutoDelete( true );
+        }
+
+        void run() {
+            int i = 0;
+            while( ( i = m_nextTitleSet.fetchAndAddOrdered( 1 ) ) < m_titleSets.count() ) {
+                ifo_handle_t* ifo = ifoOpen( m_reader, m_titleSets[i] );
+                QMutexLocker locker( &m_resultMutex );
+                m_result.insert( m_titleSets[i], ifo );
+            }
+        }
+
+    private:
+        dvd_reader_t* m_reader;
+        const QList<int>& m_titleSets;
+        QAtomicInt& m_nextTitleSet;
+        QMutex& m_resultMutex;
+        QHash<int, ifo_handle_t*>& m_result;
+    };
+
+
+    /**
+     * Open the IFOs of all \p titleSets. The first reader in \p readers is used for
+     * the calling thread. Additional readers are opened and appended to \p readers
+     * if there is enough work to justify them.
+     *
+     * \return false if any of the title sets could not be opened.
+     */
+    bool openTitleSets( K3b::Device::Device* dev,
+                        const QList<int>& titleSets,
+                        QList<dvd_reader_t*>& readers,
+                        QHash<int, ifo_handle_t*>& result )
+    {
+        // There is no point in hammering an optical drive with too many concurrent requests.
+        const int numWorkers = qBound( 1, qMin( QThread::idealThreadCount(), 4 ), titleSets.count() );
+
+        // DVDOpen initializes libdvdcss and is not reentrant. Thus, we open all readers here.
+        for( int i = 1; i < numWorkers; ++i ) {
+            dvd_reader_t* reader = DVDOpen( QFile::encodeName( dev->blockDeviceName() ) );
+            if( !reader )
+                break;
+            readers.append( reader );
+        }
+
+        QAtomicInt nextTitleSet( 0 );
+        QMutex resultMutex;
+
+        QThreadPool pool;
+        pool.setMaxThreadCount( readers.count() );
+        for( int i = 1; i < readers.count(); ++i )
+            pool.start( new TitleSetOpener( readers[i], titleSets, nextTitleSet, resultMutex, result ) );
+
+        // the calling thread does its share of the work, too
+        TitleSetOpener( readers.first(), titleSets, nextTitleSet, resultMutex, result ).run();
+        pool.waitForDone();
+
+        for( QHash<int, ifo_handle_t*>::const_iterator it = result.constBegin(); it != result.constEnd(); ++it ) {
+            if( !it.value() )
+                return false;
+        }
+        return result.count() == titleSets.count();
+    }
+
+
+    /**
+     * Closes all IFOs and all additionally opened readers. The first reader is left
+     * open since it belongs to the caller.
+     */
+    void closeTitleSets( QList<dvd_reader_t*>& readers, QHash<int, ifo_handle_t*>& ifos )
+    {
+        for( QHash<int, ifo_handle_t*>::iterator it = ifos.begin(); it != ifos.end(); ++it ) {
+            if( it.value() )
+                ifoClose( it.value() );
+        }
+        ifos.clear();
+
+        for( int i = 1; i < readers.count(); ++i )
+            DVDClose( readers[i] );
+        readers.erase( readers.begin() + qMin( 1, readers.count() ), readers.end() );
+    }
     
 } // namespace
 
@@ -87,6 +263,7 @@ bool K3b::VideoDVD::VideoDVD::open( K3b::Device::Device* dev )
 {
     m_device = 0;
     m_titles.clear();
+    m_mediaId.clear();
 
     //
     // Initialize libdvdread
@@ -101,10 +278,12 @@ bool K3b::VideoDVD::VideoDVD::open( K3b::Device::Device* dev )
     // Read volume id
     //
     char v[33];
-    if( DVDUDFVolumeInfo( dvdReaderT, v, 32, 0, 0 ) == 0 ) {
+    unsigned char volSetId[128];
+    ::memset( volSetId, 0, sizeof(volSetId) );
+    if( DVDUDFVolumeInfo( dvdReaderT, v, 32, volSetId, sizeof(volSetId) ) == 0 ) {
         m_volumeIdentifier = QString::fromLatin1( v, 31 );
     }
-    else if ( DVDISOVolumeInfo( dvdReaderT, v, 33, 0, 0 ) == 0 ) {
+    else if ( DVDISOVolumeInfo( dvdReaderT, v, 33, volSetId, sizeof(volSetId) ) == 0 ) {
         m_volumeIdentifier = QString::fromLatin1( v, 32 );
     }
     else {
@@ -123,6 +302,40 @@ bool K3b::VideoDVD::VideoDVD::open( K3b::Device::Device* dev )
         return false;
     }
 
+    //
+    // The volume descriptors and the VMG are all we need to identify the disc. If we
+    // parsed it before there is no need to touch the title sets again.
+    //
+    m_mediaId = createMediaId( m_volumeIdentifier, volSetId, sizeof(volSetId), vmg );
+    if( lookupCache( m_mediaId, m_titles ) ) {
+        qDebug() << "(K3b::VideoDVD) Using cached structure for" << m_volumeIdentifier;
+        ifoClose( vmg );
+        DVDClose( dvdReaderT );
+        m_device = dev;
+        return true;
+    }
+
+    //
+    // Several titles may share one title set. Open each of them only once.
+    //
+    QList<int> titleSets;
+    for( unsigned int i = 0; i < vmg->tt_srpt->nr_of_srpts; ++i ) {
+        const int ts = vmg->tt_srpt->title[i].title_set_nr;
+        if( !titleSets.contains( ts ) )
+            titleSets.append( ts );
+    }
+
+    QHash<int, ifo_handle_t*> titleSetIfos;
+    QList<dvd_reader_t*> readers;
+    readers.append( dvdReaderT );
+    if( !openTitleSets( dev, titleSets, readers, titleSetIfos ) ) {
+        qDebug() << "(K3b::VideoDVD) Can't open Title ifo.";
+        closeTitleSets( readers, titleSetIfos );
+        ifoClose( vmg );
+        DVDClose( dvdReaderT );
+        return false;
+    }
+
     //
     // parse titles
     //
@@ -142,15 +355,9 @@ bool K3b::VideoDVD::VideoDVD::open( K3b::Device::Device* dev )
         m_titles[i].m_ttn        = title.vts_ttn;
 
         //
-        // Open the title set the current title is a part of
+        // The title set the current title is a part of
         //
-        ifo_handle_t* titleIfo = ifoOpen( dvdReaderT, vmg->tt_srpt->title[i].title_set_nr );
-        if( !titleIfo ) {
-            qDebug() << "(K3b::VideoDVD) Can't open Title ifo.";
-            ifoClose( vmg );
-            DVDClose( dvdReaderT );
-            return false;
-        }
+        ifo_handle_t* titleIfo = titleSetIfos.value( title.title_set_nr );
 
         //
         // Length of this title
@@ -232,10 +439,9 @@ bool K3b::VideoDVD::VideoDVD::open( K3b::Device::Device* dev )
                 m_titles[i].m_ptts[j].m_lastSector = cur_pgc->cell_playback[j].last_sector;
             }
         }
-
-        ifoClose( titleIfo );
     }
 
+    closeTitleSets( readers, titleSetIfos );
     ifoClose( vmg );
     DVDClose( dvdReaderT );
 
@@ -246,6 +452,8 @@ bool K3b::VideoDVD::VideoDVD::open( K3b::Device::Device* dev )
         }
     }
 
+    insertIntoCache( m_mediaId, m_titles );
+
     //
     // Setting the device makes this a valid instance
     //
@@ -255,6 +463,13 @@ bool K3b::VideoDVD::VideoDVD::open( K3b::Device::Device* dev )
 }
 
 
+void K3b::VideoDVD::VideoDVD::clearCache()
+{
+    QMutexLocker locker( &s_cacheMutex );
+    s_cache.clear();
+}
+
+
 const K3b::VideoDVD::Title& K3b::VideoDVD::VideoDVD::title( unsigned int num ) const
 {
     return m_titles[num];
@@ -19,6 +19,7 @@
 
 #include "k3b_export.h"
 
+#include <QByteArray>
 #include <QString>
 #include <QVector>
 
@@ -41,6 +42,10 @@ namespace K3b {
      * analysis was successful and the structures are filled.
      *
      * After open() has returned the device has already been closed.
+     *
+     * The parsed structure of a disc is cached for the lifetime of the process.
+     * Opening the same Video DVD again only reads the volume descriptors and the
+     * VMG to identify the disc.
      */
     namespace VideoDVD
     {
@@ -61,11 +66,19 @@ namespace K3b {
             /**
              * Open a video dvd and parse it's contents. The device will be closed after this
              * method returns, regardless of it's success.
+             *
+             * The title sets are opened concurrently and the result is cached, see mediaId().
              */
             bool open( Device::Device* dev );
 
             Device::Device* device() const { return m_device; }
             const QString& volumeIdentifier() const { return m_volumeIdentifier; }
+
+            /**
+             * A fingerprint of the disc built from the volume descriptors and the VMG.
+             * It is used as the key for the structure cache.
+             */
+            const QByteArray& mediaId() const { return m_mediaId; }
             unsigned int numTitles() const { return m_titles.count(); }
 
             /**
@@ -76,10 +89,17 @@ namespace K3b {
 
             void debug() const;
 
+            /**
+             * Drop all cached Video DVD structures. There is normally no need to call
+             * this since the cache is keyed on the disc's media id.
+             */
+            static void clearCache();
+
         private:
             Device::Device* m_device;
             QVector<Title> m_titles;
             QString m_volumeIdentifier;
+            QByteArray m_mediaId;
         };
 
         LIBK3B_EXPORT QString audioFormatString( int format );
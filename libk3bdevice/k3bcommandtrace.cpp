@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bcommandtrace.h"
+#include "k3bscsicommand.h"
+
+#include <QStringList>
+
+#include <atomic>
+
+
+K3b::Device::CommandTrace::CommandTrace()
+    : m_slots( new Slot[RingSize] ),
+      m_head( 0 ),
+      m_histograms( new QAtomicInt[256*HistogramBuckets] )
+{
+    for( int i = 0; i < RingSize; ++i )
+        m_slots[i].sequence.store( 0 );
+    for( int i = 0; i < 256*HistogramBuckets; ++i )
+        m_histograms[i].store( 0 );
+    m_clock.start();
+}
+
+
+K3b::Device::CommandTrace::~CommandTrace()
+{
+    delete [] m_slots;
+    delete [] m_histograms;
+}
+
+
+int K3b::Device::CommandTrace::bucket( qint64 nsecs )
+{
+    const qint64 usecs = nsecs/1000;
+    int i = 0;
+    while( i < HistogramBuckets-1 && ( Q_INT64_C(1) << i ) <= usecs )
+        ++i;
+    return i;
+}
+
+
+qint64 K3b::Device::CommandTrace::bucketLimit( int i )
+{
+    if( i >= HistogramBuckets-1 )
+        return -1;
+    else
+        return ( Q_INT64_C(1) << i );
+}
+
+
+void K3b::Device::CommandTrace::record( Entry entry )
+{
+    entry.timestamp = m_clock.nsecsElapsed()/1000;
+
+    //
+    // The sequence number of a slot is 0 while it is being written and the
+    // position in the trace plus one once it is complete. Readers check
+    // it before and after copying the entry.
+    //
+    const quint64 pos = m_head.fetchAndAddRelaxed( 1 );
+    Slot& slot = m_slots[pos % RingSize];
+    slot.sequence.storeRelease( 0 );
+    std::atomic_thread_fence( std::memory_order_release );
+    slot.entry = entry;
+    slot.sequence.storeRelease( pos + 1 );
+
+    m_histograms[entry.command*HistogramBuckets + bucket( entry.nsecs )].fetchAndAddRelaxed( 1 );
+}
+
+
+QList<K3b::Device::CommandTrace::Entry> K3b::Device::CommandTrace::entries() const
+{
+    QList<Entry> list;
+
+    const quint64 head = m_head.loadAcquire();
+    const quint64 start = ( head > quint64( RingSize ) ? head - RingSize : 0 );
+    for( quint64 pos = start; pos < head; ++pos ) {
+        const Slot& slot = m_slots[pos % RingSize];
+        if( slot.sequence.loadAcquire() != pos + 1 )
+            continue;
+        const Entry entry = slot.entry;
+        std::atomic_thread_fence( std::memory_order_acquire );
+        if( slot.sequence.load() == pos + 1 )
+            list.append( entry );
+    }
+
+    return list;
+}
+
+
+QVector<quint32> K3b::Device::CommandTrace::histogram( unsigned char command ) const
+{
+    QVector<quint32> h( HistogramBuckets );
+    for( int i = 0; i < HistogramBuckets; ++i )
+        h[i] = m_histograms[command*HistogramBuckets + i].load();
+    return h;
+}
+
+
+void K3b::Device::CommandTrace::clear()
+{
+    m_head.storeRelease( 0 );
+    for( int i = 0; i < RingSize; ++i )
+        m_slots[i].sequence.storeRelease( 0 );
+    for( int i = 0; i < 256*HistogramBuckets; ++i )
+        m_histograms[i].store( 0 );
+}
+
+
+namespace {
+    QString formatDuration( qint64 usecs )
+    {
+        if( usecs < 1000 )
+            return QString::fromLatin1( "%1 us" ).arg( usecs );
+        else if( usecs < 1000*1000 )
+            return QString::fromLatin1( "%1 ms" ).arg( double( usecs )/1000.0, 0, 'f', 1 );
+        else
+            return QString::fromLatin1( "%1 s" ).arg( double( usecs )/1000000.0, 0, 'f', 2 );
+    }
+
+
+    QString bucketString( int i )
+    {
+        const qint64 limit = K3b::Device::CommandTrace::bucketLimit( i );
+        if( limit < 0 )
+            return QString::fromLatin1( ">=%1" ).arg( formatDuration( K3b::Device::CommandTrace::bucketLimit( i-1 ) ) );
+        else
+            return QString::fromLatin1( "<%1" ).arg( formatDuration( limit ) );
+    }
+
+
+    // the bucket containing the given fraction of all commands
+    int percentileBucket( const QVector<quint32>& h, quint64 total, double fraction )
+    {
+        const quint64 wanted = quint64( double( total )*fraction + 0.5 );
+        quint64 count = 0;
+        for( int i = 0; i < h.count(); ++i ) {
+            count += h[i];
+            if( count >= wanted && count > 0 )
+                return i;
+        }
+        return h.count()-1;
+    }
+}
+
+
+QString K3b::Device::CommandTrace::report() const
+{
+    QStringList lines;
+
+    lines << QLatin1String( "Latency per command:" );
+    for( int command = 0; command < 256; ++command ) {
+        const QVector<quint32> h = histogram( command );
+        quint64 total = 0;
+        for( int i = 0; i < h.count(); ++i )
+            total += h[i];
+        if( total == 0 )
+            continue;
+
+        lines << QString::fromLatin1( "  %1 (%2): %3 commands, median %4, p99 %5" )
+            .arg( commandString( command ) )
+            .arg( QString::number( command, 16 ) )
+            .arg( total )
+            .arg( bucketString( percentileBucket( h, total, 0.5 ) ) )
+            .arg( bucketString( percentileBucket( h, total, 0.99 ) ) );
+
+        QStringList buckets;
+        for( int i = 0; i < h.count(); ++i ) {
+            if( h[i] > 0 )
+                buckets << QString::fromLatin1( "%1: %2" ).arg( bucketString( i ) ).arg( h[i] );
+        }
+        lines << QLatin1String( "    " ) + buckets.join( QLatin1String( ", " ) );
+    }
+
+    const QList<Entry> list = entries();
+    lines << QString::fromLatin1( "Last %1 commands (time, command, lba, length, duration, sense):" ).arg( list.count() );
+    Q_FOREACH( const Entry& e, list ) {
+        QString line = QString::fromLatin1( "  %1 %2 %3 %4 %5" )
+                       .arg( double( e.timestamp )/1000000.0, 12, 'f', 6 )
+                       .arg( commandString( e.command ), -20 )
+                       .arg( e.lba, 10 )
+                       .arg( e.length, 8 )
+                       .arg( formatDuration( e.nsecs/1000 ), 10 );
+        if( !e.success )
+            line += QString::fromLatin1( " failed %1/%2/%3" )
+                    .arg( uint( e.senseKey ), 2, 16, QLatin1Char( '0' ) )
+                    .arg( uint( e.asc ), 2, 16, QLatin1Char( '0' ) )
+                    .arg( uint( e.ascq ), 2, 16, QLatin1Char( '0' ) );
+        lines << line;
+    }
+
+    return lines.join( QLatin1String( "\n" ) );
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef _K3B_COMMAND_TRACE_H_
+#define _K3B_COMMAND_TRACE_H_
+
+#include "k3bdevice_export.h"
+
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+
+namespace K3b {
+    namespace Device
+    {
+        /**
+         * Records the commands sent to a device together with their duration and
+         * aggregates per opcode latency histograms.
+         *
+         * The most recent commands are kept in a fixed size ring buffer. Recording
+         * is lock-free so it can be done from any thread without delaying the
+         * commands. Reading is meant for diagnostics and may skip entries which
+         * are overwritten at the same time.
+         *
+         * \sa Device::setCommandTracingEnabled()
+         */
+        class LIBK3BDEVICE_EXPORT CommandTrace
+        {
+        public:
+            enum {
+                RingSize = 4096,
+
+                /**
+                 * Bucket 0 counts commands faster than 1 usec, bucket i > 0 the ones taking
+                 * less than 2^i usecs, and the last bucket all slower ones.
+                 */
+                HistogramBuckets = 24
+            };
+
+            struct Entry {
+                qint64 timestamp;   /**< usecs since the trace has been created */
+                qint64 nsecs;       /**< duration of the command */
+                quint32 lba;        /**< start sector for commands which address one, 0 otherwise */
+                quint32 length;     /**< transfer length in bytes */
+                unsigned char command;
+                unsigned char senseKey;
+                unsigned char asc;
+                unsigned char ascq;
+                bool success;
+            };
+
+            CommandTrace();
+            ~CommandTrace();
+
+            /**
+             * Adds \p entry to the ring buffer and the histogram of its command.
+             * The timestamp is set by this method.
+             */
+            void record( Entry entry );
+
+            /**
+             * \return The most recent commands, oldest first.
+             */
+            QList<Entry> entries() const;
+
+            /**
+             * \return The latency histogram of \p command with HistogramBuckets
+             * entries.
+             */
+            QVector<quint32> histogram( unsigned char command ) const;
+
+            /**
+             * \return The upper bound of bucket \p i in usecs or -1 for the last bucket.
+             */
+            static qint64 bucketLimit( int i );
+
+            /**
+             * Forget all recorded commands. Commands recorded at the same time
+             * may or may not be kept.
+             */
+            void clear();
+
+            /**
+             * A human readable summary of the histograms followed by the
+             * recorded commands, suitable for the debugging output.
+             */
+            QString report() const;
+
+        private:
+            static int bucket( qint64 nsecs );
+
+            struct Slot {
+                QAtomicInteger<quint64> sequence;
+                Entry entry;
+            };
+
+            Slot* m_slots;
+            QAtomicInteger<quint64> m_head;
+            QAtomicInt* m_histograms;
+            QElapsedTimer m_clock;
+
+            Q_DISABLE_COPY( CommandTrace )
+        };
+    }
+}
+
+#endif
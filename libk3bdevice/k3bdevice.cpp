@@ -21,6 +21,7 @@
 #include "k3bmmc.h"
 #include "k3bscsicommand.h"
 #include "k3bcrc.h"
+#include "k3bresponsecache.h"
 
 #include "config-k3b.h"
 
@@ -33,9 +34,12 @@
 #endif
 
 #include <qglobal.h>
+#include <QAtomicPointer>
 #include <QDebug>
 #include <QFile>
+#include <QFileInfo>
 #include <QMutex>
+#include <QMutexLocker>
 #include <QStringList>
 
 #include <sys/types.h>
@@ -124,7 +128,17 @@ public:
         : supportedProfiles(0),
           deviceHandle(HANDLE_DEFAULT_VALUE),
           openedReadWrite(false),
-          burnfree(false) {
+          burnfree(false),
+          handleHolds(0),
+          closeOnRelease(false),
+          tracingEnabled(0),
+          commandTrace(0),
+          maxTransferLength(-1) {
+        ::memset( commandStats, 0, sizeof(commandStats) );
+    }
+
+    ~Private() {
+        delete commandTrace.load();
     }
 
     Solid::Device solidDevice;
@@ -154,6 +168,24 @@ public:
 
     QMutex mutex;
     QMutex openCloseMutex;
+
+    // responses to read-only commands, valid for the current medium generation only
+    ResponseCache responseCache;
+
+    QMutex statsMutex;
+    Device::CommandStatistics commandStats[256];
+
+    // protected by openCloseMutex
+    int handleHolds;
+    bool closeOnRelease;
+
+    // the trace is created once and kept until the device is deleted
+    // so commands can record into it without locking
+    QAtomicInt tracingEnabled;
+    QAtomicPointer<CommandTrace> commandTrace;
+
+    // -1 until determined
+    QAtomicInt maxTransferLength;
 };
 
 #ifdef Q_OS_FREEBSD
@@ -1672,8 +1704,10 @@ bool K3b::Device::Device::eject() const
             close();
     }
     usageUnlock();
-    if ( success )
+    if ( success ) {
+        invalidateCachedResponses();
         return success;
+    }
 #elif defined(Q_OS_LINUX)
     bool success = false;
     bool needToClose = !isOpen();
@@ -1686,8 +1720,10 @@ bool K3b::Device::Device::eject() const
             close();
     }
     usageUnlock();
-    if ( success )
+    if ( success ) {
+        invalidateCachedResponses();
         return success;
+    }
 #endif
 
     ScsiCommand cmd( this );
@@ -1717,8 +1753,10 @@ bool K3b::Device::Device::load() const
             close();
     }
     usageUnlock();
-    if ( success )
+    if ( success ) {
+        invalidateCachedResponses();
         return success;
+    }
 #elif defined(Q_OS_LINUX)
     bool success = false;
     bool needToClose = !isOpen();
@@ -1731,8 +1769,10 @@ bool K3b::Device::Device::load() const
             close();
     }
     usageUnlock();
-    if ( success )
+    if ( success ) {
+        invalidateCachedResponses();
         return success;
+    }
 #endif
 
     ScsiCommand cmd( this );
@@ -1768,17 +1808,34 @@ K3b::Device::Device::Handle K3b::Device::Device::handle() const
 }
 
 
+namespace {
+    void closeDevice( K3b::Device::Device::Handle handle )
+    {
+#if defined(Q_OS_FREEBSD)
+        cam_close_device( handle );
+#elif defined(Q_OS_WIN32)
+        CloseHandle( handle );
+#else
+        ::close( handle );
+#endif
+    }
+}
+
+
 bool K3b::Device::Device::open( bool write ) const
 {
-    if( d->openedReadWrite != write )
-        close();
-
     QMutexLocker ml( &d->openCloseMutex );
 
-    d->openedReadWrite = write;
+    // a read-only handle needs to be reopened for writing but not vice versa
+    if( write && !d->openedReadWrite && d->deviceHandle != HANDLE_DEFAULT_VALUE ) {
+        closeDevice( d->deviceHandle );
+        d->deviceHandle = HANDLE_DEFAULT_VALUE;
+    }
 
-    if( d->deviceHandle == HANDLE_DEFAULT_VALUE)
+    if( d->deviceHandle == HANDLE_DEFAULT_VALUE) {
+        d->openedReadWrite = write;
         d->deviceHandle = openDevice( QFile::encodeName(blockDeviceName()), write );
+    }
 
     return ( d->deviceHandle != HANDLE_DEFAULT_VALUE);
 }
@@ -1791,17 +1848,37 @@ void K3b::Device::Device::close() const
     if( d->deviceHandle == HANDLE_DEFAULT_VALUE)
         return;
 
-#if defined(Q_OS_FREEBSD)
-    cam_close_device(d->deviceHandle);
-#elif defined(Q_OS_WIN32)
-    CloseHandle(d->deviceHandle);
-#else
-    ::close( d->deviceHandle );
-#endif
+    if( d->handleHolds > 0 ) {
+        d->closeOnRelease = true;
+        return;
+    }
+
+    closeDevice( d->deviceHandle );
     d->deviceHandle = HANDLE_DEFAULT_VALUE;
 }
 
 
+void K3b::Device::Device::holdHandle() const
+{
+    QMutexLocker ml( &d->openCloseMutex );
+    if( d->handleHolds++ == 0 )
+        d->closeOnRelease = ( d->deviceHandle == HANDLE_DEFAULT_VALUE );
+}
+
+
+void K3b::Device::Device::releaseHandle() const
+{
+    QMutexLocker ml( &d->openCloseMutex );
+    if( d->handleHolds > 0 &&
+        --d->handleHolds == 0 &&
+        d->closeOnRelease &&
+        d->deviceHandle != HANDLE_DEFAULT_VALUE ) {
+        closeDevice( d->deviceHandle );
+        d->deviceHandle = HANDLE_DEFAULT_VALUE;
+    }
+}
+
+
 bool K3b::Device::Device::isOpen() const
 {
     return ( d->deviceHandle != HANDLE_DEFAULT_VALUE);
@@ -3133,6 +3210,35 @@ void K3b::Device::Device::checkWritingModes()
 }
 
 
+bool K3b::Device::Device::setIncrementalWriteParameters( bool testWrite, bool multiSession ) const
+{
+    UByteArray buffer;
+
+    if( !modeSense( buffer, 0x05 ) || buffer.size() < 18 ) { // 8 bytes header + 10 bytes used modepage
+        qDebug() << "(K3b::Device::Device) " << blockDeviceName() << ": modeSense 0x05 failed!";
+        return false;
+    }
+
+    wr_param_page_05* mp = (struct wr_param_page_05*)(buffer.data()+8);
+
+    mp->PS = 0;
+    mp->BUFE = 1;
+    mp->LS_V = 0;
+    mp->test_write = testWrite ? 1 : 0;
+    mp->write_type = 0x00;   // Incremental (packet)
+    mp->multi_session = multiSession ? 3 : 0;
+    mp->fp = 0;
+    mp->copy = 0;
+    mp->track_mode = 5;
+    mp->dbtype = 8;          // Mode 1
+    mp->host_appl_code = 0;
+    mp->session_format = 0;
+    mp->packet_size[0] = mp->packet_size[1] = mp->packet_size[2] = mp->packet_size[3] = 0;
+
+    return modeSelect( buffer, 1, 0 );
+}
+
+
 int K3b::Device::Device::getMaxWriteSpeedVia2A() const
 {
     int ret = 0;
@@ -3174,6 +3280,63 @@ int K3b::Device::Device::determineMaximalWriteSpeed() const
 }
 
 
+int K3b::Device::Device::determineMaximalReadSpeed() const
+{
+    int ret = 0;
+
+    //
+    // Performance data for reading with nominal tolerance. Each descriptor
+    // covers a range of the medium and contains the speed at its start and
+    // its end. Since the drives read in CLV or CAV the end speed is the highest.
+    //
+    UByteArray data;
+    if( getPerformance( data, 0x0, 0x10 ) && data.size() >= 8 ) {
+        const int numDesc = (data.size() - 8)/16;
+        for( int i = 0; i < numDesc; ++i ) {
+            ret = qMax( ret, int( from4Byte( &data[8+i*16+4] ) ) );
+            ret = qMax( ret, int( from4Byte( &data[8+i*16+12] ) ) );
+        }
+        qDebug() << "(K3b::Device::Device) " << blockDeviceName()
+                 << ": max reading speed via GET PERFORMANCE: " << ret << " KB/s";
+    }
+
+    if( ret > 0 )
+        return ret;
+    else
+        return d->maxReadSpeed;
+}
+
+
+int K3b::Device::Device::maxTransferLength() const
+{
+    int len = d->maxTransferLength.load();
+    if( len >= 0 )
+        return len;
+
+    len = 0;
+#ifdef Q_OS_LINUX
+    //
+    // The block layer splits requests larger than max_sectors_kb which does not
+    // work for SG_IO. max_hw_sectors_kb is the limit of the controller.
+    //
+    const QString name = QFileInfo( QFileInfo( blockDeviceName() ).canonicalFilePath() ).fileName();
+    Q_FOREACH( const QString& limit, QStringList() << QLatin1String( "max_sectors_kb" ) << QLatin1String( "max_hw_sectors_kb" ) ) {
+        QFile f( QString::fromLatin1( "/sys/class/block/%1/queue/%2" ).arg( name ).arg( limit ) );
+        if( f.open( QIODevice::ReadOnly ) ) {
+            bool ok = false;
+            const int kb = QString::fromLatin1( f.readAll() ).trimmed().toInt( &ok );
+            if( ok && kb > 0 && ( len == 0 || kb*1024 < len ) )
+                len = kb*1024;
+        }
+    }
+#endif
+
+    qDebug() << "(K3b::Device::Device) " << blockDeviceName() << ": max transfer length: " << len;
+    d->maxTransferLength.store( len );
+    return len;
+}
+
+
 QList<int> K3b::Device::Device::determineSupportedWriteSpeeds() const
 {
     QList<int> ret;
@@ -3705,6 +3868,87 @@ QByteArray K3b::Device::Device::mediaId( int mediaType ) const
 // }
 
 
+quint64 K3b::Device::Device::mediumGeneration() const
+{
+    return d->responseCache.generation();
+}
+
+
+void K3b::Device::Device::invalidateCachedResponses() const
+{
+    d->responseCache.invalidate();
+}
+
+
+K3b::Device::Device::CommandCacheStatistics K3b::Device::Device::commandCacheStatistics() const
+{
+    const ResponseCache::Statistics cacheStats = d->responseCache.statistics();
+    CommandCacheStatistics stats;
+    stats.hits = cacheStats.hits;
+    stats.misses = cacheStats.misses;
+    stats.invalidations = cacheStats.invalidations;
+    return stats;
+}
+
+
+K3b::Device::ResponseCache& K3b::Device::Device::responseCache() const
+{
+    return d->responseCache;
+}
+
+
+K3b::Device::Device::CommandStatistics K3b::Device::Device::commandStatistics( unsigned char command ) const
+{
+    QMutexLocker locker( &d->statsMutex );
+    return d->commandStats[command];
+}
+
+
+void K3b::Device::Device::resetCommandStatistics() const
+{
+    QMutexLocker locker( &d->statsMutex );
+    ::memset( d->commandStats, 0, sizeof(d->commandStats) );
+}
+
+
+void K3b::Device::Device::setCommandTracingEnabled( bool enabled ) const
+{
+    if( enabled && !d->commandTrace.load() ) {
+        CommandTrace* trace = new CommandTrace();
+        if( !d->commandTrace.testAndSetOrdered( 0, trace ) )
+            delete trace;
+    }
+    d->tracingEnabled.storeRelease( enabled ? 1 : 0 );
+}
+
+
+bool K3b::Device::Device::commandTracingEnabled() const
+{
+    return d->tracingEnabled.load() != 0;
+}
+
+
+K3b::Device::CommandTrace* K3b::Device::Device::commandTrace() const
+{
+    return d->commandTrace.loadAcquire();
+}
+
+
+void K3b::Device::Device::recordCommand( const CommandTrace::Entry& entry ) const
+{
+    d->statsMutex.lock();
+    CommandStatistics& stats = d->commandStats[entry.command];
+    ++stats.commands;
+    if( entry.success )
+        stats.bytes += entry.length;
+    stats.nsecs += entry.nsecs;
+    d->statsMutex.unlock();
+
+    if( d->tracingEnabled.loadAcquire() )
+        d->commandTrace.loadAcquire()->record( entry );
+}
+
+
 void K3b::Device::Device::usageLock() const
 {
     d->mutex.lock();
@@ -20,6 +20,7 @@
 #include "k3bdiskinfo.h"
 #include "k3bcdtext.h"
 #include "k3bmsf.h"
+#include "k3bcommandtrace.h"
 #include "k3bdevice_export.h"
 
 #include <qglobal.h>
@@ -47,6 +48,7 @@ namespace K3b {
     namespace Device
     {
         class Toc;
+        class ResponseCache;
 
         typedef QVarLengthArray< unsigned char > UByteArray;
 
@@ -249,6 +251,17 @@ namespace K3b {
              */
             bool testUnitReady() const;
 
+            /**
+             * Polls the drive for media events (new medium, medium removal, eject
+             * request, and so on). A reported event drops the cached command
+             * responses. Drives report each event only once.
+             *
+             * Refers to the MMC command: GET EVENT STATUS NOTIFICATION
+             *
+             * \return true if the drive reported a media event since the last poll.
+             */
+            bool checkMediaEvent() const;
+
             /**
              * checks if disk is empty, returns @p K3b::Device::State
              */
@@ -411,9 +424,27 @@ namespace K3b {
              */
             int determineMaximalWriteSpeed() const;
 
+            /**
+             * Determines the maximal reading speed for the current medium via
+             * GET PERFORMANCE. Falls back to maxReadSpeed() if the drive does
+             * not report performance data.
+             *
+             * @returnes the speed in kb/s or 0 on failure.
+             */
+            int determineMaximalReadSpeed() const;
+
+            /**
+             * The maximal number of bytes which can be transferred with a single
+             * command as reported by the kernel. The value is determined once.
+             *
+             * @return The length in bytes or 0 if it is unknown.
+             */
+            int maxTransferLength() const;
+
             /**
              * Open the device for access via a file descriptor.
              * @return true on success or if the device is already open.
+             * A device which is open for writing is not reopened if \p write is false.
              * @see close()
              *
              * Be aware that this method is not thread-safe.
@@ -422,12 +453,31 @@ namespace K3b {
 
             /**
              * Close the files descriptor.
+             * While the handle is held via holdHandle() closing is deferred until
+             * the last releaseHandle().
              * @see open()
              *
              * Be aware that this method is not thread-safe.
              */
             void close() const;
 
+            /**
+             * Keeps the file descriptor open until the matching call to releaseHandle()
+             * instead of opening and closing the device for each command. Use this around
+             * operations which send many commands, like updating the medium information.
+             * K3b::Core holds the handle while a job has blocked the device.
+             * Calls may be nested.
+             *
+             * Be aware that while a handle is held the device is kept open which
+             * may prevent other applications from accessing it exclusively.
+             */
+            void holdHandle() const;
+
+            /**
+             * \sa holdHandle()
+             */
+            void releaseHandle() const;
+
             /**
              * @return true if the device was successfully opened via @p open()
              */
@@ -613,6 +663,58 @@ namespace K3b {
                          bool streaming = false,
                          bool fua = false ) const;
 
+            /**
+             * WRITE 10 command. Writes \p length blocks from \p data starting
+             * at \p startAdress.
+             *
+             * \return 0 on success, -1 if the device could not be opened, and
+             *         otherwise the sense data of the failure combined as
+             *         (sense key << 16) | (asc << 8) | ascq, or 1 if the device
+             *         did not return any sense data.
+             */
+            int write10( const unsigned char* data,
+                         unsigned int dataLen,
+                         unsigned long startAdress,
+                         unsigned int length ) const;
+
+            /**
+             * SYNCHRONIZE CACHE command
+             *
+             * @param immed If true the command returns immediately and the drive
+             *              has to be polled via testUnitReady() until it is done.
+             */
+            bool synchronizeCache( bool immed = false ) const;
+
+            /**
+             * CLOSE TRACK/SESSION command
+             *
+             * @param function The close function as defined in MMC5:
+             *                 \li 001b - close the logical track \p trackNumber
+             *                 \li 010b - close the session
+             *                 \li 110b - finalize the disc (DVD+R, BD-R)
+             * @param immed If true the command returns immediately and the drive
+             *              has to be polled via testUnitReady() until it is done.
+             */
+            bool closeTrackSession( int function, unsigned int trackNumber = 0, bool immed = false ) const;
+
+            /**
+             * SET STREAMING command. Requests a writing speed for the range
+             * of blocks up to \p endLba. This is the preferred way to set the
+             * writing speed for DVD and Blu-ray media.
+             *
+             * @param writeSpeed The writing speed in KB/s.
+             */
+            bool setStreaming( unsigned int writeSpeed, unsigned long endLba ) const;
+
+            /**
+             * Sets up mode page 05h for incremental writing of DVD-R(W) media with
+             * buffer underrun protection enabled.
+             *
+             * @param testWrite Enable the test write bit to simulate the writing.
+             * @param multiSession If false the disc will be closed with the session.
+             */
+            bool setIncrementalWriteParameters( bool testWrite, bool multiSession ) const;
+
             /**
              * @param subchannelParam: 01h - CD current position
              *                         02h - Media Catalog number (UPC/bar code)
@@ -680,6 +782,66 @@ namespace K3b {
              */
             void usageUnlock() const;
 
+            /**
+             * The medium generation is increased whenever the medium might have
+             * changed: on media events and failing commands, when the tray is loaded
+             * or ejected, and when the medium is written, blanked, or formatted.
+             *
+             * Responses to commands which only read medium descriptors like the
+             * disc information or the TOC are cached for the current generation.
+             */
+            quint64 mediumGeneration() const;
+
+            /**
+             * Increases the medium generation and thus drops all cached command
+             * responses. This needs to be called whenever the medium has been
+             * accessed by other means than ScsiCommand, for example by an external
+             * burning application.
+             */
+            void invalidateCachedResponses() const;
+
+            struct CommandCacheStatistics {
+                quint64 hits;
+                quint64 misses;
+                quint64 invalidations;
+            };
+
+            /**
+             * Statistics on the command response cache since the device
+             * has been created.
+             */
+            CommandCacheStatistics commandCacheStatistics() const;
+
+            struct CommandStatistics {
+                quint64 commands;  /**< commands sent to the device */
+                quint64 bytes;     /**< bytes transferred by successful commands */
+                quint64 nsecs;     /**< time spent waiting for the device */
+            };
+
+            /**
+             * Statistics on the commands with opcode \p command sent to the device
+             * since it has been created or resetCommandStatistics() was called.
+             * Responses answered from the cache are not included.
+             */
+            CommandStatistics commandStatistics( unsigned char command ) const;
+
+            void resetCommandStatistics() const;
+
+            /**
+             * Enables or disables tracing of the commands sent to the device.
+             * Tracing is disabled by default.
+             *
+             * \sa commandTrace()
+             */
+            void setCommandTracingEnabled( bool enabled ) const;
+            bool commandTracingEnabled() const;
+
+            /**
+             * \return The command trace or 0 if tracing has never been enabled.
+             * The trace stays available after tracing is disabled again.
+             */
+            CommandTrace* commandTrace() const;
+
             /**
              * Thread-safe ioctl call for this device for Linux and Net-BSD systems.
              * Be aware that so far this does not include opening the device
@@ -748,10 +910,21 @@ namespace K3b {
 
             QByteArray mediaId( int mediaType ) const;
 
+            /**
+             * The cache of the responses to read-only commands sent via ScsiCommand.
+             */
+            ResponseCache& responseCache() const;
+
+            /**
+             * Updates the command statistics and the trace with a command sent via ScsiCommand.
+             */
+            void recordCommand( const CommandTrace::Entry& entry ) const;
+
             class Private;
             Private* d;
 
             friend class DeviceManager;
+            friend class ScsiCommand;
         };
 
         /**
@@ -20,6 +20,7 @@
 
 #include "k3bdevice.h"
 #include "k3bscsicommand.h"
+#include "k3bresponsecache.h"
 #include "k3bdeviceglobals.h"
 #include "QDebug"
 
@@ -36,6 +37,25 @@ bool K3b::Device::Device::testUnitReady() const
 }
 
 
+bool K3b::Device::Device::checkMediaEvent() const
+{
+    unsigned char data[8];
+    ::memset( data, 0, 8 );
+
+    ScsiCommand cmd( this );
+    cmd.enableErrorMessages( false );
+    cmd[0] = MMC_GET_EVENT_STATUS_NOTIFICATION;
+    cmd[1] = 0x1;    // polled
+    cmd[4] = 0x10;   // media class
+    cmd[8] = 8;
+    cmd[9] = 0;      // Necessary to set the proper command length
+
+    // ScsiCommand already drops the cached responses on a media event
+    return( cmd.transport( TR_DIR_READ, data, 8 ) == 0 &&
+            ResponseCache::isMediaEvent( data, 8 ) );
+}
+
+
 bool K3b::Device::Device::getFeature( UByteArray& data, unsigned int feature ) const
 {
     unsigned char header[2048];
@@ -397,6 +417,89 @@ bool K3b::Device::Device::read12( unsigned char* data,
 }
 
 
+int K3b::Device::Device::write10( const unsigned char* data,
+                                  unsigned int dataLen,
+                                  unsigned long startAdress,
+                                  unsigned int length ) const
+{
+    ScsiCommand cmd( this );
+    cmd[0] = MMC_WRITE_10;
+    cmd[2] = startAdress>>24;
+    cmd[3] = startAdress>>16;
+    cmd[4] = startAdress>>8;
+    cmd[5] = startAdress;
+    cmd[7] = length>>8;
+    cmd[8] = length;
+    cmd[9] = 0;      // Necessary to set the proper command length
+
+    const int ret = cmd.transport( TR_DIR_WRITE, const_cast<unsigned char*>( data ), dataLen );
+    if( ret <= 0 )
+        return ret;
+
+    const int sense = ( cmd.senseKey() << 16 ) | ( cmd.asc() << 8 ) | cmd.ascq();
+    return( sense != 0 ? sense : 1 );
+}
+
+
+bool K3b::Device::Device::synchronizeCache( bool immed ) const
+{
+    ScsiCommand cmd( this );
+    cmd[0] = MMC_SYNCHRONIZE_CACHE;
+    cmd[1] = ( immed ? 0x2 : 0x0 );
+    cmd[9] = 0;      // Necessary to set the proper command length
+    return( cmd.transport() == 0 );
+}
+
+
+bool K3b::Device::Device::closeTrackSession( int function, unsigned int trackNumber, bool immed ) const
+{
+    ScsiCommand cmd( this );
+    cmd[0] = MMC_CLOSE_TRACK_SESSION;
+    cmd[1] = ( immed ? 0x1 : 0x0 );
+    cmd[2] = function & 0x7;
+    cmd[4] = trackNumber>>8;
+    cmd[5] = trackNumber;
+    cmd[9] = 0;      // Necessary to set the proper command length
+    return( cmd.transport() == 0 );
+}
+
+
+bool K3b::Device::Device::setStreaming( unsigned int writeSpeed, unsigned long endLba ) const
+{
+    // one performance descriptor
+    unsigned char desc[28];
+    ::memset( desc, 0, 28 );
+
+    // end lba
+    desc[8] = endLba>>24;
+    desc[9] = endLba>>16;
+    desc[10] = endLba>>8;
+    desc[11] = endLba;
+
+    // we do not care about the reading speed but it may not be zero
+    const unsigned int readSpeed = 0xFFFF;
+    desc[12] = readSpeed>>24;
+    desc[13] = readSpeed>>16;
+    desc[14] = readSpeed>>8;
+    desc[15] = readSpeed;
+    desc[18] = 1000>>8;   // read time: 1000 ms
+    desc[19] = 1000&0xFF;
+
+    desc[20] = writeSpeed>>24;
+    desc[21] = writeSpeed>>16;
+    desc[22] = writeSpeed>>8;
+    desc[23] = writeSpeed;
+    desc[26] = 1000>>8;   // write time: 1000 ms
+    desc[27] = 1000&0xFF;
+
+    ScsiCommand cmd( this );
+    cmd[0] = MMC_SET_STREAMING;
+    cmd[10] = 28;
+    cmd[11] = 0;      // Necessary to set the proper command length
+    return( cmd.transport( TR_DIR_WRITE, desc, 28 ) == 0 );
+}
+
+
 bool K3b::Device::Device::readCd( unsigned char* data,
                                 unsigned int dataLen,
                                 int sectorType,
@@ -438,7 +438,9 @@ void K3b::Device::DeviceManager::removeDevice( const Solid::Device& dev )
 void K3b::Device::DeviceManager::slotSolidDeviceAdded( const QString& udi )
 {
     qDebug() << udi;
-    checkDevice( Solid::Device( udi ) );
+    Solid::Device solidDev( udi );
+    invalidateMedium( solidDev );
+    checkDevice( solidDev );
 }
 
 
@@ -446,6 +448,7 @@ void K3b::Device::DeviceManager::slotSolidDeviceRemoved( const QString& udi )
 {
     qDebug() << udi;
     Solid::Device solidDev( udi );
+    invalidateMedium( solidDev );
     if ( solidDev.isDeviceInterface( Solid::DeviceInterface::OpticalDrive ) ) {
         if ( solidDev.is<Solid::OpticalDrive>() ) {
             removeDevice( solidDev );
@@ -454,3 +457,17 @@ void K3b::Device::DeviceManager::slotSolidDeviceRemoved( const QString& udi )
 }
 
 
+void K3b::Device::DeviceManager::invalidateMedium( const Solid::Device& solidDev )
+{
+    //
+    // Depending on the backend a disc shows up as a child of its drive or as a
+    // change of the drive itself. Either way the cached responses describe the
+    // old medium.
+    //
+    if( Device* dev = findDeviceByUdi( solidDev.udi() ) )
+        dev->invalidateCachedResponses();
+    if( solidDev.parentUdi().isEmpty() )
+        return;
+    if( Device* dev = findDeviceByUdi( solidDev.parentUdi() ) )
+        dev->invalidateCachedResponses();
+}
@@ -211,6 +211,12 @@ namespace K3b {
             virtual void removeDevice( const Solid::Device& dev );
 
         private:
+            /**
+             * Drops the cached command responses of the drive of a disc which
+             * Solid reported as added or removed.
+             */
+            void invalidateMedium( const Solid::Device& dev );
+
             class Private;
             Private* const d;
 
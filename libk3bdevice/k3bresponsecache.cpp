@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bresponsecache.h"
+#include "k3bscsicommand.h"
+
+#include <QMutexLocker>
+
+#include <string.h>
+
+
+namespace {
+    // the cache only grows with the number of distinct commands, this is just a safety net
+    const int s_maxCachedResponses = 256;
+
+    QByteArray cacheKey( const QByteArray& cdb, size_t len )
+    {
+        QByteArray key( cdb );
+        key.append( QByteArray::number( qulonglong( len ) ) );
+        return key;
+    }
+
+
+    /**
+     * Commands which are known to leave the medium untouched. Everything
+     * else, including vendor specific commands, is treated as a possible
+     * change of the medium.
+     */
+    bool keepsMedium( unsigned char command )
+    {
+        switch( command ) {
+        case K3b::Device::MMC_TEST_UNIT_READY:
+        case K3b::Device::MMC_REQUEST_SENSE:
+        case K3b::Device::MMC_INQUIRY:
+        case K3b::Device::MMC_MODE_SENSE:
+        case K3b::Device::MMC_PREVENT_ALLOW_MEDIUM_REMOVAL:
+        case K3b::Device::MMC_READ_10:
+        case K3b::Device::MMC_READ_12:
+        case K3b::Device::MMC_READ_CD:
+        case K3b::Device::MMC_READ_CD_MSF:
+        case K3b::Device::MMC_READ_BUFFER:
+        case K3b::Device::MMC_READ_BUFFER_CAPACITY:
+        case K3b::Device::MMC_READ_CAPACITY:
+        case K3b::Device::MMC_READ_DISC_INFORMATION:
+        case K3b::Device::MMC_READ_DISC_STRUCTURE:
+        case K3b::Device::MMC_READ_FORMAT_CAPACITIES:
+        case K3b::Device::MMC_READ_SUB_CHANNEL:
+        case K3b::Device::MMC_READ_TOC_PMA_ATIP:
+        case K3b::Device::MMC_READ_TRACK_INFORMATION:
+        case K3b::Device::MMC_GET_CONFIGURATION:
+        case K3b::Device::MMC_GET_EVENT_STATUS_NOTIFICATION:
+        case K3b::Device::MMC_GET_PERFORMANCE:
+        case K3b::Device::MMC_MECHANISM_STATUS:
+        case K3b::Device::MMC_REPORT_KEY:
+        case K3b::Device::MMC_SEND_KEY:
+        case K3b::Device::MMC_SEEK_10:
+        case K3b::Device::MMC_SET_SPEED:
+        case K3b::Device::MMC_SET_READ_AHEAD:
+        case K3b::Device::MMC_SET_STREAMING:
+        case K3b::Device::MMC_VERIFY_10:
+        case K3b::Device::MMC_PLAY_AUDIO_10:
+        case K3b::Device::MMC_PLAY_AUDIO_12:
+        case K3b::Device::MMC_PLAY_AUDIO_MSF:
+        case K3b::Device::MMC_PAUSE_RESUME:
+        case K3b::Device::MMC_SCAN:
+        case K3b::Device::MMC_STOP_PLAY_SCAN:
+            return true;
+
+        default:
+            return false;
+        }
+    }
+
+
+    /**
+     * \return true if the sense data of a failed command indicates that the
+     * medium changed or is gone. Routine failures like ILLEGAL REQUEST for
+     * unsupported commands or fields say nothing about the medium.
+     */
+    bool reportsMediumChange( int senseKey, int asc )
+    {
+        return( senseKey == 0x6 ||   // UNIT ATTENTION
+                senseKey == 0x2 ||   // NOT READY
+                asc == 0x3A );       // MEDIUM NOT PRESENT
+    }
+
+}
+
+
+K3b::Device::ResponseCache::ResponseCache()
+    : m_generation( 0 ),
+      m_unitReady( false )
+{
+    m_stats.hits = 0;
+    m_stats.misses = 0;
+    m_stats.invalidations = 0;
+}
+
+
+K3b::Device::ResponseCache::~ResponseCache()
+{
+}
+
+
+bool K3b::Device::ResponseCache::isCacheable( const QByteArray& cdb )
+{
+    if( cdb.isEmpty() )
+        return false;
+
+    switch( static_cast<unsigned char>( cdb[0] ) ) {
+    case MMC_READ_DISC_INFORMATION:
+    case MMC_READ_TRACK_INFORMATION:
+    case MMC_READ_TOC_PMA_ATIP:
+    case MMC_GET_CONFIGURATION:
+    case MMC_READ_CAPACITY:
+    case MMC_READ_FORMAT_CAPACITIES:
+    case MMC_GET_PERFORMANCE:
+        return true;
+
+    case MMC_READ_DISC_STRUCTURE: {
+        // the key and AACS related formats depend on the authentication state
+        const unsigned char format = cdb.size() > 7 ? cdb[7] : 0;
+        return( format != 0x02 && format != 0x06 && format != 0x07 &&
+                ( format < 0x80 || format > 0x8F ) );
+    }
+
+    default:
+        return false;
+    }
+}
+
+
+bool K3b::Device::ResponseCache::isMediaEvent( const void* data, size_t len )
+{
+    const unsigned char* d = static_cast<const unsigned char*>( data );
+    return( data && len >= 6 &&
+            ( d[2] & 0x80 ) == 0 &&   // NEA
+            ( d[2] & 0x07 ) == 0x04 && // media class
+            ( d[4] & 0x0F ) != 0 );   // event code
+}
+
+
+bool K3b::Device::ResponseCache::lookup( const QByteArray& cdb, void* data, size_t len, quint64& generation )
+{
+    QMutexLocker locker( &m_mutex );
+    QHash<QByteArray, QByteArray>::const_iterator it = m_responses.constFind( cacheKey( cdb, len ) );
+    if( it != m_responses.constEnd() ) {
+        ::memcpy( data, it.value().constData(), len );
+        ++m_stats.hits;
+        return true;
+    }
+    else {
+        ++m_stats.misses;
+        generation = m_generation;
+        return false;
+    }
+}
+
+
+void K3b::Device::ResponseCache::store( const QByteArray& cdb, const void* data, size_t len, quint64 generation )
+{
+    QMutexLocker locker( &m_mutex );
+    if( generation == m_generation ) {
+        if( m_responses.count() >= s_maxCachedResponses )
+            m_responses.clear();
+        m_responses.insert( cacheKey( cdb, len ), QByteArray( static_cast<const char*>( data ), len ) );
+    }
+}
+
+
+void K3b::Device::ResponseCache::commandFinished( const QByteArray& cdb, bool success, int senseKey, int asc,
+                                                  const void* data, size_t len )
+{
+    const unsigned char command = cdb.isEmpty() ? MMC_TEST_UNIT_READY : cdb[0];
+
+    QMutexLocker locker( &m_mutex );
+
+    // a medium becoming ready or going away starts a new generation
+    if( command == MMC_TEST_UNIT_READY && success != m_unitReady ) {
+        m_unitReady = success;
+        invalidateLocked();
+        return;
+    }
+
+    //
+    // A failing command may be the first one to see a medium change (UNIT ATTENTION)
+    // or may fail because there is no medium. Either way we cannot trust the cache
+    // anymore. Other failures are expected while probing the drive and keep it.
+    //
+    if( ( !success && reportsMediumChange( senseKey, asc ) ) ||
+        !keepsMedium( command ) ||
+        ( success && command == MMC_GET_EVENT_STATUS_NOTIFICATION && isMediaEvent( data, len ) ) )
+        invalidateLocked();
+}
+
+
+void K3b::Device::ResponseCache::invalidate()
+{
+    QMutexLocker locker( &m_mutex );
+    invalidateLocked();
+}
+
+
+void K3b::Device::ResponseCache::invalidateLocked()
+{
+    ++m_generation;
+    if( !m_responses.isEmpty() ) {
+        m_responses.clear();
+        ++m_stats.invalidations;
+    }
+}
+
+
+quint64 K3b::Device::ResponseCache::generation() const
+{
+    QMutexLocker locker( &m_mutex );
+    return m_generation;
+}
+
+
+K3b::Device::ResponseCache::Statistics K3b::Device::ResponseCache::statistics() const
+{
+    QMutexLocker locker( &m_mutex );
+    return m_stats;
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef _K3B_RESPONSE_CACHE_H_
+#define _K3B_RESPONSE_CACHE_H_
+
+#include "k3bdevice_export.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+
+#include <stddef.h>
+
+
+namespace K3b {
+    namespace Device
+    {
+        /**
+         * Caches the responses to commands which only read descriptors of the
+         * medium, like the disc information or the TOC, keyed by the command
+         * descriptor block and the transfer length.
+         *
+         * The responses are valid for the current medium generation only. The
+         * generation is increased whenever the medium might have changed and
+         * thereby all cached responses are dropped.
+         *
+         * All methods are thread-safe.
+         *
+         * \sa Device::mediumGeneration()
+         */
+        class LIBK3BDEVICE_EXPORT ResponseCache
+        {
+        public:
+            struct Statistics {
+                quint64 hits;
+                quint64 misses;
+                quint64 invalidations;
+            };
+
+            ResponseCache();
+            ~ResponseCache();
+
+            /**
+             * \return true if the responses to \p cdb only depend on the medium.
+             */
+            static bool isCacheable( const QByteArray& cdb );
+
+            /**
+             * \return true if a GET EVENT STATUS NOTIFICATION response reports
+             * a media event (new media, media removal, eject request, and so on).
+             */
+            static bool isMediaEvent( const void* data, size_t len );
+
+            /**
+             * Copies the cached response to \p cdb into \p data.
+             * On a cache miss \p generation is set to the current medium
+             * generation which is to be passed to store().
+             */
+            bool lookup( const QByteArray& cdb, void* data, size_t len, quint64& generation );
+
+            /**
+             * Stores the response to \p cdb unless the medium generation changed
+             * since \p generation has been determined.
+             */
+            void store( const QByteArray& cdb, const void* data, size_t len, quint64 generation );
+
+            /**
+             * To be called for each command sent to the drive. Starts a new
+             * medium generation if
+             * \li the command failed with a sense code reporting a medium change
+             *     or a missing medium,
+             * \li the command is not known to leave the medium untouched (writing,
+             *     blanking, formatting, loading, mode select, vendor commands, ...),
+             * \li a GET EVENT STATUS NOTIFICATION response reports a media event,
+             * \li or the result of TEST UNIT READY changed.
+             *
+             * \param data The response of the command, only used for GET EVENT
+             *             STATUS NOTIFICATION.
+             */
+            void commandFinished( const QByteArray& cdb, bool success, int senseKey, int asc,
+                                  const void* data, size_t len );
+
+            /**
+             * Starts a new medium generation and drops all cached responses.
+             */
+            void invalidate();
+
+            quint64 generation() const;
+            Statistics statistics() const;
+
+        private:
+            void invalidateLocked();
+
+            mutable QMutex m_mutex;
+            QHash<QByteArray, QByteArray> m_responses;
+            quint64 m_generation;
+            bool m_unitReady;
+            Statistics m_stats;
+
+            Q_DISABLE_COPY( ResponseCache )
+        };
+    }
+}
+
+#endif
@@ -14,8 +14,10 @@
 
 #include "k3bscsicommand.h"
 #include "k3bdevice.h"
+#include "k3bresponsecache.h"
 
 #include <QDebug>
+#include <QElapsedTimer>
 
 
 QString K3b::Device::commandString( const unsigned char& command )
@@ -165,6 +167,11 @@ QString K3b::Device::ScsiCommand::senseKeyToString( int key )
 
 
 void K3b::Device::ScsiCommand::debugError( int command, int errorCode, int senseKey, int asc, int ascq ) {
+    // remember the sense data for the command trace
+    m_senseKey = senseKey;
+    m_asc = asc;
+    m_ascq = ascq;
+
     if( m_printErrors ) {
         qDebug() << "(K3b::Device::ScsiCommand) failed: " << endl
                  << "                           command:    " << QString("%1 (%2)")
@@ -196,7 +203,11 @@ void K3b::Device::ScsiCommand::debugError( int command, int errorCode, int sense
 K3b::Device::ScsiCommand::ScsiCommand( const K3b::Device::Device* dev )
     : d(new Private),
       m_device(dev),
-      m_printErrors(true)
+      m_printErrors(true),
+      m_timeout(0),
+      m_senseKey(0),
+      m_asc(0),
+      m_ascq(0)
 {
     clear();
 }
@@ -207,3 +218,110 @@ K3b::Device::ScsiCommand::~ScsiCommand()
     delete d;
 }
 
+
+
+namespace {
+    int defaultTimeout( unsigned char command )
+    {
+        switch( command ) {
+        case K3b::Device::MMC_TEST_UNIT_READY:
+        case K3b::Device::MMC_REQUEST_SENSE:
+        case K3b::Device::MMC_INQUIRY:
+        case K3b::Device::MMC_MODE_SENSE:
+        case K3b::Device::MMC_GET_CONFIGURATION:
+        case K3b::Device::MMC_GET_EVENT_STATUS_NOTIFICATION:
+        case K3b::Device::MMC_MECHANISM_STATUS:
+        case K3b::Device::MMC_READ_BUFFER_CAPACITY:
+        case K3b::Device::MMC_PREVENT_ALLOW_MEDIUM_REMOVAL:
+        case K3b::Device::MMC_REPORT_KEY:
+        case K3b::Device::MMC_SEND_KEY:
+        case K3b::Device::MMC_SET_SPEED:
+        case K3b::Device::MMC_SET_READ_AHEAD:
+            return 5*1000;
+
+        case K3b::Device::MMC_BLANK:
+        case K3b::Device::MMC_FORMAT_UNIT:
+        case K3b::Device::MMC_CLOSE_TRACK_SESSION:
+        case K3b::Device::MMC_SYNCHRONIZE_CACHE:
+        case K3b::Device::MMC_REPAIR_TRACK:
+        case K3b::Device::MMC_ERASE:
+        case K3b::Device::MMC_RESERVE_TRACK:
+        case K3b::Device::MMC_SEND_OPC_INFORMATION:
+        case K3b::Device::MMC_LOAD_UNLOAD_MEDIUM:
+            return 60*60*1000;
+
+        default:
+            return 30*1000;
+        }
+    }
+
+
+    /**
+     * \return The start sector of commands which address one, 0 otherwise.
+     */
+    quint32 commandLba( const QByteArray& cdb )
+    {
+        if( cdb.size() < 6 )
+            return 0;
+
+        switch( static_cast<unsigned char>( cdb[0] ) ) {
+        case K3b::Device::MMC_READ_10:
+        case K3b::Device::MMC_READ_12:
+        case K3b::Device::MMC_READ_CD:
+        case K3b::Device::MMC_WRITE_10:
+        case K3b::Device::MMC_WRITE_12:
+        case K3b::Device::MMC_WRITE_AND_VERIFY_10:
+        case K3b::Device::MMC_VERIFY_10:
+        case K3b::Device::MMC_SEEK_10:
+            return( static_cast<unsigned char>( cdb[2] ) << 24 |
+                    static_cast<unsigned char>( cdb[3] ) << 16 |
+                    static_cast<unsigned char>( cdb[4] ) << 8 |
+                    static_cast<unsigned char>( cdb[5] ) );
+        default:
+            return 0;
+        }
+    }
+}
+
+
+int K3b::Device::ScsiCommand::transport( TransportDirection dir,
+                                         void* data,
+                                         size_t len )
+{
+    const QByteArray cdb = commandDescriptorBlock();
+    const unsigned char command = cdb.isEmpty() ? MMC_TEST_UNIT_READY : cdb[0];
+    const int timeout = ( m_timeout > 0 ? m_timeout : defaultTimeout( command ) );
+
+    if( !m_device )
+        return transportImpl( dir, data, len, timeout );
+
+    ResponseCache& cache = m_device->responseCache();
+    const bool cacheable = ( dir == TR_DIR_READ && data && len > 0 && ResponseCache::isCacheable( cdb ) );
+    quint64 generation = 0;
+    if( cacheable && cache.lookup( cdb, data, len, generation ) )
+        return 0;
+
+    m_senseKey = m_asc = m_ascq = 0;
+
+    QElapsedTimer timer;
+    timer.start();
+    const int ret = transportImpl( dir, data, len, timeout );
+
+    CommandTrace::Entry entry;
+    entry.nsecs = timer.nsecsElapsed();
+    entry.lba = commandLba( cdb );
+    entry.length = len;
+    entry.command = command;
+    entry.senseKey = m_senseKey;
+    entry.asc = m_asc;
+    entry.ascq = m_ascq;
+    entry.success = ( ret == 0 );
+    m_device->recordCommand( entry );
+
+    // a response is not stored if the command started a new medium generation
+    cache.commandFinished( cdb, ret == 0, m_senseKey, m_asc, data, len );
+    if( ret == 0 && cacheable )
+        cache.store( cdb, data, len, generation );
+
+    return ret;
+}
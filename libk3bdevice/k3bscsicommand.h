@@ -18,6 +18,7 @@
 #include "k3bdevice.h"
 
 #include <qglobal.h>
+#include <QByteArray>
 #include <QString>
 
 namespace K3b {
@@ -99,6 +100,14 @@ namespace K3b {
              */
             void enableErrorMessages( bool b ) { m_printErrors = b; }
 
+            /**
+             * Sets the timeout of the command in milliseconds. 0 (the default) chooses
+             * the timeout based on the command: a few seconds for simple queries, half
+             * a minute for reading and writing, and up to an hour for commands like
+             * BLANK or FORMAT UNIT which may take that long without the immediate bit.
+             */
+            void setTimeout( int ms ) { m_timeout = ms; }
+
             void clear();
 
             unsigned char& operator[]( size_t );
@@ -119,12 +128,37 @@ namespace K3b {
              *         an error code otherwise. The error code is constructed from
              *         the scsi error code, the sense key, asc, and ascq. These four values are
              *         combined into the lower 32 bit of an integer in the order used above.
+             *
+             * Responses to commands which only read medium descriptors (disc and track
+             * information, TOC, disc structures, and configuration) are answered from
+             * the device's response cache as long as the medium has not changed.
+             *
+             * \sa Device::mediumGeneration()
              */
             int transport( TransportDirection dir = TR_DIR_NONE,
                            void* = 0,
                            size_t len = 0 );
 
+            /**
+             * The sense data of the last failed transport(). All are 0 if
+             * the command succeeded or the device did not return sense data.
+             */
+            int senseKey() const { return m_senseKey; }
+            int asc() const { return m_asc; }
+            int ascq() const { return m_ascq; }
+
         private:
+            /**
+             * The platform specific part of transport() which actually sends
+             * the command to the device.
+             */
+            int transportImpl( TransportDirection dir, void* data, size_t len, int timeout );
+
+            /**
+             * \return The command descriptor block as set up via operator[].
+             */
+            QByteArray commandDescriptorBlock() const;
+
             static QString senseKeyToString( int key );
             void debugError( int command, int errorCode, int senseKey, int asc, int ascq );
 
@@ -133,6 +167,12 @@ namespace K3b {
             const Device* m_device;
 
             bool m_printErrors;
+            int m_timeout;
+
+            // sense data of the last failed command as passed to debugError()
+            unsigned char m_senseKey;
+            unsigned char m_asc;
+            unsigned char m_ascq;
         };
     }
 }
@@ -43,7 +43,7 @@ class K3b::Device::ScsiCommand::Private
 
 public:
     Private();
-    int transport( const Device* device, TransportDirection dir, void* data, size_t len );
+    int transport( const Device* device, TransportDirection dir, void* data, size_t len, int timeout );
     unsigned char& operator[]( size_t i );
     void clear();
     const CCB& get_ccb() { return ccb; }
@@ -63,9 +63,16 @@ unsigned char& K3b::Device::ScsiCommand::operator[]( size_t i )
     return (*d)[i];
 }
 
-int K3b::Device::ScsiCommand::transport( TransportDirection dir,
-                                         void* data,
-                                         size_t len )
+QByteArray K3b::Device::ScsiCommand::commandDescriptorBlock() const
+{
+    return QByteArray( reinterpret_cast<const char*>( d->get_ccb().csio.cdb_io.cdb_bytes ), d->get_ccb().csio.cdb_len );
+}
+
+
+int K3b::Device::ScsiCommand::transportImpl( TransportDirection dir,
+                                             void* data,
+                                             size_t len,
+                                             int timeout )
 {
     if( !m_device )
         return -1;
@@ -82,7 +89,7 @@ int K3b::Device::ScsiCommand::transport( TransportDirection dir,
         return -1;
     }
 
-    int ret = d->transport( m_device, dir, data, len );
+    int ret = d->transport( m_device, dir, data, len, timeout );
     if( ret != 0 ) {
         const struct scsi_sense_data& s = d->get_ccb().csio.sense_data;
         int errorCode, senseKey, addSenseCode, addSenseCodeQual;
@@ -119,7 +126,7 @@ unsigned char& K3b::Device::ScsiCommand::Private::operator[]( size_t i )
     return ccb.csio.cdb_io.cdb_bytes[i];
 }
 
-int K3b::Device::ScsiCommand::Private::transport( const Device* device, TransportDirection dir, void* data, size_t len )
+int K3b::Device::ScsiCommand::Private::transport( const Device* device, TransportDirection dir, void* data, size_t len, int timeout )
 {
     ccb.ccb_h.path_id    = device->handle()->path_id;
     ccb.ccb_h.target_id  = device->handle()->target_id;
@@ -133,7 +140,7 @@ int K3b::Device::ScsiCommand::Private::transport( const Device* device, Transpor
     else
         direction |= (dir & TR_DIR_READ) ? CAM_DIR_IN : CAM_DIR_OUT;
 
-    cam_fill_csio( &(ccb.csio), 1, NULL, direction, MSG_SIMPLE_Q_TAG, (uint8_t*)data, len, sizeof(ccb.csio.sense_data), ccb.csio.cdb_len, 30*1000 );
+    cam_fill_csio( &(ccb.csio), 1, NULL, direction, MSG_SIMPLE_Q_TAG, (uint8_t*)data, len, sizeof(ccb.csio.sense_data), ccb.csio.cdb_len, timeout );
     int ret = cam_send_ccb( device->handle(), &ccb );
     if( ret < 0 ) {
         qCritical() << "(K3b::Device::ScsiCommand) transport cam_send_ccb failed: ret = " << ret
@@ -40,13 +40,21 @@
 #endif
 
 #ifdef SG_IO
-static bool useSgIo()
+static bool kernelSupportsSgIo()
 {
     struct utsname buf;
     uname( &buf );
     // was CDROM_SEND_PACKET declared dead in 2.5?
     return ( strcmp( buf.release, "2.5.43" ) >=0 );
 }
+
+
+static bool useSgIo()
+{
+    // the kernel does not change while we are running
+    static const bool s_useSgIo = kernelSupportsSgIo();
+    return s_useSgIo;
+}
 #endif
 
 
@@ -88,9 +96,16 @@ unsigned char& K3b::Device::ScsiCommand::operator[]( size_t i )
 }
 
 
-int K3b::Device::ScsiCommand::transport( TransportDirection dir,
-                                         void* data,
-                                         size_t len )
+QByteArray K3b::Device::ScsiCommand::commandDescriptorBlock() const
+{
+    return QByteArray( reinterpret_cast<const char*>( d->cmd.cmd ), sizeof( d->cmd.cmd ) );
+}
+
+
+int K3b::Device::ScsiCommand::transportImpl( TransportDirection dir,
+                                             void* data,
+                                             size_t len,
+                                             int timeout )
 {
     bool needToClose = false;
     int deviceHandle = -1;
@@ -121,7 +136,7 @@ int K3b::Device::ScsiCommand::transport( TransportDirection dir,
         d->sgIo.flags     = SG_FLAG_LUN_INHIBIT|SG_FLAG_DIRECT_IO;
         d->sgIo.dxferp    = data;
         d->sgIo.dxfer_len = len;
-        d->sgIo.timeout   = 5000;
+        d->sgIo.timeout   = timeout;
         if( dir == TR_DIR_READ )
             d->sgIo.dxfer_direction = SG_DXFER_FROM_DEV;
         else if( dir == TR_DIR_WRITE )
@@ -48,9 +48,16 @@ unsigned char& K3b::Device::ScsiCommand::operator[]( size_t i )
 }
 
 
-int K3b::Device::ScsiCommand::transport( TransportDirection dir,
-                                         void* data,
-                                         size_t len )
+QByteArray K3b::Device::ScsiCommand::commandDescriptorBlock() const
+{
+    return QByteArray( reinterpret_cast<const char*>( d->cmd.cmd ), d->cmd.cmdlen );
+}
+
+
+int K3b::Device::ScsiCommand::transportImpl( TransportDirection dir,
+                                             void* data,
+                                             size_t len,
+                                             int timeout )
 {
     bool needToClose = false;
     int deviceHandle = -1;
@@ -71,7 +78,7 @@ int K3b::Device::ScsiCommand::transport( TransportDirection dir,
         return -1;
     }
 
-    d->cmd.timeout = 10000;
+    d->cmd.timeout = timeout;
     d->cmd.databuf = (caddr_t) data;
     d->cmd.datalen = len;
     //  d->cmd.datalen_used = len;
@@ -54,9 +54,16 @@ unsigned char& K3b::Device::ScsiCommand::operator[]( size_t i )
 }
 
 
-int K3b::Device::ScsiCommand::transport( TransportDirection dir,
-                                       void* data,
-                                       size_t len )
+QByteArray K3b::Device::ScsiCommand::commandDescriptorBlock() const
+{
+    return QByteArray( reinterpret_cast<const char*>( d->m_cmd.spt.Cdb ), d->m_cmd.spt.CdbLength );
+}
+
+
+int K3b::Device::ScsiCommand::transportImpl( TransportDirection dir,
+                                           void* data,
+                                           size_t len,
+                                           int timeout )
 {
     bool needToClose = false;
     ULONG returned = 0;
@@ -81,7 +88,7 @@ int K3b::Device::ScsiCommand::transport( TransportDirection dir,
     d->m_cmd.spt.Length             = sizeof(SCSI_PASS_THROUGH_DIRECT);
     d->m_cmd.spt.SenseInfoLength    = SENSE_LEN_SPTI;
     d->m_cmd.spt.DataTransferLength = len;
-    d->m_cmd.spt.TimeOutValue       = 2;
+    d->m_cmd.spt.TimeOutValue       = qMax( 1, timeout/1000 );
     d->m_cmd.spt.DataBuffer         = len ? data : NULL;
     d->m_cmd.spt.SenseInfoOffset    = offsetof(SCSI_PASS_THROUGH_DIRECT_WITH_BUFFER, ucSenseBuf);
 
@@ -117,6 +117,9 @@ bool K3bFFMpegDecoder::analyseFileInternal( K3b::Msf& frames, int& samplerate, i
 
 //     frames = (unsigned long)ceil((double)bytes/2048.0);
 
+        // index the packets now so seeking later on is fast
+        m_file->buildIndex();
+
         // cleanup;
         delete m_file;
         m_file = 0;
@@ -139,6 +142,13 @@ bool K3bFFMpegDecoder::initDecoderInternal()
 
 void K3bFFMpegDecoder::cleanup()
 {
+    if( m_file ) {
+        const K3bFFMpegFile::SeekStatistics stats = m_file->seekStatistics();
+        if( stats.seeks > 0 )
+            qDebug() << "(K3bFFMpegDecoder)" << filename() << ":" << stats.seeks << "seeks,"
+                     << stats.discardedSamples << "samples discarded,"
+                     << stats.nsecs/1000000 << "ms";
+    }
     delete m_file;
     m_file = 0;
 }
@@ -34,6 +34,19 @@ extern "C" {
 #endif
 }
 
+#include <QDateTime>
+#include <QCache>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QGlobalStatic>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSharedPointer>
+#include <QVector>
+
+#include <algorithm>
+
 #include <string.h>
 #include <math.h>
 
@@ -77,6 +90,149 @@ extern "C" {
 K3bFFMpegWrapper* K3bFFMpegWrapper::s_instance = 0;
 
 
+namespace {
+    // distance between two entries of the packet index
+    const int s_indexIntervalMsecs = 250;
+
+    // decoding is started this much before the target so the decoder is
+    // primed with the data it needs from the previous packets
+    const int s_prerollMsecs = 100;
+
+    // the cached indices hold at most this many entries, which covers about
+    // 18 hours of audio
+    const int s_maxCachedIndexEntries = 256*1024;
+
+    struct IndexEntry {
+        qint64 sample;  // at the sample rate of the file, relative to the start
+        qint64 pts;     // in the time base of the stream
+        qint64 pos;     // byte position or -1
+    };
+
+    typedef QVector<IndexEntry> PacketIndex;
+
+    bool operator<( const IndexEntry& e, qint64 sample ) { return e.sample < sample; }
+    bool operator<( qint64 sample, const IndexEntry& e ) { return sample < e.sample; }
+
+    void unrefPacket( ::AVPacket* packet )
+    {
+#if LIBAVCODEC_VERSION_MAJOR >= 56
+        ::av_packet_unref( packet );
+#else
+        ::av_free_packet( packet );
+#endif
+    }
+
+    qint64 streamStart( ::AVStream* stream )
+    {
+        return ( stream->start_time != (qint64)AV_NOPTS_VALUE ? stream->start_time : 0 );
+    }
+
+    qint64 ptsToSample( ::AVStream* stream, qint64 pts )
+    {
+        ::AVRational sampleBase = { 1, FFMPEG_CODEC(stream)->sample_rate };
+        return ::av_rescale_q( pts - streamStart( stream ), stream->time_base, sampleBase );
+    }
+
+    qint64 sampleToPts( ::AVStream* stream, qint64 sample )
+    {
+        ::AVRational sampleBase = { 1, FFMPEG_CODEC(stream)->sample_rate };
+        return ::av_rescale_q( sample, sampleBase, stream->time_base ) + streamStart( stream );
+    }
+
+    qint64 durationToSamples( ::AVStream* stream, qint64 duration )
+    {
+        ::AVRational sampleBase = { 1, FFMPEG_CODEC(stream)->sample_rate };
+        return ::av_rescale_q( duration, stream->time_base, sampleBase );
+    }
+
+    PacketIndex scanPackets( const QString& filename )
+    {
+        PacketIndex index;
+
+        ::AVFormatContext* formatContext = 0;
+        if( ::avformat_open_input( &formatContext, filename.toLocal8Bit(), 0, 0 ) < 0 )
+            return index;
+
+        ::avformat_find_stream_info( formatContext, 0 );
+        if( formatContext->nb_streams == 1 && FFMPEG_CODEC(formatContext->streams[0])->sample_rate > 0 ) {
+            ::AVStream* stream = formatContext->streams[0];
+            const qint64 interval = (qint64)FFMPEG_CODEC(stream)->sample_rate * s_indexIntervalMsecs / 1000;
+            qint64 lastSample = -interval;
+
+            ::AVPacket packet;
+            ::av_init_packet( &packet );
+            while( ::av_read_frame( formatContext, &packet ) >= 0 ) {
+                if( packet.pts != (qint64)AV_NOPTS_VALUE && ( packet.flags & AV_PKT_FLAG_KEY ) ) {
+                    const qint64 sample = ptsToSample( stream, packet.pts );
+                    if( sample - lastSample >= interval ) {
+                        IndexEntry entry = { sample, packet.pts, packet.pos };
+                        index.append( entry );
+                        lastSample = sample;
+                    }
+                }
+                unrefPacket( &packet );
+            }
+        }
+
+        ::avformat_close_input( &formatContext );
+
+        index.squeeze();
+        return index;
+    }
+
+    /**
+     * The packet indices of the files which have been analysed most
+     * recently. Decoders are used from different threads.
+     */
+    class IndexCache
+    {
+    public:
+        IndexCache()
+            : m_entries( s_maxCachedIndexEntries ) {
+        }
+
+        QSharedPointer<const PacketIndex> index( const QString& filename ) {
+            const QFileInfo info( filename );
+
+            QMutexLocker locker( &m_mutex );
+            const Entry* cached = m_entries.object( filename );
+            if( cached &&
+                cached->size == info.size() &&
+                cached->lastModified == info.lastModified() )
+                return cached->index;
+            locker.unlock();
+
+            QElapsedTimer timer;
+            timer.start();
+            Entry* entry = new Entry;
+            entry->size = info.size();
+            entry->lastModified = info.lastModified();
+            entry->index = QSharedPointer<const PacketIndex>( new PacketIndex( scanPackets( filename ) ) );
+            qDebug() << "(K3bFFMpegFile) indexed" << entry->index->count() << "packets of" << filename
+                     << "in" << timer.elapsed() << "ms";
+
+            // the least recently used indices are dropped, decoders keep theirs
+            const QSharedPointer<const PacketIndex> index = entry->index;
+            locker.relock();
+            m_entries.insert( filename, entry, index->count() + 1 );
+            return index;
+        }
+
+    private:
+        struct Entry {
+            qint64 size;
+            QDateTime lastModified;
+            QSharedPointer<const PacketIndex> index;
+        };
+
+        QMutex m_mutex;
+        QCache<QString, Entry> m_entries;
+    };
+
+    Q_GLOBAL_STATIC( IndexCache, s_indexCache )
+}
+
+
 class K3bFFMpegFile::Private
 {
 public:
@@ -99,6 +255,27 @@ public:
     int packetSize;
     bool isSpacious;
     int sampleFormat;
+
+    // interleaved samples converted from planar formats
+    QByteArray convertedBuffer;
+
+    QSharedPointer<const PacketIndex> index;
+
+    // the sample the next decoded frame starts with or -1 if unknown
+    qint64 nextSample;
+
+    // the samples before seekTarget are discarded, -1 if not seeking
+    qint64 seekTarget;
+    bool seekPending;
+    bool seekByByte;
+    qint64 seekStartSample;
+
+    // after seeking by byte the packets are stamped starting with this
+    // sample, -1 if the timestamps of the demuxer are used
+    qint64 stampSample;
+    QElapsedTimer seekTimer;
+
+    K3bFFMpegFile::SeekStatistics seekStatistics;
 };
 
 
@@ -108,6 +285,18 @@ K3bFFMpegFile::K3bFFMpegFile( const QString& filename )
     d = new Private;
     d->formatContext = 0;
     d->codec = 0;
+    d->outputBufferPos = 0;
+    d->outputBufferSize = 0;
+    d->packetSize = 0;
+    d->nextSample = -1;
+    d->seekTarget = -1;
+    d->seekPending = false;
+    d->seekByByte = false;
+    d->seekStartSample = 0;
+    d->stampSample = -1;
+    d->seekStatistics.seeks = 0;
+    d->seekStatistics.discardedSamples = 0;
+    d->seekStatistics.nsecs = 0;
 #ifdef HAVE_FFMPEG_AVCODEC_DECODE_AUDIO4
 #  if LIBAVCODEC_BUILD < AV_VERSION_INT(55,28,1)
     d->frame = avcodec_alloc_frame();
@@ -200,8 +389,14 @@ bool K3bFFMpegFile::open()
 void K3bFFMpegFile::close()
 {
     d->outputBufferSize = 0;
+    if( d->packetSize > 0 )
+        unrefPacket( &d->packet );
     d->packetSize = 0;
     d->packetData = 0;
+    d->nextSample = -1;
+    d->seekTarget = -1;
+    d->seekPending = false;
+    d->stampSample = -1;
 
     if( d->codec ) {
         ::avcodec_close( FFMPEG_CODEC(d->formatContext->streams[0]) );
@@ -290,7 +485,7 @@ QString K3bFFMpegFile::comment() const
 
 int K3bFFMpegFile::read(char* buf, int bufLen)
 {
-    if (!buf || !d->outputBufferPos)
+    if (!buf)
         return -1;
 
     int ret = fillOutputBuffer();
@@ -301,9 +496,6 @@ int K3bFFMpegFile::read(char* buf, int bufLen)
     int len = qMin(bufLen, d->outputBufferSize);
     ::memcpy(buf, d->outputBufferPos, len);
 
-    if(d->isSpacious && bufLen > d->outputBufferSize)
-        delete[] d->outputBufferPos; // clean up allocated space
-
     // TODO: only swap if needed
     for(int i=0; i<len-1; i+=2)
         qSwap(buf[i], buf[i+1]); // BE -> LE
@@ -326,6 +518,31 @@ int K3bFFMpegFile::readPacket()
         }
         d->packetSize = d->packet.size;
         d->packetData = d->packet.data;
+
+        ::AVStream* stream = d->formatContext->streams[0];
+
+        //
+        // After seeking to a byte position the demuxer does not know the
+        // timestamps. We know the position of the first packet from the index
+        // and stamp the packets until the seek target is reached so the decoded
+        // frames carry their positions.
+        //
+        if( d->stampSample >= 0 ) {
+            d->packet.pts = d->packet.dts = sampleToPts( stream, d->stampSample );
+            if( d->packet.duration > 0 )
+                d->stampSample += durationToSamples( stream, d->packet.duration );
+            else
+                d->stampSample = -1;
+        }
+
+        // a fallback for decoded frames without timestamps
+        if( d->seekPending ) {
+            d->seekPending = false;
+            if( d->packet.pts != (qint64)AV_NOPTS_VALUE )
+                d->nextSample = ptsToSample( stream, d->packet.pts );
+            else
+                d->nextSample = d->seekStartSample;
+        }
     }
 
     return d->packetSize;
@@ -375,13 +592,9 @@ int K3bFFMpegFile::fillOutputBuffer()
 #  endif
 #endif
 
-        if( d->packetSize <= 0 || len < 0 )
-#if LIBAVCODEC_VERSION_MAJOR >= 56
-            ::av_packet_unref( &d->packet );
-#else
-            ::av_free_packet( &d->packet );
-#endif
         if( len < 0 ) {
+            unrefPacket( &d->packet );
+            d->packetSize = 0;
             qDebug() << "(K3bFFMpegFile) decoding failed for " << m_filename;
             return -1;
         }
@@ -394,7 +607,8 @@ int K3bFFMpegFile::fillOutputBuffer()
             d->outputBufferPos = reinterpret_cast<char*>(
                 d->frame->extended_data[0]);
             if(d->isSpacious) {
-                d->outputBufferPos = new char[d->outputBufferSize];
+                d->convertedBuffer.resize(d->outputBufferSize);
+                d->outputBufferPos = d->convertedBuffer.data();
                 if(d->sampleFormat == AV_SAMPLE_FMT_FLTP) {
                     int width = sizeof(float); // sample width of float audio
                     for(int sample=0; sample<nb_s; sample++) {
@@ -419,10 +633,37 @@ int K3bFFMpegFile::fillOutputBuffer()
                     }
                 }
             }
+
+            //
+            // Drop the samples before the seek target. After being flushed the
+            // decoder may hold back or skip samples, so the position is taken
+            // from the frame and only counted if it has no timestamp.
+            //
+            if(d->seekTarget >= 0) {
+                const qint64 timestamp = d->frame->best_effort_timestamp;
+                if(timestamp != (qint64)AV_NOPTS_VALUE)
+                    d->nextSample = ptsToSample(d->formatContext->streams[0], timestamp);
+                if(d->nextSample >= 0) {
+                    const qint64 drop = qBound<qint64>(0, d->seekTarget - d->nextSample, nb_s);
+                    d->outputBufferPos += drop * nb_ch * 2;
+                    d->outputBufferSize -= drop * nb_ch * 2;
+                    d->seekStatistics.discardedSamples += drop;
+                    if(drop < nb_s) {
+                        d->seekTarget = -1;
+                        d->stampSample = -1;
+                        d->seekStatistics.nsecs += d->seekTimer.nsecsElapsed();
+                    }
+                }
+            }
+            if(d->nextSample >= 0)
+                d->nextSample += nb_s;
         }
 #endif
         d->packetSize -= len;
         d->packetData += len;
+
+        if( d->packetSize <= 0 )
+            unrefPacket( &d->packet );
     }
 
     return d->outputBufferSize;
@@ -431,18 +672,71 @@ int K3bFFMpegFile::fillOutputBuffer()
 
 bool K3bFFMpegFile::seek( const K3b::Msf& msf )
 {
+    d->seekTimer.start();
+    ++d->seekStatistics.seeks;
+
     d->outputBufferSize = 0;
+    if( d->packetSize > 0 )
+        unrefPacket( &d->packet );
     d->packetSize = 0;
 
-    double seconds = (double)msf.totalFrames()/75.0;
-    quint64 timestamp = (quint64)(seconds * (double)AV_TIME_BASE);
+    ::AVStream* stream = d->formatContext->streams[0];
+    ::avcodec_flush_buffers( FFMPEG_CODEC(stream) );
+
+    const qint64 target = (qint64)msf.totalFrames() * sampleRate() / 75;
+    const qint64 start = qMax<qint64>( 0, target - (qint64)sampleRate() * s_prerollMsecs / 1000 );
+
+    if( !d->index )
+        buildIndex();
+
+    //
+    // Start at the last indexed packet before the target. Without an index
+    // we let ffmpeg find the packet.
+    //
+    IndexEntry entry = { start, sampleToPts( stream, start ), -1 };
+    if( !d->index->isEmpty() ) {
+        PacketIndex::const_iterator it = std::upper_bound( d->index->constBegin(), d->index->constEnd(), start );
+        if( it != d->index->constBegin() )
+            entry = *(--it);
+        else
+            entry = d->index->first();
+    }
 
-    // FIXME: do we really need the start_time and why?
-#if LIBAVFORMAT_BUILD >= 4619
-    return ( ::av_seek_frame( d->formatContext, -1, timestamp + d->formatContext->start_time, 0 ) >= 0 );
-#else
-    return ( ::av_seek_frame( d->formatContext, -1, timestamp + d->formatContext->start_time ) >= 0 );
-#endif
+    d->seekByByte = ( entry.pos >= 0 && !( d->formatContext->iformat->flags & AVFMT_NO_BYTE_SEEK ) );
+    int ret = 0;
+    if( d->seekByByte )
+        ret = ::av_seek_frame( d->formatContext, 0, entry.pos, AVSEEK_FLAG_BYTE );
+    else
+        ret = ::av_seek_frame( d->formatContext, 0, entry.pts, AVSEEK_FLAG_BACKWARD );
+
+    if( ret < 0 ) {
+        qDebug() << "(K3bFFMpegFile) seeking to " << msf.toString() << " failed for " << m_filename;
+        d->seekTarget = -1;
+        d->seekPending = false;
+        d->stampSample = -1;
+        return false;
+    }
+
+    d->nextSample = -1;
+    d->seekTarget = target;
+    d->seekStartSample = entry.sample;
+    d->stampSample = ( d->seekByByte ? entry.sample : -1 );
+    d->seekPending = true;
+
+    return true;
+}
+
+
+void K3bFFMpegFile::buildIndex()
+{
+    if( !d->index )
+        d->index = s_indexCache->index( m_filename );
+}
+
+
+K3bFFMpegFile::SeekStatistics K3bFFMpegFile::seekStatistics() const
+{
+    return d->seekStatistics;
 }
 
 
@@ -48,8 +48,31 @@ class K3bFFMpegFile
   QString comment() const;
 
   int read( char* buf, int bufLen );
+
+  /**
+   * Seeks to the exact sample at \p msf. The packet index is used to find
+   * the packet to start decoding at and the samples before the target are
+   * decoded and discarded. The position of each decoded frame is taken from
+   * its timestamp since the decoder may delay or skip samples after a seek.
+   */
   bool seek( const K3b::Msf& );
 
+  /**
+   * Scans all packets of the file and caches their positions for seek().
+   * Does nothing if the index of the file is already cached. Otherwise it
+   * is built on the first seek. Only the indices of the most recently
+   * analysed files are cached.
+   */
+  void buildIndex();
+
+  struct SeekStatistics {
+      int seeks;
+      qint64 discardedSamples;
+      qint64 nsecs;   /**< including the time to decode the discarded samples */
+  };
+
+  SeekStatistics seekStatistics() const;
+
  private:
   explicit K3bFFMpegFile( const QString& filename );
   int readPacket();
@@ -16,7 +16,7 @@
 #include <config-k3b.h>
 #include <config-flac.h>
 
-#include <QBuffer>
+#include <QByteArray>
 #include <QDebug>
 #include <QFile>
 #include <QStringList>
@@ -52,8 +52,8 @@ public:
         file = f;
         file->open(QIODevice::ReadOnly);
 
-        //TODO port me to kde4
-        //internalBuffer->flush();
+        pcm.clear();
+        pcmPos = 0;
 
         set_metadata_respond(FLAC__METADATA_TYPE_STREAMINFO);
         set_metadata_respond(FLAC__METADATA_TYPE_VORBIS_COMMENT);
@@ -75,24 +75,25 @@ public:
 #else
           : FLAC::Decoder::Stream(),
 #endif
-            comments(0) {
-            internalBuffer = new QBuffer();
-            internalBuffer->open(QIODevice::ReadWrite);
-
+            comments(0),
+            pcmPos(0) {
             open(f);
         }
 
 
     ~Private() {
         cleanup();
-        delete internalBuffer;
     }
 
     bool seekToFrame(int frame);
 
     QFile* file;
-    QBuffer* internalBuffer;
     FLAC::Metadata::VorbisComment* comments;
+
+    // decoded 16 bit big endian samples which have not been returned yet
+    QByteArray pcm;
+    int pcmPos;
+
     unsigned rate;
     unsigned channels;
     unsigned bitsPerSample;
@@ -122,6 +123,9 @@ protected:
 
 bool K3bFLACDecoder::Private::seekToFrame(int frame) {
     FLAC__uint64 sample = static_cast<FLAC__uint64>(frame) * rate / 75;
+    // the seek decodes the target frame into the buffer
+    pcm.clear();
+    pcmPos = 0;
     return seek_absolute(sample);
 }
 
@@ -219,21 +223,21 @@ void K3bFLACDecoder::Private::metadata_callback(const FLAC__StreamMetadata *meta
 }
 
 FLAC__StreamDecoderWriteStatus K3bFLACDecoder::Private::write_callback(const FLAC__Frame *frame, const FLAC__int32 * const buffer[]) {
-    unsigned i, j;
-    // Note that in canDecode we made sure that the input is 1-16 bit stereo or mono.
-    unsigned samples = frame->header.blocksize;
-
-    for(i=0; i < samples; ++i) {
-        // in FLAC channel 0 is left, 1 is right
-        for(j=0; j < this->channels; ++j) {
-            FLAC__int32 value = (buffer[j][i])<<(16 - frame->header.bits_per_sample);
-            internalBuffer->putChar(value >> 8); // msb
-            internalBuffer->putChar(value & 0xFF); // lsb
-        }
+    // Note that in canDecode we made sure that the input is stereo or mono.
+    const int samples = frame->header.blocksize;
+
+    if(pcmPos >= pcm.size()) {
+        pcm.resize(0);
+        pcmPos = 0;
     }
 
-    // Rewind the buffer so the decode method will take data from the beginning.
-    internalBuffer->seek(0);
+    // in FLAC channel 0 is left, 1 is right
+    const int oldSize = pcm.size();
+    pcm.resize(oldSize + samples*this->channels*2);
+    K3b::AudioDecoder::fromPlanar32BitTo16BitBeSigned(buffer, this->channels, samples,
+                                                      frame->header.bits_per_sample,
+                                                      pcm.data() + oldSize);
+
     return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
 }
 
@@ -311,12 +315,8 @@ bool K3bFLACDecoder::initDecoderInternal()
 
 int K3bFLACDecoder::decodeInternal( char* _data, int maxLen )
 {
-    int bytesToCopy;
-    int bytesCopied;
-    int bytesAvailable;
-
 #ifdef LEGACY_FLAC
-    if(d->internalBuffer->size() == 0) {
+    if(d->pcmPos >= d->pcm.size()) {
         // want more data
         switch(d->get_state()) {
         case FLAC__SEEKABLE_STREAM_DECODER_END_OF_STREAM:
@@ -331,7 +331,7 @@ int K3bFLACDecoder::decodeInternal( char* _data, int maxLen )
         }
     }
 #else
-    if(d->internalBuffer->size() == 0) {
+    if(d->pcmPos >= d->pcm.size()) {
         // want more data
         if(d->get_state() == FLAC__STREAM_DECODER_END_OF_STREAM)
             d->finish();
@@ -344,17 +344,12 @@ int K3bFLACDecoder::decodeInternal( char* _data, int maxLen )
     }
 #endif
 
-    bytesAvailable = d->internalBuffer->size() - d->internalBuffer->pos();
-    bytesToCopy = qMin(maxLen, bytesAvailable);
-    bytesCopied = (int)d->internalBuffer->read(_data, bytesToCopy);
-
-    if(bytesCopied == bytesAvailable) {
-        // reset the buffer
-        d->internalBuffer->close();
-        d->internalBuffer->open(QIODevice::ReadWrite|QIODevice::Truncate);
-    }
+    const int bytesAvailable = d->pcm.size() - d->pcmPos;
+    const int bytesToCopy = qMin(maxLen, bytesAvailable);
+    ::memcpy(_data, d->pcm.constData() + d->pcmPos, bytesToCopy);
+    d->pcmPos += bytesToCopy;
 
-    return bytesCopied;
+    return bytesToCopy;
 }
 
 
@@ -472,7 +467,7 @@ bool K3bFLACDecoderFactory::canDecode( const QUrl& url )
     FLAC::Metadata::get_streaminfo(url.toLocalFile().toLatin1(), info);
 
     if((info.get_channels() <= 2) &&
-       (info.get_bits_per_sample() <= 16)) {
+       (info.get_bits_per_sample() <= 32)) {
         return true;
     } else {
         qDebug() << "(K3bFLACDecoder) " << url.toLocalFile() << ": wrong format:" << endl
@@ -33,17 +33,38 @@ class K3bLibsndfileDecoder::Private
 public:
     Private():
         isOpen(false),
+        sampleFormat(SampleFloat),
         buffer(0),
-        bufferSize(0) {
+        bufferSize(0),
+        intBuffer(0),
+        intBufferSize(0) {
         format_info.name = 0;
     }
 
+    ~Private() {
+        delete [] buffer;
+        delete [] intBuffer;
+    }
+
+    //
+    // Integer PCM is read in its native representation, everything
+    // else is converted by libsndfile to float
+    //
+    enum SampleFormat {
+        SampleShort,
+        SampleInt,
+        SampleFloat
+    };
+
     SNDFILE *sndfile;
     SF_INFO sndinfo;
     SF_FORMAT_INFO format_info;
     bool isOpen;
+    SampleFormat sampleFormat;
     float* buffer;
     int bufferSize;
+    int* intBuffer;
+    int intBufferSize;
 };
 
 
@@ -88,6 +109,21 @@ bool K3bLibsndfileDecoder::openFile()
             d->format_info.format = d->sndinfo.format & SF_FORMAT_TYPEMASK ;
             sf_command (d->sndfile, SFC_GET_FORMAT_INFO, &d->format_info, sizeof (SF_FORMAT_INFO)) ;
 
+            switch( d->sndinfo.format & SF_FORMAT_SUBMASK ) {
+            case SF_FORMAT_PCM_S8:
+            case SF_FORMAT_PCM_U8:
+            case SF_FORMAT_PCM_16:
+                d->sampleFormat = Private::SampleShort;
+                break;
+            case SF_FORMAT_PCM_24:
+            case SF_FORMAT_PCM_32:
+                d->sampleFormat = Private::SampleInt;
+                break;
+            default:
+                d->sampleFormat = Private::SampleFloat;
+                break;
+            }
+
             d->isOpen = true;
             qDebug() << "(K3bLibsndfileDecoder::openLibsndfileFile) " << d->format_info.name << " file opened ";
             return true;
@@ -144,13 +180,40 @@ bool K3bLibsndfileDecoder::initDecoderInternal()
 
 int K3bLibsndfileDecoder::decodeInternal( char* data, int maxLen )
 {
-    if( !d->buffer ) {
-        d->buffer = new float[maxLen];
-        d->bufferSize = maxLen/2;
+    const int samples = maxLen/2;
+    int read = 0;
+
+    switch( d->sampleFormat ) {
+    case Private::SampleShort:
+        // 16 bit samples are read straight into the output and swapped in place
+        read = (int) sf_read_short( d->sndfile, reinterpret_cast<short*>( data ), samples );
+        if( read > 0 )
+            fromNative16BitTo16BitBeSigned( reinterpret_cast<short*>( data ), data, read );
+        break;
+
+    case Private::SampleInt:
+        if( d->intBufferSize < samples ) {
+            delete [] d->intBuffer;
+            d->intBuffer = new int[samples];
+            d->intBufferSize = samples;
+        }
+        read = (int) sf_read_int( d->sndfile, d->intBuffer, samples );
+        if( read > 0 )
+            fromNative32BitTo16BitBeSigned( d->intBuffer, data, read, 32 );
+        break;
+
+    case Private::SampleFloat:
+        if( d->bufferSize < samples ) {
+            delete [] d->buffer;
+            d->buffer = new float[samples];
+            d->bufferSize = samples;
+        }
+        read = (int) sf_read_float( d->sndfile, d->buffer, samples );
+        if( read > 0 )
+            fromFloatTo16BitBeSigned( d->buffer, data, read );
+        break;
     }
 
-    int read = (int) sf_read_float(d->sndfile, d->buffer,d->bufferSize) ;
-    fromFloatTo16BitBeSigned( d->buffer, data, read );
     read = read * 2;
 
     if( read < 0 ) {
@@ -33,6 +33,8 @@
 #include "k3bglobals.h"
 #include "k3bversion.h"
 #include "k3bdoc.h"
+#include "k3bdatadoc.h"
+#include "k3bvcddoc.h"
 #include "k3bsystemproblemdialog.h"
 #include "k3bpluginmanager.h"
 #include "k3bthememanager.h"
@@ -40,6 +42,8 @@
 #include "k3bmovixprogram.h"
 #include "k3bview.h"
 #include "k3bjob.h"
+#include "k3bjobqueue.h"
+#include "k3bjobinterface.h"
 #include "k3bmediacache.h"
 
 #include <KConfigCore/KConfig>
@@ -49,11 +53,117 @@
 
 #include <QCommandLineParser>
 #include <QDebug>
+#include <QHash>
+#include <QPointer>
+#include <QSet>
+#include <QUrl>
+
+#include <memory>
 
 
 K3b::Application::Core* K3b::Application::Core::s_k3bAppCore = 0;
 
 
+namespace {
+    /**
+     * Burns a K3b project. Each job gets its own private instance of the project
+     * which is not shown in the GUI and deleted together with the job. This way
+     * the same project can be burned on several drives at once and the user may
+     * keep editing or close it.
+     */
+    K3b::JobQueue::JobType projectJobType( K3b::ProjectManager* projectManager, K3b::JobQueue* queue )
+    {
+        // the projects loaded to determine the temp space, handed to the next job
+        std::shared_ptr<QHash<QString, QPointer<K3b::Doc> > > loaded( new QHash<QString, QPointer<K3b::Doc> >() );
+
+        // drop the loaded projects no queued job is waiting for anymore
+        QObject::connect( queue, &K3b::JobQueue::jobFinished, projectManager, [queue, loaded]() {
+            QSet<QString> pending;
+            Q_FOREACH( const K3b::JobQueue::JobInfo& info, queue->jobs() ) {
+                if( info.state == K3b::JobQueue::Queued )
+                    pending.insert( info.description.value( QLatin1String( "project" ) ).toString() );
+            }
+            QHash<QString, QPointer<K3b::Doc> >::iterator it = loaded->begin();
+            while( it != loaded->end() ) {
+                if( !pending.contains( it.key() ) ) {
+                    delete it.value().data();
+                    it = loaded->erase( it );
+                }
+                else {
+                    ++it;
+                }
+            }
+        } );
+
+        auto loadProject = [projectManager, loaded]( const QVariantMap& description ) -> K3b::Doc* {
+            const QString project = description.value( QLatin1String( "project" ) ).toString();
+            if( project.isEmpty() )
+                return 0;
+
+            QPointer<K3b::Doc> doc = loaded->value( project );
+            if( !doc ) {
+                doc = projectManager->loadProject( QUrl::fromUserInput( project ) );
+                if( !doc )
+                    return 0;
+                loaded->insert( project, doc );
+            }
+
+            if( description.contains( QLatin1String( "onTheFly" ) ) )
+                doc->setOnTheFly( description.value( QLatin1String( "onTheFly" ) ).toBool() );
+            if( description.contains( QLatin1String( "simulate" ) ) )
+                doc->setDummy( description.value( QLatin1String( "simulate" ) ).toBool() );
+            if( description.contains( QLatin1String( "speed" ) ) )
+                doc->setSpeed( description.value( QLatin1String( "speed" ) ).toInt() );
+            if( description.contains( QLatin1String( "copies" ) ) )
+                doc->setCopies( qMax( 1, description.value( QLatin1String( "copies" ) ).toInt() ) );
+            return doc;
+        };
+
+        K3b::JobQueue::JobType type;
+        type.roles = K3b::JobQueue::Writer;
+        type.create = [loaded, loadProject]( const QVariantMap& description, K3b::Device::Device*, K3b::Device::Device* writer,
+                                             K3b::JobHandler* handler, QObject* parent ) -> K3b::Job* {
+            K3b::Doc* doc = loadProject( description );
+            if( !doc )
+                return 0;
+            loaded->remove( description.value( QLatin1String( "project" ) ).toString() );
+
+            doc->setBurner( writer );
+            K3b::Job* job = doc->newBurnJob( handler, parent );
+            if( !job ) {
+                delete doc;
+                return 0;
+            }
+            doc->setParent( job );
+
+            // the image path saved with the project would be shared by all the copies
+            if( !doc->onlyCreateImages() ) {
+                const QString tempDir = K3b::JobQueue::privateTempDir( job );
+                if( tempDir.isEmpty() ) {
+                    delete job;
+                    return 0;
+                }
+                if( K3b::DataDoc* dataDoc = qobject_cast<K3b::DataDoc*>( doc ) )
+                    dataDoc->setTempDir( tempDir + QLatin1String( "image.iso" ) );
+                else if( K3b::VcdDoc* vcdDoc = qobject_cast<K3b::VcdDoc*>( doc ) )
+                    vcdDoc->setVcdImage( tempDir + QLatin1String( "image.bin" ) );
+                else
+                    doc->setTempDir( tempDir );
+            }
+            return job;
+        };
+        type.tempSpace = [loadProject]( const QVariantMap& description, K3b::Device::Device* ) -> KIO::filesize_t {
+            K3b::Doc* doc = loadProject( description );
+            if( !doc || doc->onTheFly() )
+                return 0;
+            else
+                return doc->size();
+        };
+        return type;
+    }
+}
+
+
 K3b::Application::Application( int& argc, char** argv )
     : QApplication( argc, argv ),
       m_core( nullptr ),
@@ -237,6 +347,7 @@ K3b::Application::Core::Core( QObject* parent )
     s_k3bAppCore = this;
     m_themeManager = new ThemeManager( this );
     m_projectManager = new ProjectManager( this );
+    m_jobQueue = 0;
     // we need the themes on startup (loading them is fast anyway :)
     m_themeManager->loadThemes();
 }
@@ -264,6 +375,10 @@ void K3b::Application::Core::init()
              mediaCache(), SLOT(buildDeviceList(K3b::Device::DeviceManager*)) );
     // FIXME: move this to libk3b
     appDeviceManager()->setMediaCache( mediaCache() );
+
+    m_jobQueue = new JobQueue( this );
+    m_jobQueue->registerJobType( QLatin1String( "project" ), projectJobType( m_projectManager, m_jobQueue ) );
+    new JobInterface( m_jobQueue );
 }
 
 
@@ -32,6 +32,7 @@ namespace K3b {
     class ThemeManager;
     class ProjectManager;
     class AppDeviceManager;
+    class JobQueue;
 
     class Application : public QApplication
     {
@@ -81,6 +82,12 @@ namespace K3b {
 
         ProjectManager* projectManager() const { return m_projectManager; }
 
+        /**
+         * The queue for jobs started via D-Bus. Besides the job types of libk3b
+         * it runs K3b projects.
+         */
+        JobQueue* jobQueue() const { return m_jobQueue; }
+
         MainWindow* k3bMainWindow() const { return m_mainWindow; }
 
         static Core* k3bAppCore() { return s_k3bAppCore; }
@@ -109,6 +116,7 @@ namespace K3b {
         ThemeManager* m_themeManager;
         MainWindow* m_mainWindow;
         ProjectManager* m_projectManager;
+        JobQueue* m_jobQueue;
 
         QMap<Device::Device*, int> m_deviceBlockMap;
 
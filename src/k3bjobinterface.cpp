@@ -16,9 +16,13 @@
 #include "k3bjobinterface.h"
 #include "k3bjobinterfaceadaptor.h"
 #include "k3bjob.h"
+#include "k3bjobqueue.h"
 
 #include <QDBusConnection>
 #include <QDataStream>
+#include <QDebug>
+#include <QJsonDocument>
+#include <QJsonObject>
 
 namespace K3b {
 
@@ -27,6 +31,8 @@ JobInterface::JobInterface( Job* job )
 :
     QObject( job ),
     m_job( job ),
+    m_queue( 0 ),
+    m_path( "/job" ),
     m_lastProgress( 0 ),
     m_lastSubProgress( 0 )
 {
@@ -48,13 +54,31 @@ JobInterface::JobInterface( Job* job )
     }
 
     new K3bJobInterfaceAdaptor( this );
-    QDBusConnection::sessionBus().registerObject( "/job", this );
+    QDBusConnection::sessionBus().registerObject( m_path, this );
+}
+
+
+JobInterface::JobInterface( JobQueue* queue )
+:
+    QObject( queue ),
+    m_job( 0 ),
+    m_queue( queue ),
+    m_path( "/queue" ),
+    m_lastProgress( 0 ),
+    m_lastSubProgress( 0 )
+{
+    connect( queue, SIGNAL(jobStarted(int)), this, SIGNAL(queuedJobStarted(int)) );
+    connect( queue, SIGNAL(jobFinished(int,bool)), this, SIGNAL(queuedJobFinished(int,bool)) );
+    connect( queue, SIGNAL(infoMessage(int,QString,int)), this, SIGNAL(queuedJobInfoMessage(int,QString,int)) );
+
+    new K3bJobInterfaceAdaptor( this );
+    QDBusConnection::sessionBus().registerObject( m_path, this );
 }
 
 
 JobInterface::~JobInterface()
 {
-    QDBusConnection::sessionBus().unregisterObject( "/job" );
+    QDBusConnection::sessionBus().unregisterObject( m_path );
 }
 
 
@@ -82,6 +106,96 @@ QString JobInterface::jobDetails() const
 }
 
 
+int JobInterface::enqueueJob( const QString& description )
+{
+    if( !m_queue )
+        return -1;
+
+    QJsonParseError parseError;
+    const QJsonDocument json = QJsonDocument::fromJson( description.toUtf8(), &parseError );
+    if( !json.isObject() ) {
+        qDebug() << "(K3b::JobInterface) invalid job description:" << parseError.errorString();
+        return -1;
+    }
+
+    QString error;
+    const int id = m_queue->enqueue( json.object().toVariantMap(), &error );
+    if( id < 0 )
+        qDebug() << "(K3b::JobInterface) could not queue job:" << error;
+    return id;
+}
+
+
+bool JobInterface::cancelQueuedJob( int id )
+{
+    return ( m_queue && m_queue->cancel( id ) );
+}
+
+
+QStringList JobInterface::queuedJobs() const
+{
+    QStringList list;
+    if( !m_queue )
+        return list;
+
+    Q_FOREACH( const JobQueue::JobInfo& info, m_queue->jobs() ) {
+        QString state;
+        switch( info.state ) {
+        case JobQueue::Queued:
+            state = QLatin1String( "queued" );
+            break;
+        case JobQueue::Running:
+            state = QLatin1String( "running" );
+            break;
+        case JobQueue::Succeeded:
+            state = QLatin1String( "succeeded" );
+            break;
+        case JobQueue::Failed:
+            state = QLatin1String( "failed" );
+            break;
+        case JobQueue::Canceled:
+            state = QLatin1String( "canceled" );
+            break;
+        }
+
+        list << QString::fromLatin1( "%1\t%2\t%3\t%4\t%5" )
+            .arg( info.id )
+            .arg( state )
+            .arg( info.reader.isEmpty() ? QLatin1String( "-" ) : info.reader )
+            .arg( info.writer.isEmpty() ? QLatin1String( "-" ) : info.writer )
+            .arg( info.error.isEmpty() ? info.jobDescription : info.error );
+    }
+    return list;
+}
+
+
+QString JobInterface::driveUtilisation() const
+{
+    if( m_queue )
+        return m_queue->utilisationReport();
+    else
+        return QString();
+}
+
+
+QString JobInterface::telemetry( qlonglong since ) const
+{
+    if( m_job && m_job->telemetry() )
+        return QString::fromUtf8( m_job->telemetry()->toJsonLines( since ) );
+    else
+        return QString();
+}
+
+
+bool JobInterface::exportTelemetry( const QString& filename ) const
+{
+    if( m_job && m_job->telemetry() )
+        return m_job->telemetry()->writeJsonLines( filename );
+    else
+        return false;
+}
+
+
 void JobInterface::slotProgress( int val )
 {
     if( m_lastProgress != val )
@@ -20,9 +20,14 @@
 
 /**
  * A D-BUS interface for K3b's currently running job.
+ *
+ * It also gives access to the job queue which runs jobs on all drives at
+ * once. Besides the interface of the running job at /job there is one
+ * at /queue which emits the signals of the queue.
  */
 namespace K3b {
     class Job;
+    class JobQueue;
 
     class JobInterface : public QObject
     {
@@ -31,6 +36,7 @@ namespace K3b {
 
     public:
         explicit JobInterface( Job* job );
+        explicit JobInterface( JobQueue* queue );
         ~JobInterface();
 
     public Q_SLOTS:
@@ -39,6 +45,40 @@ namespace K3b {
         QString jobDescription() const;
         QString jobDetails() const;
 
+        /**
+         * Adds a job to the queue. Only available on the /queue interface.
+         *
+         * \param description A JSON object describing the job, for example
+         *        {"type": "image", "image": "/tmp/data.iso", "media": "dvd"}
+         *        See K3b::JobQueue for details.
+         *
+         * \return The id of the queued job or -1 if the description is invalid.
+         */
+        int enqueueJob( const QString& description );
+        bool cancelQueuedJob( int id );
+
+        /**
+         * One line per job with its id, state, drives, and description.
+         */
+        QStringList queuedJobs() const;
+
+        QString driveUtilisation() const;
+
+        /**
+         * The telemetry of the running job and its subjobs as JSON lines,
+         * see K3b::JobTelemetry.
+         *
+         * \param since Only return samples newer than this timestamp in usecs.
+         *        Use -1 for all samples and the timestamp of the last sample
+         *        to poll for new ones.
+         */
+        QString telemetry( qlonglong since ) const;
+
+        /**
+         * Writes the telemetry of the running job to \p filename.
+         */
+        bool exportTelemetry( const QString& filename ) const;
+
     Q_SIGNALS:
         void started();
         void canceled();
@@ -52,12 +92,18 @@ namespace K3b {
         void deviceBuffer( int );
         void nextTrack( int track, int numTracks );
 
+        void queuedJobStarted( int id );
+        void queuedJobFinished( int id, bool success );
+        void queuedJobInfoMessage( int id, const QString&, int );
+
     private Q_SLOTS:
         void slotProgress( int );
         void slotSubProgress( int );
 
     private:
         Job* m_job;
+        JobQueue* m_queue;
+        QString m_path;
 
         int m_lastProgress;
         int m_lastSubProgress;
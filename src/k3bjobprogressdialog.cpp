@@ -47,6 +47,7 @@
 #include <QString>
 #include <QCloseEvent>
 #include <QIcon>
+#include <QFileInfo>
 #include <QFont>
 #include <QKeyEvent>
 #include <QDialogButtonBox>
@@ -367,8 +368,24 @@ void K3b::JobProgressDialog::slotFinished( bool success )
 {
     qDebug() << "received finished signal!";
 
+    // add the command traces of the job to the debugging output
+    Q_FOREACH( K3b::Device::Device* dev, k3bcore->deviceManager()->allDevices() ) {
+        K3b::Device::CommandTrace* trace = dev->commandTrace();
+        if( trace && dev->commandTracingEnabled() ) {
+            const QString group = QString::fromLatin1( "Device Commands %1" ).arg( dev->blockDeviceName() );
+            Q_FOREACH( const QString& line, trace->report().split( '\n' ) ) {
+                m_logCache.addOutput( group, line );
+                m_logFile.addOutput( group, line );
+            }
+        }
+    }
+
     m_logFile.close();
 
+    // the telemetry of the job goes next to the log file
+    if( m_job && m_job->telemetry() )
+        m_job->telemetry()->writeJsonLines( QFileInfo( m_logFile ).absolutePath() + QLatin1String( "/lasttelemetry.jsonl" ) );
+
     const KColorScheme colorScheme( QPalette::Normal, KColorScheme::Window );
     QPalette taskPalette( m_labelTask->palette() );
 
@@ -446,6 +463,11 @@ void K3b::JobProgressDialog::setJob( K3b::Job* job )
         m_labelTask->setPalette( k3bappcore->themeManager()->currentTheme()->palette() );
     m_logCache.clear();
 
+    Q_FOREACH( K3b::Device::Device* dev, k3bcore->deviceManager()->allDevices() ) {
+        if( K3b::Device::CommandTrace* trace = dev->commandTrace() )
+            trace->clear();
+    }
+
     // disconnect from the former job
     if( m_job )
         disconnect( m_job );
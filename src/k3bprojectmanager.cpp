@@ -447,6 +447,23 @@ QString K3b::ProjectManager::dbusPath( K3b::Doc* doc ) const
 
 
 K3b::Doc* K3b::ProjectManager::openProject( const QUrl& url )
+{
+    K3b::Doc* newDoc = loadProject( url );
+    if( newDoc ) {
+        // ok, finish the doc setup, inform the others about the new project
+        //dcopInterface( newDoc );
+        addProject( newDoc );
+
+        // FIXME: find a better way to tell everyone (especially the projecttabwidget)
+        //        that the doc is not changed
+        emit projectSaved( newDoc );
+    }
+
+    return newDoc;
+}
+
+
+K3b::Doc* K3b::ProjectManager::loadProject( const QUrl& url )
 {
     QApplication::setOverrideCursor( QCursor(Qt::WaitCursor) );
 
@@ -552,14 +569,6 @@ K3b::Doc* K3b::ProjectManager::openProject( const QUrl& url )
         newDoc->setSaved( true );
         newDoc->setModified( false );
 
-        // ok, finish the doc setup, inform the others about the new project
-        //dcopInterface( newDoc );
-        addProject( newDoc );
-
-        // FIXME: find a better way to tell everyone (especially the projecttabwidget)
-        //        that the doc is not changed
-        emit projectSaved( newDoc );
-
         qDebug() << "(K3b::ProjectManager) loading project done.";
     }
     else {
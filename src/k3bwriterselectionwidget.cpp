@@ -118,7 +118,7 @@ K3b::WriterSelectionWidget::WriterSelectionWidget( QWidget *parent )
 {
     d = new Private;
     d->forceAutoSpeed = false;
-    d->supportedWritingApps = K3b::WritingAppCdrecord|K3b::WritingAppCdrdao|K3b::WritingAppGrowisofs;
+    d->supportedWritingApps = K3b::WritingAppCdrecord|K3b::WritingAppCdrdao|K3b::WritingAppGrowisofs|K3b::WritingAppNative;
     d->lastSetSpeed = -1;
 
     QGroupBox* groupWriter = new QGroupBox( this );
@@ -186,6 +186,8 @@ K3b::WriterSelectionWidget::WriterSelectionWidget( QWidget *parent )
                                      "fast enough to prevent buffer underruns.") );
     m_comboWritingApp->setWhatsThis( i18n("<p>K3b uses the command line tools cdrecord, growisofs, and cdrdao "
                                           "to actually write a CD or DVD."
+                                          "<p>DVD and Blu-ray media may also be written natively "
+                                          "without the help of an external application."
                                           "<p>Normally K3b chooses the best "
                                           "suited application for every task automatically but in some cases it "
                                           "may be possible that one of the applications does not work as intended "
@@ -510,9 +512,9 @@ void K3b::WriterSelectionWidget::slotRefreshWritingApps()
 
     // select the ones that make sense
     if( Device::isDvdMedia( k3bappcore->mediaCache()->diskInfo( writerDevice() ).mediaType() ) )
-        i = K3b::WritingAppGrowisofs|K3b::WritingAppDvdRwFormat|K3b::WritingAppCdrecord;
+        i = K3b::WritingAppGrowisofs|K3b::WritingAppDvdRwFormat|K3b::WritingAppCdrecord|K3b::WritingAppNative;
     else if ( K3b::Device::isBdMedia( k3bappcore->mediaCache()->diskInfo( writerDevice() ).mediaType() ) )
-        i = K3b::WritingAppGrowisofs|K3b::WritingAppCdrecord;
+        i = K3b::WritingAppGrowisofs|K3b::WritingAppCdrecord|K3b::WritingAppNative;
     else
         i = K3b::WritingAppCdrdao|K3b::WritingAppCdrecord;
 
@@ -532,6 +534,8 @@ void K3b::WriterSelectionWidget::slotRefreshWritingApps()
         m_comboWritingApp->insertItem( K3b::WritingAppDvdRwFormat, "dvd+rw-format" );
     if (i & K3b::WritingAppCdrskin)
         m_comboWritingApp->insertItem(K3b::WritingAppCdrskin, "cdrskin");
+    if( i & K3b::WritingAppNative )
+        m_comboWritingApp->insertItem( K3b::WritingAppNative, i18n("Native") );
 
     m_comboWritingApp->setSelectedValue( lastSelected );
 
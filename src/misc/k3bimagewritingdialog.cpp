@@ -927,7 +927,7 @@ void K3b::ImageWritingDialog::toggleAll()
         K3b::WritingApps apps = K3b::WritingAppCdrecord;
         if (d->currentImageType() == IMAGE_ISO || d->currentImageType() == IMAGE_RAW) {
             // DVD/BD is always ISO here
-            apps |= K3b::WritingAppGrowisofs;
+            apps |= K3b::WritingAppGrowisofs|K3b::WritingAppNative;
         }
         if ( K3b::Device::isCdMedia( medium.diskInfo().mediaType() ) )
             apps |= K3b::WritingAppCdrdao;
@@ -17,6 +17,8 @@
 #include "k3bcore.h"
 #include "k3bstdguiitems.h"
 #include "k3bglobalsettings.h"
+#include "k3bdevice.h"
+#include "k3bdevicemanager.h"
 
 #include <KConfigCore/KConfig>
 #include <KConfigCore/KConfigGroup>
@@ -81,6 +83,8 @@ void K3b::AdvancedOptionTab::setupGui()
     groupMiscLayout->addWidget( m_checkEject );
     m_checkAutoErasingRewritable = new QCheckBox( i18n("Automatically erase CD-RWs and DVD-RWs"), groupMisc );
     groupMiscLayout->addWidget( m_checkAutoErasingRewritable );
+    m_checkTraceDeviceCommands = new QCheckBox( i18n("&Trace device commands"), groupMisc );
+    groupMiscLayout->addWidget( m_checkTraceDeviceCommands );
 
     groupAdvancedLayout->addWidget( groupWritingApp, 0, 0 );
     groupAdvancedLayout->addWidget( groupMisc, 1, 0 );
@@ -102,6 +106,7 @@ void K3b::AdvancedOptionTab::setupGui()
     m_checkAutoErasingRewritable->setToolTip( i18n("Automatically erase CD-RWs and DVD-RWs without asking") );
     m_checkEject->setToolTip( i18n("Do not eject the burn medium after a completed burn process") );
     m_checkForceUnsafeOperations->setToolTip( i18n("Force K3b to continue some operations otherwise deemed as unsafe") );
+    m_checkTraceDeviceCommands->setToolTip( i18n("Add the timing of all device commands to the debugging output") );
 
     m_checkShowForceGuiElements->setWhatsThis( i18n("<p>If this option is checked additional GUI "
                                                     "elements which allow one to influence the behavior of K3b are shown. "
@@ -144,6 +149,12 @@ void K3b::AdvancedOptionTab::setupGui()
                                                      "verification. Thus, one can force K3b to burn a high speed medium on "
                                                      "a low speed writer."
                                                      "<p><b>Caution:</b> Enabling this option may result in damaged media.") );
+
+    m_checkTraceDeviceCommands->setWhatsThis( i18n("<p>If this option is checked K3b records the duration of each "
+                                                   "command sent to the devices. Latency statistics and the most recent "
+                                                   "commands are added to the debugging output of each job."
+                                                   "<p>This helps to tell whether a slow burning or copying process "
+                                                   "is caused by the drive or by K3b.") );
 }
 
 
@@ -158,6 +169,7 @@ void K3b::AdvancedOptionTab::readSettings()
     m_checkEject->setChecked( !k3bcore->globalSettings()->ejectMedia() );
     m_checkOverburn->setChecked( k3bcore->globalSettings()->overburn() );
     m_checkForceUnsafeOperations->setChecked( k3bcore->globalSettings()->force() );
+    m_checkTraceDeviceCommands->setChecked( k3bcore->globalSettings()->traceDeviceCommands() );
     m_checkManualWritingBufferSize->setChecked( k3bcore->globalSettings()->useManualBufferSize() );
     if( k3bcore->globalSettings()->useManualBufferSize() )
         m_editWritingBufferSize->setValue( k3bcore->globalSettings()->bufferSize() );
@@ -177,6 +189,10 @@ void K3b::AdvancedOptionTab::saveSettings()
     k3bcore->globalSettings()->setUseManualBufferSize( m_checkManualWritingBufferSize->isChecked() );
     k3bcore->globalSettings()->setBufferSize( m_editWritingBufferSize->value() );
     k3bcore->globalSettings()->setForce( m_checkForceUnsafeOperations->isChecked() );
+    k3bcore->globalSettings()->setTraceDeviceCommands( m_checkTraceDeviceCommands->isChecked() );
+
+    Q_FOREACH( K3b::Device::Device* dev, k3bcore->deviceManager()->allDevices() )
+        dev->setCommandTracingEnabled( m_checkTraceDeviceCommands->isChecked() );
 }
 
 
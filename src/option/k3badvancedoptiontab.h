@@ -45,6 +45,7 @@ namespace K3b {
         QCheckBox*    m_checkBurnfree;
         QCheckBox*    m_checkEject;
         QCheckBox*    m_checkAutoErasingRewritable;
+        QCheckBox*    m_checkTraceDeviceCommands;
         QCheckBox*    m_checkOverburn;
         QCheckBox*    m_checkManualWritingBufferSize;
         QSpinBox*     m_editWritingBufferSize;
@@ -288,17 +288,10 @@ void K3b::AudioBurnDialog::slotNormalizeToggled( bool on )
 {
     if( on ) {
         // we are not able to normalize in on-the-fly mode
-        if( !k3bcore->externalBinManager()->foundBin( "normalize" ) ) {
-            KMessageBox::sorry( this, i18n("<p><b>External program <em>normalize</em> is not installed.</b>"
-                                           "<p>K3b uses <em>normalize</em> (http://normalize.nongnu.org/) "
-                                           "to normalize audio tracks. In order to "
-                                           "use this functionality, please install it first.") );
-            m_checkNormalize->setChecked( false );
-        }
-        else if( !m_checkCacheImage->isChecked() && !m_checkOnlyCreateImage->isChecked() ) {
+        if( !m_checkCacheImage->isChecked() && !m_checkOnlyCreateImage->isChecked() ) {
             if( KMessageBox::warningYesNo( this, i18n("<p>K3b is not able to normalize audio tracks when burning on-the-fly. "
-                                                      "The external program used for this task only supports normalizing a set "
-                                                      "of audio files."),
+                                                      "The volume levels of all tracks have to be known before writing "
+                                                      "can start."),
                                            QString(),
                                            KGuiItem( i18n("Disable normalization") ),
                                            KGuiItem( i18n("Disable on-the-fly burning") ),
@@ -17,6 +17,7 @@
 #include "k3bmsfedit.h"
 
 #include "k3baudiodatasource.h"
+#include "k3baudiopeaksgenerator.h"
 
 #include <KLocalizedString>
 
@@ -33,6 +34,7 @@ K3b::AudioDataSourceEditWidget::AudioDataSourceEditWidget( QWidget* parent )
     m_editor = new K3b::AudioEditorWidget( this );
     m_editStartOffset = new K3b::MsfEdit( this );
     m_editEndOffset = new K3b::MsfEdit( this );
+    m_peaksGenerator = new K3b::AudioPeaksGenerator( this );
 
     QLabel* startLabel = new QLabel( i18n("Start Offset:"), this );
     QLabel* endLabel = new QLabel( i18n("End Offset:"), this );
@@ -58,6 +60,9 @@ K3b::AudioDataSourceEditWidget::AudioDataSourceEditWidget( QWidget* parent )
     connect( m_editEndOffset, SIGNAL(valueChanged(K3b::Msf)),
              this, SLOT(slotEndOffsetEdited(K3b::Msf)) );
 
+    connect( m_peaksGenerator, SIGNAL(finished(bool)),
+             this, SLOT(slotPeaksFinished(bool)) );
+
     m_editor->setToolTip( i18n("Drag the edges of the highlighted area to define the portion of the "
                                "audio source you want to include in the Audio CD track. "
                                "You can also use the input windows to fine-tune your selection.") );
@@ -106,6 +111,17 @@ void K3b::AudioDataSourceEditWidget::loadSource( K3b::AudioDataSource* source )
 
     m_editStartOffset->setValue( startOffset() );
     m_editEndOffset->setValue( endOffset() );
+
+    // the waveform is added once it is available
+    m_editor->clearWaveforms();
+    m_peaksGenerator->start( source );
+}
+
+
+void K3b::AudioDataSourceEditWidget::slotPeaksFinished( bool success )
+{
+    if( success && m_source )
+        m_editor->addWaveform( 0, m_peaksGenerator->peaks(), 0, m_source->originalLength() );
 }
 
 
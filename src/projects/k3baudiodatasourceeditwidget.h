@@ -25,6 +25,9 @@ namespace K3b {
 namespace K3b {
     class AudioEditorWidget;
 }
+namespace K3b {
+    class AudioPeaksGenerator;
+}
 namespace K3b {
     class MsfEdit;
 }
@@ -64,6 +67,7 @@ namespace K3b {
         void slotRangeModified( int, const K3b::Msf&, const K3b::Msf& );
         void slotStartOffsetEdited( const K3b::Msf& );
         void slotEndOffsetEdited( const K3b::Msf& );
+        void slotPeaksFinished( bool success );
 
     private:
         AudioDataSource* m_source;
@@ -72,6 +76,7 @@ namespace K3b {
         AudioEditorWidget* m_editor;
         MsfEdit* m_editStartOffset;
         MsfEdit* m_editEndOffset;
+        AudioPeaksGenerator* m_peaksGenerator;
     };
 }
 
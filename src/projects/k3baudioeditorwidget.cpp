@@ -110,6 +110,15 @@ struct K3b::AudioEditorWidget::SortByStart
 };
 
 
+struct K3b::AudioEditorWidget::Waveform
+{
+    K3b::Msf pos;
+    K3b::AudioPeaks peaks;
+    K3b::Msf start;
+    K3b::Msf length;
+};
+
+
 class K3b::AudioEditorWidget::Private
 {
 public:
@@ -139,6 +148,7 @@ public:
 
     Range::List ranges;
     Marker::List markers;
+    QList<Waveform> waveforms;
 
     int maxMarkers;
     K3b::Msf length;
@@ -208,6 +218,26 @@ const K3b::Msf K3b::AudioEditorWidget::length() const
 }
 
 
+void K3b::AudioEditorWidget::addWaveform( const K3b::Msf& pos, const K3b::AudioPeaks& peaks,
+                                          const K3b::Msf& start, const K3b::Msf& length )
+{
+    Waveform w;
+    w.pos = pos;
+    w.peaks = peaks;
+    w.start = start;
+    w.length = length;
+    d->waveforms.append( w );
+    update();
+}
+
+
+void K3b::AudioEditorWidget::clearWaveforms()
+{
+    d->waveforms.clear();
+    update();
+}
+
+
 void K3b::AudioEditorWidget::setSelectedRangeBrush( const QBrush& b )
 {
     d->selectedRangeBrush = b;
@@ -491,6 +521,9 @@ void K3b::AudioEditorWidget::drawAll( QPainter* p, const QRect& drawRect )
     if( Range* selectedRange = getRange( d->selectedRangeId ) )
         drawRange( p, drawRect, *selectedRange );
 
+    for( QList<Waveform>::const_iterator it = d->waveforms.constBegin(); it != d->waveforms.constEnd(); ++it )
+        drawWaveform( p, drawRect, *it );
+
     for( Marker::List::const_iterator it = d->markers.constBegin(); it != d->markers.constEnd(); ++it )
         drawMarker( p, drawRect, *it );
 
@@ -561,6 +594,49 @@ void K3b::AudioEditorWidget::drawRange( QPainter* p, const QRect& drawRect, cons
 }
 
 
+void K3b::AudioEditorWidget::drawWaveform( QPainter* p, const QRect& drawRect, const Waveform& w )
+{
+    if( w.peaks.isEmpty() || d->length.lba() < 2 )
+        return;
+
+    p->save();
+
+    QColor color = palette().color( QPalette::Text );
+    color.setAlpha( 128 );
+    p->setPen( color );
+
+    // the same area the ranges use
+    const int top = drawRect.top() + 6;
+    const int center = top + ( drawRect.bottom() - top )/2;
+    const double scale = double( drawRect.bottom() - top ) / 2.0 / 32768.0;
+
+    // the inverse of posToMsf() in frames
+    const int width = contentsRect().width() - 2*d->margin;
+    const double framesPerPixel = double( d->length.lba()-1 ) * 588.0 / double( width );
+    const int x0 = frameWidth() + d->margin;
+
+    const qint64 offset = qint64( w.pos.lba() )*588;
+    const qint64 start = qint64( w.start.lba() )*588;
+    const qint64 frames = qint64( w.length.lba() )*588;
+
+    const int left = qMax( msfToPos( w.pos ), drawRect.left() );
+    const int right = qMin( msfToPos( w.pos + w.length - 1 ), drawRect.right() );
+    for( int x = left; x <= right; ++x ) {
+        // every column only looks up a few peaks, regardless of the zoom
+        const qint64 first = qMax<qint64>( qint64( double( x - x0 ) * framesPerPixel ) - offset, 0 );
+        const qint64 end = qMin<qint64>( qint64( double( x + 1 - x0 ) * framesPerPixel ) - offset, frames );
+        if( end <= first )
+            continue;
+
+        const K3b::AudioPeaks::Peak peak = w.peaks.peak( start + first, end - first );
+        p->drawLine( x, center - int( double( peak.max ) * scale ),
+                     x, center - int( double( peak.min ) * scale ) );
+    }
+
+    p->restore();
+}
+
+
 void K3b::AudioEditorWidget::drawMarker( QPainter* p, const QRect& drawRect, const K3b::AudioEditorWidget::Marker& m )
 {
     p->save();
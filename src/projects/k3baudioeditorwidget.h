@@ -17,6 +17,7 @@
 #define _K3B_AUDIO_EDITOR_WIDGET_H_
 
 #include "k3bmsf.h"
+#include "k3baudiopeaks.h"
 
 #include <QList>
 #include <QMouseEvent>
@@ -45,6 +46,15 @@ public:
 
     const K3b::Msf length() const;
 
+    /**
+     * Draws the part of \p peaks from \p start to \p start + \p length
+     * at position \p pos. Several waveforms can be added to show a track
+     * made of multiple sources.
+     */
+    void addWaveform( const K3b::Msf& pos, const K3b::AudioPeaks& peaks,
+                      const K3b::Msf& start, const K3b::Msf& length );
+    void clearWaveforms();
+
     /**
      * Add a user editable range.
      * @param startFixed if true the range's start cannot be changed by the user, only with modifyRange
@@ -181,6 +191,7 @@ protected:
 private:
     class Range;
     class Marker;
+    struct Waveform;
     struct SortByStart;
 
     class Private;
@@ -188,6 +199,7 @@ private:
 
     void drawAll( QPainter*, const QRect& );
     void drawRange( QPainter* p, const QRect&, const Range& r );
+    void drawWaveform( QPainter* p, const QRect&, const Waveform& w );
     void drawMarker( QPainter* p, const QRect&, const Marker& m );
 
     /**
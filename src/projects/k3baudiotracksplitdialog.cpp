@@ -15,6 +15,8 @@
 #include "k3baudiotracksplitdialog.h"
 #include "k3baudiotrack.h"
 #include "k3baudioeditorwidget.h"
+#include "k3baudiodatasource.h"
+#include "k3baudiopeaksgenerator.h"
 
 #include "k3bmsf.h"
 #include "k3bmsfedit.h"
@@ -75,6 +77,21 @@ K3b::AudioTrackSplitDialog::AudioTrackSplitDialog( K3b::AudioTrack* track, QWidg
     // load the track
     m_editorWidget->setLength( m_track->length() );
 
+    // show the waveforms of the sources as they become available
+    K3b::Msf pos;
+    for( K3b::AudioDataSource* source = m_track->firstSource(); source; source = source->next() ) {
+        K3b::AudioPeaksGenerator* generator = new K3b::AudioPeaksGenerator( this );
+        const K3b::Msf start = source->startOffset();
+        const K3b::Msf length = source->length();
+        connect( generator, &K3b::AudioPeaksGenerator::finished, this, [this, generator, pos, start, length]( bool success ) {
+            if( success )
+                m_editorWidget->addWaveform( pos, generator->peaks(), start, length );
+        } );
+        if( !generator->start( source ) )
+            delete generator;
+        pos += length;
+    }
+
     // default split
     K3b::Msf mid = m_track->length().lba() / 2;
     m_editorWidget->addRange( 0, mid-1 );
@@ -83,6 +83,8 @@ void K3b::DataAdvancedImageSettingsDialog::load( const K3b::IsoOptions& options
 
     // misc (FIXME: should not be here)
     m_checkDoNotCacheInodes->setChecked( options.doNotCacheInodes() );
+    m_checkShareIdenticalFiles->setChecked( options.shareIdenticalFiles() );
+    m_checkShareIdenticalFiles->setDisabled( options.doNotCacheInodes() );
     m_checkDoNotImportSession->setChecked( options.doNotImportSession() );
 }
 
@@ -118,6 +120,7 @@ void K3b::DataAdvancedImageSettingsDialog::save( K3b::IsoOptions& options )
     //  o.setFollowSymbolicLinks( m_checkFollowSymbolicLinks->isChecked() );
     options.setJolietLong( m_checkJolietLong->isChecked() );
     options.setDoNotCacheInodes( m_checkDoNotCacheInodes->isChecked() );
+    options.setShareIdenticalFiles( m_checkShareIdenticalFiles->isChecked() );
     options.setDoNotImportSession( m_checkDoNotImportSession->isChecked() );
 }
 
@@ -17,11 +17,13 @@
 #include "k3bdataprojectmodel.h"
 
 #include "k3bdatadoc.h"
+#include "k3bdatadocwatcher.h"
 #include "k3bdiritem.h"
 #include "k3bfileitem.h"
 #include "k3bisooptions.h"
 #include "k3bspecialdataitem.h"
 
+#include <KConfigWidgets/KColorScheme>
 #include <KCoreAddons/KUrlMimeData>
 #include <KLocalizedString>
 #include <KIconThemes/KIconEngine>
@@ -29,6 +31,7 @@
 #include <QDataStream>
 #include <QMimeData>
 #include <QFont>
+#include <QSet>
 
 
 class K3b::DataProjectModel::Private
@@ -48,6 +51,7 @@ public:
     void _k_itemsInserted( K3b::DirItem* parent, int start, int end );
     void _k_itemsRemoved( K3b::DirItem* parent, int start, int end );
     void _k_volumeIdChanged();
+    void _k_watchedItemsChanged( const QList<K3b::FileItem*>& items );
 
 private:
     DataProjectModel* q;
@@ -115,6 +119,22 @@ void K3b::DataProjectModel::Private::_k_volumeIdChanged()
 }
 
 
+void K3b::DataProjectModel::Private::_k_watchedItemsChanged( const QList<K3b::FileItem*>& items )
+{
+    // the sizes of the parent folders changed, too
+    QSet<K3b::DataItem*> changedItems;
+    Q_FOREACH( K3b::FileItem* item, items ) {
+        for( K3b::DataItem* i = item; i && !changedItems.contains( i ); i = i->parent() )
+            changedItems.insert( i );
+    }
+
+    Q_FOREACH( K3b::DataItem* item, changedItems ) {
+        const QModelIndex index = q->indexForItem( item );
+        emit q->dataChanged( index, index.sibling( index.row(), NumColumns-1 ) );
+    }
+}
+
+
 K3b::DataProjectModel::DataProjectModel( K3b::DataDoc* doc, QObject* parent )
     : QAbstractItemModel( parent ),
       d( new Private(this) )
@@ -131,6 +151,10 @@ K3b::DataProjectModel::DataProjectModel( K3b::DataDoc* doc, QObject* parent )
              this, SLOT(_k_itemsRemoved(K3b::DirItem*,int,int)), Qt::DirectConnection );
     connect( doc, SIGNAL(volumeIdChanged()),
              this, SLOT(_k_volumeIdChanged()), Qt::DirectConnection );
+    connect( doc->watcher(), SIGNAL(itemsChanged(QList<K3b::FileItem*>)),
+             this, SLOT(_k_watchedItemsChanged(QList<K3b::FileItem*>)) );
+    connect( doc->watcher(), SIGNAL(itemsMissingChanged(QList<K3b::FileItem*>)),
+             this, SLOT(_k_watchedItemsChanged(QList<K3b::FileItem*>)) );
 }
 
 
@@ -184,8 +208,16 @@ QVariant K3b::DataProjectModel::data( const QModelIndex& index, int role ) const
             else
                 return 0;
         }
+        else if ( role == Qt::ForegroundRole ) {
+            if ( item->isFile() && d->project->watcher()->isMissing( static_cast<FileItem*>( item ) ) )
+                return KColorScheme( QPalette::Active ).foreground( KColorScheme::NegativeText );
+            else
+                return QVariant();
+        }
         else if ( role == Qt::StatusTipRole ) {
-            if (item->isSymLink())
+            if ( item->isFile() && d->project->watcher()->isMissing( static_cast<FileItem*>( item ) ) )
+                return i18n( "The local file %1 has been deleted", static_cast<FileItem*>( item )->localPath() );
+            else if (item->isSymLink())
                 return i18nc( "Symlink target shown in status bar", "Link to %1", static_cast<FileItem*>( item )->linkDest() );
             else
                 return QVariant();
@@ -23,6 +23,7 @@ namespace K3b {
     class DataDoc;
     class DataItem;
     class DirItem;
+    class FileItem;
 
     class DataProjectModel : public QAbstractItemModel
     {
@@ -90,6 +91,7 @@ namespace K3b {
         Q_PRIVATE_SLOT( d, void _k_itemsInserted( K3b::DirItem* parent, int start, int end ) )
         Q_PRIVATE_SLOT( d, void _k_itemsRemoved( K3b::DirItem* parent, int start, int end ) )
         Q_PRIVATE_SLOT( d, void _k_volumeIdChanged() )
+        Q_PRIVATE_SLOT( d, void _k_watchedItemsChanged( const QList<K3b::FileItem*>& ) )
     };
 }
 
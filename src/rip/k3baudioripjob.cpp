@@ -38,7 +38,8 @@ public:
           neverSkip(false),
           paranoiaLib(0),
           device(0),
-          useIndex0(false) {
+          useIndex0(false),
+          useC2(false) {
     }
     int paranoiaMode;
     int paranoiaRetries;
@@ -50,6 +51,7 @@ public:
     Device::Device* device;
 
     bool useIndex0;
+    bool useC2;
 };
 
 
@@ -182,6 +184,12 @@ void AudioRipJob::setUseIndex0( bool b )
 }
 
 
+void AudioRipJob::setUseC2ErrorPointers( bool b )
+{
+    d->useC2 = b;
+}
+
+
 void AudioRipJob::setDevice( Device::Device* device )
 {
     d->device = device;
@@ -244,6 +252,11 @@ bool AudioRipJob::init()
     emit infoMessage( i18n("Reading CD table of contents."), Job::MessageInfo );
     d->toc = d->device->readToc();
 
+    d->paranoiaLib->setParanoiaMode( d->paranoiaMode );
+    d->paranoiaLib->setNeverSkip( d->neverSkip );
+    d->paranoiaLib->setMaxRetries( d->paranoiaRetries );
+    d->paranoiaLib->setUseC2ErrorPointers( d->useC2 );
+
     if( !d->paranoiaLib->initParanoia( d->device, d->toc ) ) {
         emit infoMessage( i18n("Could not open device %1",d->device->blockDeviceName()),
                           Job::MessageError );
@@ -252,11 +265,6 @@ bool AudioRipJob::init()
         return false;
     }
 
-    d->paranoiaLib->setParanoiaMode( d->paranoiaMode );
-    d->paranoiaLib->setNeverSkip( d->neverSkip );
-    d->paranoiaLib->setMaxRetries( d->paranoiaRetries );
-
-
     if( d->useIndex0 ) {
         emit newSubTask( i18n("Searching index 0 for all tracks") );
         d->device->indexScan( d->toc );
@@ -304,6 +312,14 @@ void AudioRipJob::trackStarted(int trackIndex)
 
 void AudioRipJob::trackFinished( int trackIndex, const QString& filename )
 {
+    const long reRead = d->paranoiaLib->reReadSectors( trackIndex );
+    if( reRead > 0 )
+        emit infoMessage( i18np("Track %2: %1 sector with C2 errors was read again.",
+                                "Track %2: %1 sectors with C2 errors were read again.",
+                                reRead, trackIndex ), Job::MessageInfo );
+    else if( reRead == 0 )
+        emit debuggingOutput( "K3b::AudioRipJob", QString( "Track %1: no C2 errors." ).arg( trackIndex ) );
+
     emit infoMessage( i18n("Successfully ripped track %1 to %2.", trackIndex, filename), Job::MessageInfo );
 }
 
@@ -40,6 +40,7 @@ namespace K3b {
         void setMaxRetries( int retries );
         void setNeverSkip( bool b );
         void setUseIndex0( bool b );
+        void setUseC2ErrorPointers( bool b );
 
         void setDevice( Device::Device* device );
 
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3baudiodecodertest.h"
+#include "k3baudiodecoder.h"
+
+#include <QByteArray>
+#include <QTest>
+#include <QVector>
+
+QTEST_GUILESS_MAIN(AudioDecoderTest)
+
+using K3b::AudioDecoder;
+
+namespace {
+    QVector<qint16> testSamples( int count )
+    {
+        QVector<qint16> samples( count );
+        for( int i = 0; i < count; ++i )
+            samples[i] = qint16( ( i*7919 ) ^ ( i << 3 ) );
+        samples[0] = 32767;
+        samples[1] = -32768;
+        return samples;
+    }
+
+    QByteArray bigEndian( const QVector<qint16>& samples )
+    {
+        QByteArray data( samples.count()*2, 0 );
+        for( int i = 0; i < samples.count(); ++i ) {
+            data[2*i]   = char( quint16( samples[i] ) >> 8 );
+            data[2*i+1] = char( quint16( samples[i] ) );
+        }
+        return data;
+    }
+}
+
+
+AudioDecoderTest::AudioDecoderTest()
+{
+}
+
+
+void AudioDecoderTest::testNative16Bit()
+{
+    const QVector<qint16> samples = testSamples( 1001 );
+    QByteArray out( samples.count()*2, 0 );
+    AudioDecoder::fromNative16BitTo16BitBeSigned( samples.constData(), out.data(), samples.count() );
+    QCOMPARE( out, bigEndian( samples ) );
+}
+
+
+void AudioDecoderTest::testNative16BitInPlace()
+{
+    const QVector<qint16> samples = testSamples( 1001 );
+    QVector<qint16> buffer = samples;
+    char* data = reinterpret_cast<char*>( buffer.data() );
+    AudioDecoder::fromNative16BitTo16BitBeSigned( buffer.constData(), data, buffer.count() );
+    QCOMPARE( QByteArray( data, buffer.count()*2 ), bigEndian( samples ) );
+}
+
+
+void AudioDecoderTest::testNative32Bit_data()
+{
+    QTest::addColumn<int>( "bitsPerSample" );
+
+    QTest::newRow( "8 bits" ) << 8;
+    QTest::newRow( "12 bits" ) << 12;
+    QTest::newRow( "16 bits" ) << 16;
+    QTest::newRow( "20 bits" ) << 20;
+    QTest::newRow( "24 bits" ) << 24;
+    QTest::newRow( "32 bits" ) << 32;
+}
+
+
+void AudioDecoderTest::testNative32Bit()
+{
+    QFETCH( int, bitsPerSample );
+
+    // the 16 bit samples with the additional bits filled with noise
+    const QVector<qint16> samples = testSamples( 999 );
+    QVector<qint16> expected( samples.count() );
+    QVector<qint32> wide( samples.count() );
+    for( int i = 0; i < samples.count(); ++i ) {
+        if( bitsPerSample >= 16 ) {
+            const int extra = bitsPerSample - 16;
+            wide[i] = ( qint32( samples[i] ) * ( 1 << extra ) ) | ( i & ( ( 1 << extra ) - 1 ) );
+            expected[i] = samples[i];
+        }
+        else {
+            wide[i] = samples[i] >> ( 16 - bitsPerSample );
+            expected[i] = qint16( quint16( wide[i] ) << ( 16 - bitsPerSample ) );
+        }
+    }
+
+    QByteArray out( samples.count()*2, 0 );
+    AudioDecoder::fromNative32BitTo16BitBeSigned( wide.constData(), out.data(), wide.count(), bitsPerSample );
+    QCOMPARE( out, bigEndian( expected ) );
+
+    // in place
+    char* data = reinterpret_cast<char*>( wide.data() );
+    AudioDecoder::fromNative32BitTo16BitBeSigned( wide.constData(), data, wide.count(), bitsPerSample );
+    QCOMPARE( QByteArray( data, wide.count()*2 ), bigEndian( expected ) );
+}
+
+
+void AudioDecoderTest::testPlanar32Bit()
+{
+    const QVector<qint16> samples = testSamples( 2*1000 );
+    QVector<qint32> left( 1000 ), right( 1000 );
+    for( int i = 0; i < 1000; ++i ) {
+        left[i] = samples[2*i];
+        right[i] = samples[2*i+1];
+    }
+    const qint32* planes[2] = { left.constData(), right.constData() };
+
+    QByteArray out( samples.count()*2, 0 );
+    AudioDecoder::fromPlanar32BitTo16BitBeSigned( planes, 2, 1000, 16, out.data() );
+    QCOMPARE( out, bigEndian( samples ) );
+
+    // 24 bit source
+    for( int i = 0; i < 1000; ++i ) {
+        left[i] = left[i] * 256 + 0x7f;
+        right[i] = right[i] * 256;
+    }
+    out.fill( 0 );
+    AudioDecoder::fromPlanar32BitTo16BitBeSigned( planes, 2, 1000, 24, out.data() );
+    QCOMPARE( out, bigEndian( samples ) );
+
+    // mono
+    QByteArray mono( 1000*2, 0 );
+    AudioDecoder::fromPlanar32BitTo16BitBeSigned( planes, 1, 1000, 24, mono.data() );
+    for( int i = 0; i < 1000; ++i ) {
+        QCOMPARE( mono[2*i], out[4*i] );
+        QCOMPARE( mono[2*i+1], out[4*i+1] );
+    }
+}
+
@@ -0,0 +1,31 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef K3B_AUDIO_DECODER_TEST_H
+#define K3B_AUDIO_DECODER_TEST_H
+
+#include <QObject>
+
+class AudioDecoderTest : public QObject
+{
+    Q_OBJECT
+public:
+    AudioDecoderTest();
+private slots:
+    void testNative16Bit();
+    void testNative16BitInPlace();
+    void testNative32Bit_data();
+    void testNative32Bit();
+    void testPlanar32Bit();
+};
+
+#endif // K3B_AUDIO_DECODER_TEST_H
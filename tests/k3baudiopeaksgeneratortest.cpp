@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3baudiopeaksgeneratortest.h"
+#include "k3baudiopeaksgenerator.h"
+#include "k3baudiopeaks.h"
+#include "k3brawaudiodatasource.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSignalSpy>
+#include <QStandardPaths>
+#include <QTest>
+
+QTEST_GUILESS_MAIN(AudioPeaksGeneratorTest)
+
+using K3b::AudioPeaksGenerator;
+
+namespace {
+    // 16 bit big endian stereo frames with a rising and falling edge
+    QByteArray rawFrames( int frames )
+    {
+        QByteArray data( frames*4, 0 );
+        for( int i = 0; i < frames; ++i ) {
+            const qint16 sample = qint16( ( i % 200 - 100 ) * 300 );
+            for( int ch = 0; ch < 2; ++ch ) {
+                data[4*i + 2*ch]     = char( quint16( sample ) >> 8 );
+                data[4*i + 2*ch + 1] = char( quint16( sample ) );
+            }
+        }
+        return data;
+    }
+
+    QStringList cachedPeaks()
+    {
+        return QDir( AudioPeaksGenerator::cacheDir() ).entryList( QStringList() << "*.peaks", QDir::Files );
+    }
+}
+
+
+AudioPeaksGeneratorTest::AudioPeaksGeneratorTest()
+{
+}
+
+
+void AudioPeaksGeneratorTest::initTestCase()
+{
+    QVERIFY( m_dir.isValid() );
+    QStandardPaths::setTestModeEnabled( true );
+}
+
+
+void AudioPeaksGeneratorTest::init()
+{
+    QDir( AudioPeaksGenerator::cacheDir() ).removeRecursively();
+}
+
+
+QString AudioPeaksGeneratorTest::writeRawFile( const QString& name, int frames )
+{
+    const QString path = m_dir.path() + '/' + name;
+    QFile f( path );
+    if( !f.open( QIODevice::WriteOnly ) )
+        return QString();
+    f.write( rawFrames( frames ) );
+    return path;
+}
+
+
+void AudioPeaksGeneratorTest::testRawFile()
+{
+    const int frames = 100*K3b::AudioPeaks::BlockFrames;
+    K3b::RawAudioDataSource source( writeRawFile( "raw", frames ) );
+
+    AudioPeaksGenerator generator;
+    QSignalSpy finishedSpy( &generator, SIGNAL(finished(bool)) );
+    QVERIFY( generator.start( &source ) );
+
+    QTRY_COMPARE( finishedSpy.count(), 1 );
+    QCOMPARE( finishedSpy.first().first().toBool(), true );
+    QVERIFY( !generator.isRunning() );
+    QCOMPARE( generator.peaks().frames(), qint64( frames ) );
+    QCOMPARE( generator.peaks().peak( 0, frames ).max, qint16( 99*300 ) );
+    QCOMPARE( cachedPeaks().count(), 1 );
+}
+
+
+void AudioPeaksGeneratorTest::testCacheHit()
+{
+    K3b::RawAudioDataSource source( writeRawFile( "cached", 100*K3b::AudioPeaks::BlockFrames ) );
+
+    AudioPeaksGenerator generator;
+    QSignalSpy finishedSpy( &generator, SIGNAL(finished(bool)) );
+    QVERIFY( generator.start( &source ) );
+    QTRY_COMPARE( finishedSpy.count(), 1 );
+
+    // replace the cached peaks with different ones
+    const QStringList cached = cachedPeaks();
+    QCOMPARE( cached.count(), 1 );
+    K3b::AudioPeaks other;
+    const QByteArray data = rawFrames( 7*K3b::AudioPeaks::BlockFrames );
+    other.append( data.constData(), data.size() );
+    other.finish();
+    QVERIFY( other.save( AudioPeaksGenerator::cacheDir() + '/' + cached.first() ) );
+
+    // the file is not read again
+    QVERIFY( generator.start( &source ) );
+    QTRY_COMPARE( finishedSpy.count(), 2 );
+    QCOMPARE( finishedSpy.last().first().toBool(), true );
+    QCOMPARE( generator.peaks().frames(), other.frames() );
+}
+
+
+void AudioPeaksGeneratorTest::testCancel()
+{
+    // large enough to take a while
+    K3b::RawAudioDataSource large( writeRawFile( "large", 8*1024*1024 ) );
+    K3b::RawAudioDataSource small( writeRawFile( "small", 10*K3b::AudioPeaks::BlockFrames ) );
+
+    AudioPeaksGenerator generator;
+    QSignalSpy finishedSpy( &generator, SIGNAL(finished(bool)) );
+    QVERIFY( generator.start( &large ) );
+
+    // canceling does not wait for the thread
+    QElapsedTimer timer;
+    timer.start();
+    generator.cancel();
+    QVERIFY( timer.elapsed() < 100 );
+    QVERIFY( !generator.isRunning() );
+
+    QTest::qWait( 200 );
+    QCOMPARE( finishedSpy.count(), 0 );
+
+    // a new run is not disturbed by the canceled one
+    QVERIFY( generator.start( &large ) );
+    QVERIFY( generator.start( &small ) );
+    QTRY_COMPARE( finishedSpy.count(), 1 );
+    QCOMPARE( finishedSpy.first().first().toBool(), true );
+    QCOMPARE( generator.peaks().frames(), qint64( 10*K3b::AudioPeaks::BlockFrames ) );
+
+    QTest::qWait( 200 );
+    QCOMPARE( finishedSpy.count(), 1 );
+
+    // canceled runs are not cached
+    QCOMPARE( cachedPeaks().count(), 1 );
+}
+
+
+void AudioPeaksGeneratorTest::testDeleteWhileRunning()
+{
+    K3b::RawAudioDataSource large( writeRawFile( "large", 8*1024*1024 ) );
+
+    AudioPeaksGenerator* generator = new AudioPeaksGenerator;
+    QVERIFY( generator->start( &large ) );
+
+    QElapsedTimer timer;
+    timer.start();
+    delete generator;
+    QVERIFY( timer.elapsed() < 100 );
+
+    // the thread finishes in the background without touching the generator
+    QTest::qWait( 500 );
+    QVERIFY( cachedPeaks().isEmpty() );
+}
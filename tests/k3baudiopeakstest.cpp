@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3baudiopeakstest.h"
+#include "k3baudiopeaks.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QVector>
+
+QTEST_GUILESS_MAIN(AudioPeaksTest)
+
+using K3b::AudioPeaks;
+
+namespace {
+
+// big endian stereo samples of a saw tooth with a growing amplitude
+QByteArray sawTooth(int frames, QVector<qint16>& samples)
+{
+    QByteArray data;
+    samples.clear();
+    for (int i = 0; i < frames*2; ++i) {
+        const qint16 s = qint16(((i*37) % 2001 - 1000) * (1 + i/4000));
+        samples.append(s);
+        data.append(char((s >> 8) & 0xff));
+        data.append(char(s & 0xff));
+    }
+    return data;
+}
+
+// the expected peak of the blocks touched by [first, first+count)
+AudioPeaks::Peak bruteForce(const QVector<qint16>& samples, qint64 first, qint64 count)
+{
+    const qint64 frames = samples.count()/2;
+    const qint64 start = first / AudioPeaks::BlockFrames * AudioPeaks::BlockFrames;
+    const qint64 end = qMin(((first + count - 1) / AudioPeaks::BlockFrames + 1) * AudioPeaks::BlockFrames, frames);
+    AudioPeaks::Peak p;
+    p.min = 32767;
+    p.max = -32768;
+    for (qint64 i = start*2; i < end*2; ++i) {
+        p.min = qMin(p.min, samples[i]);
+        p.max = qMax(p.max, samples[i]);
+    }
+    return p;
+}
+
+} // namespace
+
+AudioPeaksTest::AudioPeaksTest()
+{
+}
+
+void AudioPeaksTest::testEmpty()
+{
+    AudioPeaks peaks;
+    peaks.finish();
+    QVERIFY(peaks.isEmpty());
+    QCOMPARE(peaks.frames(), qint64(0));
+
+    const AudioPeaks::Peak p = peaks.peak(0, 1000);
+    QCOMPARE(p.min, qint16(0));
+    QCOMPARE(p.max, qint16(0));
+}
+
+void AudioPeaksTest::testLevels()
+{
+    QVector<qint16> samples;
+    const QByteArray data = sawTooth(AudioPeaks::BlockFrames*5 + 10, samples);
+
+    AudioPeaks peaks;
+    peaks.append(data.constData(), data.size());
+    peaks.finish();
+
+    // 6 blocks: 6, 3, 2, 1
+    QCOMPARE(peaks.frames(), qint64(AudioPeaks::BlockFrames*5 + 10));
+    QCOMPARE(peaks.levels(), 4);
+}
+
+void AudioPeaksTest::testPeak()
+{
+    QVector<qint16> samples;
+    const int frames = 44100*3 + 17;
+    const QByteArray data = sawTooth(frames, samples);
+
+    AudioPeaks peaks;
+    peaks.append(data.constData(), data.size());
+    peaks.finish();
+
+    const AudioPeaks::Peak all = peaks.peak(0, frames);
+    const AudioPeaks::Peak expected = bruteForce(samples, 0, frames);
+    QCOMPARE(all.min, expected.min);
+    QCOMPARE(all.max, expected.max);
+
+    quint32 x = 2463534242u;
+    for (int i = 0; i < 500; ++i) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        const qint64 first = x % frames;
+        const qint64 count = 1 + (x >> 8) % (frames - first);
+        const AudioPeaks::Peak p = peaks.peak(first, count);
+        const AudioPeaks::Peak e = bruteForce(samples, first, count);
+        QCOMPARE(p.min, e.min);
+        QCOMPARE(p.max, e.max);
+    }
+}
+
+void AudioPeaksTest::testUnalignedAppend()
+{
+    QVector<qint16> samples;
+    const QByteArray data = sawTooth(10000, samples);
+
+    AudioPeaks whole;
+    whole.append(data.constData(), data.size());
+    whole.finish();
+
+    // odd chunk sizes split samples and blocks
+    AudioPeaks chunked;
+    for (int pos = 0, len = 1; pos < data.size(); pos += len, len = 1 + (len*7 + 3) % 1001)
+        chunked.append(data.constData() + pos, qMin(len, data.size() - pos));
+    chunked.finish();
+
+    QCOMPARE(chunked.frames(), whole.frames());
+    for (qint64 first = 0; first < whole.frames(); first += 333) {
+        QCOMPARE(chunked.peak(first, 500).min, whole.peak(first, 500).min);
+        QCOMPARE(chunked.peak(first, 500).max, whole.peak(first, 500).max);
+    }
+}
+
+void AudioPeaksTest::testSaveLoad()
+{
+    QVector<qint16> samples;
+    const QByteArray data = sawTooth(20000, samples);
+
+    AudioPeaks peaks;
+    peaks.append(data.constData(), data.size());
+    peaks.finish();
+
+    QTemporaryDir dir;
+    const QString filename = dir.path() + "/test.peaks";
+    QVERIFY(peaks.save(filename));
+
+    AudioPeaks loaded;
+    QVERIFY(loaded.load(filename));
+    QCOMPARE(loaded.frames(), peaks.frames());
+    QCOMPARE(loaded.levels(), peaks.levels());
+    for (qint64 first = 0; first < peaks.frames(); first += 777) {
+        QCOMPARE(loaded.peak(first, 1000).min, peaks.peak(first, 1000).min);
+        QCOMPARE(loaded.peak(first, 1000).max, peaks.peak(first, 1000).max);
+    }
+
+    QFile f(filename);
+    QVERIFY(f.open(QIODevice::ReadWrite));
+    f.write("garbage");
+    f.close();
+    QVERIFY(!loaded.load(filename));
+    QVERIFY(loaded.isEmpty());
+}
@@ -0,0 +1,899 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+//
+// k3bbench runs the hot paths of libk3b on generated data without any
+// hardware. The fixtures are derived from fixed seeds and sizes so the
+// results of two builds on the same machine can be compared:
+//
+//   k3bbench --json --label "$(git describe)" --output baseline.jsonl
+//   ... rebuild ...
+//   k3bbench --compare baseline.jsonl
+//
+// The exit code is 1 if a benchmark failed or regressed by more than the
+// threshold compared to the baseline.
+//
+// The decode benchmarks run the wave, libsndfile (AIFF), and FLAC decoder
+// plugins built along with k3bbench on generated files of the same audio.
+//
+// The datadoc/memory benchmark also reports the heap memory used per item
+// of a generated data project (glibc only).
+//
+
+#include "k3bbenchfixtures.h"
+
+#include "k3baudiodecoder.h"
+#include "k3baudiodoc.h"
+#include "k3baudiodocreader.h"
+#include "k3baudiofile.h"
+#include "k3baudiotrack.h"
+#include "k3baudiozerodata.h"
+#include "k3bcdtext.h"
+#include "k3bchecksumpipe.h"
+#include "k3bcore.h"
+#include "k3bdatadoc.h"
+#include "k3bdataitem.h"
+#include "k3bdataitemiterator.h"
+#include "k3bdiritem.h"
+#include "k3bfileitem.h"
+#include "k3bglobals.h"
+#include "k3biso9660.h"
+#include "k3biso9660backend.h"
+#include "k3bmd5job.h"
+#include "k3bmpeginfo.h"
+#include "k3bsimplejobhandler.h"
+#include "k3bversion.h"
+
+#include <KCoreAddons/KPluginFactory>
+#include <KCoreAddons/KPluginLoader>
+
+#include <QBuffer>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLibrary>
+#include <QList>
+#include <QLoggingCategory>
+#include <QRegExp>
+#include <QSharedPointer>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QUrl>
+#include <QVector>
+
+#include <algorithm>
+#include <functional>
+
+#include <string.h>
+#include <sys/stat.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+
+namespace {
+    // fixture sizes, changing them invalidates all baselines
+    const int s_waveSeconds = 60;
+    const int s_checksumSize = 32*1024*1024;
+    const int s_isoDirs = 100;
+    const int s_isoFilesPerDir = 200;
+    const int s_dataDirs = 50;
+    const int s_dataFilesPerDir = 200;
+    const int s_memoryDirs = 100;
+    const int s_memoryFilesPerDir = 1000;
+    const int s_mpegSize = 16*1024*1024;
+    const int s_cdTextTracks = 99;
+    const int s_audioTracks = 10;
+
+    struct Benchmark {
+        enum Unit {
+            Bytes,
+            Items
+        };
+
+        QString name;
+        Unit unit;
+
+        /**
+         * Optional. Called once before the warm-up, not timed.
+         */
+        std::function<bool()> prepare;
+
+        /**
+         * One timed run. Returns the number of bytes or items processed
+         * or -1 on error.
+         */
+        std::function<qint64()> run;
+
+        /**
+         * Optional. Called after the timed runs. Returns the heap memory
+         * used per item by the last run or -1 if unknown.
+         */
+        std::function<qint64()> bytesPerItem;
+    };
+
+    struct Result {
+        QString name;
+        Benchmark::Unit unit;
+        bool success;
+        qint64 amount;
+        qint64 bytesPerItem;
+        QVector<qint64> nsecs;    // sorted
+
+        qint64 median() const {
+            if( nsecs.isEmpty() )
+                return 0;
+            const int n = nsecs.count();
+            return( n % 2 ? nsecs[n/2] : ( nsecs[n/2-1] + nsecs[n/2] )/2 );
+        }
+
+        // the median absolute deviation
+        qint64 deviation() const {
+            const qint64 m = median();
+            QVector<qint64> d;
+            Q_FOREACH( qint64 t, nsecs )
+                d.append( qAbs( t - m ) );
+            std::sort( d.begin(), d.end() );
+            if( d.isEmpty() )
+                return 0;
+            const int n = d.count();
+            return( n % 2 ? d[n/2] : ( d[n/2-1] + d[n/2] )/2 );
+        }
+
+        double throughput() const {
+            const qint64 m = median();
+            return( m > 0 ? double( amount )*1.0e9/double( m ) : 0.0 );
+        }
+    };
+
+
+    /**
+     * Serves sectors from memory like an image file.
+     */
+    class BufferBackend : public K3b::Iso9660Backend
+    {
+    public:
+        explicit BufferBackend( const QByteArray& data )
+            : m_data( data ),
+              m_isOpen( false ) {
+        }
+
+        bool open() { m_isOpen = true; return true; }
+        void close() { m_isOpen = false; }
+        bool isOpen() const { return m_isOpen; }
+
+        int read( unsigned int sector, char* buffer, int len ) {
+            const int sectors = m_data.size()/2048;
+            if( (int)sector >= sectors )
+                return 0;
+            len = qMin( len, sectors - (int)sector );
+            ::memcpy( buffer, m_data.constData() + sector*2048, len*2048 );
+            return len;
+        }
+
+    private:
+        QByteArray m_data;
+        bool m_isOpen;
+    };
+
+
+    /**
+     * Swallows everything written to it.
+     */
+    class NullDevice : public QIODevice
+    {
+    public:
+        qint64 readData( char*, qint64 ) { return -1; }
+        qint64 writeData( const char*, qint64 len ) { return len; }
+    };
+
+
+    struct DecoderPlugin {
+        QString name;
+        K3b::AudioDecoderFactory* factory;
+    };
+
+
+    /**
+     * The shared state of all benchmarks. Everything is created below
+     * the temporary directory which is removed on exit.
+     */
+    class Context
+    {
+    public:
+        QTemporaryDir tempDir;
+        QObject owner;
+        QList<DecoderPlugin> decoders;
+        QStringList audioFiles;
+
+        QString path( const QString& name ) const {
+            return tempDir.path() + QLatin1Char( '/' ) + name;
+        }
+
+        void loadDecoderPlugins( const QStringList& dirs );
+    };
+
+
+    void Context::loadDecoderPlugins( const QStringList& dirs )
+    {
+        QStringList loaded;
+        Q_FOREACH( const QString& dir, dirs ) {
+            Q_FOREACH( const QFileInfo& info, QDir( dir ).entryInfoList( QStringList() << QLatin1String( "k3b*decoder*" ), QDir::Files ) ) {
+                const QString name = info.completeBaseName();
+                if( !QLibrary::isLibrary( info.fileName() ) || loaded.contains( name ) )
+                    continue;
+
+                KPluginLoader loader( info.absoluteFilePath() );
+                KPluginFactory* pluginFactory = loader.factory();
+                if( !pluginFactory ) {
+                    qWarning() << "Could not load" << info.absoluteFilePath() << loader.errorString();
+                    continue;
+                }
+
+                if( K3b::AudioDecoderFactory* factory = pluginFactory->create<K3b::AudioDecoderFactory>( &owner ) ) {
+                    DecoderPlugin plugin;
+                    plugin.name = name;
+                    plugin.factory = factory;
+                    decoders.append( plugin );
+                    loaded.append( name );
+                }
+            }
+        }
+    }
+
+
+    K3b::AudioDecoder* createDecoder( const DecoderPlugin& plugin, const QString& filename, QObject* parent )
+    {
+        K3b::AudioDecoder* decoder = plugin.factory->createDecoder( parent );
+        decoder->setFilename( filename );
+        if( !decoder->analyseFile() ) {
+            delete decoder;
+            return 0;
+        }
+        return decoder;
+    }
+
+
+    qint64 readAll( QIODevice& dev )
+    {
+        static char buffer[64*1024];
+        qint64 total = 0;
+        qint64 read = 0;
+        while( !dev.atEnd() && ( read = dev.read( buffer, sizeof(buffer) ) ) > 0 )
+            total += read;
+        return( read < 0 ? -1 : total );
+    }
+
+
+    void addDecoderBenchmarks( Context& ctx, QList<Benchmark>& benchmarks )
+    {
+        Q_FOREACH( const DecoderPlugin& plugin, ctx.decoders ) {
+            Q_FOREACH( const QString& file, ctx.audioFiles ) {
+                if( !plugin.factory->canDecode( QUrl::fromLocalFile( file ) ) )
+                    continue;
+
+                QSharedPointer<K3b::AudioDecoder*> decoder( new K3b::AudioDecoder*( 0 ) );
+                Benchmark b;
+                b.name = QString::fromLatin1( "decode/%1/%2" ).arg( plugin.name ).arg( QFileInfo( file ).fileName() );
+                b.unit = Benchmark::Bytes;
+                b.prepare = [&ctx, plugin, file, decoder]() {
+                    *decoder = createDecoder( plugin, file, &ctx.owner );
+                    return *decoder != 0;
+                };
+                b.run = [decoder]() -> qint64 {
+                    static char buffer[10*2352];
+                    K3b::AudioDecoder* dec = *decoder;
+                    if( !dec->initDecoder() )
+                        return -1;
+                    qint64 total = 0;
+                    int read = 0;
+                    while( ( read = dec->decode( buffer, sizeof(buffer) ) ) > 0 )
+                        total += read;
+                    return( read < 0 ? -1 : total );
+                };
+                benchmarks.append( b );
+            }
+        }
+    }
+
+
+    void addAudioDocBenchmarks( Context& ctx, QList<Benchmark>& benchmarks )
+    {
+        K3b::AudioDoc* zeroDoc = new K3b::AudioDoc( &ctx.owner );
+        Benchmark zero;
+        zero.name = QLatin1String( "audiodocreader/zero" );
+        zero.unit = Benchmark::Bytes;
+        zero.prepare = [zeroDoc]() {
+            zeroDoc->newDocument();
+            for( int i = 0; i < s_audioTracks; ++i ) {
+                K3b::AudioTrack* track = new K3b::AudioTrack( zeroDoc );
+                track->setFirstSource( new K3b::AudioZeroData( K3b::Msf( 0, s_waveSeconds, 0 ) ) );
+                zeroDoc->addTrack( track, zeroDoc->numOfTracks() );
+            }
+            return true;
+        };
+        zero.run = [zeroDoc]() -> qint64 {
+            K3b::AudioDocReader reader( *zeroDoc );
+            if( !reader.open() )
+                return -1;
+            return readAll( reader );
+        };
+        benchmarks.append( zero );
+
+        // decoding the tracks through the wave decoder, if it is available
+        Q_FOREACH( const DecoderPlugin& plugin, ctx.decoders ) {
+            if( plugin.name != QLatin1String( "k3bwavedecoder" ) || ctx.audioFiles.isEmpty() )
+                continue;
+
+            const QString file = ctx.audioFiles.first();
+            K3b::AudioDoc* doc = new K3b::AudioDoc( &ctx.owner );
+            Benchmark wave;
+            wave.name = QLatin1String( "audiodocreader/wave" );
+            wave.unit = Benchmark::Bytes;
+            wave.prepare = [plugin, file, doc]() {
+                doc->newDocument();
+                // the document deletes the decoder once the last track is gone
+                K3b::AudioDecoder* decoder = createDecoder( plugin, file, 0 );
+                if( !decoder )
+                    return false;
+                for( int i = 0; i < s_audioTracks; ++i ) {
+                    K3b::AudioTrack* track = new K3b::AudioTrack( doc );
+                    track->setFirstSource( new K3b::AudioFile( decoder, doc ) );
+                    doc->addTrack( track, doc->numOfTracks() );
+                }
+                return true;
+            };
+            wave.run = [doc]() -> qint64 {
+                K3b::AudioDocReader reader( *doc );
+                if( !reader.open() )
+                    return -1;
+                return readAll( reader );
+            };
+            benchmarks.append( wave );
+        }
+    }
+
+
+    void addChecksumBenchmarks( Context& ctx, QList<Benchmark>& benchmarks )
+    {
+        QSharedPointer<QByteArray> data( new QByteArray );
+        const QString file = ctx.path( QLatin1String( "checksum.bin" ) );
+
+        Benchmark pipe;
+        pipe.name = QLatin1String( "checksumpipe/md5" );
+        pipe.unit = Benchmark::Bytes;
+        pipe.prepare = [data]() {
+            *data = BenchFixtures::randomData( s_checksumSize, 0x1b336233 );
+            return true;
+        };
+        pipe.run = [data]() -> qint64 {
+            QBuffer in( data.data() );
+            NullDevice out;
+            K3b::ChecksumPipe checksumPipe;
+            checksumPipe.readFrom( &in );
+            checksumPipe.writeTo( &out );
+            if( !checksumPipe.open() )
+                return -1;
+            // waits for the piping thread to finish
+            checksumPipe.close();
+            return( checksumPipe.checksum().isEmpty() ? -1 : in.pos() );
+        };
+        benchmarks.append( pipe );
+
+        Benchmark job;
+        job.name = QLatin1String( "md5job/file" );
+        job.unit = Benchmark::Bytes;
+        job.prepare = [file]() {
+            QFile f( file );
+            const QByteArray data = BenchFixtures::randomData( s_checksumSize, 0x2b336233 );
+            return( f.open( QIODevice::WriteOnly ) && f.write( data ) == data.size() );
+        };
+        job.run = [file]() -> qint64 {
+            K3b::SimpleJobHandler handler;
+            K3b::Md5Job md5Job( &handler );
+            bool success = false;
+            QObject::connect( &md5Job, &K3b::Job::finished, &md5Job, [&success]( bool s ) { success = s; } );
+            md5Job.setFile( file );
+            md5Job.start();
+            md5Job.wait();
+            return( success && !md5Job.hexDigest().isEmpty() ? s_checksumSize : -1 );
+        };
+        benchmarks.append( job );
+    }
+
+
+    int visit( const K3b::Iso9660Directory* dir )
+    {
+        int items = 0;
+        Q_FOREACH( const QString& name, dir->entries() ) {
+            if( name == QLatin1String( "." ) || name == QLatin1String( ".." ) )
+                continue;
+            const K3b::Iso9660Entry* entry = dir->entry( name );
+            ++items;
+            if( entry->isDirectory() )
+                items += visit( static_cast<const K3b::Iso9660Directory*>( entry ) );
+        }
+        return items;
+    }
+
+
+    void addIso9660Benchmarks( Context&, QList<Benchmark>& benchmarks )
+    {
+        QSharedPointer<QByteArray> image( new QByteArray );
+
+        Benchmark b;
+        b.name = QLatin1String( "iso9660/parse" );
+        b.unit = Benchmark::Items;
+        b.prepare = [image]() {
+            *image = BenchFixtures::isoImage( s_isoDirs, s_isoFilesPerDir );
+            return true;
+        };
+        b.run = [image]() -> qint64 {
+            K3b::Iso9660 iso( new BufferBackend( *image ) );
+            if( !iso.open() || !iso.firstIsoDirEntry() )
+                return -1;
+            const int items = visit( iso.firstIsoDirEntry() );
+            return( items == s_isoDirs*( s_isoFilesPerDir + 1 ) ? items : -1 );
+        };
+        benchmarks.append( b );
+    }
+
+
+    void addDataDocBenchmarks( Context& ctx, QList<Benchmark>& benchmarks )
+    {
+        const QString tree = ctx.path( QLatin1String( "datatree" ) );
+        const int items = s_dataDirs*( s_dataFilesPerDir + 1 ) + 1;
+
+        Benchmark add;
+        add.name = QLatin1String( "datadoc/add" );
+        add.unit = Benchmark::Items;
+        add.prepare = [tree]() {
+            return BenchFixtures::createDataTree( tree, s_dataDirs, s_dataFilesPerDir );
+        };
+        add.run = [tree, items]() -> qint64 {
+            K3b::DataDoc doc;
+            doc.newDocument();
+            doc.addUrls( QList<QUrl>() << QUrl::fromLocalFile( tree ) );
+            return( doc.root()->numFiles() + doc.root()->numDirs() == items ? items : -1 );
+        };
+        benchmarks.append( add );
+
+        K3b::DataDoc* doc = new K3b::DataDoc( &ctx.owner );
+        Benchmark iterate;
+        iterate.name = QLatin1String( "datadoc/iterate" );
+        iterate.unit = Benchmark::Items;
+        iterate.prepare = [tree, doc]() {
+            if( !QFileInfo( tree ).isDir() && !BenchFixtures::createDataTree( tree, s_dataDirs, s_dataFilesPerDir ) )
+                return false;
+            doc->newDocument();
+            doc->addUrls( QList<QUrl>() << QUrl::fromLocalFile( tree ) );
+            return true;
+        };
+        iterate.run = [doc, items]() -> qint64 {
+            int count = 0;
+            KIO::filesize_t size = 0;
+            for( K3b::DataItemIterator it( doc->root(), false ); *it; ++it ) {
+                if( !( *it )->isDir() )
+                    size += ( *it )->size();
+                ++count;
+            }
+            return( count == items && size > 0 && doc->size() >= size ? count : -1 );
+        };
+        benchmarks.append( iterate );
+    }
+
+
+    /**
+     * \return The bytes currently allocated on the heap or -1 if unknown.
+     */
+    qint64 heapUsage()
+    {
+#ifdef __GLIBC__
+#if __GLIBC_PREREQ(2, 33)
+        const struct mallinfo2 info = ::mallinfo2();
+#else
+        // wraps around above 2 GB
+        const struct mallinfo info = ::mallinfo();
+#endif
+        return qint64( info.uordblks ) + qint64( info.hblkhd );
+#else
+        return -1;
+#endif
+    }
+
+
+    void addDataItemMemoryBenchmarks( Context& ctx, QList<Benchmark>& benchmarks )
+    {
+        // only the folders exist, the files are created from a fake stat
+        const QString tree = ctx.path( QLatin1String( "memorytree" ) );
+        const int items = s_memoryDirs*( s_memoryFilesPerDir + 1 );
+        QSharedPointer<qint64> bytesPerItem( new qint64( -1 ) );
+
+        Benchmark b;
+        b.name = QLatin1String( "datadoc/memory" );
+        b.unit = Benchmark::Items;
+        b.prepare = [tree]() {
+            return BenchFixtures::createDataTree( tree, s_memoryDirs, 0 );
+        };
+        b.run = [tree, items, bytesPerItem]() -> qint64 {
+            k3b_struct_stat st;
+            ::memset( &st, 0, sizeof(st) );
+            st.st_mode = S_IFREG|0644;
+            st.st_size = 4096;
+
+            const qint64 before = heapUsage();
+            K3b::DataDoc* doc = new K3b::DataDoc;
+            doc->newDocument();
+            for( int i = 0; i < s_memoryDirs; ++i ) {
+                const QString dirName = QString::fromLatin1( "dir%1" ).arg( i, 4, 10, QLatin1Char( '0' ) );
+                const QString dirPath = tree + QLatin1Char( '/' ) + dirName + QLatin1Char( '/' );
+                K3b::DirItem* dir = new K3b::DirItem( dirName );
+                K3b::DirItem::Children files;
+                for( int j = 0; j < s_memoryFilesPerDir; ++j ) {
+                    st.st_ino = i*s_memoryFilesPerDir + j + 1;
+                    const QString name = QString::fromLatin1( "file %1.dat" ).arg( j, 5, 10, QLatin1Char( '0' ) );
+                    files.append( new K3b::FileItem( &st, &st, dirPath + name, *doc ) );
+                }
+                dir->addDataItems( files );
+                doc->root()->addDataItem( dir );
+            }
+            const qint64 after = heapUsage();
+
+            const int count = doc->root()->numFiles() + doc->root()->numDirs();
+            *bytesPerItem = ( before >= 0 && after >= before ? ( after - before )/items : -1 );
+            delete doc;
+            return( count == items ? count : -1 );
+        };
+        b.bytesPerItem = [bytesPerItem]() {
+            return *bytesPerItem;
+        };
+        benchmarks.append( b );
+    }
+
+
+    void addMpegInfoBenchmarks( Context& ctx, QList<Benchmark>& benchmarks )
+    {
+        const QString file = ctx.path( QLatin1String( "stream.mpg" ) );
+
+        Benchmark b;
+        b.name = QLatin1String( "mpeginfo/scan" );
+        b.unit = Benchmark::Bytes;
+        b.prepare = [file]() {
+            return BenchFixtures::writeMpegFile( file, s_mpegSize );
+        };
+        b.run = [file]() -> qint64 {
+            K3b::MpegInfo info( QFile::encodeName( file ).constData() );
+            if( info.version() != K3b::MpegInfo::MPEG_VERS_MPEG1 ||
+                !info.mpeg_info->has_video ||
+                !info.mpeg_info->has_audio )
+                return -1;
+            return QFileInfo( file ).size();
+        };
+        benchmarks.append( b );
+    }
+
+
+    void addCdTextBenchmarks( Context&, QList<Benchmark>& benchmarks )
+    {
+        QSharedPointer<K3b::Device::CdText> text( new K3b::Device::CdText );
+        QSharedPointer<QByteArray> raw( new QByteArray );
+
+        Benchmark encode;
+        encode.name = QLatin1String( "cdtext/encode" );
+        encode.unit = Benchmark::Items;
+        encode.prepare = [text]() {
+            *text = BenchFixtures::cdText( s_cdTextTracks );
+            return true;
+        };
+        encode.run = [text]() -> qint64 {
+            // changing the copy drops the cached pack data
+            const int rounds = 100;
+            for( int i = 0; i < rounds; ++i ) {
+                K3b::Device::CdText copy( *text );
+                copy.setMessage( QString::number( i ) );
+                if( copy.rawPackData().isEmpty() )
+                    return -1;
+            }
+            return rounds;
+        };
+        benchmarks.append( encode );
+
+        Benchmark decode;
+        decode.name = QLatin1String( "cdtext/decode" );
+        decode.unit = Benchmark::Items;
+        decode.prepare = [raw]() {
+            *raw = BenchFixtures::cdText( s_cdTextTracks ).rawPackData();
+            return !raw->isEmpty();
+        };
+        decode.run = [raw]() -> qint64 {
+            const int rounds = 100;
+            for( int i = 0; i < rounds; ++i ) {
+                K3b::Device::CdText text( *raw );
+                if( text.count() != s_cdTextTracks )
+                    return -1;
+            }
+            return rounds;
+        };
+        benchmarks.append( decode );
+    }
+
+
+    Result runBenchmark( const Benchmark& b, int warmup, int runs )
+    {
+        Result r;
+        r.name = b.name;
+        r.unit = b.unit;
+        r.success = false;
+        r.amount = 0;
+        r.bytesPerItem = -1;
+
+        if( b.prepare && !b.prepare() )
+            return r;
+
+        for( int i = 0; i < warmup; ++i ) {
+            if( b.run() < 0 )
+                return r;
+        }
+
+        QElapsedTimer timer;
+        for( int i = 0; i < runs; ++i ) {
+            timer.start();
+            const qint64 amount = b.run();
+            const qint64 nsecs = timer.nsecsElapsed();
+            if( amount < 0 )
+                return r;
+            r.amount = amount;
+            r.nsecs.append( nsecs );
+        }
+
+        std::sort( r.nsecs.begin(), r.nsecs.end() );
+        if( b.bytesPerItem )
+            r.bytesPerItem = b.bytesPerItem();
+        r.success = true;
+        return r;
+    }
+
+
+    QByteArray toJsonLine( const Result& r )
+    {
+        QJsonObject o;
+        o.insert( QLatin1String( "kind" ), QLatin1String( "result" ) );
+        o.insert( QLatin1String( "name" ), r.name );
+        o.insert( QLatin1String( "success" ), r.success );
+        if( r.success ) {
+            o.insert( QLatin1String( "unit" ), QLatin1String( r.unit == Benchmark::Bytes ? "bytes" : "items" ) );
+            o.insert( QLatin1String( "amount" ), double( r.amount ) );
+            o.insert( QLatin1String( "runs" ), r.nsecs.count() );
+            o.insert( QLatin1String( "median" ), double( r.median() ) );
+            o.insert( QLatin1String( "deviation" ), double( r.deviation() ) );
+            o.insert( QLatin1String( "min" ), double( r.nsecs.first() ) );
+            o.insert( QLatin1String( "max" ), double( r.nsecs.last() ) );
+            o.insert( QLatin1String( "throughput" ), r.throughput() );
+            if( r.bytesPerItem >= 0 )
+                o.insert( QLatin1String( "bytes_per_item" ), double( r.bytesPerItem ) );
+        }
+        return QJsonDocument( o ).toJson( QJsonDocument::Compact );
+    }
+
+
+    QString toText( const Result& r )
+    {
+        if( !r.success )
+            return QString::fromLatin1( "%1 FAILED" ).arg( r.name, -32 );
+
+        const QString throughput = ( r.unit == Benchmark::Bytes
+                                     ? QString::fromLatin1( "%1 MB/s" ).arg( r.throughput()/1024.0/1024.0, 0, 'f', 1 )
+                                     : QString::fromLatin1( "%1 items/s" ).arg( r.throughput(), 0, 'f', 0 ) );
+        const QString memory = ( r.bytesPerItem >= 0
+                                 ? QString::fromLatin1( ", %1 bytes/item" ).arg( r.bytesPerItem )
+                                 : QString() );
+        return QString::fromLatin1( "%1 %2 ms +- %3 ms (min %4 ms, max %5 ms) %6%7" )
+            .arg( r.name, -32 )
+            .arg( r.median()/1.0e6, 9, 'f', 2 )
+            .arg( r.deviation()/1.0e6, 0, 'f', 2 )
+            .arg( r.nsecs.first()/1.0e6, 0, 'f', 2 )
+            .arg( r.nsecs.last()/1.0e6, 0, 'f', 2 )
+            .arg( throughput )
+            .arg( memory );
+    }
+
+
+    /**
+     * \return The medians of the successful results in a file written with --json.
+     */
+    QHash<QString, qint64> loadBaseline( const QString& filename, bool* ok )
+    {
+        QHash<QString, qint64> medians;
+        QFile f( filename );
+        *ok = f.open( QIODevice::ReadOnly );
+        if( !*ok )
+            return medians;
+
+        Q_FOREACH( const QByteArray& line, f.readAll().split( '\n' ) ) {
+            const QJsonObject o = QJsonDocument::fromJson( line ).object();
+            if( o.value( QLatin1String( "kind" ) ).toString() == QLatin1String( "result" ) &&
+                o.value( QLatin1String( "success" ) ).toBool() )
+                medians.insert( o.value( QLatin1String( "name" ) ).toString(),
+                                qint64( o.value( QLatin1String( "median" ) ).toDouble() ) );
+        }
+        return medians;
+    }
+}
+
+
+int main( int argc, char* argv[] )
+{
+    QCoreApplication app( argc, argv );
+    app.setApplicationName( QLatin1String( "k3bbench" ) );
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription( QLatin1String( "Benchmarks the hot paths of libk3b on generated data." ) );
+    parser.addHelpOption();
+    QCommandLineOption listOption( QLatin1String( "list" ), QLatin1String( "List the benchmarks and exit." ) );
+    QCommandLineOption filterOption( QLatin1String( "filter" ), QLatin1String( "Only run the benchmarks matching <regexp>." ), QLatin1String( "regexp" ) );
+    QCommandLineOption runsOption( QLatin1String( "runs" ), QLatin1String( "The number of timed runs (default 5)." ), QLatin1String( "n" ), QLatin1String( "5" ) );
+    QCommandLineOption warmupOption( QLatin1String( "warmup" ), QLatin1String( "The number of untimed runs before (default 1)." ), QLatin1String( "n" ), QLatin1String( "1" ) );
+    QCommandLineOption jsonOption( QLatin1String( "json" ), QLatin1String( "Write the results as JSON lines." ) );
+    QCommandLineOption outputOption( QLatin1String( "output" ), QLatin1String( "Write the results to <file>." ), QLatin1String( "file" ) );
+    QCommandLineOption labelOption( QLatin1String( "label" ), QLatin1String( "A label for the results like the commit." ), QLatin1String( "label" ) );
+    QCommandLineOption compareOption( QLatin1String( "compare" ), QLatin1String( "Compare to the JSON results in <file>." ), QLatin1String( "file" ) );
+    QCommandLineOption thresholdOption( QLatin1String( "threshold" ), QLatin1String( "Slowdowns above <percent> are regressions (default 10)." ), QLatin1String( "percent" ), QLatin1String( "10" ) );
+    QCommandLineOption pluginDirOption( QLatin1String( "plugin-dir" ), QLatin1String( "Load the decoder plugins from <dir>." ), QLatin1String( "dir" ) );
+    QCommandLineOption audioFileOption( QLatin1String( "audio-file" ), QLatin1String( "Also decode <file>." ), QLatin1String( "file" ) );
+    QCommandLineOption verboseOption( QLatin1String( "verbose" ), QLatin1String( "Show the debugging output of libk3b." ) );
+    parser.addOption( listOption );
+    parser.addOption( filterOption );
+    parser.addOption( runsOption );
+    parser.addOption( warmupOption );
+    parser.addOption( jsonOption );
+    parser.addOption( outputOption );
+    parser.addOption( labelOption );
+    parser.addOption( compareOption );
+    parser.addOption( thresholdOption );
+    parser.addOption( pluginDirOption );
+    parser.addOption( audioFileOption );
+    parser.addOption( verboseOption );
+    parser.process( app );
+
+    if( !parser.isSet( verboseOption ) )
+        QLoggingCategory::setFilterRules( QLatin1String( "*.debug=false" ) );
+
+    QTextStream err( stderr );
+    K3b::Core core;
+    Context ctx;
+    if( !ctx.tempDir.isValid() ) {
+        err << "Could not create a temporary directory." << endl;
+        return 2;
+    }
+
+    //
+    // The decoders need their fixtures to decide if they can handle them
+    //
+    QStringList pluginDirs = parser.values( pluginDirOption );
+#ifdef K3B_BENCH_PLUGIN_DIRS
+    if( pluginDirs.isEmpty() )
+        pluginDirs = QString::fromLocal8Bit( K3B_BENCH_PLUGIN_DIRS ).split( QLatin1Char( '|' ), QString::SkipEmptyParts );
+#endif
+    ctx.loadDecoderPlugins( pluginDirs );
+    if( !BenchFixtures::writeWaveFile( ctx.path( QLatin1String( "stereo.wav" ) ), s_waveSeconds, 44100, 2 ) ||
+        !BenchFixtures::writeWaveFile( ctx.path( QLatin1String( "mono22050.wav" ) ), s_waveSeconds, 22050, 1 ) ||
+        !BenchFixtures::writeAiffFile( ctx.path( QLatin1String( "stereo.aiff" ) ), s_waveSeconds, 44100, 2 ) ||
+        !BenchFixtures::writeFlacFile( ctx.path( QLatin1String( "stereo.flac" ) ), s_waveSeconds, 44100, 2 ) ) {
+        err << "Could not create the audio fixtures." << endl;
+        return 2;
+    }
+    // wave files are left to the wave decoder, libsndfile gets the AIFF file
+    ctx.audioFiles << ctx.path( QLatin1String( "stereo.wav" ) )
+                   << ctx.path( QLatin1String( "mono22050.wav" ) )
+                   << ctx.path( QLatin1String( "stereo.aiff" ) )
+                   << ctx.path( QLatin1String( "stereo.flac" ) );
+    Q_FOREACH( const QString& file, parser.values( audioFileOption ) )
+        ctx.audioFiles << QFileInfo( file ).absoluteFilePath();
+
+    QList<Benchmark> benchmarks;
+    addDecoderBenchmarks( ctx, benchmarks );
+    addAudioDocBenchmarks( ctx, benchmarks );
+    addChecksumBenchmarks( ctx, benchmarks );
+    addIso9660Benchmarks( ctx, benchmarks );
+    addDataDocBenchmarks( ctx, benchmarks );
+    addDataItemMemoryBenchmarks( ctx, benchmarks );
+    addMpegInfoBenchmarks( ctx, benchmarks );
+    addCdTextBenchmarks( ctx, benchmarks );
+
+    if( parser.isSet( filterOption ) ) {
+        const QRegExp filter( parser.value( filterOption ) );
+        QList<Benchmark> selected;
+        Q_FOREACH( const Benchmark& b, benchmarks ) {
+            if( filter.indexIn( b.name ) >= 0 )
+                selected.append( b );
+        }
+        benchmarks = selected;
+    }
+
+    QTextStream out( stdout );
+    if( parser.isSet( listOption ) ) {
+        Q_FOREACH( const Benchmark& b, benchmarks )
+            out << b.name << endl;
+        return 0;
+    }
+
+    QFile outputFile;
+    if( parser.isSet( outputOption ) ) {
+        outputFile.setFileName( parser.value( outputOption ) );
+        if( !outputFile.open( QIODevice::WriteOnly|QIODevice::Truncate ) ) {
+            err << "Could not open " << outputFile.fileName() << endl;
+            return 2;
+        }
+        out.setDevice( &outputFile );
+    }
+
+    const bool json = parser.isSet( jsonOption );
+    const int runs = qMax( 1, parser.value( runsOption ).toInt() );
+    const int warmup = qMax( 0, parser.value( warmupOption ).toInt() );
+
+    if( json ) {
+        QJsonObject header;
+        header.insert( QLatin1String( "kind" ), QLatin1String( "start" ) );
+        header.insert( QLatin1String( "time" ), QDateTime::currentDateTimeUtc().toString( Qt::ISODate ) );
+        header.insert( QLatin1String( "label" ), parser.value( labelOption ) );
+        header.insert( QLatin1String( "version" ), core.version().toString() );
+        header.insert( QLatin1String( "qt" ), QLatin1String( qVersion() ) );
+        header.insert( QLatin1String( "runs" ), runs );
+        out << QJsonDocument( header ).toJson( QJsonDocument::Compact ) << endl;
+    }
+
+    QList<Result> results;
+    bool failed = false;
+    Q_FOREACH( const Benchmark& b, benchmarks ) {
+        const Result r = runBenchmark( b, warmup, runs );
+        failed = failed || !r.success;
+        results.append( r );
+        if( json )
+            out << toJsonLine( r ) << endl;
+        else
+            out << toText( r ) << endl;
+    }
+
+    //
+    // Compare the medians to the baseline
+    //
+    bool regressed = false;
+    if( parser.isSet( compareOption ) ) {
+        bool ok = false;
+        const QHash<QString, qint64> baseline = loadBaseline( parser.value( compareOption ), &ok );
+        if( !ok ) {
+            err << "Could not read " << parser.value( compareOption ) << endl;
+            return 2;
+        }
+
+        const double threshold = parser.value( thresholdOption ).toDouble();
+        err << "Compared to " << parser.value( compareOption ) << ":" << endl;
+        Q_FOREACH( const Result& r, results ) {
+            if( !r.success || !baseline.contains( r.name ) || baseline[r.name] <= 0 )
+                continue;
+            const double change = 100.0*( double( r.median() )/double( baseline[r.name] ) - 1.0 );
+            const bool regression = ( change > threshold );
+            regressed = regressed || regression;
+            err << QString::fromLatin1( "%1 %2%" ).arg( r.name, -32 ).arg( change, 7, 'f', 1 )
+                << ( regression ? " REGRESSION" : "" ) << endl;
+        }
+    }
+
+    return( failed || regressed ? 1 : 0 );
+}
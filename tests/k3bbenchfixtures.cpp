@@ -0,0 +1,538 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bbenchfixtures.h"
+
+#include <QDir>
+#include <QFile>
+#include <QVector>
+
+#include <string.h>
+
+
+namespace {
+    const int s_sectorSize = 2048;
+
+    inline quint32 xorshift( quint32& x )
+    {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        return x;
+    }
+
+    bool writeFile( const QString& filename, const QByteArray& data )
+    {
+        QFile f( filename );
+        return( f.open( QIODevice::WriteOnly|QIODevice::Truncate ) && f.write( data ) == data.size() );
+    }
+
+    void setLe16( char* p, quint16 v )
+    {
+        p[0] = char( v );
+        p[1] = char( v >> 8 );
+    }
+
+    void setLe32( char* p, quint32 v )
+    {
+        setLe16( p, quint16( v ) );
+        setLe16( p + 2, quint16( v >> 16 ) );
+    }
+
+    void setBe16( char* p, quint16 v )
+    {
+        p[0] = char( v >> 8 );
+        p[1] = char( v );
+    }
+
+    void setBe32( char* p, quint32 v )
+    {
+        setBe16( p, quint16( v >> 16 ) );
+        setBe16( p + 2, quint16( v ) );
+    }
+
+    // ISO9660 both-byte order fields
+    void set723( char* p, quint16 v )
+    {
+        setLe16( p, v );
+        p[2] = char( v >> 8 );
+        p[3] = char( v );
+    }
+
+    void set733( char* p, quint32 v )
+    {
+        setLe32( p, v );
+        p[4] = char( v >> 24 );
+        p[5] = char( v >> 16 );
+        p[6] = char( v >> 8 );
+        p[7] = char( v );
+    }
+
+    int recordLength( int nameLen )
+    {
+        // the name is padded to an even record length
+        return 33 + nameLen + ( nameLen % 2 == 0 ? 1 : 0 );
+    }
+
+    void writeRecord( char* p, quint32 extent, quint32 size, bool dir, const QByteArray& name )
+    {
+        p[0] = char( recordLength( name.size() ) );
+        set733( p + 2, extent );
+        set733( p + 10, size );
+        p[18] = 126;    // 2026-01-01 00:00:00 GMT
+        p[19] = 1;
+        p[20] = 1;
+        p[25] = char( dir ? 0x02 : 0x00 );
+        set723( p + 28, 1 );
+        p[32] = char( name.size() );
+        ::memcpy( p + 33, name.constData(), name.size() );
+    }
+
+    /**
+     * Directory records may not cross sector boundaries.
+     */
+    class DirectoryWriter
+    {
+    public:
+        explicit DirectoryWriter( char* start )
+            : m_start( start ),
+              m_pos( 0 ) {
+        }
+
+        void add( quint32 extent, quint32 size, bool dir, const QByteArray& name ) {
+            const int len = recordLength( name.size() );
+            if( m_pos % s_sectorSize + len > s_sectorSize )
+                m_pos += s_sectorSize - m_pos % s_sectorSize;
+            if( m_start )
+                writeRecord( m_start + m_pos, extent, size, dir, name );
+            m_pos += len;
+        }
+
+        int sectors() const {
+            return ( m_pos + s_sectorSize - 1 ) / s_sectorSize;
+        }
+
+    private:
+        char* m_start;
+        int m_pos;
+    };
+
+    QByteArray dirName( int i )
+    {
+        return QString::fromLatin1( "DIR%1" ).arg( i, 4, 10, QLatin1Char( '0' ) ).toLatin1();
+    }
+
+    QByteArray fileName( int i )
+    {
+        return QString::fromLatin1( "F%1.DAT;1" ).arg( i, 5, 10, QLatin1Char( '0' ) ).toLatin1();
+    }
+
+    // MPEG-1 system clock reference or time stamp, 33 bits with markers
+    void appendTimestamp( QByteArray& out, int prefix, quint64 ts )
+    {
+        out += char( ( prefix << 4 ) | ( ( ts >> 29 ) & 0x0e ) | 0x01 );
+        out += char( ts >> 22 );
+        out += char( ( ( ts >> 14 ) & 0xfe ) | 0x01 );
+        out += char( ts >> 7 );
+        out += char( ( ( ts << 1 ) & 0xfe ) | 0x01 );
+    }
+
+    void appendRate( QByteArray& out, int rate )
+    {
+        out += char( 0x80 | ( rate >> 15 ) );
+        out += char( rate >> 7 );
+        out += char( ( rate << 1 ) | 0x01 );
+    }
+
+    // the VCD mux rate of 1411200 bits/s in units of 50 bytes/s
+    const int s_muxRate = 3528;
+
+    void appendPackHeader( QByteArray& out, quint64 scr )
+    {
+        out += QByteArray( "\x00\x00\x01\xba", 4 );
+        appendTimestamp( out, 0x2, scr );
+        appendRate( out, s_muxRate );
+    }
+
+    void appendPacket( QByteArray& out, char streamId, const QByteArray& payload )
+    {
+        out += QByteArray( "\x00\x00\x01", 3 );
+        out += streamId;
+        const int len = payload.size() + 1;
+        out += char( len >> 8 );
+        out += char( len );
+        out += char( 0x0f );    // no time stamps
+        out += payload;
+    }
+}
+
+
+namespace {
+    // the content of all audio fixtures: a triangle wave with some noise
+    QVector<qint16> audioSamples( int frames, int channels )
+    {
+        QVector<qint16> samples( frames*channels );
+        quint32 x = 0x4b336233;
+        qint16* s = samples.data();
+        for( int i = 0; i < frames; ++i ) {
+            for( int c = 0; c < channels; ++c ) {
+                const int tone = ( ( i + c*25 ) % 100 - 50 )*400;
+                const int noise = int( xorshift( x ) & 0x7ff ) - 0x400;
+                *s++ = qint16( qBound( -32768, tone + noise, 32767 ) );
+            }
+        }
+        return samples;
+    }
+
+    quint8 flacCrc8( const char* data, int len )
+    {
+        quint8 crc = 0;
+        for( int i = 0; i < len; ++i ) {
+            crc ^= quint8( data[i] );
+            for( int j = 0; j < 8; ++j )
+                crc = ( crc & 0x80 ) ? quint8( ( crc << 1 ) ^ 0x07 ) : quint8( crc << 1 );
+        }
+        return crc;
+    }
+
+    quint16 flacCrc16( const char* data, int len )
+    {
+        quint16 crc = 0;
+        for( int i = 0; i < len; ++i ) {
+            crc ^= quint16( quint8( data[i] ) ) << 8;
+            for( int j = 0; j < 8; ++j )
+                crc = ( crc & 0x8000 ) ? quint16( ( crc << 1 ) ^ 0x8005 ) : quint16( crc << 1 );
+        }
+        return crc;
+    }
+
+    // the frame number in the UTF-8 like coding of FLAC
+    void appendFlacNumber( QByteArray& out, quint32 n )
+    {
+        if( n < 0x80 ) {
+            out.append( char( n ) );
+            return;
+        }
+
+        int bytes = 2;
+        while( bytes < 6 && n >= ( quint32( 1 ) << ( 5*bytes + 1 ) ) )
+            ++bytes;
+        out.append( char( ( 0xFF00 >> bytes ) | ( n >> ( 6*( bytes - 1 ) ) ) ) );
+        for( int i = bytes - 2; i >= 0; --i )
+            out.append( char( 0x80 | ( ( n >> ( 6*i ) ) & 0x3F ) ) );
+    }
+}
+
+
+QByteArray BenchFixtures::randomData( int size, quint32 seed )
+{
+    QByteArray data( size, Qt::Uninitialized );
+    quint32 x = seed ? seed : 1;
+    for( int i = 0; i < size; ++i )
+        data[i] = char( xorshift( x ) >> 24 );
+    return data;
+}
+
+
+bool BenchFixtures::writeWaveFile( const QString& filename, int seconds, int samplerate, int channels )
+{
+    const int frames = seconds*samplerate;
+    const int dataSize = frames*channels*2;
+
+    QByteArray data( 44 + dataSize, Qt::Uninitialized );
+    char* p = data.data();
+    ::memcpy( p, "RIFF", 4 );
+    setLe32( p + 4, 36 + dataSize );
+    ::memcpy( p + 8, "WAVEfmt ", 8 );
+    setLe32( p + 16, 16 );
+    setLe16( p + 20, 1 );    // PCM
+    setLe16( p + 22, channels );
+    setLe32( p + 24, samplerate );
+    setLe32( p + 28, samplerate*channels*2 );
+    setLe16( p + 32, channels*2 );
+    setLe16( p + 34, 16 );
+    ::memcpy( p + 36, "data", 4 );
+    setLe32( p + 40, dataSize );
+
+    const QVector<qint16> samples = audioSamples( frames, channels );
+    for( int i = 0; i < samples.count(); ++i )
+        setLe16( p + 44 + 2*i, quint16( samples[i] ) );
+
+    return writeFile( filename, data );
+}
+
+
+bool BenchFixtures::writeAiffFile( const QString& filename, int seconds, int samplerate, int channels )
+{
+    const int frames = seconds*samplerate;
+    const int dataSize = frames*channels*2;
+
+    QByteArray data( 54 + dataSize, '\0' );
+    char* p = data.data();
+    ::memcpy( p, "FORM", 4 );
+    setBe32( p + 4, 46 + dataSize );
+    ::memcpy( p + 8, "AIFFCOMM", 8 );
+    setBe32( p + 16, 18 );
+    setBe16( p + 20, channels );
+    setBe32( p + 22, frames );
+    setBe16( p + 26, 16 );
+
+    // the sample rate as 80 bit extended float
+    quint64 mantissa = samplerate;
+    int exponent = 16383 + 63;
+    while( !( mantissa & ( Q_UINT64_C( 1 ) << 63 ) ) ) {
+        mantissa <<= 1;
+        --exponent;
+    }
+    setBe16( p + 28, exponent );
+    setBe32( p + 30, quint32( mantissa >> 32 ) );
+    setBe32( p + 34, quint32( mantissa ) );
+
+    // offset and block size stay 0
+    ::memcpy( p + 38, "SSND", 4 );
+    setBe32( p + 42, 8 + dataSize );
+
+    const QVector<qint16> samples = audioSamples( frames, channels );
+    for( int i = 0; i < samples.count(); ++i )
+        setBe16( p + 54 + 2*i, quint16( samples[i] ) );
+
+    return writeFile( filename, data );
+}
+
+
+bool BenchFixtures::writeFlacFile( const QString& filename, int seconds, int samplerate, int channels )
+{
+    const int frames = seconds*samplerate;
+    const int blockSize = 4096;
+
+    QByteArray data( "fLaC" );
+
+    // STREAMINFO as the last metadata block, min and max frame size and MD5 unknown
+    char info[38];
+    ::memset( info, 0, sizeof(info) );
+    info[0] = char( 0x80 );
+    info[3] = 34;
+    setBe16( info + 4, blockSize );
+    setBe16( info + 6, blockSize );
+    const quint64 format = ( quint64( samplerate ) << 44 ) | ( quint64( channels - 1 ) << 41 ) |
+                           ( quint64( 16 - 1 ) << 36 ) | quint64( frames );
+    setBe32( info + 14, quint32( format >> 32 ) );
+    setBe32( info + 18, quint32( format ) );
+    data.append( info, sizeof(info) );
+
+    //
+    // Uncompressed (verbatim) frames. Decoding them takes the same paths
+    // through the decoder plugin as compressed ones.
+    //
+    const QVector<qint16> samples = audioSamples( frames, channels );
+    data.reserve( data.size() + samples.count()*2 + ( frames/blockSize + 1 )*32 );
+    QByteArray frame;
+    for( int first = 0, number = 0; first < frames; first += blockSize, ++number ) {
+        const int count = qMin( blockSize, frames - first );
+
+        frame.resize( 0 );
+        frame.append( char( 0xFF ) );
+        frame.append( char( 0xF8 ) );
+        // 4096 samples or the size at the end of the header, the sample rate from STREAMINFO
+        frame.append( char( count == blockSize ? 0xC0 : 0x70 ) );
+        // independent channels with 16 bits per sample
+        frame.append( char( ( ( channels - 1 ) << 4 ) | 0x08 ) );
+        appendFlacNumber( frame, number );
+        if( count != blockSize ) {
+            frame.append( char( ( count - 1 ) >> 8 ) );
+            frame.append( char( count - 1 ) );
+        }
+        frame.append( char( flacCrc8( frame.constData(), frame.size() ) ) );
+
+        for( int c = 0; c < channels; ++c ) {
+            frame.append( char( 0x02 ) );
+            for( int i = 0; i < count; ++i ) {
+                const quint16 sample = quint16( samples[( first + i )*channels + c] );
+                frame.append( char( sample >> 8 ) );
+                frame.append( char( sample ) );
+            }
+        }
+
+        const quint16 crc = flacCrc16( frame.constData(), frame.size() );
+        frame.append( char( crc >> 8 ) );
+        frame.append( char( crc ) );
+        data.append( frame );
+    }
+
+    return writeFile( filename, data );
+}
+
+
+QByteArray BenchFixtures::isoImage( int dirs, int filesPerDir )
+{
+    const QByteArray dot( 1, '\0' );
+    const QByteArray dotdot( 1, '\1' );
+
+    //
+    // Determine the layout: the volume descriptors are followed by the root
+    // directory, the sub directories and the data sector.
+    //
+    DirectoryWriter rootLayout( 0 );
+    rootLayout.add( 0, 0, true, dot );
+    rootLayout.add( 0, 0, true, dotdot );
+    for( int i = 0; i < dirs; ++i )
+        rootLayout.add( 0, 0, true, dirName( i ) );
+
+    DirectoryWriter dirLayout( 0 );
+    dirLayout.add( 0, 0, true, dot );
+    dirLayout.add( 0, 0, true, dotdot );
+    for( int i = 0; i < filesPerDir; ++i )
+        dirLayout.add( 0, 0, false, fileName( i ) );
+
+    const int rootExtent = 18;
+    const int rootSectors = rootLayout.sectors();
+    const int dirSectors = dirLayout.sectors();
+    const int dataExtent = rootExtent + rootSectors + dirs*dirSectors;
+    const int totalSectors = dataExtent + 1;
+
+    QByteArray image( totalSectors*s_sectorSize, '\0' );
+
+    //
+    // The primary volume descriptor and the terminator
+    //
+    char* pvd = image.data() + 16*s_sectorSize;
+    pvd[0] = 1;
+    ::memcpy( pvd + 1, "CD001", 5 );
+    pvd[6] = 1;
+    ::memset( pvd + 8, ' ', 64 );
+    ::memcpy( pvd + 40, "K3B_BENCH", 9 );
+    set733( pvd + 80, totalSectors );
+    set723( pvd + 120, 1 );
+    set723( pvd + 124, 1 );
+    set723( pvd + 128, s_sectorSize );
+    writeRecord( pvd + 156, rootExtent, rootSectors*s_sectorSize, true, dot );
+    ::memset( pvd + 190, ' ', 623 );
+    for( int i = 0; i < 4; ++i )
+        ::memset( pvd + 813 + i*17, '0', 16 );
+    pvd[881] = 1;
+
+    char* terminator = image.data() + 17*s_sectorSize;
+    terminator[0] = char( 255 );
+    ::memcpy( terminator + 1, "CD001", 5 );
+    terminator[6] = 1;
+
+    //
+    // The directories
+    //
+    DirectoryWriter root( image.data() + rootExtent*s_sectorSize );
+    root.add( rootExtent, rootSectors*s_sectorSize, true, dot );
+    root.add( rootExtent, rootSectors*s_sectorSize, true, dotdot );
+    for( int i = 0; i < dirs; ++i ) {
+        const int extent = rootExtent + rootSectors + i*dirSectors;
+        root.add( extent, dirSectors*s_sectorSize, true, dirName( i ) );
+
+        DirectoryWriter dir( image.data() + extent*s_sectorSize );
+        dir.add( extent, dirSectors*s_sectorSize, true, dot );
+        dir.add( rootExtent, rootSectors*s_sectorSize, true, dotdot );
+        for( int j = 0; j < filesPerDir; ++j )
+            dir.add( dataExtent, s_sectorSize, false, fileName( j ) );
+    }
+
+    const QByteArray data = randomData( s_sectorSize, 0x6b336233 );
+    ::memcpy( image.data() + dataExtent*s_sectorSize, data.constData(), s_sectorSize );
+
+    return image;
+}
+
+
+bool BenchFixtures::writeMpegFile( const QString& filename, int size )
+{
+    // every pack carries one packet of this size as on a VCD
+    const int packetSize = 2324;
+    const int packSize = 12 + 6 + 1 + packetSize;
+    const quint64 scrPerPack = quint64( packSize )*90000/( s_muxRate*50 );
+
+    QByteArray out;
+    out.reserve( size + 2*packSize );
+    quint64 scr = 0;
+
+    appendPackHeader( out, scr );
+    QByteArray systemHeader;
+    appendRate( systemHeader, s_muxRate );
+    systemHeader += char( 0x04 );   // one audio stream
+    systemHeader += char( 0xe1 );   // one video stream
+    systemHeader += char( 0xff );
+    out += QByteArray( "\x00\x00\x01\xbb", 4 );
+    out += char( systemHeader.size() >> 8 );
+    out += char( systemHeader.size() );
+    out += systemHeader;
+
+    // 352x240, 29.97 fps, 1150 kbit/s
+    QByteArray sequenceHeader( "\x00\x00\x01\xb3\x16\x00\xf0\x14\x02\xce\xe0\xa4", 12 );
+    appendPacket( out, char( 0xe0 ), sequenceHeader + QByteArray( packetSize - sequenceHeader.size(), char( 0xff ) ) );
+
+    // video data without any start codes
+    QByteArray video = randomData( packetSize, 0x5b336233 );
+    for( int i = 0; i < video.size(); ++i ) {
+        if( video[i] == 0 )
+            video[i] = char( 0xff );
+    }
+
+    while( out.size() < size ) {
+        scr += scrPerPack;
+        appendPackHeader( out, scr );
+        appendPacket( out, char( 0xe0 ), video );
+    }
+
+    // MPEG-1 layer II, 224 kbit/s, 44.1 kHz, stereo
+    scr += scrPerPack;
+    appendPackHeader( out, scr );
+    QByteArray audio( "\xff\xfd\xb0\x04", 4 );
+    appendPacket( out, char( 0xc0 ), audio + QByteArray( packetSize - audio.size(), char( 0x55 ) ) );
+
+    scr += scrPerPack;
+    appendPackHeader( out, scr );
+    out += QByteArray( "\x00\x00\x01\xb9", 4 );
+
+    return writeFile( filename, out );
+}
+
+
+bool BenchFixtures::createDataTree( const QString& path, int dirs, int filesPerDir )
+{
+    QDir root( path );
+    for( int i = 0; i < dirs; ++i ) {
+        const QString dir = QString::fromLatin1( "dir%1" ).arg( i, 4, 10, QLatin1Char( '0' ) );
+        if( !root.mkpath( dir ) )
+            return false;
+
+        const QString dirPath = root.filePath( dir );
+        for( int j = 0; j < filesPerDir; ++j ) {
+            const QString name = QString::fromLatin1( "file %1.dat" ).arg( j, 5, 10, QLatin1Char( '0' ) );
+            if( !writeFile( dirPath + QLatin1Char( '/' ) + name, QByteArray( j % 64, 'x' ) ) )
+                return false;
+        }
+    }
+    return true;
+}
+
+
+K3b::Device::CdText BenchFixtures::cdText( int tracks )
+{
+    K3b::Device::CdText text;
+    text.setTitle( QLatin1String( "K3b Benchmark" ) );
+    text.setPerformer( QLatin1String( "K3b Developers" ) );
+    text.setMessage( QLatin1String( "Generated" ) );
+
+    for( int i = 0; i < tracks; ++i ) {
+        K3b::Device::TrackCdText& track = text.track( i );
+        track.setTitle( QString::fromLatin1( "Title %1" ).arg( i + 1 ) );
+        track.setPerformer( QString::fromLatin1( "Artist %1" ).arg( i + 1 ) );
+    }
+
+    return text;
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef K3B_BENCH_FIXTURES_H
+#define K3B_BENCH_FIXTURES_H
+
+#include "k3bcdtext.h"
+
+#include <QByteArray>
+#include <QString>
+
+/**
+ * Generators for the input data of k3bbench.
+ *
+ * All fixtures are derived from fixed seeds so two builds always work on
+ * exactly the same data and their results can be compared.
+ */
+namespace BenchFixtures
+{
+    /**
+     * Pseudo-random bytes from a xorshift generator.
+     */
+    QByteArray randomData( int size, quint32 seed );
+
+    /**
+     * Writes a 16 bit PCM wave file containing a tone mixed with noise.
+     */
+    bool writeWaveFile( const QString& filename, int seconds, int samplerate, int channels );
+
+    /**
+     * Writes the samples of writeWaveFile() as a 16 bit AIFF file.
+     */
+    bool writeAiffFile( const QString& filename, int seconds, int samplerate, int channels );
+
+    /**
+     * Writes the samples of writeWaveFile() as an uncompressed 16 bit FLAC file.
+     */
+    bool writeFlacFile( const QString& filename, int seconds, int samplerate, int channels );
+
+    /**
+     * Creates an ISO9660 image with \p dirs directories below the root
+     * each containing \p filesPerDir files. All files share a single data
+     * sector to keep the image small.
+     */
+    QByteArray isoImage( int dirs, int filesPerDir );
+
+    /**
+     * Writes an MPEG-1 program stream of roughly \p size bytes with a video
+     * stream at the beginning and an audio stream at the end, the worst case
+     * for the stream detection of MpegInfo.
+     */
+    bool writeMpegFile( const QString& filename, int size );
+
+    /**
+     * Creates \p dirs directories below \p path each containing
+     * \p filesPerDir small files.
+     */
+    bool createDataTree( const QString& path, int dirs, int filesPerDir );
+
+    /**
+     * CD-Text with titles and performers for \p tracks tracks.
+     */
+    K3b::Device::CdText cdText( int tracks );
+}
+
+#endif // K3B_BENCH_FIXTURES_H
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bc2errorpointerstest.h"
+#include "k3bc2errorpointers.h"
+
+#include <QTest>
+
+QTEST_GUILESS_MAIN(C2ErrorPointersTest)
+
+using K3b::C2ErrorPointers;
+
+C2ErrorPointersTest::C2ErrorPointersTest()
+{
+}
+
+void C2ErrorPointersTest::testModePage()
+{
+    unsigned char page[8+20] = { 0 };
+    QVERIFY(!C2ErrorPointers::supportedByDrive(page, sizeof(page)));
+
+    page[8+5] = 0x10;
+    QVERIFY(C2ErrorPointers::supportedByDrive(page, sizeof(page)));
+
+    // other capability bits do not count
+    page[8+5] = 0xEF;
+    QVERIFY(!C2ErrorPointers::supportedByDrive(page, sizeof(page)));
+
+    // truncated page
+    page[8+5] = 0x10;
+    QVERIFY(!C2ErrorPointers::supportedByDrive(page, 8+5));
+}
+
+void C2ErrorPointersTest::testDisabled()
+{
+    C2ErrorPointers c2;
+    c2.setDriveSupport(true);
+    QVERIFY(!c2.active());
+    c2.countReRead(1);
+    QCOMPARE(c2.reReadSectors(1), -1L);
+}
+
+void C2ErrorPointersTest::testUnsupportedDrive()
+{
+    C2ErrorPointers c2;
+    c2.setEnabled(true);
+    c2.setDriveSupport(false);
+    QVERIFY(!c2.active());
+    QCOMPARE(c2.reReadSectors(1), -1L);
+}
+
+void C2ErrorPointersTest::testEnabledAfterProbe()
+{
+    // the order AudioRipJob used: open the drive, then enable C2
+    C2ErrorPointers c2;
+    c2.setDriveSupport(true);
+    c2.setEnabled(true);
+    QVERIFY(c2.active());
+    QCOMPARE(c2.reReadSectors(1), 0L);
+
+    c2.readFinished(true);
+    c2.countReRead(1);
+    c2.countReRead(1);
+    c2.countReRead(3);
+    QCOMPARE(c2.reReadSectors(1), 2L);
+    QCOMPARE(c2.reReadSectors(2), 0L);
+    QCOMPARE(c2.reReadSectors(3), 1L);
+}
+
+void C2ErrorPointersTest::testEnabledBeforeProbe()
+{
+    C2ErrorPointers c2;
+    c2.setEnabled(true);
+    QVERIFY(!c2.active());
+    c2.setDriveSupport(true);
+    QVERIFY(c2.active());
+    QCOMPARE(c2.reReadSectors(1), 0L);
+}
+
+void C2ErrorPointersTest::testFirstReadFails()
+{
+    C2ErrorPointers c2;
+    c2.setEnabled(true);
+    c2.setDriveSupport(true);
+    c2.readFinished(false);
+    QVERIFY(!c2.active());
+    QCOMPARE(c2.reReadSectors(1), -1L);
+
+    // a new drive is probed again
+    c2.setDriveSupport(true);
+    QVERIFY(c2.active());
+}
+
+void C2ErrorPointersTest::testLaterReadFails()
+{
+    C2ErrorPointers c2;
+    c2.setEnabled(true);
+    c2.setDriveSupport(true);
+    c2.readFinished(true);
+    c2.readFinished(false);
+    QVERIFY(c2.active());
+}
+
+void C2ErrorPointersTest::testResetCounters()
+{
+    C2ErrorPointers c2;
+    c2.setEnabled(true);
+    c2.setDriveSupport(true);
+    c2.countReRead(1);
+    c2.resetCounters();
+    QCOMPARE(c2.reReadSectors(1), 0L);
+}
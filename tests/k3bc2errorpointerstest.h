@@ -0,0 +1,34 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef K3B_C2_ERROR_POINTERS_TEST_H
+#define K3B_C2_ERROR_POINTERS_TEST_H
+
+#include <QObject>
+
+class C2ErrorPointersTest : public QObject
+{
+    Q_OBJECT
+public:
+    C2ErrorPointersTest();
+private slots:
+    void testModePage();
+    void testDisabled();
+    void testUnsupportedDrive();
+    void testEnabledAfterProbe();
+    void testEnabledBeforeProbe();
+    void testFirstReadFails();
+    void testLaterReadFails();
+    void testResetCounters();
+};
+
+#endif // K3B_C2_ERROR_POINTERS_TEST_H
@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bcommandtracetest.h"
+#include "k3bcommandtrace.h"
+
+#include <QTest>
+#include <QThread>
+
+QTEST_GUILESS_MAIN(CommandTraceTest)
+
+using K3b::Device::CommandTrace;
+
+namespace {
+    CommandTrace::Entry entry( unsigned char command, quint32 lba, qint64 nsecs, bool success = true )
+    {
+        CommandTrace::Entry e;
+        e.timestamp = 0;
+        e.nsecs = nsecs;
+        e.lba = lba;
+        e.length = 2048;
+        e.command = command;
+        e.senseKey = success ? 0 : 0x3;
+        e.asc = success ? 0 : 0x11;
+        e.ascq = 0;
+        e.success = success;
+        return e;
+    }
+
+    class RecordThread : public QThread
+    {
+    public:
+        RecordThread( CommandTrace& trace, unsigned char command, int count )
+            : m_trace( trace ), m_command( command ), m_count( count ) {}
+
+    protected:
+        void run() {
+            for( int i = 0; i < m_count; ++i )
+                m_trace.record( entry( m_command, i, 1000 ) );
+        }
+
+    private:
+        CommandTrace& m_trace;
+        unsigned char m_command;
+        int m_count;
+    };
+}
+
+CommandTraceTest::CommandTraceTest()
+{
+}
+
+void CommandTraceTest::testRecord()
+{
+    CommandTrace trace;
+    QVERIFY(trace.entries().isEmpty());
+
+    trace.record(entry(0x28, 16, 500000));
+    trace.record(entry(0x43, 0, 2000, false));
+
+    const QList<CommandTrace::Entry> entries = trace.entries();
+    QCOMPARE(entries.count(), 2);
+    QCOMPARE(int(entries[0].command), 0x28);
+    QCOMPARE(entries[0].lba, quint32(16));
+    QCOMPARE(entries[0].nsecs, qint64(500000));
+    QVERIFY(entries[0].success);
+    QCOMPARE(int(entries[1].command), 0x43);
+    QVERIFY(!entries[1].success);
+    QCOMPARE(int(entries[1].senseKey), 0x3);
+    QCOMPARE(int(entries[1].asc), 0x11);
+    QVERIFY(entries[0].timestamp <= entries[1].timestamp);
+}
+
+void CommandTraceTest::testRingOverflow()
+{
+    CommandTrace trace;
+    const int count = CommandTrace::RingSize + 100;
+    for( int i = 0; i < count; ++i )
+        trace.record(entry(0x28, i, 1000));
+
+    const QList<CommandTrace::Entry> entries = trace.entries();
+    QCOMPARE(entries.count(), int(CommandTrace::RingSize));
+    QCOMPARE(entries.first().lba, quint32(100));
+    QCOMPARE(entries.last().lba, quint32(count - 1));
+    for( int i = 1; i < entries.count(); ++i )
+        QCOMPARE(entries[i].lba, entries[i-1].lba + 1);
+
+    // the histogram is not limited by the ring size
+    int total = 0;
+    Q_FOREACH( quint32 c, trace.histogram(0x28) )
+        total += c;
+    QCOMPARE(total, count);
+}
+
+void CommandTraceTest::testHistogram()
+{
+    CommandTrace trace;
+    trace.record(entry(0x28, 0, 500));          // < 1 us
+    trace.record(entry(0x28, 0, 1500));         // 1 us
+    trace.record(entry(0x28, 0, 3000));         // 3 us
+    trace.record(entry(0x28, 0, 3999));         // 3 us
+    trace.record(entry(0x28, 0, Q_INT64_C(3600)*1000*1000*1000)); // one hour
+
+    const QVector<quint32> h = trace.histogram(0x28);
+    QCOMPARE(h.count(), int(CommandTrace::HistogramBuckets));
+    QCOMPARE(h[0], quint32(1));
+    QCOMPARE(h[1], quint32(1));
+    QCOMPARE(h[2], quint32(2));
+    QCOMPARE(h[CommandTrace::HistogramBuckets-1], quint32(1));
+
+    QCOMPARE(CommandTrace::bucketLimit(0), qint64(1));
+    QCOMPARE(CommandTrace::bucketLimit(2), qint64(4));
+    QCOMPARE(CommandTrace::bucketLimit(CommandTrace::HistogramBuckets-1), qint64(-1));
+
+    Q_FOREACH( quint32 c, trace.histogram(0x2A) )
+        QCOMPARE(c, quint32(0));
+}
+
+void CommandTraceTest::testClear()
+{
+    CommandTrace trace;
+    trace.record(entry(0x28, 0, 1000));
+    trace.clear();
+    QVERIFY(trace.entries().isEmpty());
+    Q_FOREACH( quint32 c, trace.histogram(0x28) )
+        QCOMPARE(c, quint32(0));
+
+    trace.record(entry(0x2A, 5, 1000));
+    QCOMPARE(trace.entries().count(), 1);
+    QCOMPARE(trace.entries().first().lba, quint32(5));
+}
+
+void CommandTraceTest::testConcurrentRecord()
+{
+    CommandTrace trace;
+    const int count = 10000;
+    QList<RecordThread*> threads;
+    for( int i = 0; i < 4; ++i )
+        threads.append(new RecordThread(trace, 0x28 + i, count));
+    Q_FOREACH( RecordThread* t, threads )
+        t->start();
+
+    // reading while recording must only return complete entries
+    while( threads.first()->isRunning() ) {
+        Q_FOREACH( const CommandTrace::Entry& e, trace.entries() ) {
+            QVERIFY(e.command >= 0x28 && e.command < 0x28 + 4);
+            QCOMPARE(e.length, quint32(2048));
+        }
+    }
+
+    Q_FOREACH( RecordThread* t, threads ) {
+        t->wait();
+        delete t;
+    }
+
+    for( int i = 0; i < 4; ++i ) {
+        int total = 0;
+        Q_FOREACH( quint32 c, trace.histogram(0x28 + i) )
+            total += c;
+        QCOMPARE(total, count);
+    }
+    QCOMPARE(trace.entries().count(), int(CommandTrace::RingSize));
+}
+
+void CommandTraceTest::testReport()
+{
+    CommandTrace trace;
+    trace.record(entry(0x28, 32, 2000000));
+    trace.record(entry(0x28, 64, 2000000, false));
+
+    const QString report = trace.report();
+    QVERIFY(report.contains("READ (10) (28): 2 commands"));
+    QVERIFY(report.contains("Last 2 commands"));
+    QVERIFY(report.contains("failed 03/11/00"));
+}
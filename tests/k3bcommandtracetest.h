@@ -0,0 +1,32 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef K3B_COMMAND_TRACE_TEST_H
+#define K3B_COMMAND_TRACE_TEST_H
+
+#include <QObject>
+
+class CommandTraceTest : public QObject
+{
+    Q_OBJECT
+public:
+    CommandTraceTest();
+private slots:
+    void testRecord();
+    void testRingOverflow();
+    void testHistogram();
+    void testClear();
+    void testConcurrentRecord();
+    void testReport();
+};
+
+#endif // K3B_COMMAND_TRACE_TEST_H
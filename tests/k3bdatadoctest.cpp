@@ -0,0 +1,306 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bdatadoctest.h"
+#include "k3bdatadoc.h"
+#include "k3bdiritem.h"
+#include "k3bfileitem.h"
+#include "k3bisooptions.h"
+#include "k3bspecialdataitem.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+QTEST_GUILESS_MAIN( DataDocTest )
+
+DataDocTest::DataDocTest()
+    : m_doc( 0 )
+{
+}
+
+
+void DataDocTest::init()
+{
+    m_doc = new K3b::DataDoc;
+    m_doc->newDocument();
+}
+
+
+void DataDocTest::cleanup()
+{
+    delete m_doc;
+    m_doc = 0;
+}
+
+
+void DataDocTest::testPrepareFilenames()
+{
+    K3b::IsoOptions o = m_doc->isoOptions();
+    o.setWhiteSpaceTreatment( K3b::IsoOptions::replace );
+    o.setWhiteSpaceTreatmentReplaceString( "_" );
+    m_doc->setIsoOptions( o );
+
+    K3b::DirItem* dir = new K3b::DirItem( "a dir" );
+    m_doc->root()->addDataItem( dir );
+    K3b::DataItem* file = new K3b::SpecialDataItem( 0, "a file" );
+    dir->addDataItem( file );
+
+    m_doc->prepareFilenames();
+    QCOMPARE( dir->writtenName(), QString( "a_dir" ) );
+    QCOMPARE( file->writtenName(), QString( "a_file" ) );
+    QVERIFY( !m_doc->root()->subtreeNamesDirty() );
+    QVERIFY( !dir->namesDirty() );
+}
+
+
+void DataDocTest::testSameNames()
+{
+    K3b::IsoOptions o = m_doc->isoOptions();
+    o.setWhiteSpaceTreatment( K3b::IsoOptions::strip );
+    m_doc->setIsoOptions( o );
+
+    K3b::DataItem* file1 = new K3b::SpecialDataItem( 0, "b" );
+    K3b::DataItem* file2 = new K3b::SpecialDataItem( 0, "a b" );
+    K3b::DataItem* file3 = new K3b::SpecialDataItem( 0, "a" );
+    K3b::DataItem* file4 = new K3b::SpecialDataItem( 0, "ab" );
+    m_doc->root()->addDataItem( file1 );
+    m_doc->root()->addDataItem( file2 );
+    m_doc->root()->addDataItem( file3 );
+    m_doc->root()->addDataItem( file4 );
+
+    m_doc->prepareFilenames();
+    QCOMPARE( file1->writtenName(), QString( "b" ) );
+    QCOMPARE( file2->writtenName(), QString( "ab1" ) );
+    QCOMPARE( file3->writtenName(), QString( "a" ) );
+    QCOMPARE( file4->writtenName(), QString( "ab2" ) );
+}
+
+
+void DataDocTest::testCutFilenames()
+{
+    K3b::IsoOptions o = m_doc->isoOptions();
+    o.setCreateJoliet( true );
+    o.setJolietLong( false );
+    m_doc->setIsoOptions( o );
+
+    K3b::DataItem* file1 = new K3b::SpecialDataItem( 0, QString( 70, 'x' ) );
+    K3b::DataItem* file2 = new K3b::SpecialDataItem( 0, "short" );
+    m_doc->root()->addDataItem( file1 );
+    m_doc->root()->addDataItem( file2 );
+
+    m_doc->prepareFilenames();
+    QVERIFY( m_doc->needToCutFilenames() );
+    QCOMPARE( m_doc->needToCutFilenameItems(), QList<K3b::DataItem*>() << file1 );
+    QCOMPARE( file1->writtenName(), QString( 64, 'x' ) );
+    QVERIFY( file1->writtenNameCut() );
+    QVERIFY( !file2->writtenNameCut() );
+
+    // the cut items are still reported if nothing changed
+    m_doc->prepareFilenames();
+    QCOMPARE( m_doc->needToCutFilenameItems(), QList<K3b::DataItem*>() << file1 );
+}
+
+
+void DataDocTest::testOnlyDirtyDirsArePrepared()
+{
+    K3b::DirItem* dir1 = new K3b::DirItem( "dir1" );
+    K3b::DirItem* dir2 = new K3b::DirItem( "dir2" );
+    m_doc->root()->addDataItem( dir1 );
+    m_doc->root()->addDataItem( dir2 );
+    K3b::DataItem* file1 = new K3b::SpecialDataItem( 0, "file1" );
+    K3b::DataItem* file2 = new K3b::SpecialDataItem( 0, "file2" );
+    dir1->addDataItem( file1 );
+    dir2->addDataItem( file2 );
+    m_doc->prepareFilenames();
+
+    // fake written names to see which directories are handled
+    file1->setWrittenName( "fake1" );
+    file2->setWrittenName( "fake2" );
+
+    dir2->addDataItem( new K3b::SpecialDataItem( 0, "file3" ) );
+    QVERIFY( dir2->namesDirty() );
+    QVERIFY( !dir1->subtreeNamesDirty() );
+    QVERIFY( m_doc->root()->subtreeNamesDirty() );
+    QVERIFY( !m_doc->root()->namesDirty() );
+
+    m_doc->prepareFilenames();
+    QCOMPARE( file1->writtenName(), QString( "fake1" ) );
+    QCOMPARE( file2->writtenName(), QString( "file2" ) );
+
+    dir1->takeDataItem( file1 );
+    QVERIFY( dir1->namesDirty() );
+    delete file1;
+}
+
+
+void DataDocTest::testRenameMarksDirty()
+{
+    K3b::DirItem* dir = new K3b::DirItem( "dir" );
+    m_doc->root()->addDataItem( dir );
+    K3b::DataItem* file = new K3b::SpecialDataItem( 0, "file" );
+    dir->addDataItem( file );
+    m_doc->prepareFilenames();
+
+    file->setK3bName( "renamed" );
+    QVERIFY( dir->namesDirty() );
+    QVERIFY( m_doc->root()->subtreeNamesDirty() );
+
+    m_doc->prepareFilenames();
+    QCOMPARE( file->writtenName(), QString( "renamed" ) );
+}
+
+
+void DataDocTest::testOptionsChangePreparesAll()
+{
+    K3b::DataItem* file = new K3b::SpecialDataItem( 0, "a file" );
+    m_doc->root()->addDataItem( file );
+    m_doc->prepareFilenames();
+    QCOMPARE( file->writtenName(), QString( "a file" ) );
+
+    K3b::IsoOptions o = m_doc->isoOptions();
+    o.setWhiteSpaceTreatment( K3b::IsoOptions::strip );
+    m_doc->setIsoOptions( o );
+    m_doc->prepareFilenames();
+    QCOMPARE( file->writtenName(), QString( "afile" ) );
+}
+
+
+void DataDocTest::testRefreshFileItem()
+{
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+    const QString path = dir.path() + "/file";
+
+    QFile file( path );
+    QVERIFY( file.open( QIODevice::WriteOnly ) );
+    file.write( QByteArray( 100, 'x' ) );
+    file.close();
+
+    K3b::FileItem* item = new K3b::FileItem( path, *m_doc );
+    m_doc->root()->addDataItem( item );
+    QCOMPARE( item->size(), KIO::filesize_t( 100 ) );
+    QVERIFY( item->localModificationTime( false ) != 0 );
+    QCOMPARE( m_doc->size(), KIO::filesize_t( 2048 ) );
+
+    QVERIFY( file.open( QIODevice::Append ) );
+    file.write( QByteArray( 5000, 'x' ) );
+    file.close();
+
+    m_doc->refreshFileItem( item );
+    QCOMPARE( item->size(), KIO::filesize_t( 5100 ) );
+    QCOMPARE( m_doc->root()->size(), KIO::filesize_t( 5100 ) );
+    QCOMPARE( m_doc->size(), KIO::filesize_t( 3*2048 ) );
+}
+
+
+void DataDocTest::testFileItemLocalPath()
+{
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+    const QString path = dir.path() + "/file";
+    QFile file( path );
+    QVERIFY( file.open( QIODevice::WriteOnly ) );
+    file.close();
+
+    K3b::FileItem* item = new K3b::FileItem( path, *m_doc );
+    K3b::FileItem* renamed = new K3b::FileItem( path, *m_doc, "other" );
+    m_doc->root()->addDataItem( item );
+    m_doc->root()->addDataItem( renamed );
+    QCOMPARE( item->localPath(), path );
+    QCOMPARE( renamed->localPath(), path );
+    QCOMPARE( renamed->k3bName(), QString( "other" ) );
+
+    // renaming does not change the local path
+    item->setK3bName( "new name" );
+    QCOMPARE( item->localPath(), path );
+
+    K3b::DataItem* copy = item->copy();
+    QCOMPARE( copy->localPath(), path );
+    delete copy;
+
+    m_doc->prepareFilenames();
+    QCOMPARE( renamed->writtenName(), QString( "other" ) );
+}
+
+
+void DataDocTest::testSymLinkItem()
+{
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+    const QString path = dir.path() + "/file";
+    const QString link = dir.path() + "/link";
+    QFile file( path );
+    QVERIFY( file.open( QIODevice::WriteOnly ) );
+    file.write( QByteArray( 100, 'x' ) );
+    file.close();
+    QVERIFY( QFile::link( path, link ) );
+
+    K3b::FileItem* fileItem = new K3b::FileItem( path, *m_doc );
+    K3b::FileItem* linkItem = new K3b::FileItem( link, *m_doc );
+    m_doc->root()->addDataItem( fileItem );
+    m_doc->root()->addDataItem( linkItem );
+    QVERIFY( linkItem->isSymLink() );
+    QCOMPARE( linkItem->itemSize( true ), KIO::filesize_t( 100 ) );
+    QVERIFY( linkItem->itemSize( false ) != KIO::filesize_t( 100 ) );
+    QVERIFY( linkItem->localId( true ) == fileItem->localId( false ) );
+    QCOMPARE( fileItem->itemSize( true ), fileItem->itemSize( false ) );
+
+    K3b::FileItem* copy = static_cast<K3b::FileItem*>( linkItem->copy() );
+    QCOMPARE( copy->itemSize( true ), KIO::filesize_t( 100 ) );
+    delete copy;
+}
+
+
+void DataDocTest::fillLargeDir()
+{
+    // 50,000 files with a lot of duplicates after whitespace treatment
+    K3b::IsoOptions o = m_doc->isoOptions();
+    o.setWhiteSpaceTreatment( K3b::IsoOptions::strip );
+    m_doc->setIsoOptions( o );
+
+    K3b::DirItem* dir = new K3b::DirItem( "large" );
+    K3b::DirItem::Children items;
+    for( int i = 0; i < 50000; ++i ) {
+        const QString name = ( i % 2 ? QString( "file %1.txt" ) : QString( "file%1.txt" ) ).arg( i / 2 );
+        items.append( new K3b::SpecialDataItem( 0, name ) );
+    }
+    dir->addDataItems( items );
+    m_doc->root()->addDataItem( dir );
+}
+
+
+void DataDocTest::benchmarkPrepareFilenames()
+{
+    fillLargeDir();
+    K3b::DirItem* dir = static_cast<K3b::DirItem*>( m_doc->root()->children().first() );
+    QBENCHMARK {
+        dir->setNamesDirty();
+        m_doc->prepareFilenames();
+    }
+}
+
+
+void DataDocTest::benchmarkPrepareFilenamesAfterRename()
+{
+    fillLargeDir();
+    m_doc->root()->addDataItem( new K3b::DirItem( "small" ) );
+    m_doc->prepareFilenames();
+
+    K3b::DataItem* small = m_doc->root()->children().last();
+    int i = 0;
+    QBENCHMARK {
+        small->setK3bName( QString( "small%1" ).arg( ++i ) );
+        m_doc->prepareFilenames();
+    }
+}
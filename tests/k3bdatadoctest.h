@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef K3B_DATA_DOC_TEST_H
+#define K3B_DATA_DOC_TEST_H
+
+#include <QObject>
+
+namespace K3b {
+    class DataDoc;
+}
+
+class DataDocTest : public QObject
+{
+    Q_OBJECT
+public:
+    DataDocTest();
+private slots:
+    void init();
+    void cleanup();
+    void testPrepareFilenames();
+    void testSameNames();
+    void testCutFilenames();
+    void testOnlyDirtyDirsArePrepared();
+    void testRenameMarksDirty();
+    void testOptionsChangePreparesAll();
+    void testRefreshFileItem();
+    void testFileItemLocalPath();
+    void testSymLinkItem();
+    void benchmarkPrepareFilenames();
+    void benchmarkPrepareFilenamesAfterRename();
+private:
+    void fillLargeDir();
+
+    K3b::DataDoc* m_doc;
+};
+
+#endif // K3B_DATA_DOC_TEST_H
@@ -0,0 +1,227 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bdatadocwatchertest.h"
+#include "k3bdatadoc.h"
+#include "k3bdatadocwatcher.h"
+#include "k3bdiritem.h"
+#include "k3bfileitem.h"
+
+#include <QDir>
+#include <QFile>
+#include <QSignalSpy>
+#include <QTest>
+
+Q_DECLARE_METATYPE( K3b::FileItem* )
+
+QTEST_GUILESS_MAIN( DataDocWatcherTest )
+
+namespace {
+    void appendToFile( const QString& path, const QByteArray& data )
+    {
+        QFile file( path );
+        QVERIFY( file.open( QIODevice::Append ) );
+        file.write( data );
+    }
+}
+
+
+DataDocWatcherTest::DataDocWatcherTest()
+    : m_doc( 0 ),
+      m_dir( 0 )
+{
+}
+
+
+void DataDocWatcherTest::initTestCase()
+{
+    qRegisterMetaType<QList<K3b::FileItem*> >();
+}
+
+
+void DataDocWatcherTest::init()
+{
+    m_dir = new QTemporaryDir;
+    QVERIFY( m_dir->isValid() );
+    m_doc = new K3b::DataDoc;
+    m_doc->newDocument();
+    if( !m_doc->watcher()->isActive() )
+        QSKIP( "inotify is not available" );
+    m_doc->watcher()->setDelay( 0 );
+}
+
+
+void DataDocWatcherTest::cleanup()
+{
+    delete m_doc;
+    m_doc = 0;
+    delete m_dir;
+    m_dir = 0;
+}
+
+
+K3b::FileItem* DataDocWatcherTest::addFile( const QString& name, const QByteArray& data )
+{
+    QFile file( m_dir->path() + '/' + name );
+    if( !file.open( QIODevice::WriteOnly ) )
+        return 0;
+    file.write( data );
+    file.close();
+
+    K3b::FileItem* item = new K3b::FileItem( file.fileName(), *m_doc );
+    m_doc->root()->addDataItem( item );
+    return item;
+}
+
+
+void DataDocWatcherTest::testModifiedFile()
+{
+    K3b::FileItem* item = addFile( "file", QByteArray( 100, 'x' ) );
+    QVERIFY( item );
+    QCOMPARE( m_doc->size(), KIO::filesize_t( 2048 ) );
+
+    QSignalSpy spy( m_doc->watcher(), SIGNAL(itemsChanged(QList<K3b::FileItem*>)) );
+    appendToFile( item->localPath(), QByteArray( 5000, 'x' ) );
+    QVERIFY( spy.wait( 5000 ) );
+
+    QCOMPARE( spy.first().first().value<QList<K3b::FileItem*> >(), QList<K3b::FileItem*>() << item );
+    QCOMPARE( item->size(), KIO::filesize_t( 5100 ) );
+    QCOMPARE( m_doc->root()->size(), KIO::filesize_t( 5100 ) );
+    QCOMPARE( m_doc->size(), KIO::filesize_t( 3*2048 ) );
+}
+
+
+void DataDocWatcherTest::testDeletedFile()
+{
+    K3b::FileItem* item = addFile( "file", QByteArray( 100, 'x' ) );
+    QVERIFY( item );
+
+    QSignalSpy spy( m_doc->watcher(), SIGNAL(itemsMissingChanged(QList<K3b::FileItem*>)) );
+    QVERIFY( QFile::remove( item->localPath() ) );
+    QVERIFY( spy.wait( 5000 ) );
+    QVERIFY( m_doc->watcher()->isMissing( item ) );
+    QCOMPARE( m_doc->watcher()->missingItems(), QList<K3b::FileItem*>() << item );
+
+    appendToFile( item->localPath(), QByteArray( 100, 'x' ) );
+    QVERIFY( spy.wait( 5000 ) );
+    QVERIFY( !m_doc->watcher()->isMissing( item ) );
+}
+
+
+void DataDocWatcherTest::testEventStorm()
+{
+    K3b::FileItem* item1 = addFile( "file1", QByteArray() );
+    K3b::FileItem* item2 = addFile( "file2", QByteArray() );
+    QVERIFY( item1 && item2 );
+
+    QSignalSpy spy( m_doc->watcher(), SIGNAL(itemsChanged(QList<K3b::FileItem*>)) );
+    m_doc->watcher()->setDelay( 200 );
+    for( int i = 0; i < 1000; ++i ) {
+        appendToFile( item1->localPath(), QByteArray( 10, 'x' ) );
+        appendToFile( item2->localPath(), QByteArray( 10, 'x' ) );
+    }
+    QVERIFY( spy.wait( 5000 ) );
+
+    // all events are handled by one update
+    QList<K3b::FileItem*> items = spy.first().first().value<QList<K3b::FileItem*> >();
+    QCOMPARE( items.count(), 2 );
+    QVERIFY( items.contains( item1 ) && items.contains( item2 ) );
+    QCOMPARE( item1->size(), KIO::filesize_t( 10000 ) );
+    QCOMPARE( m_doc->root()->size(), KIO::filesize_t( 20000 ) );
+}
+
+
+void DataDocWatcherTest::testRemovedItem()
+{
+    K3b::FileItem* item = addFile( "file", QByteArray( 100, 'x' ) );
+    QVERIFY( item );
+    const QString path = item->localPath();
+    m_doc->removeItem( item );
+
+    QSignalSpy spy( m_doc->watcher(), SIGNAL(itemsMissingChanged(QList<K3b::FileItem*>)) );
+    QVERIFY( QFile::remove( path ) );
+    m_doc->watcher()->flush();
+    QVERIFY( !spy.wait( 500 ) );
+    QVERIFY( m_doc->watcher()->missingItems().isEmpty() );
+}
+
+
+void DataDocWatcherTest::testSuspended()
+{
+    K3b::FileItem* item = addFile( "file", QByteArray( 100, 'x' ) );
+    QVERIFY( item );
+
+    // a job writing the project holds it
+    QObject job;
+    m_doc->watcher()->suspend( &job );
+    QVERIFY( m_doc->watcher()->isSuspended() );
+
+    QSignalSpy spy( m_doc->watcher(), SIGNAL(itemsChanged(QList<K3b::FileItem*>)) );
+    appendToFile( item->localPath(), QByteArray( 5000, 'x' ) );
+    QVERIFY( !spy.wait( 500 ) );
+    m_doc->watcher()->flush();
+    QCOMPARE( spy.count(), 0 );
+    QCOMPARE( item->size(), KIO::filesize_t( 100 ) );
+
+    // the collected events are handled once the job is done
+    m_doc->watcher()->resume( &job );
+    QVERIFY( !m_doc->watcher()->isSuspended() );
+    QVERIFY( spy.wait( 5000 ) );
+    QCOMPARE( item->size(), KIO::filesize_t( 5100 ) );
+}
+
+
+void DataDocWatcherTest::testHolderDeleted()
+{
+    K3b::FileItem* item = addFile( "file", QByteArray( 100, 'x' ) );
+    QVERIFY( item );
+
+    QObject* job = new QObject;
+    m_doc->watcher()->suspend( job );
+    m_doc->watcher()->suspend( job );
+
+    QSignalSpy spy( m_doc->watcher(), SIGNAL(itemsMissingChanged(QList<K3b::FileItem*>)) );
+    QVERIFY( QFile::remove( item->localPath() ) );
+    QVERIFY( !spy.wait( 500 ) );
+
+    delete job;
+    QVERIFY( !m_doc->watcher()->isSuspended() );
+    QVERIFY( spy.wait( 5000 ) );
+    QVERIFY( m_doc->watcher()->isMissing( item ) );
+}
+
+
+void DataDocWatcherTest::testRecreatedFolder()
+{
+    QVERIFY( QDir( m_dir->path() ).mkdir( "folder" ) );
+    K3b::FileItem* item = addFile( "folder/file", QByteArray( 100, 'x' ) );
+    QVERIFY( item );
+
+    QSignalSpy spy( m_doc->watcher(), SIGNAL(itemsMissingChanged(QList<K3b::FileItem*>)) );
+    QVERIFY( QFile::remove( item->localPath() ) );
+    QVERIFY( QDir( m_dir->path() ).rmdir( "folder" ) );
+    QVERIFY( spy.wait( 5000 ) );
+    QVERIFY( m_doc->watcher()->isMissing( item ) );
+
+    // the folder is watched again once it is back
+    spy.clear();
+    QVERIFY( QDir( m_dir->path() ).mkdir( "folder" ) );
+    appendToFile( item->localPath(), QByteArray( 100, 'x' ) );
+    QTRY_VERIFY_WITH_TIMEOUT( !m_doc->watcher()->isMissing( item ), 10000 );
+    QVERIFY( spy.count() > 0 );
+
+    // and changes are seen again
+    QSignalSpy changedSpy( m_doc->watcher(), SIGNAL(itemsChanged(QList<K3b::FileItem*>)) );
+    appendToFile( item->localPath(), QByteArray( 100, 'x' ) );
+    QVERIFY( changedSpy.wait( 5000 ) );
+    QCOMPARE( item->size(), KIO::filesize_t( 200 ) );
+}
@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef K3B_DATA_DOC_WATCHER_TEST_H
+#define K3B_DATA_DOC_WATCHER_TEST_H
+
+#include <QObject>
+#include <QTemporaryDir>
+
+namespace K3b {
+    class DataDoc;
+    class FileItem;
+}
+
+class DataDocWatcherTest : public QObject
+{
+    Q_OBJECT
+public:
+    DataDocWatcherTest();
+private slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+    void testModifiedFile();
+    void testDeletedFile();
+    void testEventStorm();
+    void testRemovedItem();
+    void testSuspended();
+    void testHolderDeleted();
+    void testRecreatedFolder();
+private:
+    K3b::FileItem* addFile( const QString& name, const QByteArray& data );
+    K3b::DataDoc* m_doc;
+    QTemporaryDir* m_dir;
+};
+
+#endif // K3B_DATA_DOC_WATCHER_TEST_H
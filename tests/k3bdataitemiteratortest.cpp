@@ -0,0 +1,221 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bdataitemiteratortest.h"
+#include "k3bdataitemiterator.h"
+#include "k3bdiritem.h"
+#include "k3bspecialdataitem.h"
+
+#include <QAtomicInt>
+#include <QList>
+#include <QMutex>
+#include <QSet>
+#include <QTest>
+
+QTEST_GUILESS_MAIN( DataItemIteratorTest )
+
+namespace {
+    QList<K3b::DataItem*> nextSiblingOrder( K3b::DataItem* start )
+    {
+        QList<K3b::DataItem*> items;
+        for( K3b::DataItem* item = start; item; item = item->nextSibling() )
+            items.append( item );
+        return items;
+    }
+
+    QList<K3b::DataItem*> iteratorOrder( K3b::DataItem* start, bool includeStart = true )
+    {
+        QList<K3b::DataItem*> items;
+        for( K3b::DataItemIterator it( start, includeStart ); *it; ++it )
+            items.append( *it );
+        return items;
+    }
+
+    void fillDir( K3b::DirItem* dir, int dirs, int files, int depth )
+    {
+        K3b::DirItem::Children items;
+        for( int i = 0; i < files; ++i )
+            items.append( new K3b::SpecialDataItem( 0, QString( "file%1" ).arg( i ) ) );
+        for( int i = 0; i < dirs && depth > 0; ++i ) {
+            K3b::DirItem* subDir = new K3b::DirItem( QString( "dir%1" ).arg( i ) );
+            fillDir( subDir, dirs, files, depth-1 );
+            items.append( subDir );
+        }
+        dir->addDataItems( items );
+    }
+}
+
+DataItemIteratorTest::DataItemIteratorTest()
+    : m_root( 0 ),
+      m_largeTree( 0 )
+{
+}
+
+void DataItemIteratorTest::init()
+{
+    //
+    // root
+    //  + a
+    //  |  + a1
+    //  |  + a2
+    //  |  + a3
+    //  |     + a31
+    //  + b
+    //  + c
+    //  |  + c1
+    //  + d
+    //
+    m_root = new K3b::DirItem( "root" );
+    K3b::DirItem* a = new K3b::DirItem( "a" );
+    m_root->addDataItem( a );
+    a->addDataItem( new K3b::SpecialDataItem( 0, "a1" ) );
+    a->addDataItem( new K3b::DirItem( "a2" ) );
+    K3b::DirItem* a3 = new K3b::DirItem( "a3" );
+    a->addDataItem( a3 );
+    a3->addDataItem( new K3b::SpecialDataItem( 0, "a31" ) );
+    m_root->addDataItem( new K3b::SpecialDataItem( 0, "b" ) );
+    K3b::DirItem* c = new K3b::DirItem( "c" );
+    m_root->addDataItem( c );
+    c->addDataItem( new K3b::SpecialDataItem( 0, "c1" ) );
+    m_root->addDataItem( new K3b::DirItem( "d" ) );
+}
+
+void DataItemIteratorTest::cleanup()
+{
+    delete m_root;
+    m_root = 0;
+}
+
+void DataItemIteratorTest::cleanupTestCase()
+{
+    delete m_largeTree;
+}
+
+void DataItemIteratorTest::testPreOrder()
+{
+    const QList<K3b::DataItem*> items = iteratorOrder( m_root );
+    QCOMPARE( items.count(), 10 );
+    QCOMPARE( items, nextSiblingOrder( m_root ) );
+
+    QStringList names;
+    Q_FOREACH( K3b::DataItem* item, items )
+        names << item->k3bName();
+    QCOMPARE( names.join( ' ' ), QString( "root a a1 a2 a3 a31 b c c1 d" ) );
+}
+
+void DataItemIteratorTest::testSkipStart()
+{
+    QList<K3b::DataItem*> items = iteratorOrder( m_root, false );
+    QCOMPARE( items.count(), 9 );
+    QCOMPARE( items.first()->k3bName(), QString( "a" ) );
+
+    // iterating a subtree does not leave it
+    K3b::DataItem* c = m_root->find( "c" );
+    items = iteratorOrder( c, false );
+    QCOMPARE( items.count(), 1 );
+    QCOMPARE( items.first()->k3bName(), QString( "c1" ) );
+
+    K3b::DataItem* b = m_root->find( "b" );
+    QVERIFY( iteratorOrder( b, false ).isEmpty() );
+    QCOMPARE( iteratorOrder( b ).count(), 1 );
+}
+
+void DataItemIteratorTest::testSkipChildren()
+{
+    QStringList names;
+    for( K3b::DataItemIterator it( m_root, false ); *it; ++it ) {
+        names << (*it)->k3bName();
+        if( (*it)->k3bName() == "a" )
+            it.skipChildren();
+    }
+    QCOMPARE( names.join( ' ' ), QString( "a b c c1 d" ) );
+}
+
+void DataItemIteratorTest::testEmptyDir()
+{
+    K3b::DirItem dir( "empty" );
+    QCOMPARE( iteratorOrder( &dir ).count(), 1 );
+    QVERIFY( iteratorOrder( &dir, false ).isEmpty() );
+}
+
+void DataItemIteratorTest::testParallelForEach()
+{
+    K3b::DirItem root( "root" );
+    fillDir( &root, 8, 100, 2 );
+
+    const QList<K3b::DataItem*> expected = iteratorOrder( &root, false );
+    QVERIFY( expected.count() > 4096 );
+
+    QMutex mutex;
+    QList<K3b::DataItem*> visited;
+    K3b::parallelForEachDataItem( &root, [&]( K3b::DataItem* item ) {
+        QMutexLocker locker( &mutex );
+        visited.append( item );
+    } );
+
+    QCOMPARE( visited.count(), expected.count() );
+    QCOMPARE( visited.toSet(), expected.toSet() );
+
+    QAtomicInt count( 0 );
+    K3b::parallelForEachDataItem( &root, [&]( K3b::DataItem* ) { count.ref(); }, true );
+    QCOMPARE( count.load(), expected.count() + 1 );
+}
+
+K3b::DirItem* DataItemIteratorTest::largeTree()
+{
+    // 100 dirs with 100 dirs with 100 files each: 1,010,101 items
+    if( !m_largeTree ) {
+        m_largeTree = new K3b::DirItem( "root" );
+        fillDir( m_largeTree, 100, 0, 2 );
+        Q_FOREACH( K3b::DataItem* dir, m_largeTree->children() ) {
+            Q_FOREACH( K3b::DataItem* subDir, static_cast<K3b::DirItem*>( dir )->children() )
+                fillDir( static_cast<K3b::DirItem*>( subDir ), 0, 100, 0 );
+        }
+    }
+    return m_largeTree;
+}
+
+void DataItemIteratorTest::benchmarkIterator()
+{
+    K3b::DirItem* root = largeTree();
+    int count = 0;
+    QBENCHMARK {
+        count = 0;
+        for( K3b::DataItemIterator it( root ); *it; ++it )
+            ++count;
+    }
+    QCOMPARE( count, 1010101 );
+}
+
+void DataItemIteratorTest::benchmarkNextSibling()
+{
+    K3b::DirItem* root = largeTree();
+    int count = 0;
+    QBENCHMARK {
+        count = 0;
+        for( K3b::DataItem* item = root; item; item = item->nextSibling() )
+            ++count;
+    }
+    QCOMPARE( count, 1010101 );
+}
+
+void DataItemIteratorTest::benchmarkParallelForEach()
+{
+    K3b::DirItem* root = largeTree();
+    QAtomicInt count( 0 );
+    QBENCHMARK {
+        count.store( 0 );
+        K3b::parallelForEachDataItem( root, [&]( K3b::DataItem* ) { count.ref(); }, true );
+    }
+    QCOMPARE( count.load(), 1010101 );
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef K3B_DATA_ITEM_ITERATOR_TEST_H
+#define K3B_DATA_ITEM_ITERATOR_TEST_H
+
+#include <QObject>
+
+namespace K3b {
+    class DirItem;
+}
+
+class DataItemIteratorTest : public QObject
+{
+    Q_OBJECT
+public:
+    DataItemIteratorTest();
+private slots:
+    void init();
+    void cleanup();
+    void testPreOrder();
+    void testSkipStart();
+    void testSkipChildren();
+    void testEmptyDir();
+    void testParallelForEach();
+    void benchmarkIterator();
+    void benchmarkNextSibling();
+    void benchmarkParallelForEach();
+    void cleanupTestCase();
+private:
+    K3b::DirItem* largeTree();
+
+    K3b::DirItem* m_root;
+    K3b::DirItem* m_largeTree;
+};
+
+#endif // K3B_DATA_ITEM_ITERATOR_TEST_H
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bduplicatefindertest.h"
+#include "k3bduplicatefinder.h"
+
+#include <QFile>
+#include <QTest>
+
+QTEST_GUILESS_MAIN(DuplicateFinderTest)
+
+using K3b::DuplicateFinder;
+using K3b::FileItem;
+
+namespace {
+
+FileItem::Id fakeId(int inode)
+{
+    FileItem::Id id;
+    id.device = 1;
+    id.inode = inode;
+    return id;
+}
+
+} // namespace
+
+DuplicateFinderTest::DuplicateFinderTest()
+{
+}
+
+QString DuplicateFinderTest::createFile(const QString& name, const QByteArray& data)
+{
+    const QString path = m_dir.path() + '/' + name;
+    QFile f(path);
+    if (!f.open(QIODevice::WriteOnly) || f.write(data) != data.size())
+        return QString();
+    return path;
+}
+
+void DuplicateFinderTest::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+}
+
+void DuplicateFinderTest::testSmallFiles()
+{
+    DuplicateFinder finder;
+    const QByteArray a("the same content");
+    const QByteArray b("other content!!!");
+    finder.addFile(createFile("a1", a), a.size(), fakeId(1));
+    finder.addFile(createFile("b1", b), b.size(), fakeId(2));
+    finder.addFile(createFile("a2", a), a.size(), fakeId(3));
+    finder.addFile(createFile("a3", a), a.size(), fakeId(4));
+    finder.addFile(createFile("empty1", QByteArray()), 0, fakeId(5));
+    finder.addFile(createFile("empty2", QByteArray()), 0, fakeId(6));
+
+    QVERIFY(finder.find());
+    QCOMPARE(finder.original(0), 0);
+    QCOMPARE(finder.original(1), 1);
+    QCOMPARE(finder.original(2), 0);
+    QCOMPARE(finder.original(3), 0);
+    QCOMPARE(finder.original(4), 4);
+    QCOMPARE(finder.original(5), 5);
+    QCOMPARE(finder.duplicates(), 2);
+    QCOMPARE(finder.reclaimableSize(), KIO::filesize_t(2*2048));
+}
+
+void DuplicateFinderTest::testLargeFiles()
+{
+    // equal in the first 64 KB, only the complete hash tells them apart
+    QByteArray a(300*1024, 'x');
+    QByteArray b(a);
+    b[b.size() - 1] = 'y';
+
+    DuplicateFinder finder;
+    finder.addFile(createFile("large1", a), a.size(), fakeId(1));
+    finder.addFile(createFile("large2", b), b.size(), fakeId(2));
+    finder.addFile(createFile("large3", a), a.size(), fakeId(3));
+
+    QVERIFY(finder.find());
+    QCOMPARE(finder.original(0), 0);
+    QCOMPARE(finder.original(1), 1);
+    QCOMPARE(finder.original(2), 0);
+    QCOMPARE(finder.duplicates(), 1);
+    QCOMPARE(finder.reclaimableSize(), KIO::filesize_t(300*1024));
+}
+
+void DuplicateFinderTest::testHardLinks()
+{
+    const QByteArray a("hard linked content");
+
+    DuplicateFinder finder;
+    const QString first = createFile("h1", a);
+    const QString copy = createFile("h2", a);
+    finder.addFile(first, a.size(), fakeId(1));
+    finder.addFile(first, a.size(), fakeId(1));
+    finder.addFile(copy, a.size(), fakeId(2));
+    finder.addFile(copy, a.size(), fakeId(2));
+
+    QVERIFY(finder.find());
+    QCOMPARE(finder.original(0), 0);
+    QCOMPARE(finder.original(1), 0);
+    QCOMPARE(finder.original(2), 0);
+    QCOMPARE(finder.original(3), 0);
+
+    // the hard links of the copy do not need any space anyway
+    QCOMPARE(finder.duplicates(), 1);
+    QCOMPARE(finder.reclaimableSize(), KIO::filesize_t(2048));
+}
+
+void DuplicateFinderTest::testMissingFile()
+{
+    const QByteArray a("content of a file");
+
+    DuplicateFinder finder;
+    finder.addFile(createFile("m1", a), a.size(), fakeId(1));
+    finder.addFile(m_dir.path() + "/does-not-exist", a.size(), fakeId(2));
+    finder.addFile(m_dir.path() + "/does-not-exist-either", a.size(), fakeId(3));
+
+    QVERIFY(finder.find());
+    QCOMPARE(finder.original(1), 1);
+    QCOMPARE(finder.original(2), 2);
+    QCOMPARE(finder.duplicates(), 0);
+}
+
+void DuplicateFinderTest::testCanceled()
+{
+    const QByteArray a("canceled");
+
+    DuplicateFinder finder;
+    finder.addFile(createFile("c1", a), a.size(), fakeId(1));
+    finder.addFile(createFile("c2", a), a.size(), fakeId(2));
+
+    QVERIFY(!finder.find([]() { return true; }));
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bduplicationjobtest.h"
+#include "k3bduplicationjob.h"
+#include "k3bjobqueue.h"
+#include "k3bcore.h"
+
+#include <QSignalSpy>
+#include <QTest>
+
+QTEST_GUILESS_MAIN(DuplicationJobTest)
+
+using K3b::DuplicationJob;
+
+DuplicationJobTest::DuplicationJobTest()
+    : m_core( new K3b::Core( this ) )
+{
+}
+
+void DuplicationJobTest::testNoWriters()
+{
+    DuplicationJob job( 0 );
+    job.setImagePath( QLatin1String( "/nonexistent.iso" ) );
+    QSignalSpy finishedSpy( &job, SIGNAL(finished(bool)) );
+    QSignalSpy burningSpy( &job, SIGNAL(burning(bool)) );
+    QSignalSpy messageSpy( &job, SIGNAL(infoMessage(QString,int)) );
+
+    job.start();
+
+    QCOMPARE( finishedSpy.count(), 1 );
+    QCOMPARE( finishedSpy.first().first().toBool(), false );
+    QCOMPARE( burningSpy.count(), 0 );
+    QCOMPARE( messageSpy.count(), 1 );
+    QCOMPARE( messageSpy.first().at( 1 ).toInt(), int( K3b::Job::MessageError ) );
+    QVERIFY( !job.active() );
+    QCOMPARE( job.successfulCopies(), 0 );
+}
+
+void DuplicationJobTest::testCancelWhenNotRunning()
+{
+    DuplicationJob job( 0 );
+    QSignalSpy finishedSpy( &job, SIGNAL(finished(bool)) );
+    QSignalSpy canceledSpy( &job, SIGNAL(canceled()) );
+
+    job.cancel();
+
+    QCOMPARE( finishedSpy.count(), 0 );
+    QCOMPARE( canceledSpy.count(), 0 );
+}
+
+void DuplicationJobTest::testQueueJobTypes()
+{
+    K3b::JobQueue queue;
+    QVERIFY( queue.jobTypes().contains( QLatin1String( "duplicate" ) ) );
+    QVERIFY( queue.jobTypes().contains( QLatin1String( "duplicateimage" ) ) );
+}
+
+void DuplicationJobTest::testQueueUnknownWriter()
+{
+    K3b::JobQueue queue;
+    QVariantMap description;
+    description.insert( QLatin1String( "type" ), QLatin1String( "duplicateimage" ) );
+    description.insert( QLatin1String( "image" ), QLatin1String( "/tmp/data.iso" ) );
+    description.insert( QLatin1String( "writers" ), QStringList() << QLatin1String( "/dev/nonexistent" ) );
+
+    QString error;
+    QCOMPARE( queue.enqueue( description, &error ), -1 );
+    QVERIFY( error.contains( QLatin1String( "/dev/nonexistent" ) ) );
+}
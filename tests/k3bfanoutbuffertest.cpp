@@ -0,0 +1,249 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bfanoutbuffertest.h"
+#include "k3bfanoutbuffer.h"
+
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QSemaphore>
+#include <QSignalSpy>
+#include <QTest>
+#include <QThread>
+
+QTEST_GUILESS_MAIN(FanOutBufferTest)
+
+using K3b::FanOutBuffer;
+
+namespace {
+    /**
+     * Blocks in each write until the test releases it.
+     */
+    class BlockingSink : public QIODevice
+    {
+    public:
+        BlockingSink() {
+            open( WriteOnly );
+        }
+
+        QSemaphore entered;
+        QSemaphore release;
+
+    protected:
+        qint64 readData( char*, qint64 ) {
+            return -1;
+        }
+
+        qint64 writeData( const char*, qint64 len ) {
+            entered.release();
+            release.acquire();
+            return len;
+        }
+    };
+
+    /**
+     * Accepts \p limit bytes and fails afterwards.
+     */
+    class FailingSink : public QIODevice
+    {
+    public:
+        explicit FailingSink( qint64 limit )
+            : m_limit( limit ) {
+            open( WriteOnly );
+        }
+
+    protected:
+        qint64 readData( char*, qint64 ) {
+            return -1;
+        }
+
+        qint64 writeData( const char*, qint64 len ) {
+            if( m_limit <= 0 )
+                return -1;
+            len = qMin( len, m_limit );
+            m_limit -= len;
+            return len;
+        }
+
+    private:
+        qint64 m_limit;
+    };
+
+    /**
+     * Writes to the buffer from another thread since the write blocks.
+     */
+    class WriterThread : public QThread
+    {
+    public:
+        WriterThread( FanOutBuffer* buffer, const QByteArray& data )
+            : m_buffer( buffer ),
+              m_data( data ),
+              written( 0 ) {
+        }
+
+        qint64 written;
+
+    protected:
+        void run() {
+            written = m_buffer->write( m_data );
+        }
+
+    private:
+        FanOutBuffer* m_buffer;
+        QByteArray m_data;
+    };
+
+    QByteArray testData( int size )
+    {
+        QByteArray data( size, 0 );
+        for( int i = 0; i < size; ++i )
+            data[i] = char( i % 251 );
+        return data;
+    }
+}
+
+FanOutBufferTest::FanOutBufferTest()
+{
+}
+
+void FanOutBufferTest::testAllSinksGetAllData()
+{
+    // more data than fits into the buffer
+    const QByteArray data = testData( 5*64*1024 + 100 );
+
+    QBuffer first, second;
+    first.open( QIODevice::WriteOnly );
+    second.open( QIODevice::WriteOnly );
+
+    FanOutBuffer buffer( 64*1024 );
+    QCOMPARE( buffer.addSink( &first ), 0 );
+    QCOMPARE( buffer.addSink( &second, true ), 1 );
+    QSignalSpy sinkFinishedSpy( &buffer, SIGNAL(sinkFinished(int)) );
+    QSignalSpy finishedSpy( &buffer, SIGNAL(finished()) );
+
+    QVERIFY( buffer.open() );
+    QCOMPARE( buffer.write( data ), qint64( data.size() ) );
+    buffer.close();
+
+    QTRY_COMPARE( finishedSpy.count(), 1 );
+    QCOMPARE( sinkFinishedSpy.count(), 2 );
+    QCOMPARE( buffer.activeSinks(), 0 );
+    QCOMPARE( buffer.bytesWrittenToSink( 0 ), quint64( data.size() ) );
+    QCOMPARE( buffer.bytesWrittenToSink( 1 ), quint64( data.size() ) );
+    QCOMPARE( first.data(), data );
+    QCOMPARE( second.data(), data );
+
+    // only the second sink is closed by the buffer
+    QVERIFY( first.isOpen() );
+    QVERIFY( !second.isOpen() );
+}
+
+void FanOutBufferTest::testFailingSinkIsDropped()
+{
+    const QByteArray data = testData( 4*64*1024 );
+
+    QBuffer good;
+    good.open( QIODevice::WriteOnly );
+    FailingSink bad( 1000 );
+
+    FanOutBuffer buffer( 64*1024 );
+    buffer.addSink( &good );
+    buffer.addSink( &bad );
+    QSignalSpy failedSpy( &buffer, SIGNAL(sinkFailed(int)) );
+
+    QVERIFY( buffer.open() );
+    QCOMPARE( buffer.write( data ), qint64( data.size() ) );
+    buffer.close();
+
+    QTRY_VERIFY( !buffer.running() );
+    QVERIFY( buffer.hasSinkFailed( 1 ) );
+    QVERIFY( !buffer.hasSinkFailed( 0 ) );
+    QCOMPARE( failedSpy.count(), 1 );
+    QCOMPARE( failedSpy.first().first().toInt(), 1 );
+    QCOMPARE( buffer.bytesWrittenToSink( 1 ), quint64( 1000 ) );
+    QCOMPARE( good.data(), data );
+}
+
+void FanOutBufferTest::testSlowestSinkGovernsWrites()
+{
+    QBuffer fast;
+    fast.open( QIODevice::WriteOnly );
+    BlockingSink slow;
+
+    FanOutBuffer buffer( 64*1024 );
+    buffer.addSink( &fast );
+    buffer.addSink( &slow );
+    QVERIFY( buffer.open() );
+
+    // twice the buffer size cannot be written while the slow sink is stuck
+    const QByteArray data = testData( 2*64*1024 );
+    WriterThread writer( &buffer, data );
+    writer.start();
+
+    QVERIFY( slow.entered.tryAcquire( 1, 5000 ) );
+    QTRY_COMPARE( buffer.bytesWrittenToSink( 0 ), quint64( 64*1024 ) );
+    QVERIFY( !writer.wait( 200 ) );
+
+    // each sink has its own cursor
+    QCOMPARE( buffer.bytesWrittenToSink( 1 ), quint64( 0 ) );
+    QCOMPARE( buffer.fillLevel( 1 ), 100 );
+    QCOMPARE( buffer.fillLevel( 0 ), 0 );
+
+    slow.release.release( 1000 );
+    QVERIFY( writer.wait( 5000 ) );
+    QCOMPARE( writer.written, qint64( data.size() ) );
+
+    buffer.close();
+    QTRY_VERIFY( !buffer.running() );
+    QCOMPARE( buffer.bytesWrittenToSink( 1 ), quint64( data.size() ) );
+    QCOMPARE( fast.data(), data );
+}
+
+void FanOutBufferTest::testStopDoesNotWait()
+{
+    BlockingSink sink;
+    FanOutBuffer buffer( 64*1024 );
+    buffer.addSink( &sink );
+    QSignalSpy finishedSpy( &buffer, SIGNAL(finished()) );
+
+    QVERIFY( buffer.open() );
+    buffer.write( QByteArray( 2048, 'x' ) );
+    QVERIFY( sink.entered.tryAcquire( 1, 5000 ) );
+
+    QElapsedTimer timer;
+    timer.start();
+    buffer.stop();
+    QVERIFY( timer.elapsed() < 100 );
+    QVERIFY( !buffer.isOpen() );
+    QVERIFY( buffer.running() );
+    QCOMPARE( finishedSpy.count(), 0 );
+
+    // the sink thread ends once the current write returns
+    sink.release.release();
+    QTRY_COMPARE( finishedSpy.count(), 1 );
+    QVERIFY( !buffer.running() );
+}
+
+void FanOutBufferTest::testAbortWaits()
+{
+    BlockingSink sink;
+    FanOutBuffer buffer( 64*1024 );
+    buffer.addSink( &sink );
+
+    QVERIFY( buffer.open() );
+    buffer.write( QByteArray( 2048, 'x' ) );
+    QVERIFY( sink.entered.tryAcquire( 1, 5000 ) );
+
+    sink.release.release();
+    buffer.abort();
+    QVERIFY( !buffer.running() );
+}
@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bffmpegwrappertest.h"
+#include "k3bffmpegwrapper.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <QScopedPointer>
+#include <QTest>
+#include <QtEndian>
+
+#include <string.h>
+
+QTEST_GUILESS_MAIN(FFMpegWrapperTest)
+
+namespace {
+    const int s_sampleRate = 44100;
+    const int s_seconds = 5;
+
+    /**
+     * Each stereo sample holds its own index: the lower 15 bits on the left
+     * and the upper bits on the right channel.
+     */
+    QByteArray countingWave( int samples )
+    {
+        QByteArray data( 44 + samples*4, 0 );
+        char* p = data.data();
+        ::memcpy( p, "RIFF", 4 );
+        qToLittleEndian<quint32>( data.size() - 8, reinterpret_cast<uchar*>( p + 4 ) );
+        ::memcpy( p + 8, "WAVEfmt ", 8 );
+        qToLittleEndian<quint32>( 16, reinterpret_cast<uchar*>( p + 16 ) );
+        qToLittleEndian<quint16>( 1, reinterpret_cast<uchar*>( p + 20 ) );   // PCM
+        qToLittleEndian<quint16>( 2, reinterpret_cast<uchar*>( p + 22 ) );
+        qToLittleEndian<quint32>( s_sampleRate, reinterpret_cast<uchar*>( p + 24 ) );
+        qToLittleEndian<quint32>( s_sampleRate*4, reinterpret_cast<uchar*>( p + 28 ) );
+        qToLittleEndian<quint16>( 4, reinterpret_cast<uchar*>( p + 32 ) );
+        qToLittleEndian<quint16>( 16, reinterpret_cast<uchar*>( p + 34 ) );
+        ::memcpy( p + 36, "data", 4 );
+        qToLittleEndian<quint32>( samples*4, reinterpret_cast<uchar*>( p + 40 ) );
+
+        for( int i = 0; i < samples; ++i ) {
+            qToLittleEndian<quint16>( i & 0x7fff, reinterpret_cast<uchar*>( p + 44 + i*4 ) );
+            qToLittleEndian<quint16>( i >> 15, reinterpret_cast<uchar*>( p + 44 + i*4 + 2 ) );
+        }
+        return data;
+    }
+
+    /**
+     * Reads \p count samples and returns the index of the first one or -1
+     * if the samples are not consecutive.
+     */
+    int readSamples( K3bFFMpegFile* file, int count )
+    {
+        QByteArray data;
+        char buf[4096];
+        while( data.size() < count*4 ) {
+            const int len = file->read( buf, qMin<int>( sizeof(buf), count*4 - data.size() ) );
+            if( len <= 0 )
+                return -1;
+            data.append( buf, len );
+        }
+
+        // the decoder delivers big endian samples
+        const uchar* p = reinterpret_cast<const uchar*>( data.constData() );
+        int first = -1;
+        for( int i = 0; i < count; ++i ) {
+            const int index = qFromBigEndian<quint16>( p + i*4 ) | ( qFromBigEndian<quint16>( p + i*4 + 2 ) << 15 );
+            if( i == 0 )
+                first = index;
+            else if( index != first + i )
+                return -1;
+        }
+        return first;
+    }
+}
+
+
+FFMpegWrapperTest::FFMpegWrapperTest()
+{
+}
+
+
+void FFMpegWrapperTest::initTestCase()
+{
+    QVERIFY( m_dir.isValid() );
+    m_file = m_dir.path() + "/counting.wav";
+    QFile file( m_file );
+    QVERIFY( file.open( QIODevice::WriteOnly ) );
+    file.write( countingWave( s_sampleRate*s_seconds ) );
+}
+
+
+void FFMpegWrapperTest::testRead()
+{
+    QScopedPointer<K3bFFMpegFile> file( K3bFFMpegWrapper::instance()->open( m_file ) );
+    QVERIFY( file );
+    QCOMPARE( file->sampleRate(), s_sampleRate );
+    QCOMPARE( file->channels(), 2 );
+    QCOMPARE( readSamples( file.data(), 10000 ), 0 );
+}
+
+
+void FFMpegWrapperTest::testSeek_data()
+{
+    QTest::addColumn<int>( "frames" );
+
+    QTest::newRow( "start" ) << 0;
+    QTest::newRow( "first frame" ) << 1;
+    QTest::newRow( "within the preroll" ) << 5;
+    QTest::newRow( "odd position" ) << 2*75 + 37;
+    QTest::newRow( "near the end" ) << s_seconds*75 - 2;
+}
+
+
+void FFMpegWrapperTest::testSeek()
+{
+    QFETCH( int, frames );
+
+    QScopedPointer<K3bFFMpegFile> file( K3bFFMpegWrapper::instance()->open( m_file ) );
+    QVERIFY( file );
+    QVERIFY( file->seek( K3b::Msf( frames ) ) );
+
+    // one audio frame holds 588 samples at 44.1 kHz
+    QCOMPARE( readSamples( file.data(), 588 ), frames*588 );
+}
+
+
+void FFMpegWrapperTest::testSeekBackwards()
+{
+    QScopedPointer<K3bFFMpegFile> file( K3bFFMpegWrapper::instance()->open( m_file ) );
+    QVERIFY( file );
+
+    QVERIFY( file->seek( K3b::Msf( 3*75 + 10 ) ) );
+    QCOMPARE( readSamples( file.data(), 5000 ), ( 3*75 + 10 )*588 );
+
+    QVERIFY( file->seek( K3b::Msf( 75 + 3 ) ) );
+    QCOMPARE( readSamples( file.data(), 5000 ), ( 75 + 3 )*588 );
+
+    // reading continues seamlessly after a seek
+    QCOMPARE( readSamples( file.data(), 5000 ), ( 75 + 3 )*588 + 5000 );
+}
+
+
+void FFMpegWrapperTest::testSeekStatistics()
+{
+    QScopedPointer<K3bFFMpegFile> file( K3bFFMpegWrapper::instance()->open( m_file ) );
+    QVERIFY( file );
+
+    QVERIFY( file->seek( K3b::Msf( 2*75 ) ) );
+    QCOMPARE( readSamples( file.data(), 588 ), 2*75*588 );
+    QVERIFY( file->seek( K3b::Msf( 4*75 ) ) );
+    QCOMPARE( readSamples( file.data(), 588 ), 4*75*588 );
+
+    // decoding starts at an indexed packet before the target
+    const K3bFFMpegFile::SeekStatistics stats = file->seekStatistics();
+    QCOMPARE( stats.seeks, 2 );
+    QVERIFY( stats.discardedSamples > 0 );
+    QVERIFY( stats.nsecs > 0 );
+}
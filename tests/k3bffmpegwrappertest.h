@@ -0,0 +1,36 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef K3B_FFMPEG_WRAPPER_TEST_H
+#define K3B_FFMPEG_WRAPPER_TEST_H
+
+#include <QObject>
+#include <QTemporaryDir>
+
+class FFMpegWrapperTest : public QObject
+{
+    Q_OBJECT
+public:
+    FFMpegWrapperTest();
+private slots:
+    void initTestCase();
+    void testRead();
+    void testSeek_data();
+    void testSeek();
+    void testSeekBackwards();
+    void testSeekStatistics();
+private:
+    QTemporaryDir m_dir;
+    QString m_file;
+};
+
+#endif // K3B_FFMPEG_WRAPPER_TEST_H
@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ * Copyright (C) 1998-2009 Sebastian Trueg <trueg@k3b.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3biso9660backendtest.h"
+#include "k3biso9660backend.h"
+
+#include <QByteArray>
+#include <QTest>
+
+#include <string.h>
+
+QTEST_GUILESS_MAIN( Iso9660BackendTest )
+
+namespace {
+    /**
+     * Serves sectors from memory like a file, counting the reads.
+     */
+    class MemoryBackend : public K3b::Iso9660Backend
+    {
+    public:
+        explicit MemoryBackend( int sectors )
+            : data( sectors*2048, Qt::Uninitialized ),
+              reads( 0 ),
+              readSectors( 0 ),
+              m_isOpen( false ) {
+            for( int i = 0; i < data.size(); ++i )
+                data[i] = char( ( i*7 + i/2048 ) & 0xff );
+        }
+
+        bool open() { m_isOpen = true; return true; }
+        void close() { m_isOpen = false; }
+        bool isOpen() const { return m_isOpen; }
+
+        int read( unsigned int sector, char* buffer, int len ) {
+            ++reads;
+            const int sectors = data.size()/2048;
+            if( (int)sector >= sectors )
+                return 0;
+            len = qMin( len, sectors - (int)sector );
+            ::memcpy( buffer, data.constData() + sector*2048, len*2048 );
+            readSectors += len;
+            return len;
+        }
+
+        QByteArray data;
+        int reads;
+        int readSectors;
+
+    private:
+        bool m_isOpen;
+    };
+}
+
+
+Iso9660BackendTest::Iso9660BackendTest()
+{
+}
+
+
+void Iso9660BackendTest::testAlignedReads()
+{
+    MemoryBackend* mem = new MemoryBackend( 1000 );
+    K3b::Iso9660CachingBackend cache( mem );
+    QVERIFY( cache.open() );
+
+    char buffer[2048*10];
+    for( int sector = 0; sector < 100; sector += 10 ) {
+        QCOMPARE( cache.read( sector, buffer, 10 ), 10 );
+        QVERIFY( ::memcmp( buffer, mem->data.constData() + sector*2048, sizeof(buffer) ) == 0 );
+    }
+
+    // 100 sectors are covered by 4 blocks of 32 sectors
+    QVERIFY( mem->reads <= 4 );
+}
+
+
+void Iso9660BackendTest::testUnalignedReads()
+{
+    MemoryBackend* mem = new MemoryBackend( 1000 );
+    K3b::Iso9660CachingBackend cache( mem, 256*1024 );
+    QVERIFY( cache.open() );
+
+    QByteArray buffer( 200000, Qt::Uninitialized );
+    qsrand( 42 );
+    for( int i = 0; i < 1000; ++i ) {
+        const quint64 pos = qrand() % ( mem->data.size() - buffer.size() );
+        const int len = 1 + qrand() % buffer.size();
+        QCOMPARE( cache.readBytes( pos, buffer.data(), len ), len );
+        QVERIFY( ::memcmp( buffer.constData(), mem->data.constData() + pos, len ) == 0 );
+    }
+}
+
+
+void Iso9660BackendTest::testSequentialReadAhead()
+{
+    MemoryBackend* mem = new MemoryBackend( 4096 );
+    K3b::Iso9660CachingBackend cache( mem );
+    QVERIFY( cache.open() );
+
+    // read the whole data in small unaligned chunks
+    char buffer[1000];
+    quint64 pos = 0;
+    int read = 0;
+    while( ( read = cache.readBytes( pos, buffer, sizeof(buffer) ) ) > 0 ) {
+        QVERIFY( ::memcmp( buffer, mem->data.constData() + pos, read ) == 0 );
+        pos += read;
+    }
+    QCOMPARE( pos, quint64( mem->data.size() ) );
+
+    // each sector is read once and mostly with several blocks at once
+    QCOMPARE( mem->readSectors, 4096 );
+    QVERIFY( mem->reads < 4096/K3b::Iso9660CachingBackend::BlockSectors );
+}
+
+
+void Iso9660BackendTest::testLargeReadsBypassCache()
+{
+    MemoryBackend* mem = new MemoryBackend( 1000 );
+    K3b::Iso9660CachingBackend cache( mem );
+    QVERIFY( cache.open() );
+
+    QByteArray buffer( 100*2048, Qt::Uninitialized );
+    QCOMPARE( cache.read( 7, buffer.data(), 100 ), 100 );
+    QCOMPARE( mem->reads, 1 );
+    QCOMPARE( mem->readSectors, 100 );
+    QVERIFY( ::memcmp( buffer.constData(), mem->data.constData() + 7*2048, buffer.size() ) == 0 );
+
+    // aligned start, unaligned length: the tail comes from the cache
+    QCOMPARE( cache.readBytes( 2048, buffer.data(), 70*2048 + 100 ), 70*2048 + 100 );
+    QVERIFY( ::memcmp( buffer.constData(), mem->data.constData() + 2048, 70*2048 + 100 ) == 0 );
+}
+
+
+void Iso9660BackendTest::testEndOfData()
+{
+    MemoryBackend* mem = new MemoryBackend( 40 );
+    K3b::Iso9660CachingBackend cache( mem );
+    QVERIFY( cache.open() );
+
+    char buffer[2048*4];
+    QCOMPARE( cache.read( 38, buffer, 4 ), 2 );
+    QVERIFY( ::memcmp( buffer, mem->data.constData() + 38*2048, 2*2048 ) == 0 );
+    QCOMPARE( cache.readBytes( 40*2048 - 10, buffer, 100 ), 10 );
+    QCOMPARE( cache.read( 40, buffer, 1 ), -1 );
+}
+
+
+void Iso9660BackendTest::testEviction()
+{
+    // two blocks only
+    MemoryBackend* mem = new MemoryBackend( 1000 );
+    K3b::Iso9660CachingBackend cache( mem, 1 );
+    QVERIFY( cache.open() );
+
+    char buffer[2048];
+    const unsigned int sectors[] = { 0, 40, 0, 80, 0, 40 };
+    for( unsigned int i = 0; i < sizeof(sectors)/sizeof(sectors[0]); ++i ) {
+        QCOMPARE( cache.read( sectors[i], buffer, 1 ), 1 );
+        QVERIFY( ::memcmp( buffer, mem->data.constData() + sectors[i]*2048, 2048 ) == 0 );
+    }
+
+    // block 0 stays cached since it is used most recently, block 1 is evicted by block 2
+    QCOMPARE( mem->reads, 4 );
+}
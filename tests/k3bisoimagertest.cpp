@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bisoimagertest.h"
+#include "k3bisoimager.h"
+#include "k3bdatadoc.h"
+#include "k3bdiritem.h"
+#include "k3bfileitem.h"
+#include "k3bisooptions.h"
+
+#include <QFile>
+#include <QStringList>
+#include <QTest>
+
+QTEST_GUILESS_MAIN(IsoImagerTest)
+
+
+IsoImagerTest::IsoImagerTest()
+    : m_doc( 0 ),
+      m_dir( 0 ),
+      m_fileCount( 0 )
+{
+}
+
+
+void IsoImagerTest::init()
+{
+    m_dir = new QTemporaryDir;
+    QVERIFY( m_dir->isValid() );
+    m_doc = new K3b::DataDoc;
+    m_doc->newDocument();
+}
+
+
+void IsoImagerTest::cleanup()
+{
+    delete m_doc;
+    m_doc = 0;
+    delete m_dir;
+    m_dir = 0;
+}
+
+
+K3b::FileItem* IsoImagerTest::addFile( K3b::DirItem* dir, const QString& name )
+{
+    // the local names do not matter, only the names in the project
+    QFile file( m_dir->path() + QString( "/%1" ).arg( ++m_fileCount ) );
+    if( !file.open( QIODevice::WriteOnly ) )
+        return 0;
+    file.write( "data" );
+    file.close();
+
+    K3b::FileItem* item = new K3b::FileItem( file.fileName(), *m_doc, name );
+    dir->addDataItem( item );
+    return item;
+}
+
+
+K3b::DirItem* IsoImagerTest::addDir( K3b::DirItem* dir, const QString& name )
+{
+    K3b::DirItem* item = new K3b::DirItem( name );
+    dir->addDataItem( item );
+    return item;
+}
+
+
+QStringList IsoImagerTest::writeOrder() const
+{
+    QStringList names;
+    Q_FOREACH( K3b::FileItem* item, K3b::mkisofsWriteOrder( m_doc->root(), m_doc->isoOptions() ) )
+        names << item->k3bPath();
+    return names;
+}
+
+
+void IsoImagerTest::testWriteOrder()
+{
+    K3b::DirItem* root = m_doc->root();
+    addFile( root, "b.txt" );
+    K3b::DirItem* z = addDir( root, "z" );
+    addFile( z, "c" );
+    addFile( root, "a.txt" );
+    K3b::DirItem* sub = addDir( root, "sub" );
+    addFile( sub, "y" );
+    addFile( addDir( sub, "deeper" ), "x" );
+    addFile( root, "m" );
+
+    // the files of a folder come before its subfolders, all sorted by name
+    QCOMPARE( writeOrder(), QStringList()
+              << "a.txt" << "b.txt" << "m"
+              << "sub/y" << "sub/deeper/x"
+              << "z/c" );
+}
+
+
+void IsoImagerTest::testSortWeight()
+{
+    K3b::DirItem* root = m_doc->root();
+    addFile( root, "a" );
+    K3b::DirItem* z = addDir( root, "z" );
+    addFile( z, "c" )->setSortWeight( 10 );
+    addFile( z, "d" )->setSortWeight( 10 );
+    addFile( root, "b" )->setSortWeight( -5 );
+    addFile( root, "e" );
+
+    // equal weights keep the tree order
+    QCOMPARE( writeOrder(), QStringList()
+              << "z/c" << "z/d" << "a" << "e" << "b" );
+}
+
+
+void IsoImagerTest::testIsoNames()
+{
+    K3b::DirItem* root = m_doc->root();
+    addFile( root, "a-b" );
+    addFile( root, "ab" );
+    addFile( root, "a.b" );
+    addFile( root, "A_C" );
+
+    // A.B;1 < AB.;1 < A_B.;1 < A_C.;1: the dot sorts first and '-' becomes '_'
+    QCOMPARE( writeOrder(), QStringList()
+              << "a.b" << "ab" << "a-b" << "A_C" );
+}
+
+
+void IsoImagerTest::testUntranslatedNames()
+{
+    K3b::IsoOptions options = m_doc->isoOptions();
+    options.setISOuntranslatedFilenames( true );
+    m_doc->setIsoOptions( options );
+
+    K3b::DirItem* root = m_doc->root();
+    addFile( root, "b" );
+    addFile( root, "a-b" );
+    addFile( root, "B" );
+
+    // the names are compared as they are
+    QCOMPARE( writeOrder(), QStringList()
+              << "B" << "a-b" << "b" );
+}
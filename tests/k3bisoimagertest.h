@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef K3B_ISO_IMAGER_TEST_H
+#define K3B_ISO_IMAGER_TEST_H
+
+#include <QObject>
+#include <QTemporaryDir>
+
+namespace K3b {
+    class DataDoc;
+    class DirItem;
+    class FileItem;
+}
+
+class IsoImagerTest : public QObject
+{
+    Q_OBJECT
+public:
+    IsoImagerTest();
+private slots:
+    void init();
+    void cleanup();
+    void testWriteOrder();
+    void testSortWeight();
+    void testIsoNames();
+    void testUntranslatedNames();
+private:
+    K3b::FileItem* addFile( K3b::DirItem* dir, const QString& name );
+    K3b::DirItem* addDir( K3b::DirItem* dir, const QString& name );
+    QStringList writeOrder() const;
+    K3b::DataDoc* m_doc;
+    QTemporaryDir* m_dir;
+    int m_fileCount;
+};
+
+#endif // K3B_ISO_IMAGER_TEST_H
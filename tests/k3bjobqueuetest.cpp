@@ -0,0 +1,314 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bjobqueuetest.h"
+#include "k3bjobqueue.h"
+#include "k3bcore.h"
+#include "k3bjob.h"
+
+#include <QList>
+#include <QPointer>
+#include <QSignalSpy>
+#include <QTest>
+
+QTEST_GUILESS_MAIN(JobQueueTest)
+
+using K3b::JobQueue;
+
+namespace {
+    /**
+     * Runs until the test finishes it. With "wait" set it asks for a medium
+     * which is never inserted.
+     */
+    class FakeJob : public K3b::Job
+    {
+    public:
+        FakeJob( const QVariantMap& description, K3b::JobHandler* handler, QObject* parent )
+            : K3b::Job( handler, parent ),
+              m_description( description ) {
+        }
+
+        QVariantMap description() const { return m_description; }
+
+        void finish( bool success ) {
+            jobFinished( success );
+        }
+
+        void start() {
+            jobStarted();
+            if( m_description.value( "wait" ).toBool() &&
+                waitForMedium( 0, K3b::Device::STATE_EMPTY, K3b::Device::MEDIA_WRITABLE ) == K3b::Device::MEDIA_UNKNOWN ) {
+                emit canceled();
+                jobFinished( false );
+            }
+        }
+
+        void cancel() {
+            emit canceled();
+            jobFinished( false );
+        }
+
+    private:
+        QVariantMap m_description;
+    };
+
+    QList<QPointer<FakeJob> > s_jobs;
+
+    FakeJob* lastJob()
+    {
+        return s_jobs.isEmpty() ? 0 : s_jobs.last().data();
+    }
+
+    JobQueue::JobType fakeJobType()
+    {
+        JobQueue::JobType type;
+        type.create = []( const QVariantMap& description, K3b::Device::Device*, K3b::Device::Device*,
+                          K3b::JobHandler* handler, QObject* parent ) -> K3b::Job* {
+            FakeJob* job = new FakeJob( description, handler, parent );
+            s_jobs.append( job );
+            return job;
+        };
+        type.tempSpace = []( const QVariantMap& description, K3b::Device::Device* ) -> KIO::filesize_t {
+            return description.value( "size", 0 ).toULongLong();
+        };
+        return type;
+    }
+
+    QVariantMap fakeJob( KIO::filesize_t size = 0 )
+    {
+        QVariantMap description;
+        description.insert( "type", "fake" );
+        if( size > 0 )
+            description.insert( "size", size );
+        return description;
+    }
+
+    QVariantMap waitingJob()
+    {
+        QVariantMap description = fakeJob();
+        description.insert( "wait", true );
+        return description;
+    }
+}
+
+JobQueueTest::JobQueueTest()
+    : m_core( new K3b::Core( this ) )
+{
+}
+
+void JobQueueTest::init()
+{
+    s_jobs.clear();
+}
+
+void JobQueueTest::testInvalidType()
+{
+    JobQueue queue;
+    QVariantMap description;
+    description.insert( "type", "nope" );
+    QString error;
+    QCOMPARE( queue.enqueue( description, &error ), -1 );
+    QVERIFY( !error.isEmpty() );
+}
+
+void JobQueueTest::testScheduling()
+{
+    JobQueue queue;
+    queue.registerJobType( "fake", fakeJobType() );
+    QSignalSpy finishedSpy( &queue, SIGNAL(jobFinished(int,bool)) );
+
+    // jobs which need no drives and no temp space all run at once
+    const int first = queue.enqueue( fakeJob() );
+    const int second = queue.enqueue( fakeJob() );
+    QVERIFY( first > 0 );
+    QVERIFY( second > first );
+    QCOMPARE( queue.job( first ).state, JobQueue::Queued );
+
+    QTRY_COMPARE( s_jobs.count(), 2 );
+    QCOMPARE( queue.job( first ).state, JobQueue::Running );
+    QCOMPARE( queue.job( second ).state, JobQueue::Running );
+
+    s_jobs[0]->finish( true );
+    QCOMPARE( queue.job( first ).state, JobQueue::Succeeded );
+    QCOMPARE( queue.job( second ).state, JobQueue::Running );
+
+    s_jobs[1]->finish( false );
+    QCOMPARE( queue.job( second ).state, JobQueue::Failed );
+
+    QCOMPARE( finishedSpy.count(), 2 );
+    QCOMPARE( finishedSpy.at( 0 ).at( 1 ).toBool(), true );
+    QCOMPARE( finishedSpy.at( 1 ).at( 1 ).toBool(), false );
+
+    queue.clearFinished();
+    QVERIFY( queue.jobs().isEmpty() );
+}
+
+void JobQueueTest::testCopies()
+{
+    JobQueue queue;
+    queue.registerJobType( "fake", fakeJobType() );
+    QSignalSpy finishedSpy( &queue, SIGNAL(jobFinished(int,bool)) );
+
+    QVariantMap description = fakeJob();
+    description.insert( "copies", 3 );
+    const int id = queue.enqueue( description );
+
+    // each copy is written by a job of its own
+    for( int i = 1; i <= 3; ++i ) {
+        QTRY_COMPARE( s_jobs.count(), i );
+        QCOMPARE( lastJob()->description().value( "copies" ).toInt(), 1 );
+        QCOMPARE( queue.job( id ).state, JobQueue::Running );
+        lastJob()->finish( true );
+    }
+
+    QCOMPARE( queue.job( id ).state, JobQueue::Succeeded );
+    QCOMPARE( finishedSpy.count(), 1 );
+    QTest::qWait( 50 );
+    QCOMPARE( s_jobs.count(), 3 );
+}
+
+void JobQueueTest::testCancelQueued()
+{
+    JobQueue queue;
+    queue.registerJobType( "fake", fakeJobType() );
+    queue.setTempBudget( 100 );
+    queue.setMaxTempJobs( 1 );
+
+    const int running = queue.enqueue( fakeJob( 10 ) );
+    const int queued = queue.enqueue( fakeJob( 10 ) );
+    QTRY_COMPARE( queue.job( running ).state, JobQueue::Running );
+    QCOMPARE( queue.job( queued ).state, JobQueue::Queued );
+
+    QVERIFY( queue.cancel( queued ) );
+    QCOMPARE( queue.job( queued ).state, JobQueue::Canceled );
+
+    QVERIFY( queue.cancel( running ) );
+    QCOMPARE( queue.job( running ).state, JobQueue::Canceled );
+
+    QTest::qWait( 50 );
+    QCOMPARE( s_jobs.count(), 1 );
+}
+
+void JobQueueTest::testTempBudget()
+{
+    JobQueue queue;
+    queue.registerJobType( "fake", fakeJobType() );
+    queue.setTempBudget( 100 );
+    QCOMPARE( queue.tempBudget(), KIO::filesize_t( 100 ) );
+
+    const int first = queue.enqueue( fakeJob( 60 ) );
+    const int second = queue.enqueue( fakeJob( 60 ) );
+    const int noTemp = queue.enqueue( fakeJob() );
+
+    QTRY_COMPARE( s_jobs.count(), 2 );
+    QCOMPARE( queue.job( first ).state, JobQueue::Running );
+    QCOMPARE( queue.job( second ).state, JobQueue::Queued );
+    QCOMPARE( queue.job( noTemp ).state, JobQueue::Running );
+
+    // the space is given back once the job is done
+    s_jobs[0]->finish( true );
+    QTRY_COMPARE( queue.job( second ).state, JobQueue::Running );
+    QCOMPARE( s_jobs.count(), 3 );
+}
+
+void JobQueueTest::testTempSpaceNeverFits()
+{
+    JobQueue queue;
+    queue.registerJobType( "fake", fakeJobType() );
+    queue.setTempBudget( 100 );
+
+    const int id = queue.enqueue( fakeJob( 200 ) );
+    QTRY_COMPARE( queue.job( id ).state, JobQueue::Failed );
+    QVERIFY( !queue.job( id ).error.isEmpty() );
+    QVERIFY( s_jobs.isEmpty() );
+}
+
+void JobQueueTest::testMaxTempJobs()
+{
+    JobQueue queue;
+    queue.registerJobType( "fake", fakeJobType() );
+    queue.setTempBudget( 1000 );
+
+    const int first = queue.enqueue( fakeJob( 10 ) );
+    const int second = queue.enqueue( fakeJob( 10 ) );
+    const int third = queue.enqueue( fakeJob( 10 ) );
+
+    // two jobs use the temp folder at a time by default
+    QTRY_COMPARE( s_jobs.count(), 2 );
+    QCOMPARE( queue.job( first ).state, JobQueue::Running );
+    QCOMPARE( queue.job( second ).state, JobQueue::Running );
+    QCOMPARE( queue.job( third ).state, JobQueue::Queued );
+
+    s_jobs[1]->finish( true );
+    QTRY_COMPARE( queue.job( third ).state, JobQueue::Running );
+}
+
+void JobQueueTest::testMediumTimeout()
+{
+    JobQueue queue;
+    queue.registerJobType( "fake", fakeJobType() );
+    queue.setMediumTimeout( 1 );
+    QSignalSpy finishedSpy( &queue, SIGNAL(jobFinished(int,bool)) );
+
+    const int id = queue.enqueue( waitingJob() );
+
+    // the job is stopped and waits in the queue
+    QTRY_COMPARE( s_jobs.count(), 1 );
+    QTRY_VERIFY( !lastJob() );
+    QCOMPARE( queue.job( id ).state, JobQueue::Queued );
+    QCOMPARE( finishedSpy.count(), 0 );
+
+    QTRY_COMPARE_WITH_TIMEOUT( queue.job( id ).state, JobQueue::Failed, 10000 );
+    QVERIFY( !queue.job( id ).error.isEmpty() );
+    QCOMPARE( finishedSpy.count(), 1 );
+
+    // the job is not restarted without its medium
+    QCOMPARE( s_jobs.count(), 1 );
+}
+
+void JobQueueTest::testSeveralJobsWaitForMedia()
+{
+    JobQueue queue;
+    queue.registerJobType( "fake", fakeJobType() );
+    queue.setMediumTimeout( 1 );
+
+    const int firstWaiting = queue.enqueue( waitingJob() );
+    const int secondWaiting = queue.enqueue( waitingJob() );
+    const int other = queue.enqueue( fakeJob() );
+
+    QTRY_COMPARE( s_jobs.count(), 3 );
+    QTRY_COMPARE( queue.job( firstWaiting ).state, JobQueue::Queued );
+    QTRY_COMPARE( queue.job( secondWaiting ).state, JobQueue::Queued );
+
+    // waiting jobs do not keep the others from running
+    QCOMPARE( queue.job( other ).state, JobQueue::Running );
+    s_jobs[2]->finish( true );
+    QCOMPARE( queue.job( other ).state, JobQueue::Succeeded );
+
+    QTRY_COMPARE_WITH_TIMEOUT( queue.job( firstWaiting ).state, JobQueue::Failed, 10000 );
+    QTRY_COMPARE_WITH_TIMEOUT( queue.job( secondWaiting ).state, JobQueue::Failed, 10000 );
+}
+
+void JobQueueTest::testCancelWaiting()
+{
+    JobQueue queue;
+    queue.registerJobType( "fake", fakeJobType() );
+    queue.setMediumTimeout( 600 );
+
+    const int id = queue.enqueue( waitingJob() );
+    QTRY_COMPARE( s_jobs.count(), 1 );
+    QTRY_VERIFY( !lastJob() );
+    QCOMPARE( queue.job( id ).state, JobQueue::Queued );
+
+    QVERIFY( queue.cancel( id ) );
+    QCOMPARE( queue.job( id ).state, JobQueue::Canceled );
+}
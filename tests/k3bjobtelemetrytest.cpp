@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bjobtelemetrytest.h"
+#include "k3bjobtelemetry.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTest>
+
+QTEST_GUILESS_MAIN(JobTelemetryTest)
+
+using K3b::JobTelemetry;
+
+JobTelemetryTest::JobTelemetryTest()
+{
+}
+
+void JobTelemetryTest::testStages()
+{
+    JobTelemetry telemetry;
+    const int copy = telemetry.addStage("CdCopyJob");
+    const int reader = telemetry.addStage("DataTrackReader", copy);
+    const int writer = telemetry.addStage("CdrecordWriter", copy);
+    const int writer2 = telemetry.addStage("CdrecordWriter", copy);
+
+    QCOMPARE(telemetry.numStages(), 4);
+    QCOMPARE(telemetry.stageName(reader), QString("DataTrackReader"));
+    QCOMPARE(telemetry.stageName(writer), QString("CdrecordWriter"));
+    QCOMPARE(telemetry.stageName(writer2), QString("CdrecordWriter#2"));
+    QCOMPARE(telemetry.parentStage(copy), -1);
+    QCOMPARE(telemetry.parentStage(writer), copy);
+
+    for (int i = telemetry.numStages(); i < JobTelemetry::MaxStages; ++i)
+        QVERIFY(telemetry.addStage("Job") >= 0);
+    QCOMPARE(telemetry.addStage("Job"), -1);
+
+    telemetry.start();
+    QCOMPARE(telemetry.numStages(), 0);
+}
+
+void JobTelemetryTest::testRecord()
+{
+    JobTelemetry telemetry;
+    const int stage = telemetry.addStage("CdrecordWriter");
+
+    telemetry.record(stage, JobTelemetry::FifoFill, 97);
+    telemetry.record(stage, JobTelemetry::DeviceBuffer, 80);
+    telemetry.record(stage, JobTelemetry::WriteSpeed, 7056);
+    telemetry.record(stage, JobTelemetry::Retry, 3);
+
+    // unknown stages are ignored
+    telemetry.record(stage + 1, JobTelemetry::FifoFill, 50);
+    telemetry.record(-1, JobTelemetry::FifoFill, 50);
+
+    const QList<JobTelemetry::Sample> samples = telemetry.samples();
+    QCOMPARE(samples.count(), 4);
+    QCOMPARE(samples[0].stage, stage);
+    QCOMPARE(samples[0].kind, JobTelemetry::FifoFill);
+    QCOMPARE(samples[0].value, qint64(97));
+    QCOMPARE(samples[1].kind, JobTelemetry::DeviceBuffer);
+    QCOMPARE(samples[2].kind, JobTelemetry::WriteSpeed);
+    QCOMPARE(samples[2].value, qint64(7056));
+    QCOMPARE(samples[3].kind, JobTelemetry::Retry);
+    for (int i = 1; i < samples.count(); ++i)
+        QVERIFY(samples[i-1].timestamp <= samples[i].timestamp);
+}
+
+void JobTelemetryTest::testBytesThrottled()
+{
+    JobTelemetry telemetry;
+    telemetry.setSampleInterval(10000);
+    const int stage = telemetry.addStage("DataTrackReader");
+    const int idle = telemetry.addStage("Idle");
+
+    for (int i = 1; i <= 1000; ++i)
+        telemetry.record(stage, JobTelemetry::Bytes, qint64(i) * 2048);
+
+    QList<JobTelemetry::Sample> samples = telemetry.samples();
+    QCOMPARE(samples.count(), 1);
+    QCOMPARE(samples[0].kind, JobTelemetry::Bytes);
+    QCOMPARE(samples[0].value, qint64(2048));
+
+    // flushing records the last value once, stages without data are skipped
+    telemetry.flush(stage);
+    telemetry.flush(stage);
+    telemetry.flush(idle);
+    samples = telemetry.samples();
+    QCOMPARE(samples.count(), 2);
+    QCOMPARE(samples[1].value, qint64(1000) * 2048);
+}
+
+void JobTelemetryTest::testStall()
+{
+    JobTelemetry telemetry;
+    telemetry.setSampleInterval(0);
+    telemetry.setStallThreshold(50);
+    const int stage = telemetry.addStage("NativeWriter");
+
+    telemetry.record(stage, JobTelemetry::Bytes, 1024);
+    QTest::qSleep(100);
+
+    // no progress, no stall
+    telemetry.record(stage, JobTelemetry::Bytes, 1024);
+    telemetry.record(stage, JobTelemetry::Bytes, 2048);
+
+    const QList<JobTelemetry::Sample> samples = telemetry.samples();
+    QCOMPARE(samples.count(), 4);
+    QCOMPARE(samples[2].kind, JobTelemetry::Stall);
+    QVERIFY(samples[2].value >= 50);
+    QCOMPARE(samples[3].kind, JobTelemetry::Bytes);
+    QCOMPARE(samples[3].value, qint64(2048));
+}
+
+void JobTelemetryTest::testRingOverflow()
+{
+    JobTelemetry telemetry;
+    const int stage = telemetry.addStage("DuplicationJob");
+
+    for (int i = 0; i < JobTelemetry::RingSize + 10; ++i)
+        telemetry.record(stage, JobTelemetry::FifoFill, i);
+
+    const QList<JobTelemetry::Sample> samples = telemetry.samples();
+    QCOMPARE(samples.count(), int(JobTelemetry::RingSize));
+    QCOMPARE(samples.first().value, qint64(10));
+    QCOMPARE(samples.last().value, qint64(JobTelemetry::RingSize + 9));
+    QCOMPARE(telemetry.droppedSamples(), quint64(10));
+}
+
+void JobTelemetryTest::testSince()
+{
+    JobTelemetry telemetry;
+    const int stage = telemetry.addStage("CdrecordWriter");
+
+    telemetry.record(stage, JobTelemetry::FifoFill, 1);
+    QTest::qSleep(5);
+    telemetry.record(stage, JobTelemetry::FifoFill, 2);
+
+    const QList<JobTelemetry::Sample> all = telemetry.samples();
+    QCOMPARE(all.count(), 2);
+
+    const QList<JobTelemetry::Sample> newer = telemetry.samples(all[0].timestamp);
+    QCOMPARE(newer.count(), 1);
+    QCOMPARE(newer[0].value, qint64(2));
+    QVERIFY(telemetry.samples(all[1].timestamp).isEmpty());
+}
+
+void JobTelemetryTest::testJsonLines()
+{
+    JobTelemetry telemetry;
+    telemetry.start("Copying CD");
+    const int copy = telemetry.addStage("CdCopyJob");
+    const int writer = telemetry.addStage("CdrecordWriter", copy);
+    telemetry.record(writer, JobTelemetry::FifoFill, 97);
+    telemetry.record(copy, JobTelemetry::Bytes, 1048576);
+
+    const QList<QByteArray> lines = telemetry.toJsonLines().split('\n');
+    QCOMPARE(lines.count(), 4);
+    QVERIFY(lines[3].isEmpty());
+
+    const QJsonObject header = QJsonDocument::fromJson(lines[0]).object();
+    QCOMPARE(header.value("kind").toString(), QString("start"));
+    QCOMPARE(header.value("job").toString(), QString("Copying CD"));
+    QCOMPARE(header.value("dropped").toInt(), 0);
+    QVERIFY(!header.value("time").toString().isEmpty());
+
+    const QJsonObject fifo = QJsonDocument::fromJson(lines[1]).object();
+    QCOMPARE(fifo.value("stage").toString(), QString("CdrecordWriter"));
+    QCOMPARE(fifo.value("parent").toString(), QString("CdCopyJob"));
+    QCOMPARE(fifo.value("kind").toString(), QString("fifo"));
+    QCOMPARE(fifo.value("value").toInt(), 97);
+    QVERIFY(fifo.contains("t"));
+
+    const QJsonObject bytes = QJsonDocument::fromJson(lines[2]).object();
+    QCOMPARE(bytes.value("stage").toString(), QString("CdCopyJob"));
+    QVERIFY(!bytes.contains("parent"));
+    QCOMPARE(bytes.value("kind").toString(), QString("bytes"));
+    QCOMPARE(bytes.value("value").toDouble(), 1048576.0);
+}
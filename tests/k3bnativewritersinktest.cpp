@@ -0,0 +1,287 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bnativewritersinktest.h"
+#include "k3bnativewritersink.h"
+#include "k3bfanoutbuffer.h"
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QStringList>
+#include <QTest>
+
+QTEST_GUILESS_MAIN(NativeWriterSinkTest)
+
+using K3b::NativeWriterSink;
+
+namespace {
+    /**
+     * A drive which does not exist. The sink calls it from the buffer thread.
+     */
+    class FakeDriveSink : public NativeWriterSink
+    {
+    public:
+        FakeDriveSink()
+            : busy( 0 ),
+              ready( 1 ) {
+        }
+
+        QByteArray written() const {
+            QMutexLocker locker( &mutex );
+            return data;
+        }
+
+        QList<unsigned long> writtenLbas() const {
+            QMutexLocker locker( &mutex );
+            return lbas;
+        }
+
+        QStringList sentCommands() const {
+            QMutexLocker locker( &mutex );
+            return commands;
+        }
+
+        // the drive reports "long write in progress"
+        QAtomicInt busy;
+        QAtomicInt ready;
+
+    protected:
+        int writeSectors( const unsigned char* buf, unsigned long lba, int sectors ) {
+            if( busy.load() )
+                return 0x020408;
+            QMutexLocker locker( &mutex );
+            lbas.append( lba );
+            data.append( reinterpret_cast<const char*>( buf ), sectors*2048 );
+            return 0;
+        }
+
+        bool flushCache() {
+            QMutexLocker locker( &mutex );
+            commands.append( "flush" );
+            return true;
+        }
+
+        bool closeTrackSession( int function, int trackNumber ) {
+            QMutexLocker locker( &mutex );
+            commands.append( QString( "close %1 %2" ).arg( function ).arg( trackNumber ) );
+            return true;
+        }
+
+        bool unitReady() {
+            return ready.load();
+        }
+
+        bool readBufferCapacity( long long& length, long long& available ) {
+            length = 100;
+            available = 25;
+            return true;
+        }
+
+    private:
+        mutable QMutex mutex;
+        QByteArray data;
+        QList<unsigned long> lbas;
+        QStringList commands;
+    };
+
+    QByteArray testData( int size )
+    {
+        QByteArray data( size, 0 );
+        for( int i = 0; i < size; ++i )
+            data[i] = char( i % 251 + 1 );
+        return data;
+    }
+}
+
+NativeWriterSinkTest::NativeWriterSinkTest()
+{
+}
+
+void NativeWriterSinkTest::testWriteTrack()
+{
+    // two full blocks of 32 sectors and an incomplete last sector
+    const int size = 64*2048 + 100;
+    const QByteArray data = testData( size );
+
+    FakeDriveSink sink;
+    sink.prepare( size, 0x2 );
+    QCOMPARE( sink.state(), NativeWriterSink::StateWriting );
+
+    K3b::FanOutBuffer buffer( 1024*1024 );
+    buffer.addSink( &sink );
+    QVERIFY( buffer.open() );
+    QCOMPARE( buffer.write( data ), qint64( size ) );
+    buffer.close();
+
+    QTRY_COMPARE( sink.state(), NativeWriterSink::StateDone );
+    QCOMPARE( sink.error(), NativeWriterSink::ErrorNone );
+    QCOMPARE( sink.sectorsWritten(), qint64( 65 ) );
+    QCOMPARE( sink.writtenLbas(), QList<unsigned long>() << 0 << 32 << 64 );
+    QCOMPARE( sink.deviceBufferFill(), 75 );
+
+    const QByteArray written = sink.written();
+    QCOMPARE( written.size(), 65*2048 );
+    QCOMPARE( written.left( size ), data );
+    QCOMPARE( written.mid( size ), QByteArray( 65*2048 - size, 0 ) );
+
+    QCOMPARE( sink.sentCommands(), QStringList() << "flush" << "close 1 1" << "close 2 0" );
+}
+
+void NativeWriterSinkTest::testOverwriteMedium()
+{
+    FakeDriveSink sink;
+    sink.prepare( 2048, 0 );
+
+    K3b::FanOutBuffer buffer( 1024*1024 );
+    buffer.addSink( &sink );
+    QVERIFY( buffer.open() );
+    buffer.write( testData( 2048 ) );
+    buffer.close();
+
+    QTRY_COMPARE( sink.state(), NativeWriterSink::StateDone );
+    QCOMPARE( sink.sentCommands(), QStringList() << "flush" );
+}
+
+void NativeWriterSinkTest::testTooMuchData()
+{
+    FakeDriveSink sink;
+    sink.prepare( 2048, 0 );
+
+    K3b::FanOutBuffer buffer( 1024*1024 );
+    buffer.addSink( &sink );
+    QVERIFY( buffer.open() );
+    buffer.write( testData( 4096 ) );
+    buffer.close();
+
+    QTRY_COMPARE( sink.state(), NativeWriterSink::StateFailed );
+    QCOMPARE( sink.error(), NativeWriterSink::ErrorTooMuchData );
+    QVERIFY( sink.writtenLbas().isEmpty() );
+}
+
+void NativeWriterSinkTest::testTooLittleData()
+{
+    FakeDriveSink sink;
+    sink.prepare( 4096, 0 );
+
+    K3b::FanOutBuffer buffer( 1024*1024 );
+    buffer.addSink( &sink );
+    QVERIFY( buffer.open() );
+    buffer.write( testData( 2048 ) );
+    buffer.close();
+
+    QTRY_COMPARE( buffer.activeSinks(), 0 );
+    QCOMPARE( sink.state(), NativeWriterSink::StateWriting );
+
+    sink.endOfData();
+    QCOMPARE( sink.state(), NativeWriterSink::StateFailed );
+    QCOMPARE( sink.error(), NativeWriterSink::ErrorTooLittleData );
+}
+
+void NativeWriterSinkTest::testBusyDrive()
+{
+    FakeDriveSink sink;
+    sink.busy.store( 1 );
+    sink.prepare( 2048, 0 );
+
+    K3b::FanOutBuffer buffer( 1024*1024 );
+    buffer.addSink( &sink );
+    QVERIFY( buffer.open() );
+    buffer.write( testData( 2048 ) );
+    buffer.close();
+
+    QTRY_VERIFY( sink.writeRetries() > 0 );
+    QCOMPARE( sink.state(), NativeWriterSink::StateWriting );
+
+    // the write is retried until the drive accepts it
+    sink.busy.store( 0 );
+    QTRY_COMPARE( sink.state(), NativeWriterSink::StateDone );
+    QCOMPARE( sink.writtenLbas(), QList<unsigned long>() << 0 );
+}
+
+void NativeWriterSinkTest::testAbortBeforeWrite()
+{
+    FakeDriveSink sink;
+    sink.prepare( 2048, 0 );
+    sink.abort();
+    QVERIFY( sink.abortRequested() );
+
+    K3b::FanOutBuffer buffer( 1024*1024 );
+    buffer.addSink( &sink );
+    QVERIFY( buffer.open() );
+    buffer.write( testData( 2048 ) );
+
+    QTRY_COMPARE( sink.state(), NativeWriterSink::StateFailed );
+    QCOMPARE( sink.error(), NativeWriterSink::ErrorAborted );
+    QVERIFY( sink.writtenLbas().isEmpty() );
+    QTRY_VERIFY( buffer.hasSinkFailed( 0 ) );
+
+    // preparing the next track resets the abort
+    sink.prepare( 2048, 0 );
+    QVERIFY( !sink.abortRequested() );
+}
+
+void NativeWriterSinkTest::testAbortDuringWrite()
+{
+    // without the abort the sink would retry for 30 seconds
+    FakeDriveSink sink;
+    sink.busy.store( 1 );
+    sink.prepare( 64*2048, 0 );
+
+    K3b::FanOutBuffer buffer( 1024*1024 );
+    buffer.addSink( &sink );
+    QVERIFY( buffer.open() );
+    buffer.write( testData( 64*2048 ) );
+
+    QTRY_VERIFY( sink.writeRetries() > 0 );
+
+    QElapsedTimer timer;
+    timer.start();
+    sink.abort();
+    buffer.stop();
+    QVERIFY( timer.elapsed() < 100 );
+
+    QTRY_COMPARE_WITH_TIMEOUT( sink.state(), NativeWriterSink::StateFailed, 2000 );
+    QCOMPARE( sink.error(), NativeWriterSink::ErrorAborted );
+    QTRY_VERIFY_WITH_TIMEOUT( !buffer.running(), 2000 );
+    QVERIFY( sink.writtenLbas().isEmpty() );
+}
+
+void NativeWriterSinkTest::testAbortDuringFlush()
+{
+    // without the abort the sink would wait 15 minutes for the drive
+    FakeDriveSink sink;
+    sink.ready.store( 0 );
+    sink.prepare( 2048, 0x6 );
+
+    K3b::FanOutBuffer buffer( 1024*1024 );
+    buffer.addSink( &sink );
+    QVERIFY( buffer.open() );
+    buffer.write( testData( 2048 ) );
+
+    QTRY_COMPARE( sink.state(), NativeWriterSink::StateFlushing );
+
+    QElapsedTimer timer;
+    timer.start();
+    sink.abort();
+    buffer.stop();
+    QVERIFY( timer.elapsed() < 100 );
+
+    QTRY_COMPARE_WITH_TIMEOUT( sink.state(), NativeWriterSink::StateFailed, 2000 );
+    QCOMPARE( sink.error(), NativeWriterSink::ErrorAborted );
+    QTRY_VERIFY_WITH_TIMEOUT( !buffer.running(), 2000 );
+
+    // the track is not closed after an abort
+    QCOMPARE( sink.sentCommands(), QStringList() << "flush" );
+}
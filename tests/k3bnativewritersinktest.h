@@ -0,0 +1,34 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef K3B_NATIVE_WRITER_SINK_TEST_H
+#define K3B_NATIVE_WRITER_SINK_TEST_H
+
+#include <QObject>
+
+class NativeWriterSinkTest : public QObject
+{
+    Q_OBJECT
+public:
+    NativeWriterSinkTest();
+private slots:
+    void testWriteTrack();
+    void testOverwriteMedium();
+    void testTooMuchData();
+    void testTooLittleData();
+    void testBusyDrive();
+    void testAbortBeforeWrite();
+    void testAbortDuringWrite();
+    void testAbortDuringFlush();
+};
+
+#endif // K3B_NATIVE_WRITER_SINK_TEST_H
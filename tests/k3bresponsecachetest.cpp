@@ -0,0 +1,286 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#include "k3bresponsecachetest.h"
+#include "k3bresponsecache.h"
+#include "k3bscsicommand.h"
+
+#include <QTest>
+
+QTEST_GUILESS_MAIN(ResponseCacheTest)
+
+using K3b::Device::ResponseCache;
+
+namespace {
+    QByteArray cdb( unsigned char command, int size = 10 )
+    {
+        QByteArray c( size, 0 );
+        c[0] = char( command );
+        return c;
+    }
+
+    QByteArray discStructure( unsigned char format )
+    {
+        QByteArray c = cdb( K3b::Device::MMC_READ_DISC_STRUCTURE, 12 );
+        c[7] = char( format );
+        return c;
+    }
+
+    QByteArray response( char fill )
+    {
+        return QByteArray( 32, fill );
+    }
+
+    /**
+     * Caches a disc information response in \p cache.
+     */
+    void fillCache( ResponseCache& cache )
+    {
+        const QByteArray data = response( 'd' );
+        quint64 generation = 0;
+        char buf[32];
+        cache.lookup( cdb( K3b::Device::MMC_READ_DISC_INFORMATION ), buf, sizeof(buf), generation );
+        cache.store( cdb( K3b::Device::MMC_READ_DISC_INFORMATION ), data.constData(), data.size(), generation );
+    }
+
+    bool isCached( ResponseCache& cache )
+    {
+        quint64 generation = 0;
+        char buf[32];
+        return cache.lookup( cdb( K3b::Device::MMC_READ_DISC_INFORMATION ), buf, sizeof(buf), generation );
+    }
+
+    QByteArray mediaEvent( bool noEventAvailable, int notificationClass, int eventCode )
+    {
+        QByteArray data( 8, 0 );
+        data[1] = 6;
+        data[2] = char( ( noEventAvailable ? 0x80 : 0 ) | notificationClass );
+        data[3] = 0x10;
+        data[4] = char( eventCode );
+        return data;
+    }
+}
+
+
+ResponseCacheTest::ResponseCacheTest()
+{
+}
+
+
+void ResponseCacheTest::testCacheable_data()
+{
+    QTest::addColumn<QByteArray>( "cdb" );
+    QTest::addColumn<bool>( "cacheable" );
+
+    QTest::newRow( "disc information" ) << cdb( K3b::Device::MMC_READ_DISC_INFORMATION ) << true;
+    QTest::newRow( "track information" ) << cdb( K3b::Device::MMC_READ_TRACK_INFORMATION ) << true;
+    QTest::newRow( "toc" ) << cdb( K3b::Device::MMC_READ_TOC_PMA_ATIP ) << true;
+    QTest::newRow( "configuration" ) << cdb( K3b::Device::MMC_GET_CONFIGURATION ) << true;
+    QTest::newRow( "capacity" ) << cdb( K3b::Device::MMC_READ_CAPACITY ) << true;
+    QTest::newRow( "physical format" ) << discStructure( 0x00 ) << true;
+    QTest::newRow( "disc key" ) << discStructure( 0x02 ) << false;
+    QTest::newRow( "aacs" ) << discStructure( 0x83 ) << false;
+    QTest::newRow( "read 10" ) << cdb( K3b::Device::MMC_READ_10 ) << false;
+    QTest::newRow( "write 10" ) << cdb( K3b::Device::MMC_WRITE_10 ) << false;
+    QTest::newRow( "event status" ) << cdb( K3b::Device::MMC_GET_EVENT_STATUS_NOTIFICATION ) << false;
+    QTest::newRow( "empty" ) << QByteArray() << false;
+}
+
+
+void ResponseCacheTest::testCacheable()
+{
+    QFETCH( QByteArray, cdb );
+    QFETCH( bool, cacheable );
+    QCOMPARE( ResponseCache::isCacheable( cdb ), cacheable );
+}
+
+
+void ResponseCacheTest::testHit()
+{
+    ResponseCache cache;
+    QVERIFY( !isCached( cache ) );
+    fillCache( cache );
+
+    quint64 generation = 0;
+    char buf[32];
+    QVERIFY( cache.lookup( cdb( K3b::Device::MMC_READ_DISC_INFORMATION ), buf, sizeof(buf), generation ) );
+    QCOMPARE( QByteArray( buf, sizeof(buf) ), response( 'd' ) );
+
+    // the transfer length is part of the key
+    QVERIFY( !cache.lookup( cdb( K3b::Device::MMC_READ_DISC_INFORMATION ), buf, 16, generation ) );
+
+    const ResponseCache::Statistics stats = cache.statistics();
+    QCOMPARE( stats.hits, quint64( 1 ) );
+    QCOMPARE( stats.misses, quint64( 3 ) );
+    QCOMPARE( stats.invalidations, quint64( 0 ) );
+}
+
+
+void ResponseCacheTest::testKeptByReadCommands()
+{
+    ResponseCache cache;
+    fillCache( cache );
+    const quint64 generation = cache.generation();
+
+    cache.commandFinished( cdb( K3b::Device::MMC_READ_10 ), true, 0, 0, 0, 0 );
+    cache.commandFinished( cdb( K3b::Device::MMC_INQUIRY, 6 ), true, 0, 0, 0, 0 );
+    cache.commandFinished( cdb( K3b::Device::MMC_SET_SPEED, 12 ), true, 0, 0, 0, 0 );
+
+    // probing unsupported commands or fields says nothing about the medium
+    cache.commandFinished( cdb( K3b::Device::MMC_READ_DISC_STRUCTURE, 12 ), false, 0x5, 0x24, 0, 0 );
+    cache.commandFinished( cdb( K3b::Device::MMC_READ_10 ), false, 0x3, 0x11, 0, 0 );
+
+    QCOMPARE( cache.generation(), generation );
+    QVERIFY( isCached( cache ) );
+}
+
+
+void ResponseCacheTest::testInvalidatedByCommand_data()
+{
+    QTest::addColumn<int>( "command" );
+
+    QTest::newRow( "write 10" ) << int( K3b::Device::MMC_WRITE_10 );
+    QTest::newRow( "blank" ) << int( K3b::Device::MMC_BLANK );
+    QTest::newRow( "format unit" ) << int( K3b::Device::MMC_FORMAT_UNIT );
+    QTest::newRow( "close track" ) << int( K3b::Device::MMC_CLOSE_TRACK_SESSION );
+    QTest::newRow( "load/unload" ) << int( K3b::Device::MMC_LOAD_UNLOAD_MEDIUM );
+    QTest::newRow( "mode select" ) << int( K3b::Device::MMC_MODE_SELECT );
+    QTest::newRow( "vendor specific" ) << 0xEA;
+}
+
+
+void ResponseCacheTest::testInvalidatedByCommand()
+{
+    QFETCH( int, command );
+
+    ResponseCache cache;
+    fillCache( cache );
+    const quint64 generation = cache.generation();
+
+    // even if the command fails it might have touched the medium
+    cache.commandFinished( cdb( command ), false, 0x5, 0x24, 0, 0 );
+    QVERIFY( cache.generation() > generation );
+    QVERIFY( !isCached( cache ) );
+    QCOMPARE( cache.statistics().invalidations, quint64( 1 ) );
+}
+
+
+void ResponseCacheTest::testInvalidatedBySense_data()
+{
+    QTest::addColumn<int>( "senseKey" );
+    QTest::addColumn<int>( "asc" );
+
+    QTest::newRow( "medium changed" ) << 0x6 << 0x28;
+    QTest::newRow( "becoming ready" ) << 0x2 << 0x04;
+    QTest::newRow( "no medium" ) << 0x2 << 0x3A;
+    QTest::newRow( "no medium, other sense key" ) << 0x5 << 0x3A;
+}
+
+
+void ResponseCacheTest::testInvalidatedBySense()
+{
+    QFETCH( int, senseKey );
+    QFETCH( int, asc );
+
+    ResponseCache cache;
+    fillCache( cache );
+
+    cache.commandFinished( cdb( K3b::Device::MMC_READ_10 ), false, senseKey, asc, 0, 0 );
+    QVERIFY( !isCached( cache ) );
+}
+
+
+void ResponseCacheTest::testMediaEvent_data()
+{
+    QTest::addColumn<QByteArray>( "data" );
+    QTest::addColumn<bool>( "success" );
+    QTest::addColumn<bool>( "invalidated" );
+
+    QTest::newRow( "new media" ) << mediaEvent( false, 0x4, 0x2 ) << true << true;
+    QTest::newRow( "media removal" ) << mediaEvent( false, 0x4, 0x3 ) << true << true;
+    QTest::newRow( "eject request" ) << mediaEvent( false, 0x4, 0x1 ) << true << true;
+    QTest::newRow( "no change" ) << mediaEvent( false, 0x4, 0x0 ) << true << false;
+    QTest::newRow( "no event available" ) << mediaEvent( true, 0x4, 0x2 ) << true << false;
+    QTest::newRow( "other class" ) << mediaEvent( false, 0x2, 0x2 ) << true << false;
+    QTest::newRow( "failed" ) << mediaEvent( false, 0x4, 0x2 ) << false << false;
+}
+
+
+void ResponseCacheTest::testMediaEvent()
+{
+    QFETCH( QByteArray, data );
+    QFETCH( bool, success );
+    QFETCH( bool, invalidated );
+
+    QCOMPARE( ResponseCache::isMediaEvent( data.constData(), data.size() ), invalidated || !success );
+
+    ResponseCache cache;
+    fillCache( cache );
+    cache.commandFinished( cdb( K3b::Device::MMC_GET_EVENT_STATUS_NOTIFICATION ), success,
+                           success ? 0 : 0x5, success ? 0 : 0x24,
+                           data.constData(), data.size() );
+    QCOMPARE( isCached( cache ), !invalidated );
+}
+
+
+void ResponseCacheTest::testUnitReady()
+{
+    ResponseCache cache;
+
+    // the first successful TEST UNIT READY starts a new generation
+    cache.commandFinished( cdb( K3b::Device::MMC_TEST_UNIT_READY, 6 ), true, 0, 0, 0, 0 );
+    fillCache( cache );
+    const quint64 generation = cache.generation();
+
+    cache.commandFinished( cdb( K3b::Device::MMC_TEST_UNIT_READY, 6 ), true, 0, 0, 0, 0 );
+    QCOMPARE( cache.generation(), generation );
+    QVERIFY( isCached( cache ) );
+
+    // the medium is gone
+    cache.commandFinished( cdb( K3b::Device::MMC_TEST_UNIT_READY, 6 ), false, 0x2, 0x3A, 0, 0 );
+    QVERIFY( cache.generation() > generation );
+    QVERIFY( !isCached( cache ) );
+}
+
+
+void ResponseCacheTest::testInvalidate()
+{
+    // used by the media cache once it noticed a new medium
+    ResponseCache cache;
+    fillCache( cache );
+    const quint64 generation = cache.generation();
+
+    cache.invalidate();
+    QCOMPARE( cache.generation(), generation + 1 );
+    QVERIFY( !isCached( cache ) );
+    QCOMPARE( cache.statistics().invalidations, quint64( 1 ) );
+
+    // an empty cache is not counted
+    cache.invalidate();
+    QCOMPARE( cache.generation(), generation + 2 );
+    QCOMPARE( cache.statistics().invalidations, quint64( 1 ) );
+}
+
+
+void ResponseCacheTest::testStaleResponse()
+{
+    ResponseCache cache;
+    const QByteArray data = response( 's' );
+    quint64 generation = 0;
+    char buf[32];
+    QVERIFY( !cache.lookup( cdb( K3b::Device::MMC_READ_DISC_INFORMATION ), buf, sizeof(buf), generation ) );
+
+    // the medium changed while the command was running
+    cache.invalidate();
+    cache.store( cdb( K3b::Device::MMC_READ_DISC_INFORMATION ), data.constData(), data.size(), generation );
+    QVERIFY( !isCached( cache ) );
+}
@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) 2026 K3b Developers
+ *
+ * This file is part of the K3b project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file "COPYING" for the exact licensing terms.
+ */
+
+#ifndef K3B_RESPONSE_CACHE_TEST_H
+#define K3B_RESPONSE_CACHE_TEST_H
+
+#include <QObject>
+
+class ResponseCacheTest : public QObject
+{
+    Q_OBJECT
+public:
+    ResponseCacheTest();
+private slots:
+    void testCacheable_data();
+    void testCacheable();
+    void testHit();
+    void testKeptByReadCommands();
+    void testInvalidatedByCommand_data();
+    void testInvalidatedByCommand();
+    void testInvalidatedBySense_data();
+    void testInvalidatedBySense();
+    void testMediaEvent_data();
+    void testMediaEvent();
+    void testUnitReady();
+    void testInvalidate();
+    void testStaleResponse();
+};
+
+#endif // K3B_RESPONSE_CACHE_TEST_H